@@ -5,9 +5,11 @@ CLOUD_SERVER_SOURCES = \
 	$(SRC)/Cloud/Client.cpp \
 	$(SRC)/Cloud/Thermal.cpp \
 	$(SRC)/Cloud/Data.cpp \
+	$(SRC)/Cloud/Shards.cpp \
+	$(SRC)/Cloud/Journal.cpp \
 	$(SRC)/Cloud/Sender.cpp \
 	$(SRC)/Cloud/Main.cpp
-CLOUD_SERVER_DEPENDS = ASYNC LIBNET IO OS GEO MATH UTIL
+CLOUD_SERVER_DEPENDS = ASYNC LIBNET IO OS THREAD GEO MATH UTIL
 $(eval $(call link-program,xcsoar-cloud-server,CLOUD_SERVER))
 
 CLOUD_TO_KML_SOURCES = \
@@ -5,6 +5,7 @@ TERRAIN_SOURCES = \
 	$(SRC)/Terrain/RasterMap.cpp \
 	$(SRC)/Terrain/RasterTile.cpp \
 	$(SRC)/Terrain/RasterTileCache.cpp \
+	$(SRC)/Terrain/TileStore.cpp \
 	$(SRC)/Terrain/ZzipStream.cpp \
 	$(SRC)/Terrain/Loader.cpp \
 	$(SRC)/Terrain/WorldFile.cpp \
@@ -14,12 +15,13 @@ TERRAIN_SOURCES = \
 	$(SRC)/Terrain/Thread.cpp \
 	$(SRC)/Terrain/HeightMatrix.cpp \
 	$(SRC)/Terrain/RasterRenderer.cpp \
+	$(SRC)/Terrain/RasterShading.cpp \
 	$(SRC)/Terrain/TerrainRenderer.cpp \
 	$(SRC)/Terrain/TerrainSettings.cpp
 
 TERRAIN_CXXFLAGS_INTERNAL = -Wno-shift-negative-value
 TERRAIN_CPPFLAGS_INTERNAL = $(SCREEN_CPPFLAGS)
 
-TERRAIN_DEPENDS = JASPER ZZIP GEO UTIL
+TERRAIN_DEPENDS = JASPER ZZIP GEO THREAD UTIL
 
 $(eval $(call link-library,libterrain,TERRAIN))
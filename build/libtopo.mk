@@ -1,11 +1,13 @@
 TOPO_SOURCES = \
 	$(SRC)/Topography/ShapeFile.cpp \
+	$(SRC)/Topography/TopographyCache.cpp \
 	$(SRC)/Topography/TopographyFile.cpp \
 	$(SRC)/Topography/TopographyStore.cpp \
 	$(SRC)/Topography/TopographyFileRenderer.cpp \
 	$(SRC)/Topography/TopographyRenderer.cpp \
 	$(SRC)/Topography/Thread.cpp \
 	$(SRC)/Topography/TopographyGlue.cpp \
+	$(SRC)/Topography/AsyncCacheBuilder.cpp \
 	$(SRC)/Topography/XShape.cpp \
 	$(SRC)/Topography/Index.cpp \
 	$(SRC)/Topography/CachedTopographyRenderer.cpp
@@ -210,6 +210,7 @@ XCSOAR_SOURCES := \
 	$(SRC)/Renderer/ClimbPercentRenderer.cpp \
 	$(SRC)/Renderer/RadarRenderer.cpp \
 	\
+	$(SRC)/Airspace/AirspaceCache.cpp \
 	$(SRC)/Airspace/AirspaceGlue.cpp \
 	$(SRC)/Airspace/AirspaceParser.cpp \
 	$(SRC)/Airspace/AirspaceVisibility.cpp \
@@ -248,6 +249,7 @@ XCSOAR_SOURCES := \
 	$(SRC)/Logger/LoggerImpl.cpp \
 	$(SRC)/IGC/IGCFix.cpp \
 	$(SRC)/IGC/IGCWriter.cpp \
+	$(SRC)/IGC/IGCOutputThread.cpp \
 	$(SRC)/IGC/IGCString.cpp \
 	$(SRC)/IGC/Generator.cpp \
 	$(SRC)/util/MD5.cpp \
@@ -490,6 +492,7 @@ XCSOAR_SOURCES := \
 	\
 	$(SRC)/Job/Thread.cpp \
 	$(SRC)/Job/Async.cpp \
+	$(SRC)/Job/Parallel.cpp \
 	\
 	$(SRC)/RateLimiter.cpp \
 	\
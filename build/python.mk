@@ -27,8 +27,10 @@ PYTHON_SOURCES = \
 	$(PYTHON_SRC)/PythonConverters.cpp \
 	$(PYTHON_SRC)/PythonGlue.cpp \
 	$(PYTHON_SRC)/Flight.cpp \
+	$(PYTHON_SRC)/FixBuffer.cpp \
 	$(PYTHON_SRC)/Airspaces.cpp \
 	$(PYTHON_SRC)/Util.cpp \
+	$(PYTHON_SRC)/Batch.cpp \
 	$(ENGINE_SRC_DIR)/Task/TaskBehaviour.cpp \
 	$(SRC)/Logger/Settings.cpp \
 	$(SRC)/TeamCode/Settings.cpp \
@@ -45,13 +47,14 @@ PYTHON_SOURCES = \
 	$(ENGINE_SRC_DIR)/Airspace/AirspaceIntersectionVisitor.cpp \
 	$(ENGINE_SRC_DIR)/Airspace/AirspaceIntersectSort.cpp \
 	$(ENGINE_SRC_DIR)/Airspace/AirspacePolygon.cpp \
+	$(ENGINE_SRC_DIR)/Airspace/PolygonEdgeIndex.cpp \
 	$(ENGINE_SRC_DIR)/Airspace/Airspaces.cpp \
 	$(ENGINE_SRC_DIR)/Airspace/AirspaceSorter.cpp \
 	$(ENGINE_SRC_DIR)/Airspace/AirspaceAircraftPerformance.cpp \
 	$(SRC)/NMEA/Aircraft.cpp
 PYTHON_LDADD = $(DEBUG_REPLAY_LDADD)
 PYTHON_LDLIBS = $(shell python3-config --ldflags)
-PYTHON_DEPENDS = CONTEST WAYPOINT UTIL ZZIP GEO MATH TIME
+PYTHON_DEPENDS = CONTEST WAYPOINT THREAD UTIL ZZIP GEO MATH TIME
 PYTHON_CPPFLAGS = $(shell python3-config --includes) \
 	-I$(TEST_SRC_DIR) -Wno-write-strings
 PYTHON_NO_LIB_PREFIX = y
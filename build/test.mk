@@ -87,7 +87,7 @@ TEST_NAMES = \
 	TestValidity TestUTM \
 	TestAllocatedGrid \
 	TestRadixTree TestGeoBounds TestGeoClip \
-	TestLogger TestGRecord TestClimbAvCalc \
+	TestLogger TestGRecord TestIGCOutputThread TestClimbAvCalc \
 	TestWaypointReader TestThermalBase \
 	TestFlarmNet \
 	TestColorRamp TestGeoPoint TestDiffFilter \
@@ -99,6 +99,7 @@ TEST_NAMES = \
 	TestTaskWaypoint \
 	TestTeamCode \
 	TestZeroFinder \
+	TestFlatCache \
 	TestAirspaceParser \
 	TestMETARParser \
 	TestIGCParser \
@@ -167,6 +168,7 @@ $(eval $(call link-program,TestOverwritingRingBuffer,TEST_OVERWRITING_RING_BUFFE
 
 TEST_IGC_PARSER_SOURCES = \
 	$(SRC)/IGC/IGCParser.cpp \
+	$(SRC)/IGC/IGCScanner.cpp \
 	$(TEST_SRC_DIR)/tap.c \
 	$(TEST_SRC_DIR)/TestIGCParser.cpp
 TEST_IGC_PARSER_DEPENDS = MATH UTIL
@@ -180,8 +182,15 @@ TEST_METAR_PARSER_SOURCES = \
 TEST_METAR_PARSER_DEPENDS = MATH UTIL UNITS
 $(eval $(call link-program,TestMETARParser,TEST_METAR_PARSER))
 
+TEST_FLAT_CACHE_SOURCES = \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestFlatCache.cpp
+TEST_FLAT_CACHE_DEPENDS = IO OS UTIL
+$(eval $(call link-program,TestFlatCache,TEST_FLAT_CACHE))
+
 TEST_AIRSPACE_PARSER_SOURCES = \
 	$(SRC)/Airspace/AirspaceParser.cpp \
+	$(SRC)/Airspace/AirspaceCache.cpp \
 	$(SRC)/Atmosphere/Pressure.cpp \
 	$(SRC)/RadioFrequency.cpp \
 	$(TEST_SRC_DIR)/FakeDialogs.cpp \
@@ -624,6 +633,7 @@ $(eval $(call link-program,TestRadixTree,TEST_RADIX_TREE))
 TEST_LOGGER_SOURCES = \
 	$(SRC)/IGC/IGCFix.cpp \
 	$(SRC)/IGC/IGCWriter.cpp \
+	$(SRC)/IGC/IGCOutputThread.cpp \
 	$(SRC)/IGC/IGCString.cpp \
 	$(SRC)/IGC/Generator.cpp \
 	$(SRC)/Logger/LoggerFRecord.cpp \
@@ -634,9 +644,19 @@ TEST_LOGGER_SOURCES = \
 	$(SRC)/Atmosphere/Pressure.cpp \
 	$(TEST_SRC_DIR)/tap.c \
 	$(TEST_SRC_DIR)/TestLogger.cpp
-TEST_LOGGER_DEPENDS = IO OS GEO MATH UTIL UNITS
+TEST_LOGGER_DEPENDS = IO OS THREAD GEO MATH UTIL UNITS
 $(eval $(call link-program,TestLogger,TEST_LOGGER))
 
+TEST_IGC_OUTPUT_THREAD_SOURCES = \
+	$(SRC)/IGC/IGCOutputThread.cpp \
+	$(SRC)/Logger/GRecord.cpp \
+	$(SRC)/util/MD5.cpp \
+	$(SRC)/Version.cpp \
+	$(TEST_SRC_DIR)/tap.c \
+	$(TEST_SRC_DIR)/TestIGCOutputThread.cpp
+TEST_IGC_OUTPUT_THREAD_DEPENDS = IO OS THREAD UTIL
+$(eval $(call link-program,TestIGCOutputThread,TEST_IGC_OUTPUT_THREAD))
+
 TEST_GRECORD_SOURCES = \
 	$(SRC)/Logger/GRecord.cpp \
 	$(SRC)/util/MD5.cpp \
@@ -727,8 +747,12 @@ DEBUG_PROGRAM_NAMES = \
 	RunMD5 RunSHA256 \
 	ReadGRecord VerifyGRecord AppendGRecord FixGRecord \
 	AddChecksum \
-	LoadTopography LoadTerrain \
-	RunHeightMatrix \
+	LoadTopography ConvertTopography LoadTerrain BenchmarkTerrainLoader \
+	RunHeightMatrix BenchmarkRasterRenderer BenchmarkTerrainHeights \
+	BenchmarkAirspacePolygon \
+	BenchmarkIGCParser \
+	BenchmarkWaypoints \
+	BenchmarkBlackboard \
 	RunInputParser \
 	RunWaypointParser RunAirspaceParser \
 	RunFlightParser \
@@ -805,7 +829,7 @@ DEBUG_PROGRAM_NAMES += DownloadFile \
 	UploadFile \
 	RunWeGlideClient \
 	RunTimClient \
-	RunNOAADownloader RunSkyLinesTracking RunLiveTrack24
+	RunNOAADownloader RunSkyLinesTracking RunSkyLinesLoad RunLiveTrack24
 endif
 
 ifeq ($(TARGET_IS_LINUX),y)
@@ -840,6 +864,7 @@ DEBUG_REPLAY_SOURCES = \
 	$(SRC)/Device/Util/NMEAReader.cpp \
 	$(SRC)/Device/Config.cpp \
 	$(SRC)/IGC/IGCParser.cpp \
+	$(SRC)/IGC/IGCScanner.cpp \
 	$(SRC)/IGC/Generator.cpp \
 	$(SRC)/Formatter/NMEAFormatter.cpp \
 	$(ENGINE_SRC_DIR)/Airspace/AirspaceWarningConfig.cpp \
@@ -993,6 +1018,14 @@ RUN_SL_TRACKING_SOURCES = \
 RUN_SL_TRACKING_DEPENDS = $(DEBUG_REPLAY_DEPENDS)
 $(eval $(call link-program,RunSkyLinesTracking,RUN_SL_TRACKING))
 
+RUN_SL_LOAD_SOURCES = \
+	$(SRC)/net/SocketError.cxx \
+	$(SRC)/Tracking/SkyLines/Assemble.cpp \
+	$(SRC)/TransponderCode.cpp \
+	$(TEST_SRC_DIR)/RunSkyLinesLoad.cpp
+RUN_SL_LOAD_DEPENDS = LIBNET IO OS GEO MATH UTIL
+$(eval $(call link-program,RunSkyLinesLoad,RUN_SL_LOAD))
+
 RUN_LIVETRACK24_SOURCES = \
 	$(DEBUG_REPLAY_SOURCES) \
 	$(SRC)/net/SocketError.cxx \
@@ -1112,6 +1145,20 @@ LOAD_TOPOGRAPHY_DEPENDS = TOPO RESOURCE GEO MATH THREAD IO SYSTEM UTIL ZZIP
 LOAD_TOPOGRAPHY_CPPFLAGS = $(SCREEN_CPPFLAGS)
 $(eval $(call link-program,LoadTopography,LOAD_TOPOGRAPHY))
 
+CONVERT_TOPOGRAPHY_SOURCES = \
+	$(SRC)/Projection/Projection.cpp \
+	$(SRC)/Projection/WindowProjection.cpp \
+	$(SRC)/system/Path.cpp \
+	$(TEST_SRC_DIR)/FakeLogFile.cpp \
+	$(TEST_SRC_DIR)/ConvertTopography.cpp
+ifeq ($(OPENGL),y)
+CONVERT_TOPOGRAPHY_SOURCES += \
+	$(CANVAS_SRC_DIR)/opengl/Triangulate.cpp
+endif
+CONVERT_TOPOGRAPHY_DEPENDS = TOPO RESOURCE GEO MATH THREAD IO SYSTEM UTIL ZZIP
+CONVERT_TOPOGRAPHY_CPPFLAGS = $(SCREEN_CPPFLAGS)
+$(eval $(call link-program,ConvertTopography,CONVERT_TOPOGRAPHY))
+
 LOAD_TERRAIN_SOURCES = \
 	$(SRC)/Operation/ConsoleOperationEnvironment.cpp \
 	$(TEST_SRC_DIR)/LoadTerrain.cpp
@@ -1119,6 +1166,12 @@ LOAD_TERRAIN_CPPFLAGS = $(SCREEN_CPPFLAGS)
 LOAD_TERRAIN_DEPENDS = TERRAIN OPERATION GEO MATH OS IO ZZIP UTIL
 $(eval $(call link-program,LoadTerrain,LOAD_TERRAIN))
 
+BENCHMARK_TERRAIN_LOADER_SOURCES = \
+	$(TEST_SRC_DIR)/BenchmarkTerrainLoader.cpp
+BENCHMARK_TERRAIN_LOADER_CPPFLAGS = $(SCREEN_CPPFLAGS)
+BENCHMARK_TERRAIN_LOADER_DEPENDS = TERRAIN OPERATION GEO MATH THREAD OS IO ZZIP UTIL
+$(eval $(call link-program,BenchmarkTerrainLoader,BENCHMARK_TERRAIN_LOADER))
+
 RUN_HEIGHT_MATRIX_SOURCES = \
 	$(SRC)/Projection/Projection.cpp \
 	$(SRC)/Projection/WindowProjection.cpp \
@@ -1128,6 +1181,24 @@ RUN_HEIGHT_MATRIX_CPPFLAGS = $(SCREEN_CPPFLAGS)
 RUN_HEIGHT_MATRIX_DEPENDS = TERRAIN OPERATION GEO MATH IO OS ZZIP UTIL
 $(eval $(call link-program,RunHeightMatrix,RUN_HEIGHT_MATRIX))
 
+BENCHMARK_RASTER_RENDERER_SOURCES = \
+	$(SRC)/Projection/Projection.cpp \
+	$(SRC)/Projection/WindowProjection.cpp \
+	$(TEST_SRC_DIR)/BenchmarkRasterRenderer.cpp
+ifeq ($(OPENGL),y)
+BENCHMARK_RASTER_RENDERER_SOURCES += \
+	$(SRC)/Renderer/GeoBitmapRenderer.cpp \
+	$(SRC)/ui/event/Idle.cpp
+endif
+BENCHMARK_RASTER_RENDERER_CPPFLAGS = $(SCREEN_CPPFLAGS)
+BENCHMARK_RASTER_RENDERER_DEPENDS = TERRAIN SCREEN OPERATION GEO MATH THREAD IO OS ZZIP UTIL
+$(eval $(call link-program,BenchmarkRasterRenderer,BENCHMARK_RASTER_RENDERER))
+
+BENCHMARK_TERRAIN_HEIGHTS_SOURCES = \
+	$(TEST_SRC_DIR)/BenchmarkTerrainHeights.cpp
+BENCHMARK_TERRAIN_HEIGHTS_DEPENDS = TERRAIN OPERATION GEO MATH THREAD IO OS ZZIP UTIL
+$(eval $(call link-program,BenchmarkTerrainHeights,BENCHMARK_TERRAIN_HEIGHTS))
+
 RUN_INPUT_PARSER_SOURCES = \
 	$(SRC)/Input/InputKeys.cpp \
 	$(SRC)/Input/InputConfig.cpp \
@@ -1161,6 +1232,21 @@ NEAREST_WAYPOINTS_LDADD = $(FAKE_LIBS)
 NEAREST_WAYPOINTS_DEPENDS = WAYPOINTFILE OPERATION IO OS THREAD ZZIP GEO MATH UTIL
 $(eval $(call link-program,NearestWaypoints,NEAREST_WAYPOINTS))
 
+BENCHMARK_WAYPOINTS_SOURCES = \
+	$(SRC)/Waypoint/Factory.cpp \
+	$(SRC)/RadioFrequency.cpp \
+	$(SRC)/Operation/ConsoleOperationEnvironment.cpp \
+	$(TEST_SRC_DIR)/FakeTerrain.cpp \
+	$(TEST_SRC_DIR)/BenchmarkWaypoints.cpp
+BENCHMARK_WAYPOINTS_LDADD = $(FAKE_LIBS)
+BENCHMARK_WAYPOINTS_DEPENDS = WAYPOINTFILE OPERATION IO OS THREAD ZZIP GEO MATH UTIL
+$(eval $(call link-program,BenchmarkWaypoints,BENCHMARK_WAYPOINTS))
+
+BENCHMARK_BLACKBOARD_SOURCES = \
+	$(TEST_SRC_DIR)/BenchmarkBlackboard.cpp
+BENCHMARK_BLACKBOARD_DEPENDS = OS THREAD TIME GEO MATH UTIL
+$(eval $(call link-program,BenchmarkBlackboard,BENCHMARK_BLACKBOARD))
+
 RUN_FLIGHT_PARSER_SOURCES = \
 	$(SRC)/Logger/FlightParser.cpp \
 	$(TEST_SRC_DIR)/RunFlightParser.cpp
@@ -1179,6 +1265,24 @@ RUN_AIRSPACE_PARSER_LDADD = $(FAKE_LIBS)
 RUN_AIRSPACE_PARSER_DEPENDS = AIRSPACE IO OS ZZIP GEO MATH UTIL UNITS
 $(eval $(call link-program,RunAirspaceParser,RUN_AIRSPACE_PARSER))
 
+BENCHMARK_AIRSPACE_POLYGON_SOURCES = \
+	$(SRC)/Airspace/AirspaceParser.cpp \
+	$(SRC)/Atmosphere/Pressure.cpp \
+	$(SRC)/RadioFrequency.cpp \
+	$(TEST_SRC_DIR)/FakeTerrain.cpp \
+	$(TEST_SRC_DIR)/FakeLanguage.cpp \
+	$(TEST_SRC_DIR)/BenchmarkAirspacePolygon.cpp
+BENCHMARK_AIRSPACE_POLYGON_LDADD = $(FAKE_LIBS)
+BENCHMARK_AIRSPACE_POLYGON_DEPENDS = AIRSPACE IO OS ZZIP GEO MATH UTIL UNITS
+$(eval $(call link-program,BenchmarkAirspacePolygon,BENCHMARK_AIRSPACE_POLYGON))
+
+BENCHMARK_IGC_PARSER_SOURCES = \
+	$(SRC)/IGC/IGCParser.cpp \
+	$(SRC)/IGC/IGCScanner.cpp \
+	$(TEST_SRC_DIR)/BenchmarkIGCParser.cpp
+BENCHMARK_IGC_PARSER_DEPENDS = IO OS MATH UTIL
+$(eval $(call link-program,BenchmarkIGCParser,BENCHMARK_IGC_PARSER))
+
 ENUMERATE_PORTS_SOURCES = \
 	$(TEST_SRC_DIR)/EnumeratePorts.cpp
 ENUMERATE_PORTS_DEPENDS = PORT OS
@@ -1426,6 +1530,7 @@ RUN_IGC_WRITER_SOURCES = \
 	$(SRC)/Computer/ClimbAverageCalculator.cpp \
 	$(SRC)/IGC/IGCFix.cpp \
 	$(SRC)/IGC/IGCWriter.cpp \
+	$(SRC)/IGC/IGCOutputThread.cpp \
 	$(SRC)/IGC/IGCString.cpp \
 	$(SRC)/IGC/Generator.cpp \
 	$(SRC)/Logger/LoggerFRecord.cpp \
@@ -2141,6 +2246,7 @@ RUN_ANALYSIS_SOURCES = \
 	$(SRC)/Airspace/ActivePredicate.cpp \
 	$(SRC)/Airspace/ProtectedAirspaceWarningManager.cpp \
 	$(SRC)/Airspace/AirspaceParser.cpp \
+	$(SRC)/Airspace/AirspaceCache.cpp \
 	$(SRC)/Airspace/AirspaceGlue.cpp \
 	$(SRC)/Airspace/AirspaceVisibility.cpp \
 	$(SRC)/Airspace/AirspaceComputerSettings.cpp \
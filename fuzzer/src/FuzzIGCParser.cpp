@@ -2,6 +2,7 @@
 // Copyright The XCSoar Project
 
 #include "IGC/IGCParser.hpp"
+#include "IGC/IGCScanner.hpp"
 #include "IGC/IGCExtensions.hpp"
 #include "IGC/IGCHeader.hpp"
 #include "IGC/IGCFix.hpp"
@@ -47,6 +48,12 @@ LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
       IGCDeclarationTurnpoint tp;
       IGCParseDeclarationTurnpoint(line, tp);
     }
+
+    IGCScanner scanner{{(const std::byte *)data, size}};
+    IGCFix fixes[16];
+    BrokenDate date;
+    while (scanner.Read(fixes) > 0)
+      scanner.TakeDate(date);
   } catch (...) {
     return EXIT_FAILURE;
   }
@@ -0,0 +1,216 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include <Python.h>
+
+#include "Batch.hpp"
+
+#include "PythonConverters.hpp"
+#include "Flight/Flight.hpp"
+#include "Engine/Contest/ContestStatistics.hpp"
+#include "thread/Parallel.hpp"
+#include "thread/WorkerPool.hpp"
+#include "util/Exception.hxx"
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct BatchOptions {
+  unsigned full = 512,
+           triangle = 1024,
+           sprint = 96,
+           max_iterations = 20e6,
+           max_tree_size = 5e6;
+};
+
+/**
+ * The result of AnalyseFlight() for one flight found by
+ * FlightTimes().
+ */
+struct BatchAnalysis {
+  ContestStatistics olc_plus;
+  ContestStatistics dmst;
+
+  PhaseList phase_list;
+  PhaseTotals phase_totals;
+
+  WindList wind_list;
+
+  AtmosphericPressure qnh;
+  bool qnh_available;
+};
+
+struct BatchResult {
+  std::vector<FlightTimeResult> times;
+  std::vector<BatchAnalysis> analyses;
+
+  /**
+   * The error message if the file could not be analysed; empty on
+   * success.
+   */
+  std::string error;
+};
+
+} // anonymous namespace
+
+/**
+ * Analyse all flights in one file.  Runs without the GIL.
+ */
+static void
+AnalyseFile(const char *path, const BatchOptions &options,
+            WorkerPool &pool, BatchResult &result)
+{
+  /* keep the fixes in memory, they're replayed once per flight */
+  Flight flight(path, true);
+
+  flight.Times(result.times);
+
+  for (const auto &times : result.times) {
+    /* score from the release (if known) until the landing */
+    const BrokenDateTime scoring_start = times.release_time.IsPlausible()
+      ? times.release_time
+      : times.takeoff_time;
+
+    auto &analysis = result.analyses.emplace_back();
+    flight.Analyse(times.takeoff_time, scoring_start,
+                   times.landing_time, times.landing_time,
+                   analysis.olc_plus, analysis.dmst,
+                   analysis.phase_list, analysis.phase_totals,
+                   analysis.wind_list,
+                   options.full, options.triangle, options.sprint,
+                   options.max_iterations, options.max_tree_size,
+                   &pool);
+
+    analysis.qnh = flight.qnh;
+    analysis.qnh_available = flight.qnh_available;
+  }
+}
+
+static PyObject *
+WriteBatchResult(const char *path, const BatchResult &result)
+{
+  if (!result.error.empty())
+    return Py_BuildValue("{s:s,s:s}",
+                         "file", path,
+                         "error", result.error.c_str());
+
+  PyObject *py_analyses = PyList_New(0);
+
+  for (const auto &analysis : result.analyses) {
+    PyObject *py_analysis =
+      Python::WriteAnalysis(analysis.olc_plus, analysis.dmst,
+                            analysis.phase_list, analysis.phase_totals,
+                            analysis.wind_list,
+                            analysis.qnh_available ? &analysis.qnh : nullptr);
+    if (py_analysis == nullptr || PyList_Append(py_analyses, py_analysis) != 0) {
+      Py_XDECREF(py_analysis);
+      Py_DECREF(py_analyses);
+      return nullptr;
+    }
+
+    Py_DECREF(py_analysis);
+  }
+
+  PyObject *py_times = Python::WriteFlightTimes(result.times);
+  if (py_times == nullptr) {
+    Py_DECREF(py_analyses);
+    return nullptr;
+  }
+
+  return Py_BuildValue("{s:s,s:N,s:N}",
+                       "file", path,
+                       "times", py_times,
+                       "analyses", py_analyses);
+}
+
+PyObject *
+xcsoar_analyse_batch([[maybe_unused]] PyObject *self,
+                     PyObject *args, PyObject *kwargs)
+{
+  PyObject *py_files;
+  unsigned n_threads = 0;
+  BatchOptions options;
+
+  static char *kwlist[] = {"files", "threads",
+                           "full", "triangle", "sprint",
+                           "max_iterations", "max_tree_size", nullptr};
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|IIIIII", kwlist,
+                                   &py_files, &n_threads,
+                                   &options.full, &options.triangle,
+                                   &options.sprint,
+                                   &options.max_iterations,
+                                   &options.max_tree_size)) {
+    return nullptr;
+  }
+
+  PyObject *py_fast = PySequence_Fast(py_files, "Expected a list of file names.");
+  if (py_fast == nullptr)
+    return nullptr;
+
+  const Py_ssize_t num_files = PySequence_Fast_GET_SIZE(py_fast);
+
+  std::vector<std::string> files;
+  files.reserve(num_files);
+
+  for (Py_ssize_t i = 0; i < num_files; ++i) {
+    const char *path = PyUnicode_AsUTF8(PySequence_Fast_GET_ITEM(py_fast, i));
+    if (path == nullptr) {
+      Py_DECREF(py_fast);
+      return nullptr;
+    }
+
+    files.emplace_back(path);
+  }
+
+  Py_DECREF(py_fast);
+
+  if (n_threads == 0)
+    n_threads = GetProcessorCount();
+
+  n_threads = std::clamp(n_threads, 1U,
+                         std::max(unsigned(files.size()), 1U));
+
+  std::vector<BatchResult> results(files.size());
+
+  Py_BEGIN_ALLOW_THREADS
+
+  /* each thread picks the next file until there are none left, so
+     long flights don't hold up the others; the contest solvers use
+     the same threads, so those which have run out of files help
+     with the remaining ones */
+  std::atomic_size_t next{0};
+
+  WorkerPool pool(n_threads - 1);
+
+  pool.Run(n_threads, [&](unsigned){
+    for (std::size_t i; (i = next.fetch_add(1)) < files.size();) {
+      try {
+        AnalyseFile(files[i].c_str(), options, pool, results[i]);
+      } catch (...) {
+        results[i].error = GetFullMessage(std::current_exception());
+      }
+    }
+  });
+
+  Py_END_ALLOW_THREADS
+
+  PyObject *py_results = PyList_New(0);
+
+  for (std::size_t i = 0; i < files.size(); ++i) {
+    PyObject *py_result = WriteBatchResult(files[i].c_str(), results[i]);
+    if (py_result == nullptr || PyList_Append(py_results, py_result) != 0) {
+      Py_XDECREF(py_result);
+      Py_DECREF(py_results);
+      return nullptr;
+    }
+
+    Py_DECREF(py_result);
+  }
+
+  return py_results;
+}
@@ -0,0 +1,9 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include <Python.h>
+
+/* xcsoar methods */
+PyObject* xcsoar_analyse_batch(PyObject *self, PyObject *args, PyObject *kwargs);
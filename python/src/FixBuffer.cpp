@@ -0,0 +1,137 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include <Python.h>
+
+#include "FixBuffer.hpp"
+#include "Flight/Flight.hpp"
+
+#include <cstring>
+
+static void
+xcsoar_FixBuffer_dealloc(Pyxcsoar_FixBuffer *self)
+{
+  delete self->fixes;
+  Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static Py_ssize_t
+xcsoar_FixBuffer_length(Pyxcsoar_FixBuffer *self)
+{
+  return self->fixes->size();
+}
+
+static int
+xcsoar_FixBuffer_getbuffer(Pyxcsoar_FixBuffer *self, Py_buffer *view,
+                           int flags)
+{
+  if (flags & PyBUF_WRITABLE) {
+    PyErr_SetString(PyExc_BufferError, "xcsoar.FixBuffer is read-only.");
+    view->obj = nullptr;
+    return -1;
+  }
+
+  /* no copy: the view points into the std::vector */
+  view->buf = self->fixes->data();
+  view->obj = (PyObject *)self;
+  Py_INCREF(self);
+  view->len = self->fixes->size() * sizeof(FixRecord);
+  view->readonly = 1;
+  view->itemsize = sizeof(FixRecord);
+  view->format = (flags & PyBUF_FORMAT) ? const_cast<char *>(FixRecord::FORMAT) : nullptr;
+  view->ndim = 1;
+  view->shape = (flags & PyBUF_ND) ? self->shape : nullptr;
+  view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES
+    ? self->strides
+    : nullptr;
+  view->suboffsets = nullptr;
+  view->internal = nullptr;
+  return 0;
+}
+
+static PySequenceMethods xcsoar_FixBuffer_as_sequence = {
+  (lenfunc)xcsoar_FixBuffer_length, /* sq_length */
+};
+
+static PyBufferProcs xcsoar_FixBuffer_as_buffer = {
+  (getbufferproc)xcsoar_FixBuffer_getbuffer, /* bf_getbuffer */
+  nullptr,               /* bf_releasebuffer */
+};
+
+PyTypeObject xcsoar_FixBuffer_Type = {
+  PyVarObject_HEAD_INIT(&PyType_Type, 0 /* obj_size */)
+  "xcsoar.FixBuffer",    /* char *tp_name; */
+  sizeof(Pyxcsoar_FixBuffer), /* int tp_basicsize; */
+  0,                     /* int tp_itemsize; not used much */
+  (destructor)xcsoar_FixBuffer_dealloc, /* destructor tp_dealloc; */
+  0,                     /* printfunc  tp_print; */
+  0,                     /* getattrfunc  tp_getattr; __getattr__ */
+  0,                     /* setattrfunc  tp_setattr; __setattr__ */
+  0,                     /* cmpfunc  tp_compare; __cmp__ */
+  0,                     /* reprfunc  tp_repr; __repr__ */
+  0,                     /* PyNumberMethods *tp_as_number; */
+  &xcsoar_FixBuffer_as_sequence, /* PySequenceMethods *tp_as_sequence; */
+  0,                     /* PyMappingMethods *tp_as_mapping; */
+  0,                     /* hashfunc tp_hash; __hash__ */
+  0,                     /* ternaryfunc tp_call; __call__ */
+  0,                     /* reprfunc tp_str; __str__ */
+  0,                     /* tp_getattro */
+  0,                     /* tp_setattro */
+  &xcsoar_FixBuffer_as_buffer, /* tp_as_buffer */
+  Py_TPFLAGS_DEFAULT,    /* tp_flags */
+  "xcsoar.FixBuffer object; use numpy.asarray() or memoryview() to access the fixes", /* tp_doc */
+};
+
+PyObject* FixBuffer_New(std::vector<FixRecord> &&fixes) {
+  Pyxcsoar_FixBuffer *self =
+    PyObject_New(Pyxcsoar_FixBuffer, &xcsoar_FixBuffer_Type);
+  if (self == nullptr)
+    return nullptr;
+
+  self->fixes = new std::vector<FixRecord>(std::move(fixes));
+  self->shape[0] = self->fixes->size();
+  self->strides[0] = sizeof(FixRecord);
+
+  return (PyObject *)self;
+}
+
+bool FixBuffer_AppendTo(PyObject *py_buffer, Flight &flight) {
+  Py_buffer view;
+  if (PyObject_GetBuffer(py_buffer, &view, PyBUF_RECORDS_RO) != 0)
+    return false;
+
+  if (view.ndim != 1 || view.itemsize != sizeof(FixRecord)) {
+    PyBuffer_Release(&view);
+    PyErr_SetString(PyExc_TypeError, "Expected an array of fixes as returned by Flight.fixes().");
+    return false;
+  }
+
+  /* PyBUF_RECORDS_RO includes PyBUF_FORMAT; other records of the
+     same size would be misinterpreted */
+  if (view.format == nullptr ||
+      std::strcmp(view.format, FixRecord::FORMAT) != 0) {
+    PyBuffer_Release(&view);
+    PyErr_SetString(PyExc_ValueError, "Unexpected record format; expected fixes as returned by Flight.fixes().");
+    return false;
+  }
+
+  const auto *p = (const std::byte *)view.buf;
+  for (Py_ssize_t i = 0; i < view.shape[0]; ++i, p += view.strides[0]) {
+    FixRecord record;
+    std::memcpy(&record, p, sizeof(record));
+    flight.AppendFix(record.ToFix());
+  }
+
+  PyBuffer_Release(&view);
+  return true;
+}
+
+bool FixBuffer_init(PyObject* m) {
+  if (PyType_Ready(&xcsoar_FixBuffer_Type) < 0)
+      return false;
+
+  Py_INCREF(&xcsoar_FixBuffer_Type);
+  PyModule_AddObject(m, "FixBuffer", (PyObject *)&xcsoar_FixBuffer_Type);
+
+  return true;
+}
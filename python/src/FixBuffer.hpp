@@ -0,0 +1,36 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include <Python.h>
+
+#include "Flight/FixRecord.hpp"
+
+#include <vector>
+
+class Flight;
+
+/* xcsoar.FixBuffer: a read-only array of #FixRecord, exported via the
+   buffer protocol */
+struct Pyxcsoar_FixBuffer {
+  PyObject_HEAD std::vector<FixRecord> *fixes;
+  Py_ssize_t shape[1], strides[1];
+};
+
+/**
+ * Create a new xcsoar.FixBuffer object, taking ownership of the
+ * given fixes.
+ */
+PyObject* FixBuffer_New(std::vector<FixRecord> &&fixes);
+
+/**
+ * Append all fixes from an object supporting the buffer protocol
+ * with #FixRecord items (e.g. a xcsoar.FixBuffer or a NumPy array
+ * created from it) to the flight.
+ *
+ * @return false on error (with a Python exception set)
+ */
+bool FixBuffer_AppendTo(PyObject *py_buffer, Flight &flight);
+
+bool FixBuffer_init(PyObject* m);
@@ -6,6 +6,7 @@
 
 #include "Flight.hpp"
 
+#include "FixBuffer.hpp"
 #include "PythonGlue.hpp"
 #include "PythonConverters.hpp"
 #include "Flight/Flight.hpp"
@@ -57,6 +58,12 @@ PyObject* xcsoar_Flight_new(PyTypeObject *type, PyObject *args, PyObject *kwargs
     Py_BEGIN_ALLOW_THREADS
     self->flight = new Flight(self->filename, keep);
     Py_END_ALLOW_THREADS
+  } else if (PyObject_CheckBuffer(py_input_data)) {
+    /* an array returned by Flight.fixes() */
+    self->flight = new Flight();
+
+    if (!FixBuffer_AppendTo(py_input_data, *self->flight))
+      return 0;
   } else if (PySequence_Check(py_input_data) == 1) {
     Py_ssize_t num_items = PySequence_Fast_GET_SIZE(py_input_data);
 
@@ -167,48 +174,72 @@ PyObject* xcsoar_Flight_path(Pyxcsoar_Flight *self, PyObject *args) {
   return py_fixes;
 }
 
-PyObject* xcsoar_Flight_times(Pyxcsoar_Flight *self) {
-  std::vector<FlightTimeResult> results;
+PyObject* xcsoar_Flight_fixes(Pyxcsoar_Flight *self, PyObject *args) {
+  PyObject *py_begin = nullptr,
+           *py_end = nullptr;
 
-  Py_BEGIN_ALLOW_THREADS
-  self->flight->Times(results);
-  Py_END_ALLOW_THREADS
+  if (!PyArg_ParseTuple(args, "|OO", &py_begin, &py_end)) {
+    return nullptr;
+  }
 
-  PyObject *py_times = PyList_New(0);
+  auto begin = std::chrono::system_clock::time_point::min();
+  auto end = std::chrono::system_clock::time_point::max();
 
-  for (auto times : results) {
-    PyObject *py_power_states = PyList_New(0);
+  if (py_begin != nullptr && PyDateTime_Check(py_begin))
+    begin = Python::PyToBrokenDateTime(py_begin).ToTimePoint();
 
-    for (auto power_state : times.power_states) {
-      PyObject *py_power_state = Py_BuildValue("{s:N,s:N,s:O}",
-        "time", Python::BrokenDateTimeToPy(power_state.time),
-        "location", Python::WriteLonLat(power_state.location),
-        "powered", power_state.state == PowerState::ON ? Py_True : Py_False);
+  if (py_end != nullptr && PyDateTime_Check(py_end))
+    end = Python::PyToBrokenDateTime(py_end).ToTimePoint();
 
-      if (PyList_Append(py_power_states, py_power_state) != 0)
-        return nullptr;
+  DebugReplay *replay = self->flight->Replay();
 
-      Py_DECREF(py_power_state);
-    }
+  if (replay == nullptr) {
+    PyErr_SetString(PyExc_IOError, "Can't start replay - file not found.");
+    return nullptr;
+  }
 
-    PyObject *py_single_flight = Py_BuildValue("{s:N,s:N,s:N}",
-      "takeoff", Python::WriteEvent(times.takeoff_time, times.takeoff_location),
-      "landing", Python::WriteEvent(times.landing_time, times.landing_location),
-      "power_states", py_power_states);
+  std::vector<FixRecord> fixes;
 
-    if (times.release_time.IsPlausible()) {
-      PyObject *py_release = Python::WriteEvent(times.release_time, times.release_location);
-      PyDict_SetItemString(py_single_flight, "release", py_release);
-      Py_DECREF(py_release);
-    }
+  Py_BEGIN_ALLOW_THREADS
 
-    if (PyList_Append(py_times, py_single_flight) != 0)
-      return nullptr;
+  while (replay->Next()) {
+    if (replay->Level() == -1) continue;
 
-    Py_DECREF(py_single_flight);
+    const MoreData &basic = replay->Basic();
+    const auto date_time_utc = basic.date_time_utc.ToTimePoint();
+
+    if (date_time_utc < begin)
+      continue;
+    else if (date_time_utc > end)
+      break;
+
+    if (!basic.time_available || !basic.location_available ||
+        !basic.NavAltitudeAvailable())
+      continue;
+
+    IGCFixEnhanced fix;
+    fix.Clear();
+    fix.Apply(basic, replay->Calculated());
+    fix.level = replay->Level();
+
+    fixes.push_back(FixRecord::From(fix));
   }
 
-  return py_times;
+  delete replay;
+
+  Py_END_ALLOW_THREADS
+
+  return FixBuffer_New(std::move(fixes));
+}
+
+PyObject* xcsoar_Flight_times(Pyxcsoar_Flight *self) {
+  std::vector<FlightTimeResult> results;
+
+  Py_BEGIN_ALLOW_THREADS
+  self->flight->Times(results);
+  Py_END_ALLOW_THREADS
+
+  return Python::WriteFlightTimes(results);
 }
 
 PyObject* xcsoar_Flight_reduce(Pyxcsoar_Flight *self, PyObject *args, PyObject *kwargs) {
@@ -320,61 +351,11 @@ PyObject* xcsoar_Flight_analyse(Pyxcsoar_Flight *self, PyObject *args, PyObject
   if (!success)
     Py_RETURN_NONE;
 
-  /* write olc_plus statistics */
-  PyObject *py_olc_plus = Py_BuildValue("{s:N,s:N,s:N}",
-    "classic", Python::WriteContest(olc_plus.result[0], olc_plus.solution[0]),
-    "triangle", Python::WriteContest(olc_plus.result[1], olc_plus.solution[1]),
-    "plus", Python::WriteContest(olc_plus.result[2], olc_plus.solution[2]));
-
-  /* write dmst statistics */
-  PyObject *py_dmst = Py_BuildValue("{s:N}",
-    "quadrilateral", Python::WriteContest(dmst.result[0], dmst.solution[0]));
-
-  /* write contests */
-  PyObject *py_contests = Py_BuildValue("{s:N,s:N}",
-    "olc_plus", py_olc_plus,
-    "dmst", py_dmst);
-
-  /* write fligh phases */
-  PyObject *py_phases = PyList_New(0);
-
-  for (Phase phase : phase_list) {
-    PyObject *py_phase = Python::WritePhase(phase);
-    if (PyList_Append(py_phases, py_phase) != 0)
-      return nullptr;
-
-    Py_DECREF(py_phase);
-  }
-
-  /* write wind list*/
-  PyObject *py_wind_list = PyList_New(0);
-
-  for (WindListItem wind_item: wind_list) {
-    PyObject *py_wind = Python::WriteWindItem(wind_item);
-    if (PyList_Append(py_wind_list, py_wind) != 0)
-      return nullptr;
-
-    Py_DECREF(py_wind);
-  }
-
-  /* write QNH */
-  PyObject *py_qnh;
-
-  if (self->flight->qnh_available) {
-    py_qnh = PyFloat_FromDouble(self->flight->qnh.GetHectoPascal());
-  } else {
-    py_qnh = Py_None;
-    Py_INCREF(Py_None);
-  }
-
-  PyObject *py_result = Py_BuildValue("{s:N,s:N,s:N,s:N,s:N}",
-    "contests", py_contests,
-    "phases", py_phases,
-    "performance", Python::WritePerformanceStats(phase_totals),
-    "wind", py_wind_list,
-    "qnh", py_qnh);
-
-  return py_result;
+  return Python::WriteAnalysis(olc_plus, dmst,
+                               phase_list, phase_totals, wind_list,
+                               self->flight->qnh_available
+                               ? &self->flight->qnh
+                               : nullptr);
 }
 
 PyObject* xcsoar_Flight_encode(Pyxcsoar_Flight *self, PyObject *args) {
@@ -453,6 +434,7 @@ PyObject* xcsoar_Flight_encode(Pyxcsoar_Flight *self, PyObject *args) {
 PyMethodDef xcsoar_Flight_methods[] = {
   {"setQNH", (PyCFunction)xcsoar_Flight_setQNH, METH_VARARGS, "Set QNH for the flight (in hPa)."},
   {"path", (PyCFunction)xcsoar_Flight_path, METH_VARARGS, "Get flight as list."},
+  {"fixes", (PyCFunction)xcsoar_Flight_fixes, METH_VARARGS, "Get flight as xcsoar.FixBuffer (for numpy.asarray())."},
   {"times", (PyCFunction)xcsoar_Flight_times, METH_VARARGS, "Get takeoff/release/landing times from flight."},
   {"reduce", (PyCFunction)xcsoar_Flight_reduce, METH_VARARGS | METH_KEYWORDS, "Reduce flight."},
   {"analyse", (PyCFunction)xcsoar_Flight_analyse, METH_VARARGS | METH_KEYWORDS, "Analyse flight."},
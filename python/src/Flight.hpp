@@ -20,6 +20,7 @@ void xcsoar_Flight_dealloc(Pyxcsoar_Flight *self);
 
 PyObject* xcsoar_Flight_setQNH(Pyxcsoar_Flight *self, PyObject *args);
 PyObject* xcsoar_Flight_path(Pyxcsoar_Flight *self, PyObject *args);
+PyObject* xcsoar_Flight_fixes(Pyxcsoar_Flight *self, PyObject *args);
 PyObject* xcsoar_Flight_times(Pyxcsoar_Flight *self);
 PyObject* xcsoar_Flight_reduce(Pyxcsoar_Flight *self, PyObject *args, PyObject *kwargs);
 PyObject* xcsoar_Flight_analyse(Pyxcsoar_Flight *self, PyObject *args, PyObject *kwargs);
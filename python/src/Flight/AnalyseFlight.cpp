@@ -131,9 +131,12 @@ Run(DebugReplay &replay, FlightPhaseDetector &flight_phase_detector,
 ContestStatistics
 SolveContest(Contest contest,
              Trace &full_trace, Trace &triangle_trace, Trace &sprint_trace,
-             const unsigned max_iterations, const unsigned max_tree_size)
+             const unsigned max_iterations, const unsigned max_tree_size,
+             WorkerPool *pool)
 {
   ContestManager manager(contest, full_trace, triangle_trace, sprint_trace);
+  if (pool != nullptr)
+    manager.SetWorkerPool(*pool);
   manager.SolveExhaustive(max_iterations, max_tree_size);
   return manager.GetStats();
 }
@@ -153,7 +156,8 @@ void AnalyseFlight(DebugReplay &replay,
              const unsigned triangle_points,
              const unsigned sprint_points,
              const unsigned max_iterations,
-             const unsigned max_tree_size)
+             const unsigned max_tree_size,
+             WorkerPool *pool)
 {
   Trace full_trace({}, Trace::null_time, full_points);
   Trace triangle_trace({}, Trace::null_time, triangle_points);
@@ -167,10 +171,10 @@ void AnalyseFlight(DebugReplay &replay,
 
   olc_plus = SolveContest(Contest::OLC_PLUS,
     full_trace, triangle_trace, sprint_trace,
-    max_iterations, max_tree_size);
+    max_iterations, max_tree_size, pool);
   dmst = SolveContest(Contest::DMST,
     full_trace, triangle_trace, sprint_trace,
-    max_iterations, max_tree_size);
+    max_iterations, max_tree_size, pool);
 
   phase_list = flight_phase_detector.GetPhases();
   phase_totals = flight_phase_detector.GetTotals();
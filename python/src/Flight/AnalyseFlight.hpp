@@ -12,6 +12,7 @@
 
 class DebugReplay;
 class Trace;
+class WorkerPool;
 struct ContestStatistics;
 struct ComputerSettings;
 
@@ -44,7 +45,8 @@ Run(DebugReplay &replay, FlightPhaseDetector &flight_phase_detector,
 ContestStatistics
 SolveContest(Contest contest,
              Trace &full_trace, Trace &triangle_trace, Trace &sprint_trace,
-             const unsigned max_iterations, const unsigned max_tree_size);
+             const unsigned max_iterations, const unsigned max_tree_size,
+             WorkerPool *pool = nullptr);
 
 void AnalyseFlight(DebugReplay &replay,
              const BrokenDateTime &takeoff_time,
@@ -61,4 +63,5 @@ void AnalyseFlight(DebugReplay &replay,
              const unsigned triangle_points = 1024,
              const unsigned sprint_points = 96,
              const unsigned max_iterations = 20e6,
-             const unsigned max_tree_size = 5e6);
+             const unsigned max_tree_size = 5e6,
+             WorkerPool *pool = nullptr);
@@ -0,0 +1,83 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "IGCFixEnhanced.hpp"
+#include "time/BrokenDateTime.hpp"
+
+#include <chrono>
+#include <cstdint>
+
+/**
+ * A flat, fixed-size copy of the most important attributes of an
+ * #IGCFixEnhanced.  Arrays of these are exported to Python via the
+ * buffer protocol, which allows NumPy to use them as structured
+ * array without creating a Python object per fix.
+ */
+struct FixRecord {
+  /**
+   * UTC, seconds since the epoch.
+   */
+  int64_t time;
+
+  /**
+   * Degrees.
+   */
+  double latitude, longitude;
+
+  int32_t gps_altitude, pressure_altitude;
+
+  /**
+   * Engine noise level; -1 if not available.
+   */
+  int16_t enl;
+
+  /**
+   * The detail level assigned by Flight::Reduce().
+   */
+  int16_t level;
+
+  uint8_t reserved[4];
+
+  /**
+   * The PEP 3118 format string describing this struct.
+   */
+  static constexpr const char *FORMAT =
+    "T{=q:time:d:latitude:d:longitude:"
+    "i:gps_altitude:i:pressure_altitude:"
+    "h:enl:h:level:4x}";
+
+  static FixRecord From(const IGCFixEnhanced &fix) noexcept {
+    FixRecord r{};
+    r.time = std::chrono::duration_cast<std::chrono::seconds>(
+      BrokenDateTime(fix.date, fix.time).ToTimePoint().time_since_epoch()).count();
+    r.latitude = fix.location.latitude.Degrees();
+    r.longitude = fix.location.longitude.Degrees();
+    r.gps_altitude = fix.gps_altitude;
+    r.pressure_altitude = fix.pressure_altitude;
+    r.enl = fix.enl;
+    r.level = fix.level;
+    return r;
+  }
+
+  IGCFixEnhanced ToFix() const noexcept {
+    IGCFixEnhanced fix;
+    fix.Clear();
+
+    const auto date_time = BrokenDateTime::FromUnixTimeUTC(time);
+    fix.date = date_time;
+    fix.time = date_time;
+    fix.clock = TimeStamp{date_time.DurationSinceMidnight()};
+    fix.location = GeoPoint(Angle::Degrees(longitude),
+                            Angle::Degrees(latitude));
+    fix.gps_valid = true;
+    fix.gps_altitude = gps_altitude;
+    fix.pressure_altitude = pressure_altitude;
+    fix.enl = enl;
+    fix.level = level;
+    return fix;
+  }
+};
+
+static_assert(sizeof(FixRecord) == 40);
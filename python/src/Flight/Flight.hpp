@@ -99,7 +99,8 @@ public:
                const unsigned triangle = 1024,
                const unsigned sprint = 96,
                const unsigned max_iterations = 20e6,
-               const unsigned max_tree_size = 5e6) {
+               const unsigned max_tree_size = 5e6,
+               WorkerPool *pool = nullptr) {
     DebugReplay *replay = Replay();
     if (replay == nullptr) return false;
 
@@ -110,7 +111,7 @@ public:
                   olc_plus, dmst,
                   phase_list, phase_totals, wind_list, computer_settings,
                   full, triangle, sprint,
-                  max_iterations, max_tree_size);
+                  max_iterations, max_tree_size, pool);
     delete replay;
 
     if (!qnh_available && computer_settings.pressure_available) {
@@ -13,6 +13,8 @@
 #include "time/BrokenDateTime.hpp"
 #include "Engine/Contest/ContestTrace.hpp"
 #include "Engine/Contest/ContestResult.hpp"
+#include "Engine/Contest/ContestStatistics.hpp"
+#include "Atmosphere/Pressure.hpp"
 #include "FlightPhaseDetector.hpp"
 
 #if PY_MAJOR_VERSION >= 3
@@ -238,6 +240,107 @@ PyObject* Python::WriteWindItem(const WindListItem &wind_item) {
     "direction", wind_item.wind.bearing.Degrees());
 }
 
+PyObject* Python::WriteFlightTimes(const std::vector<FlightTimeResult> &results) {
+  PyObject *py_times = PyList_New(0);
+
+  for (auto times : results) {
+    PyObject *py_power_states = PyList_New(0);
+
+    for (auto power_state : times.power_states) {
+      PyObject *py_power_state = Py_BuildValue("{s:N,s:N,s:O}",
+        "time", Python::BrokenDateTimeToPy(power_state.time),
+        "location", Python::WriteLonLat(power_state.location),
+        "powered", power_state.state == PowerState::ON ? Py_True : Py_False);
+
+      if (PyList_Append(py_power_states, py_power_state) != 0)
+        return nullptr;
+
+      Py_DECREF(py_power_state);
+    }
+
+    PyObject *py_single_flight = Py_BuildValue("{s:N,s:N,s:N}",
+      "takeoff", Python::WriteEvent(times.takeoff_time, times.takeoff_location),
+      "landing", Python::WriteEvent(times.landing_time, times.landing_location),
+      "power_states", py_power_states);
+
+    if (times.release_time.IsPlausible()) {
+      PyObject *py_release = Python::WriteEvent(times.release_time, times.release_location);
+      PyDict_SetItemString(py_single_flight, "release", py_release);
+      Py_DECREF(py_release);
+    }
+
+    if (PyList_Append(py_times, py_single_flight) != 0)
+      return nullptr;
+
+    Py_DECREF(py_single_flight);
+  }
+
+  return py_times;
+}
+
+PyObject* Python::WriteAnalysis(const ContestStatistics &olc_plus,
+                                const ContestStatistics &dmst,
+                                const PhaseList &phase_list,
+                                const PhaseTotals &phase_totals,
+                                const WindList &wind_list,
+                                const AtmosphericPressure *qnh) {
+  /* write olc_plus statistics */
+  PyObject *py_olc_plus = Py_BuildValue("{s:N,s:N,s:N}",
+    "classic", Python::WriteContest(olc_plus.result[0], olc_plus.solution[0]),
+    "triangle", Python::WriteContest(olc_plus.result[1], olc_plus.solution[1]),
+    "plus", Python::WriteContest(olc_plus.result[2], olc_plus.solution[2]));
+
+  /* write dmst statistics */
+  PyObject *py_dmst = Py_BuildValue("{s:N}",
+    "quadrilateral", Python::WriteContest(dmst.result[0], dmst.solution[0]));
+
+  /* write contests */
+  PyObject *py_contests = Py_BuildValue("{s:N,s:N}",
+    "olc_plus", py_olc_plus,
+    "dmst", py_dmst);
+
+  /* write fligh phases */
+  PyObject *py_phases = PyList_New(0);
+
+  for (Phase phase : phase_list) {
+    PyObject *py_phase = Python::WritePhase(phase);
+    if (PyList_Append(py_phases, py_phase) != 0)
+      return nullptr;
+
+    Py_DECREF(py_phase);
+  }
+
+  /* write wind list*/
+  PyObject *py_wind_list = PyList_New(0);
+
+  for (WindListItem wind_item: wind_list) {
+    PyObject *py_wind = Python::WriteWindItem(wind_item);
+    if (PyList_Append(py_wind_list, py_wind) != 0)
+      return nullptr;
+
+    Py_DECREF(py_wind);
+  }
+
+  /* write QNH */
+  PyObject *py_qnh;
+
+  if (qnh != nullptr) {
+    py_qnh = PyFloat_FromDouble(qnh->GetHectoPascal());
+  } else {
+    py_qnh = Py_None;
+    Py_INCREF(Py_None);
+  }
+
+  PyObject *py_result = Py_BuildValue("{s:N,s:N,s:N,s:N,s:N}",
+    "contests", py_contests,
+    "phases", py_phases,
+    "performance", Python::WritePerformanceStats(phase_totals),
+    "wind", py_wind_list,
+    "qnh", py_qnh);
+
+  return py_result;
+}
+
 PyObject* Python::IGCFixEnhancedToPyTuple(const IGCFixEnhanced &fix) {
   PyObject *py_enl,
            *py_trt,
@@ -5,12 +5,16 @@
 
 #include <Python.h>
 
+#include "Flight/AnalyseFlight.hpp"
+#include "Flight/FlightTimes.hpp"
 #include "util/tstring.hpp"
 #include "time/Stamp.hpp"
 
 struct BrokenDateTime;
 struct GeoPoint;
 struct ContestResult;
+struct ContestStatistics;
+class AtmosphericPressure;
 class ContestTraceVector;
 struct ContestTracePoint;
 struct Phase;
@@ -58,6 +62,25 @@ namespace Python {
 
   PyObject* WriteWindItem(const WindListItem &wind_item);
 
+  /**
+   * Convert the result of FlightTimes() to a list of dicts
+   * (returned by xcsoar.Flight.times())
+   */
+  PyObject* WriteFlightTimes(const std::vector<FlightTimeResult> &results);
+
+  /**
+   * Convert the result of AnalyseFlight() to a python dict
+   * (returned by xcsoar.Flight.analyse())
+   *
+   * @param qnh the QNH, or nullptr if unknown
+   */
+  PyObject* WriteAnalysis(const ContestStatistics &olc_plus,
+                          const ContestStatistics &dmst,
+                          const PhaseList &phase_list,
+                          const PhaseTotals &phase_totals,
+                          const WindList &wind_list,
+                          const AtmosphericPressure *qnh);
+
   /**
    * Convert a IGCFixEnhanced to a tuple
    */
@@ -7,12 +7,15 @@
 
 #include "PythonGlue.hpp"
 #include "Flight.hpp"
+#include "FixBuffer.hpp"
 #include "Airspaces.hpp"
 #include "Util.hpp"
+#include "Batch.hpp"
 
 
 PyMethodDef xcsoar_methods[] = {
   {"encode", (PyCFunction)xcsoar_encode, METH_VARARGS | METH_KEYWORDS, "Encode a list of numbers."},
+  {"analyse_batch", (PyCFunction)xcsoar_analyse_batch, METH_VARARGS | METH_KEYWORDS, "Analyse a list of IGC files in parallel."},
   {nullptr, nullptr, 0, nullptr}
 };
 
@@ -51,6 +54,9 @@ MOD_INIT(xcsoar) {
   if (!Flight_init(m))
     return MOD_ERROR_VAL;
 
+  if (!FixBuffer_init(m))
+    return MOD_ERROR_VAL;
+
   if (!Airspaces_init(m))
     return MOD_ERROR_VAL;
 
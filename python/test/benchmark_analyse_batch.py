@@ -0,0 +1,37 @@
+#!/usr/bin/env python
+
+from __future__ import print_function
+
+import xcsoar
+import argparse
+import multiprocessing
+import time
+
+# Parse command line parameters
+parser = argparse.ArgumentParser(
+    description='Measure xcsoar.analyse_batch() throughput for a set of IGC files.')
+
+parser.add_argument('file_names', type=str, nargs='+')
+parser.add_argument('--max-threads', type=int,
+                    default=multiprocessing.cpu_count())
+
+args = parser.parse_args()
+
+threads = 1
+while True:
+  start = time.time()
+  results = xcsoar.analyse_batch(args.file_names, threads=threads)
+  duration = time.time() - start
+
+  n_flights = sum(len(result.get('analyses', [])) for result in results)
+  n_errors = sum(1 for result in results if 'error' in result)
+
+  print("threads={:3d} files={} flights={} errors={} time={:.2f}s "
+        "=> {:.2f} flights/s".format(threads, len(results), n_flights,
+                                     n_errors, duration,
+                                     n_flights / duration))
+
+  if threads >= args.max_threads:
+    break
+
+  threads = min(threads * 2, args.max_threads)
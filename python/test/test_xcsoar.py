@@ -97,3 +97,20 @@ for i, fix in enumerate(flight.path()):
   print(fix)
 
 del flight
+
+
+print()
+print("Init xcsoar.Flight with an array from Flight.fixes()")
+
+flight = xcsoar.Flight(args.file_name, True)
+fixes = flight.fixes()
+print("{} fixes, {} bytes".format(len(fixes), memoryview(fixes).nbytes))
+
+copy = xcsoar.Flight(fixes)
+assert len(copy.fixes()) == len(fixes)
+
+copy.reduce(max_points=10)
+pprint(copy.encode())
+
+del copy
+del flight
@@ -29,17 +29,18 @@ SendGetComputerSettings() noexcept;
 void
 XCSoarInterface::ReceiveGPS() noexcept
 {
+  auto &device_blackboard = *backend_components->device_blackboard;
+
   {
-    auto &device_blackboard = *backend_components->device_blackboard;
     const std::lock_guard lock{device_blackboard.mutex};
 
-    ReadBlackboardBasic(device_blackboard.Basic());
-
     const NMEAInfo &real = device_blackboard.RealState();
     Private::movement_detected = real.alive && real.gps.real &&
       real.MovementDetected();
   }
 
+  ReadBlackboardBasic(*device_blackboard.LockGetBasicSnapshot());
+
   BroadcastGPSUpdate();
 
   if (!Basic().flarm.traffic.IsEmpty())
@@ -50,11 +51,11 @@ XCSoarInterface::ReceiveGPS() noexcept
 void
 XCSoarInterface::ReceiveCalculated() noexcept
 {
+  auto &device_blackboard = *backend_components->device_blackboard;
+  ReadBlackboardCalculated(*device_blackboard.LockGetCalculatedSnapshot());
+
   {
-    auto &device_blackboard = *backend_components->device_blackboard;
     const std::lock_guard lock{device_blackboard.mutex};
-
-    ReadBlackboardCalculated(device_blackboard.Calculated());
     device_blackboard.ReadComputerSettings(GetComputerSettings());
   }
 
@@ -0,0 +1,217 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "AirspaceCache.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Airspace/AirspaceCircle.hpp"
+#include "Engine/Airspace/AirspacePolygon.hpp"
+#include "io/FlatCache.hpp"
+#include "util/StringAPI.hxx"
+
+#include <stdexcept>
+#include <vector>
+
+using namespace AirspaceCacheFormat;
+
+static Altitude
+ExportAltitude(const AirspaceAltitude &src) noexcept
+{
+  Altitude a{};
+  a.altitude = src.altitude;
+  a.flight_level = src.flight_level;
+  a.altitude_above_terrain = src.altitude_above_terrain;
+  a.reference = uint8_t(src.reference);
+  return a;
+}
+
+static AirspaceAltitude
+ImportAltitude(const Altitude &src) noexcept
+{
+  AirspaceAltitude a;
+  a.altitude = src.altitude;
+  a.flight_level = src.flight_level;
+  a.altitude_above_terrain = src.altitude_above_terrain;
+  a.reference = AltitudeReference(src.reference);
+  return a;
+}
+
+static Point
+ExportPoint(const GeoPoint &src) noexcept
+{
+  return {src.latitude.Radians(), src.longitude.Radians()};
+}
+
+static GeoPoint
+ImportPoint(const Point &src) noexcept
+{
+  return {Angle::Radians(src.longitude), Angle::Radians(src.latitude)};
+}
+
+void
+SaveAirspaceCache(FileCache &cache, const TCHAR *name, Path original_path,
+                  const TCHAR *source, const Airspaces &airspaces)
+{
+  std::vector<Record> records;
+  std::vector<Point> points;
+  FlatCache::StringTable strings;
+
+  const StringRef source_ref = strings.Add(source);
+
+  for (const auto &i : airspaces.QueryAll()) {
+    const AbstractAirspace &as = i.GetAirspace();
+
+    Record r{};
+    r.base = ExportAltitude(as.GetBase());
+    r.top = ExportAltitude(as.GetTop());
+    r.first_point = points.size();
+
+    switch (as.GetShape()) {
+    case AbstractAirspace::Shape::CIRCLE:
+      r.radius = static_cast<const AirspaceCircle &>(as).GetRadius();
+      points.push_back(ExportPoint(as.GetReferenceLocation()));
+      break;
+
+    case AbstractAirspace::Shape::POLYGON:
+      for (const auto &p : as.GetPoints())
+        points.push_back(ExportPoint(p.GetLocation()));
+      break;
+    }
+
+    r.n_points = points.size() - r.first_point;
+    r.name = strings.Add(as.GetName());
+
+    const auto radio_frequency = as.GetRadioFrequency();
+    r.radio_frequency = radio_frequency.IsDefined()
+      ? radio_frequency.GetKiloHertz()
+      : 0;
+
+    r.shape = uint8_t(as.GetShape());
+    r.asclass = as.GetClass();
+    r.astype = as.GetType();
+    r.days = as.GetDays().GetMask();
+    records.push_back(r);
+  }
+
+  const auto chars = strings.GetChars();
+
+  FlatCache::Writer writer(cache, name, original_path);
+
+  Trailer trailer{};
+  trailer.magic = MAGIC;
+  trailer.version = VERSION;
+  trailer.n_records = records.size();
+  trailer.n_points = points.size();
+  trailer.n_chars = chars.size();
+  trailer.source = source_ref;
+  trailer.records_offset = writer.GetPosition();
+
+  writer.Write(records);
+  writer.Write(points);
+  writer.Write(chars);
+  writer.Commit(trailer);
+}
+
+[[gnu::pure]]
+static bool
+IsValidAltitude(const Altitude &a) noexcept
+{
+  return a.reference <= uint8_t(AltitudeReference::STD);
+}
+
+[[gnu::pure]]
+static bool
+IsValidRecord(const Record &r, const Trailer &trailer) noexcept
+{
+  if (r.first_point > trailer.n_points ||
+      r.n_points > trailer.n_points - r.first_point ||
+      r.name >= trailer.n_chars ||
+      r.asclass >= AIRSPACECLASSCOUNT || r.astype >= AIRSPACECLASSCOUNT ||
+      !IsValidAltitude(r.base) || !IsValidAltitude(r.top))
+    return false;
+
+  switch (AbstractAirspace::Shape(r.shape)) {
+  case AbstractAirspace::Shape::CIRCLE:
+    return r.n_points == 1 && r.radius >= 0;
+
+  case AbstractAirspace::Shape::POLYGON:
+    return r.n_points >= 3;
+  }
+
+  return false;
+}
+
+static AirspacePtr
+ImportAirspace(const Record &r, std::span<const Point> points,
+               const TCHAR *chars)
+{
+  AirspacePtr as;
+
+  if (AbstractAirspace::Shape(r.shape) == AbstractAirspace::Shape::CIRCLE) {
+    as = std::make_shared<AirspaceCircle>(ImportPoint(points.front()),
+                                          r.radius);
+  } else {
+    std::vector<GeoPoint> v;
+    v.reserve(points.size());
+    for (const auto &p : points)
+      v.push_back(ImportPoint(p));
+
+    as = std::make_shared<AirspacePolygon>(v);
+  }
+
+  as->SetProperties(chars + r.name, AirspaceClass(r.asclass),
+                    AirspaceClass(r.astype),
+                    ImportAltitude(r.base), ImportAltitude(r.top));
+
+  if (r.radio_frequency != 0)
+    as->SetRadioFrequency(RadioFrequency::FromKiloHertz(r.radio_frequency));
+
+  AirspaceActivity days;
+  days.SetMask(r.days);
+  as->SetDays(days);
+
+  return as;
+}
+
+static void
+LoadAirspaceCache(std::span<const std::byte> raw, const TCHAR *source,
+                  Airspaces &airspaces)
+{
+  FlatCache::Reader reader(raw);
+  const auto trailer = reader.ReadTrailer<Trailer>();
+  if (trailer.magic != MAGIC || trailer.version != VERSION)
+    throw std::runtime_error("Malformed airspace cache");
+
+  reader.Seek(trailer.records_offset);
+  const auto records = reader.Read<Record>(trailer.n_records);
+  const auto points = reader.Read<Point>(trailer.n_points);
+  const auto chars = reader.ReadStrings(trailer.n_chars);
+  reader.Finish();
+
+  for (const auto &r : records)
+    if (!IsValidRecord(r, trailer))
+      throw std::runtime_error("Malformed airspace cache record");
+
+  if (!StringIsEqual(FlatCache::GetString(chars, trailer.source), source))
+    throw std::runtime_error("Airspace cache is for a different file");
+
+  std::vector<AirspacePtr> result;
+  result.reserve(records.size());
+
+  for (const auto &r : records)
+    result.push_back(ImportAirspace(r, points.subspan(r.first_point,
+                                                      r.n_points),
+                                    chars.data()));
+
+  for (auto &i : result)
+    airspaces.Add(std::move(i));
+}
+
+bool
+LoadAirspaceCache(FileCache &cache, const TCHAR *name, Path original_path,
+                  const TCHAR *source, Airspaces &airspaces)
+{
+  return FlatCache::Load(cache, name, original_path,
+                         [&](std::unique_ptr<FileMapping> &&mapping){
+                           LoadAirspaceCache(*mapping, source, airspaces);
+                         });
+}
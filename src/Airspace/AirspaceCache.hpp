@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include <cstdint>
+#include <tchar.h>
+
+class FileCache;
+class Path;
+class Airspaces;
+
+/**
+ * On-disk layout of an airspace cache file: the parsed airspaces of
+ * one airspace file, with arcs and circles already converted, which
+ * can be loaded without parsing the original file again.
+ *
+ * This is a #FlatCache file which consists of an array of #Record,
+ * an array of #Point, a FlatCache::StringTable and a #Trailer at the
+ * very end.
+ */
+namespace AirspaceCacheFormat {
+
+static constexpr uint32_t MAGIC = 0x41535043;
+static constexpr uint32_t VERSION = 1;
+
+/**
+ * See FlatCache::StringRef.
+ */
+using StringRef = uint32_t;
+
+struct Altitude {
+  double altitude, flight_level, altitude_above_terrain;
+  uint8_t reference;
+  uint8_t reserved[7];
+};
+
+struct Point {
+  /**
+   * The location in radians.
+   */
+  double latitude, longitude;
+};
+
+struct Record {
+  Altitude base, top;
+
+  /**
+   * The radius of a circle in metres; unused for polygons.
+   */
+  double radius;
+
+  /**
+   * The position and number of points in the #Point array.  A
+   * polygon has at least three points; a circle has exactly one
+   * (its center).
+   */
+  uint32_t first_point, n_points;
+
+  StringRef name;
+
+  /**
+   * The radio frequency in kHz; 0 if not defined.
+   */
+  uint32_t radio_frequency;
+
+  uint8_t shape, asclass, astype, days;
+  uint8_t reserved[4];
+};
+
+struct Trailer {
+  uint32_t magic;
+  uint32_t version;
+
+  uint32_t n_records, n_points, n_chars;
+
+  /**
+   * The string which identifies the original file; it is compared
+   * on loading, in addition to the size and modification time
+   * checked by #FileCache.
+   */
+  StringRef source;
+
+  uint64_t records_offset;
+};
+
+} // namespace AirspaceCacheFormat
+
+/**
+ * Write all airspaces of the given container (which were all parsed
+ * from the same file) to a new cache file.  Airspaces::Optimise()
+ * must have been called.
+ *
+ * Throws on error.
+ *
+ * @param source a string identifying the original file
+ */
+void
+SaveAirspaceCache(FileCache &cache, const TCHAR *name, Path original_path,
+                  const TCHAR *source, const Airspaces &airspaces);
+
+/**
+ * Load airspaces from a cache file and add them to the #Airspaces
+ * container.
+ *
+ * Throws if the cache file is malformed; it is deleted in this case
+ * and nothing has been added.
+ *
+ * @return false if there is no up-to-date cache file
+ */
+bool
+LoadAirspaceCache(FileCache &cache, const TCHAR *name, Path original_path,
+                  const TCHAR *source, Airspaces &airspaces);
@@ -3,6 +3,7 @@
 
 #include "Airspace/AirspaceGlue.hpp"
 #include "Airspace/AirspaceParser.hpp"
+#include "Airspace/AirspaceCache.hpp"
 #include "Engine/Airspace/Airspaces.hpp"
 #include "Atmosphere/Pressure.hpp"
 #include "Profile/Keys.hpp"
@@ -22,21 +23,82 @@
 
 #include <string.h>
 
-static bool
-ParseAirspaceFile(Airspaces &airspaces, Path path,
-                  OperationEnvironment &operation) noexcept
-try {
-  FileReader file_reader{path};
-  ProgressReader progress_reader{file_reader, file_reader.GetSize(), operation};
-  BufferedReader buffered_reader{progress_reader};
+/**
+ * Load airspaces from the #FileCache if it is up to date; if not,
+ * call the given parser and save its result to a new cache file.
+ *
+ * Throws on error.
+ *
+ * @param parse a function which parses the original file into the
+ * given #Airspaces container
+ */
+template<typename P>
+static void
+ParseCachedAirspaceFile(Airspaces &airspaces, FileCache *cache,
+                        const TCHAR *cache_name, Path original_path,
+                        P &&parse)
+{
+  if (cache == nullptr) {
+    parse(airspaces);
+    return;
+  }
+
+  try {
+    if (LoadAirspaceCache(*cache, cache_name, original_path,
+                          original_path.c_str(), airspaces))
+      return;
+  } catch (...) {
+    LogError(std::current_exception(), "Failed to load airspace cache");
+  }
+
+  Airspaces parsed;
+
+  const auto move_all = [&]{
+    parsed.Optimise();
+    for (const auto &i : parsed.QueryAll())
+      airspaces.Add(i.GetAirspacePtr());
+  };
+
+  try {
+    parse(parsed);
+  } catch (...) {
+    /* keep the airspaces which were parsed before the error, but
+       don't cache them */
+    move_all();
+    throw;
+  }
+
+  parsed.Optimise();
 
   try {
-    ParseAirspaceFile(airspaces, buffered_reader);
+    SaveAirspaceCache(*cache, cache_name, original_path,
+                      original_path.c_str(), parsed);
   } catch (...) {
-    // TODO translate this?
-    std::throw_with_nested(FmtRuntimeError("Error in file {}", path));
+    LogError(std::current_exception(), "Failed to save airspace cache");
   }
 
+  move_all();
+}
+
+static bool
+ParseAirspaceFile(Airspaces &airspaces, FileCache *cache,
+                  const TCHAR *cache_name, Path path,
+                  OperationEnvironment &operation) noexcept
+try {
+  ParseCachedAirspaceFile(airspaces, cache, cache_name, path,
+                          [&](Airspaces &dest){
+    FileReader file_reader{path};
+    ProgressReader progress_reader{file_reader, file_reader.GetSize(), operation};
+    BufferedReader buffered_reader{progress_reader};
+
+    try {
+      ParseAirspaceFile(dest, buffered_reader);
+    } catch (...) {
+      // TODO translate this?
+      std::throw_with_nested(FmtRuntimeError("Error in file {}", path));
+    }
+  });
+
   return true;
 } catch (...) {
   LogError(std::current_exception());
@@ -44,21 +106,29 @@ try {
   return false;
 }
 
+/**
+ * @param archive_path the path of the ZIP file, which is used to
+ * check whether the cache file is up to date
+ */
 static bool
-ParseAirspaceFile(Airspaces &airspaces,
+ParseAirspaceFile(Airspaces &airspaces, FileCache *cache,
+                  const TCHAR *cache_name, Path archive_path,
                   struct zzip_dir *dir, const char *path,
                   OperationEnvironment &operation)
 try {
-  ZipReader zip_reader{dir, path};
-  ProgressReader progress_reader{zip_reader, zip_reader.GetSize(), operation};
-  BufferedReader buffered_reader{progress_reader};
+  ParseCachedAirspaceFile(airspaces, cache, cache_name, archive_path,
+                          [&](Airspaces &dest){
+    ZipReader zip_reader{dir, path};
+    ProgressReader progress_reader{zip_reader, zip_reader.GetSize(), operation};
+    BufferedReader buffered_reader{progress_reader};
 
-  try {
-    ParseAirspaceFile(airspaces, buffered_reader);
-  } catch (...) {
-    // TODO translate this?
-    std::throw_with_nested(FmtRuntimeError("Error in file {}", path));
-  }
+    try {
+      ParseAirspaceFile(dest, buffered_reader);
+    } catch (...) {
+      // TODO translate this?
+      std::throw_with_nested(FmtRuntimeError("Error in file {}", path));
+    }
+  });
 
   return true;
 } catch (...) {
@@ -70,6 +140,7 @@ try {
 void
 ReadAirspace(Airspaces &airspaces,
              AtmosphericPressure press,
+             FileCache *cache,
              OperationEnvironment &operation)
 {
   LogString("ReadAirspace");
@@ -80,17 +151,22 @@ ReadAirspace(Airspaces &airspaces,
   // Read the airspace filenames from the registry
   if (const auto path = Profile::GetPath(ProfileKeys::AirspaceFile);
       path != nullptr)
-    airspace_ok |= ParseAirspaceFile(airspaces, path, operation);
+    airspace_ok |= ParseAirspaceFile(airspaces, cache, _T("airspace-primary"),
+                                     path, operation);
 
   if (const auto path = Profile::GetPath(ProfileKeys::AdditionalAirspaceFile);
       path != nullptr)
-    airspace_ok |= ParseAirspaceFile(airspaces, path, operation);
+    airspace_ok |= ParseAirspaceFile(airspaces, cache,
+                                     _T("airspace-additional"),
+                                     path, operation);
 
   try {
     if (auto archive = OpenMapFile();
         archive && archive->Exists("airspace.txt"))
-      airspace_ok |= ParseAirspaceFile(airspaces, archive->get(),
-                                       "airspace.txt", operation);
+      airspace_ok |= ParseAirspaceFile(airspaces, cache, _T("airspace-map"),
+                                       Profile::GetPath(ProfileKeys::MapFile),
+                                       archive->get(), "airspace.txt",
+                                       operation);
   } catch (...) {
     LogError(std::current_exception(),
              "Failed to load airspaces from map file");
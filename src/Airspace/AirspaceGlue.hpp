@@ -7,13 +7,18 @@ class RasterTerrain;
 class AtmosphericPressure;
 class Airspaces;
 class OperationEnvironment;
+class FileCache;
 
 /**
  * Reads the airspace files into the memory
+ *
+ * @param cache if not nullptr, then parsed airspace files are cached
+ * there, and unmodified files are loaded from the cache
  */
 void
 ReadAirspace(Airspaces &airspaces,
              AtmosphericPressure press,
+             FileCache *cache,
              OperationEnvironment &operation);
 
 void
@@ -0,0 +1,101 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+
+/**
+ * An immutable copy of a blackboard structure which can be shared
+ * between threads.  Readers obtain a reference-counted pointer to the
+ * current snapshot (which is cheap) instead of copying the whole
+ * structure while holding the blackboard mutex.
+ *
+ * The writer prepares the next snapshot in one of a few recycled
+ * buffers without holding a lock, and then publishes it by swapping
+ * pointers.  A buffer is reused only after all readers have released
+ * it; if none is free (because readers keep old snapshots), a new one
+ * is allocated.
+ *
+ * This class does not have its own mutex; the owner protects
+ * #current (i.e. Get(), GetSnapshot() and Commit()) with its own
+ * lock.  Prepare() may only be called by one thread at a time.
+ */
+template<typename T>
+class BlackboardSnapshot {
+  /**
+   * The number of buffers besides #current: one which may still be
+   * used by a reader and one which is being prepared.
+   */
+  static constexpr std::size_t N_SPARE = 2;
+
+  std::shared_ptr<T> current;
+
+  std::array<std::shared_ptr<T>, N_SPARE> spare;
+
+public:
+  BlackboardSnapshot() noexcept
+    :current(std::make_shared<T>()) {}
+
+  BlackboardSnapshot(const BlackboardSnapshot &) = delete;
+  BlackboardSnapshot &operator=(const BlackboardSnapshot &) = delete;
+
+  /**
+   * Returns the current snapshot.  The reference is valid while the
+   * owner's lock is held.
+   */
+  const T &Get() const noexcept {
+    return *current;
+  }
+
+  /**
+   * Returns a new reference to the current snapshot, which remains
+   * valid after the owner's lock has been released.
+   */
+  std::shared_ptr<const T> GetSnapshot() const noexcept {
+    return current;
+  }
+
+  /**
+   * Copy the given value into a buffer which is not visible to
+   * readers.  This does not need the owner's lock.
+   *
+   * @return the prepared buffer, to be passed to Commit()
+   */
+  std::shared_ptr<T> &Prepare(const T &src) noexcept {
+    for (auto &i : spare) {
+      if (i && i.use_count() == 1) {
+        /* synchronise with the release of the last reader before
+           overwriting the buffer */
+        std::atomic_thread_fence(std::memory_order_acquire);
+        *i = src;
+        return i;
+      }
+    }
+
+    /* all buffers are in use: allocate a new one (or replace a
+       buffer which is still referenced by a reader, which keeps it
+       alive) */
+    auto &slot = spare.front() ? spare.back() : spare.front();
+    slot = std::make_shared<T>(src);
+    return slot;
+  }
+
+  /**
+   * Make the buffer returned by Prepare() the current snapshot.  The
+   * caller must hold the owner's lock.
+   */
+  void Commit(std::shared_ptr<T> &prepared) noexcept {
+    current.swap(prepared);
+  }
+
+  /**
+   * Prepare() and Commit() in one step.  The caller must hold the
+   * owner's lock.
+   */
+  void Publish(const T &src) noexcept {
+    Commit(Prepare(src));
+  }
+};
@@ -15,7 +15,10 @@ DeviceBlackboard::DeviceBlackboard() noexcept
 {
   // Clear the gps_info and calculated_info
   gps_info.Reset();
+
+  DerivedInfo calculated_info;
   calculated_info.Reset();
+  calculated.Publish(calculated_info);
 
   // Set GPS assumed time to system time
   gps_info.UpdateClock();
@@ -28,6 +31,8 @@ DeviceBlackboard::DeviceBlackboard() noexcept
 
   simulator.Init(simulator_data);
 
+  PublishBasic();
+
   real_clock.Reset();
   replay_clock.Reset();
 }
@@ -3,14 +3,18 @@
 
 #pragma once
 
-#include "Blackboard/BaseBlackboard.hpp"
+#include "Blackboard/BlackboardSnapshot.hpp"
 #include "Blackboard/ComputerSettingsBlackboard.hpp"
+#include "NMEA/MoreData.hpp"
+#include "NMEA/Derived.hpp"
 #include "Device/Simulator.hpp"
 #include "Device/Features.hpp"
 #include "thread/Mutex.hxx"
 #include "time/WrapClock.hpp"
 
 #include <array>
+#include <memory>
+#include <utility>
 
 class AtmosphericPressure;
 class OperationEnvironment;
@@ -22,14 +26,33 @@ class RadioFrequency;
  * 
  * The DeviceBlackboard is used as the global ground truth-state
  * since it is accessed quickly with only one mutex
+ *
+ * The merged basic data and the calculated data are also published
+ * as immutable snapshots (see #BlackboardSnapshot), which other
+ * threads can obtain without copying them while holding the mutex.
  */
-class DeviceBlackboard
-  : public BaseBlackboard, public ComputerSettingsBlackboard
+class DeviceBlackboard : public ComputerSettingsBlackboard
 {
   friend class MergeThread;
 
   Simulator simulator;
 
+  /**
+   * The merged data, which is modified by the #MergeThread.
+   */
+  MoreData gps_info;
+
+  /**
+   * Snapshots of #gps_info, published by the #MergeThread.
+   */
+  BlackboardSnapshot<MoreData> basic_snapshot;
+
+  /**
+   * The results of the #GlideComputer, published by the
+   * #CalculationThread.
+   */
+  BlackboardSnapshot<DerivedInfo> calculated;
+
   /**
    * Data from each physical device.
    */
@@ -62,13 +85,63 @@ public:
   DeviceBlackboard() noexcept;
 
   /**
-   * Reads the given derived_info usually provided by the
-   * GlideComputerBlackboard and saves it to the own Blackboard
+   * Caller must lock the blackboard.
+   */
+  const MoreData &Basic() const noexcept {
+    return gps_info;
+  }
+
+  /**
+   * Caller must lock the blackboard.
+   */
+  const DerivedInfo &Calculated() const noexcept {
+    return calculated.Get();
+  }
+
+  /**
+   * Obtain a reference to the most recently published snapshot of
+   * Basic().  The method takes care for locking and unlocking the
+   * mutex.
+   */
+  std::shared_ptr<const MoreData> LockGetBasicSnapshot() noexcept {
+    const std::lock_guard lock{mutex};
+    return basic_snapshot.GetSnapshot();
+  }
+
+  /**
+   * Obtain a reference to the current Calculated() data.  The method
+   * takes care for locking and unlocking the mutex.
+   */
+  std::shared_ptr<const DerivedInfo> LockGetCalculatedSnapshot() noexcept {
+    const std::lock_guard lock{mutex};
+    return calculated.GetSnapshot();
+  }
+
+  /**
+   * Obtain both snapshots at once, under the same lock, so the
+   * calculated data belongs to the basic data.
+   */
+  std::pair<std::shared_ptr<const MoreData>,
+            std::shared_ptr<const DerivedInfo>>
+  LockGetSnapshots() noexcept {
+    const std::lock_guard lock{mutex};
+    return {basic_snapshot.GetSnapshot(), calculated.GetSnapshot()};
+  }
+
+  /**
+   * Publish the given derived_info usually provided by the
+   * GlideComputerBlackboard.  The data is copied without holding the
+   * mutex; the method locks it only to swap the snapshot.  Must not
+   * be called by more than one thread at a time.
+   *
    * @param derived_info Calculated information usually provided
    * by the GlideComputerBlackboard
    */
-  void ReadBlackboard(const DerivedInfo &derived_info) noexcept {
-    calculated_info = derived_info;
+  void LockPublishCalculated(const DerivedInfo &derived_info) noexcept {
+    auto &prepared = calculated.Prepare(derived_info);
+
+    const std::lock_guard lock{mutex};
+    calculated.Commit(prepared);
   }
 
   /**
@@ -166,4 +239,12 @@ public:
    * Caller must lock the blackboard.
    */
   void Merge() noexcept;
+
+  /**
+   * Publish the current Basic() data as a new snapshot.  Caller must
+   * lock the blackboard.
+   */
+  void PublishBasic() noexcept {
+    basic_snapshot.Publish(gps_info);
+  }
 };
@@ -63,12 +63,14 @@ CalculationThread::Tick() noexcept
 
   // update and transfer master info to glide computer
   {
-    const std::lock_guard lock{device_blackboard.mutex};
+    /* the snapshot is immutable; copying it does not need to block
+       the DeviceBlackboard */
+    const auto basic = device_blackboard.LockGetBasicSnapshot();
 
-    gps_updated = device_blackboard.Basic().location_available.Modified(glide_computer.Basic().location_available);
+    gps_updated = basic->location_available.Modified(glide_computer.Basic().location_available);
 
     // Copy data from DeviceBlackboard to GlideComputerBlackboard
-    glide_computer.ReadBlackboard(device_blackboard.Basic());
+    glide_computer.ReadBlackboard(*basic);
   }
 
   bool force;
@@ -95,10 +97,7 @@ CalculationThread::Tick() noexcept
   // values changed, so copy them back now: ONLY CALCULATED INFO
   // should be changed in DoCalculations, so we only need to write
   // that one back (otherwise we may write over new data)
-  {
-    const std::lock_guard lock{device_blackboard.mutex};
-    device_blackboard.ReadBlackboard(glide_computer.Calculated());
-  }
+  device_blackboard.LockPublishCalculated(glide_computer.Calculated());
 
   // if (new GPS data)
   if (gps_updated || force)
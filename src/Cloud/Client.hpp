@@ -196,6 +196,14 @@ public:
     return list.empty();
   }
 
+  unsigned GetNextId() const noexcept {
+    return next_id;
+  }
+
+  void SetNextId(unsigned _next_id) noexcept {
+    next_id = _next_id;
+  }
+
   /**
    * For iteration over the list of all clients in unspecified order.
    * The iterators get invalidated by all modifying calls.
@@ -0,0 +1,319 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Journal.hpp"
+#include "Shards.hpp"
+#include "Serialiser.hpp"
+#include "io/FileOutputStream.hxx"
+#include "io/FileReader.hxx"
+#include "system/FileUtil.hpp"
+#include "util/PrintException.hxx"
+
+#include <chrono>
+#include <iostream>
+
+using std::cout;
+using std::cerr;
+using std::endl;
+
+static constexpr uint32_t JOURNAL_MAGIC = 0x5753f610;
+static constexpr uint32_t JOURNAL_VERSION = 1;
+
+/**
+ * How often are queued records written to the journal file?  This is
+ * the maximum amount of data lost on a crash.
+ */
+static constexpr auto WRITE_INTERVAL = std::chrono::seconds(1);
+
+/**
+ * Compact the journal when it grows beyond this size, even if no
+ * compaction has been requested.
+ */
+static constexpr uint64_t MAX_JOURNAL_SIZE = 256 * 1024 * 1024;
+
+enum class JournalRecordType : uint8_t {
+  CLIENT = 1,
+  REMOVE_CLIENT = 2,
+  THERMAL = 3,
+};
+
+CloudJournal::CloudJournal(Path _snapshot_path, const CloudShards &_shards)
+  :Thread("journal"),
+   snapshot_path(_snapshot_path),
+   path(snapshot_path + ".journal"),
+   old_path(snapshot_path + ".journal.old"),
+   shards(_shards) {}
+
+CloudJournal::~CloudJournal() noexcept
+{
+  if (IsDefined())
+    Stop();
+}
+
+/**
+ * Is there no more data?
+ */
+static bool
+IsEOF(Deserialiser &s)
+{
+  return s.Read().empty() && !s.Fill(true);
+}
+
+void
+CloudJournal::ReplayFile(CloudShards &dest, Path p) const
+{
+  if (!File::Exists(p))
+    return;
+
+  FileReader fr(p);
+  Deserialiser s(fr);
+
+  if (s.Read32() != JOURNAL_MAGIC)
+    throw std::runtime_error("Bad magic");
+
+  if (s.Read32() != JOURNAL_VERSION)
+    throw std::runtime_error("Bad version");
+
+  unsigned n = 0;
+
+  /* a crash may have left a truncated record at the end; everything
+     before it is applied */
+  try {
+    while (!IsEOF(s)) {
+      switch (JournalRecordType(s.Read8())) {
+      case JournalRecordType::CLIENT:
+        dest.ReplayClient(CloudClient::Load(s));
+        break;
+
+      case JournalRecordType::REMOVE_CLIENT:
+        dest.ReplayRemoveClient(s.Read64());
+        break;
+
+      case JournalRecordType::THERMAL:
+        dest.ReplayThermal(CloudThermal::Load(s));
+        break;
+
+      default:
+        throw std::runtime_error("Malformed record");
+      }
+
+      ++n;
+    }
+  } catch (...) {
+    cerr << "Failed to read " << p.c_str() << endl;
+    PrintException(std::current_exception());
+  }
+
+  cout << "Replayed " << n << " records from " << p.c_str() << endl;
+}
+
+void
+CloudJournal::Replay(CloudShards &dest) const
+{
+  /* the old journal is older than the current one; it exists only
+     if the last compaction did not complete */
+  for (const Path p : {Path(old_path), Path(path)}) {
+    try {
+      ReplayFile(dest, p);
+    } catch (...) {
+      cerr << "Failed to replay " << p.c_str() << endl;
+      PrintException(std::current_exception());
+    }
+  }
+}
+
+void
+CloudJournal::Start()
+{
+  /* everything replayed is now in the snapshot */
+  SaveSnapshot();
+  File::Delete(old_path);
+  File::Delete(path);
+  OpenFile();
+
+  Thread::Start();
+}
+
+void
+CloudJournal::Stop() noexcept
+{
+  {
+    const std::scoped_lock lock{mutex};
+    quit = true;
+    cond.notify_one();
+  }
+
+  Join();
+}
+
+void
+CloudJournal::OpenFile()
+{
+  if (File::Exists(path)) {
+    /* never truncate a journal which has not been compacted */
+    file = std::make_unique<FileOutputStream>(path,
+                                              FileOutputStream::Mode::APPEND_EXISTING);
+    return;
+  }
+
+  file = std::make_unique<FileOutputStream>(path,
+                                            FileOutputStream::Mode::CREATE_VISIBLE);
+
+  Serialiser s(*file);
+  s.Write32(JOURNAL_MAGIC);
+  s.Write32(JOURNAL_VERSION);
+  s.Flush();
+}
+
+void
+CloudJournal::ReplaceDamagedFile()
+{
+  /* the snapshot includes everything in the damaged journal(s) */
+  SaveSnapshot();
+  File::Delete(old_path);
+  File::Delete(path);
+
+  damaged = false;
+  OpenFile();
+}
+
+void
+CloudJournal::Write(const std::vector<Record> &records)
+{
+  if (damaged)
+    ReplaceDamagedFile();
+  else if (!file)
+    /* reopening the file during the last compaction has failed; try
+       again */
+    OpenFile();
+
+  const uint64_t offset = file->Tell();
+
+  try {
+    Serialiser s(*file);
+
+    for (const auto &i : records) {
+      if (const auto *client = std::get_if<CloudClient>(&i)) {
+        s.Write8(uint8_t(JournalRecordType::CLIENT));
+        client->Save(s);
+      } else if (const auto *removed = std::get_if<RemovedClient>(&i)) {
+        s.Write8(uint8_t(JournalRecordType::REMOVE_CLIENT));
+        s.Write64(removed->key);
+      } else {
+        s.Write8(uint8_t(JournalRecordType::THERMAL));
+        std::get<CloudThermal>(i).Save(s);
+      }
+    }
+
+    s.Flush();
+    file->Sync();
+  } catch (...) {
+    /* remove the partial record; if later records were appended
+       after it, Replay() would stop there and lose them */
+    try {
+      file->Truncate(offset);
+    } catch (...) {
+      cerr << "Failed to truncate " << path.c_str() << endl;
+      PrintException(std::current_exception());
+
+      file.reset();
+      damaged = true;
+    }
+
+    throw;
+  }
+}
+
+void
+CloudJournal::SaveSnapshot()
+{
+  cout << "Saving data to " << snapshot_path.c_str() << endl;
+
+  FileOutputStream fos(snapshot_path);
+
+  {
+    Serialiser s(fos);
+    shards.Save(s);
+    s.Flush();
+  }
+
+  fos.Commit();
+}
+
+void
+CloudJournal::Compact() noexcept
+try {
+  if (damaged) {
+    ReplaceDamagedFile();
+    return;
+  }
+
+  /* if the old journal still exists, the previous compaction has
+     failed; keep it and continue writing to the current journal,
+     which is safe because records are idempotent */
+  if (!File::Exists(old_path)) {
+    file.reset();
+
+    const bool renamed = File::Rename(path, old_path);
+    OpenFile();
+
+    if (!renamed)
+      throw std::runtime_error("Failed to rename journal");
+  }
+
+  /* the snapshot includes all records in the old journal */
+  SaveSnapshot();
+  File::Delete(old_path);
+} catch (...) {
+  PrintException(std::current_exception());
+}
+
+void
+CloudJournal::Run() noexcept
+{
+  std::vector<Record> records;
+
+  std::unique_lock lock{mutex};
+
+  while (true) {
+    cond.wait_for(lock, WRITE_INTERVAL, [this]{ return compact || quit; });
+
+    bool do_compact = compact || quit;
+    const bool do_quit = quit;
+    compact = false;
+    records.swap(queue);
+
+    lock.unlock();
+
+    if (!records.empty()) {
+      try {
+        Write(records);
+      } catch (...) {
+        cerr << "Failed to write journal" << endl;
+        PrintException(std::current_exception());
+
+        /* Write() has removed the partial batch from the file (or
+           marked it as damaged); retry the batch in the next cycle,
+           before the records which have been queued meanwhile; records
+           are idempotent, so writing some of them twice is harmless */
+        const std::scoped_lock requeue_lock{mutex};
+        for (auto &i : queue)
+          records.emplace_back(std::move(i));
+        queue.swap(records);
+      }
+
+      records.clear();
+
+      if (file && file->Tell() > MAX_JOURNAL_SIZE)
+        do_compact = true;
+    }
+
+    if (do_compact)
+      Compact();
+
+    if (do_quit)
+      break;
+
+    lock.lock();
+  }
+}
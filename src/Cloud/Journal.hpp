@@ -0,0 +1,143 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Client.hpp"
+#include "Thermal.hpp"
+#include "thread/Thread.hpp"
+#include "thread/Mutex.hxx"
+#include "thread/Cond.hxx"
+#include "system/Path.hpp"
+
+#include <memory>
+#include <variant>
+#include <vector>
+
+class FileOutputStream;
+class CloudShards;
+
+/**
+ * A write-ahead log of all modifications to the #CloudShards, which
+ * replaces periodic full snapshots.  Worker threads only queue
+ * records; a separate thread appends them to the journal file once
+ * per second.  From time to time, the journal is compacted, i.e. a
+ * new snapshot is written and the journal is truncated.
+ *
+ * On startup, the journal is replayed on top of the snapshot.
+ */
+class CloudJournal final : Thread {
+  struct RemovedClient {
+    uint64_t key;
+  };
+
+  using Record = std::variant<CloudClient, RemovedClient, CloudThermal>;
+
+  const AllocatedPath snapshot_path;
+
+  /**
+   * The journal file which is currently being written.
+   */
+  const AllocatedPath path;
+
+  /**
+   * The previous journal file, which exists only while a compaction
+   * is in progress (or has failed).
+   */
+  const AllocatedPath old_path;
+
+  const CloudShards &shards;
+
+  Mutex mutex;
+  Cond cond;
+
+  /**
+   * Records which have not yet been written.  Protected by #mutex.
+   */
+  std::vector<Record> queue;
+
+  /**
+   * Protected by #mutex.
+   */
+  bool compact = false, quit = false;
+
+  /**
+   * The journal file.  Only accessed by the thread (after Start()).
+   */
+  std::unique_ptr<FileOutputStream> file;
+
+  /**
+   * Set if a write has failed and the partial record could not be
+   * removed from the journal file.  It must not be appended to;
+   * instead, it is replaced after writing a new snapshot.  Only
+   * accessed by the thread (after Start()).
+   */
+  bool damaged = false;
+
+public:
+  CloudJournal(Path _snapshot_path, const CloudShards &_shards);
+  ~CloudJournal() noexcept;
+
+  /**
+   * Apply the journal files left by the previous run to the given
+   * #CloudShards.  Call this after loading the snapshot and before
+   * Start().
+   */
+  void Replay(CloudShards &dest) const;
+
+  /**
+   * Write a new snapshot (which includes everything replayed),
+   * truncate the journal and start the thread.
+   *
+   * Throws on error.
+   */
+  void Start();
+
+  /**
+   * Write all pending records and a final snapshot, and stop the
+   * thread.
+   */
+  void Stop() noexcept;
+
+  /**
+   * Ask the thread to compact the journal.
+   */
+  void RequestCompaction() noexcept {
+    const std::scoped_lock lock{mutex};
+    compact = true;
+    cond.notify_one();
+  }
+
+  /**
+   * Record a new or modified client.
+   */
+  void AddClient(const CloudClient &client) {
+    Add(client);
+  }
+
+  void RemoveClient(uint64_t key) {
+    Add(RemovedClient{key});
+  }
+
+  void AddThermal(const CloudThermal &thermal) {
+    Add(thermal);
+  }
+
+private:
+  template<typename T>
+  void Add(const T &record) {
+    const std::scoped_lock lock{mutex};
+    queue.emplace_back(std::in_place_type<T>, record);
+  }
+
+  void ReplayFile(CloudShards &dest, Path p) const;
+
+  void OpenFile();
+  void ReplaceDamagedFile();
+  void Write(const std::vector<Record> &records);
+  void SaveSnapshot();
+  void Compact() noexcept;
+
+  /* virtual methods from Thread */
+  void Run() noexcept override;
+};
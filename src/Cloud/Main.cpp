@@ -1,7 +1,8 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 // Copyright The XCSoar Project
 
-#include "Data.hpp"
+#include "Shards.hpp"
+#include "Journal.hpp"
 #include "Dump.hpp"
 #include "Sender.hpp"
 #include "Serialiser.hpp"
@@ -11,17 +12,21 @@
 #include "event/Loop.hxx"
 #include "event/CoarseTimerEvent.hxx"
 #include "event/SignalMonitor.hxx"
+#include "thread/Thread.hpp"
 #include "net/IPv4Address.hxx"
-#include "io/FileOutputStream.hxx"
 #include "io/FileReader.hxx"
 #include "util/PrintException.hxx"
 #include "util/Exception.hxx"
 #include "util/Compiler.h"
 #include "util/ScopeExit.hxx"
 
+#include <algorithm>
 #include <array>
+#include <forward_list>
 #include <iostream>
 #include <iomanip>
+#include <sstream>
+#include <thread>
 
 #include <signal.h>
 
@@ -38,55 +43,26 @@ using std::cout;
 using std::cerr;
 using std::endl;
 
+/**
+ * Handles the datagrams received by one thread.  All threads share
+ * the UDP port (SO_REUSEPORT) and the #CloudShards.
+ */
 class CloudServer final
-  : public SkyLinesTracking::Server, CloudData
+  : public SkyLinesTracking::Server
 {
-  const AllocatedPath db_path;
+  CloudShards &shards;
 
-  CoarseTimerEvent save_timer, expire_timer;
+  /**
+   * The main thread's #EventLoop, to be stopped on fatal errors.
+   */
+  EventLoop &main_loop;
 
 public:
-  CloudServer(AllocatedPath &&_db_path, EventLoop &event_loop,
-              SocketAddress bind_address)
-    :SkyLinesTracking::Server(event_loop, bind_address),
-     db_path(std::move(_db_path)),
-     save_timer(event_loop, BIND_THIS_METHOD(OnSaveTimer)),
-     expire_timer(event_loop, BIND_THIS_METHOD(OnExpireTimer))
-  {
-#ifndef _WIN32
-    SignalMonitorRegister(SIGINT, BIND_THIS_METHOD(OnQuitSignal));
-    SignalMonitorRegister(SIGTERM, BIND_THIS_METHOD(OnQuitSignal));
-    SignalMonitorRegister(SIGQUIT, BIND_THIS_METHOD(OnQuitSignal));
-
-    SignalMonitorRegister(SIGHUP, BIND_THIS_METHOD(OnReloadSignal));
-    SignalMonitorRegister(SIGUSR1, BIND_THIS_METHOD(OnDumpSignal));
-#endif
-
-    ScheduleSave();
-  }
-
-  void Load();
-  void Save();
-
-private:
-  void OnSaveTimer() noexcept {
-    Save();
-    ScheduleSave();
-  }
-
-  void ScheduleSave() {
-    save_timer.Schedule(std::chrono::minutes(1));
-  }
-
-  void OnExpireTimer() noexcept {
-    clients.Expire(GetEventLoop().SteadyNow() - std::chrono::minutes(10));
-    if (!clients.empty())
-      ScheduleExpire();
-  }
-
-  void ScheduleExpire() {
-    expire_timer.Schedule(std::chrono::minutes(5));
-  }
+  CloudServer(EventLoop &event_loop, EventLoop &_main_loop,
+              CloudShards &_shards,
+              SocketAddress bind_address, bool reuse_port)
+    :SkyLinesTracking::Server(event_loop, bind_address, reuse_port),
+     shards(_shards), main_loop(_main_loop) {}
 
 protected:
   /* virtual methods from class SkyLinesTracking::Server */
@@ -116,31 +92,29 @@ protected:
 
   void OnSendError(SocketAddress address,
                    std::exception_ptr e) noexcept override {
-    cerr << "Failed to send to " << address
-         << ": " << GetFullMessage(e)
-         << endl;
+    std::ostringstream os;
+    os << "Failed to send to " << address
+       << ": " << GetFullMessage(e)
+       << '\n';
+    cerr << os.str() << std::flush;
   }
 
   void OnError(std::exception_ptr e) override {
     cerr << GetFullMessage(e) << endl;
-    GetEventLoop().Break();
-  }
-
-#ifndef _WIN32
-  void OnQuitSignal() noexcept {
-    GetEventLoop().Break();
-  }
-
-  void OnReloadSignal() noexcept {
-    Save();
-  }
-
-  void OnDumpSignal() noexcept {
-    DumpClients();
+    main_loop.InjectBreak();
   }
-#endif
 };
 
+/**
+ * Write one line to stdout.  The line is assembled first, so lines
+ * from different threads do not get mixed up.
+ */
+static void
+PrintLine(const std::ostringstream &os)
+{
+  cout << os.str() << std::flush;
+}
+
 void
 CloudServer::OnFix(const Client &c,
                    std::chrono::milliseconds time_of_day,
@@ -148,46 +122,41 @@ CloudServer::OnFix(const Client &c,
 {
   (void)time_of_day; // TODO: use this parameter
 
-  CloudClient *client;
-  if (location.IsValid()) {
-    bool was_empty = clients.empty();
-
-    client = &clients.Make(c.address, c.key, location, altitude);
-
-    cout << "FIX\t"
-         << client->address << '\t'
-         << std::hex << client->key << std::dec << '\t'
-         << client->id << '\t'
-         << client->location << '\t'
-         << client->altitude << 'm'
-         << endl;
-
-    if (was_empty)
-      ScheduleExpire();
-  } else {
-    client = clients.Find(c.key);
-    if (client != nullptr)
-      clients.Refresh(*client, c.address);
+  if (!location.IsValid()) {
+    shards.Refresh(c.key, c.address);
+    return;
   }
 
+  const unsigned id = shards.Make(c.address, c.key, location, altitude);
+
+  std::ostringstream os;
+  os << "FIX\t"
+     << SocketAddress(c.address) << '\t'
+     << std::hex << c.key << std::dec << '\t'
+     << id << '\t'
+     << location << '\t'
+     << altitude << "m\n";
+  PrintLine(os);
+
   /* send this new traffic location to all interested clients
      immediately */
   const auto now = std::chrono::steady_clock::now();
-  for (const auto &i : clients.QueryWithinRange(location, TRAFFIC_RANGE)) {
-    if (i->key == c.key)
+  shards.VisitClients(location, TRAFFIC_RANGE, [&](const CloudClient &i){
+    if (i.key == c.key)
       /* ignore this client's own submissions - he knows them
          already */
-      continue;
+      return true;
 
-    if (now > i->wants_traffic)
+    if (now > i.wants_traffic)
       /* not interested (anymore) */
-      continue;
+      return true;
 
-    TrafficResponseSender s(*this, i->address, i->key);
-    s.Add(client->id, 0, //TODO: time?
-          client->location, client->altitude);
+    TrafficResponseSender s(*this, i.address, i.key);
+    s.Add(id, 0, //TODO: time?
+          location, altitude);
     s.Flush();
-  }
+    return true;
+  });
 }
 
 void
@@ -197,36 +166,35 @@ CloudServer::OnTrafficRequest(const Client &c, bool near)
     /* "near" is the only selection flag we know */
     return;
 
-  auto *client = clients.Find(c.key);
-  if (client == nullptr)
+  const auto now = std::chrono::steady_clock::now();
+
+  ::GeoPoint location;
+  if (!shards.WithClient(c.key, [&](CloudClient &client){
+    client.wants_traffic = now + REQUEST_EXPIRY;
+    location = client.location;
+  }))
     /* we don't send our data to clients who didn't sent anything to
        us yet */
     return;
 
-  const auto now = std::chrono::steady_clock::now();
-
-  client->wants_traffic = now + REQUEST_EXPIRY;
-
   const auto min_stamp = now - MAX_TRAFFIC_AGE;
 
   TrafficResponseSender s(*this, c.address, c.key);
 
   unsigned n = 0;
-  for (const auto &traffic : clients.QueryWithinRange(client->location,
-                                                      TRAFFIC_RANGE)) {
-    if (traffic.get() == client)
-      continue;
+  shards.VisitClients(location, TRAFFIC_RANGE, [&](const CloudClient &traffic){
+    if (traffic.key == c.key)
+      return true;
 
-    if (traffic->stamp < min_stamp)
+    if (traffic.stamp < min_stamp)
       /* don't send stale traffic, it's probably not there anymore */
-      continue;
+      return true;
 
-    s.Add(traffic->id, 0, //TODO: time?
-          traffic->location, traffic->altitude);
+    s.Add(traffic.id, 0, //TODO: time?
+          traffic.location, traffic.altitude);
 
-    if (++n > 64)
-      break;
-  }
+    return ++n <= 64;
+  });
 
   s.Flush();
 }
@@ -239,21 +207,24 @@ CloudServer::OnWaveSubmit(const Client &c,
                           int top_altitude,
                           double lift)
 {
-  auto *client = clients.Find(c.key);
-  if (client == nullptr)
+  unsigned id;
+  if (!shards.WithClient(c.key, [&id](const CloudClient &client){
+    id = client.id;
+  }))
     /* we don't trust the client if he didn't sent anything to us
        yet */
     return;
 
-  cout << "WAVE\t"
-       << client->address << '\t'
-       << std::hex << client->key << std::dec << '\t'
-       << client->id << '\t'
-       << a << '\t'
-       << b << '\t'
-       << bottom_altitude << '-' << top_altitude << "m\t"
-       << lift << "m/s"
-       << endl;
+  std::ostringstream os;
+  os << "WAVE\t"
+     << SocketAddress(c.address) << '\t'
+     << std::hex << c.key << std::dec << '\t'
+     << id << '\t'
+     << a << '\t'
+     << b << '\t'
+     << bottom_altitude << '-' << top_altitude << "m\t"
+     << lift << "m/s\n";
+  PrintLine(os);
 }
 
 void
@@ -265,135 +236,281 @@ CloudServer::OnThermalSubmit(const Client &c,
                              int top_altitude,
                              double lift)
 {
-  auto *client = clients.Find(c.key);
-  if (client == nullptr)
+  unsigned id;
+  if (!shards.WithClient(c.key, [&id](const CloudClient &client){
+    id = client.id;
+  }))
     /* we don't trust the client if he didn't sent anything to us
        yet */
     return;
 
-  cout << "THERMAL\t"
-       << client->address << '\t'
-       << std::hex << client->key << std::dec << '\t'
-       << client->id << '\t'
-       << top_location << '\t'
-       << bottom_altitude << '-' << top_altitude << "m\t"
-       << lift << "m/s"
-       << endl;
-
-  const auto &thermal =
-    thermals.Make(c.key,
-                  AGeoPoint(bottom_location, bottom_altitude),
-                  AGeoPoint(top_location, top_altitude),
-                  lift);
+  std::ostringstream os;
+  os << "THERMAL\t"
+     << SocketAddress(c.address) << '\t'
+     << std::hex << c.key << std::dec << '\t'
+     << id << '\t'
+     << top_location << '\t'
+     << bottom_altitude << '-' << top_altitude << "m\t"
+     << lift << "m/s\n";
+  PrintLine(os);
+
+  const auto thermal =
+    shards.AddThermal(c.key,
+                      AGeoPoint(bottom_location, bottom_altitude),
+                      AGeoPoint(top_location, top_altitude),
+                      lift);
 
   /* send this new thermal to all interested clients immediately */
   const auto now = std::chrono::steady_clock::now();
-  for (const auto &i : clients.QueryWithinRange(bottom_location,
-                                                THERMAL_RANGE)) {
-    if (i->key == c.key)
+  shards.VisitClients(bottom_location, THERMAL_RANGE,
+                      [&](const CloudClient &i){
+    if (i.key == c.key)
       /* ignore this client's own submissions - he knows them
          already */
-      continue;
+      return true;
 
-    if (now > i->wants_thermals)
+    if (now > i.wants_thermals)
       /* not interested (anymore) */
-      continue;
+      return true;
 
-    ThermalResponseSender s(*this, i->address, i->key);
-    s.Add(thermal.Pack());
+    ThermalResponseSender s(*this, i.address, i.key);
+    s.Add(thermal);
     s.Flush();
-  }
+    return true;
+  });
 }
 
 void
 CloudServer::OnThermalRequest(const Client &c)
 {
-  auto *client = clients.Find(c.key);
-  if (client == nullptr)
+  const auto now = std::chrono::steady_clock::now();
+
+  ::GeoPoint location;
+  if (!shards.WithClient(c.key, [&](CloudClient &client){
+    client.wants_thermals = now + REQUEST_EXPIRY;
+    location = client.location;
+  }))
     /* we don't send our data to clients who didn't sent anything to
        us yet */
     return;
 
-  const auto now = std::chrono::steady_clock::now();
-
-  client->wants_thermals = now + REQUEST_EXPIRY;
-
   const auto min_time = now - MAX_THERMAL_AGE;
 
   ThermalResponseSender s(*this, c.address, c.key);
 
   unsigned n = 0;
-  for (const auto &thermal : thermals.QueryWithinRange(client->location,
-                                                       THERMAL_RANGE)) {
-    if (thermal->client_key == c.key)
+  shards.VisitThermals(location, THERMAL_RANGE,
+                       [&](const CloudThermal &thermal){
+    if (thermal.client_key == c.key)
       /* ignore this client's own submissions - he knows them
          already */
-      continue;
+      return true;
 
-    if (thermal->time < min_time)
+    if (thermal.time < min_time)
       /* don't send old thermals, they're useless */
-      continue;
+      return true;
 
-    s.Add(thermal->Pack());
+    s.Add(thermal.Pack());
 
-    if (++n > 256)
-      break;
-  }
+    return ++n <= 256;
+  });
 
   s.Flush();
 }
 
-void
-CloudServer::Load()
-{
-  FileReader fr(db_path);
-  Deserialiser s(fr);
-  CloudData::Load(s);
-}
+/**
+ * A thread which runs a #CloudServer in its own #EventLoop.
+ */
+class CloudThread final : protected Thread {
+  EventLoop event_loop{ThreadId::Null()};
 
-void
-CloudServer::Save()
-{
-  cout << "Saving data to " << db_path.c_str() << endl;
+  CloudServer server;
+
+public:
+  CloudThread(EventLoop &main_loop, CloudShards &shards,
+              SocketAddress bind_address, bool reuse_port)
+    :Thread("cloud"),
+     server(event_loop, main_loop, shards, bind_address, reuse_port) {}
+
+  ~CloudThread() noexcept {
+    if (IsDefined())
+      Stop();
+  }
+
+  void Start() {
+    event_loop.SetAlive(true);
+    Thread::Start();
+  }
+
+  void Stop() noexcept {
+    event_loop.InjectBreak();
+    Join();
+
+    /* the thread has exited; allow destroying the #CloudServer's
+       SocketEvent from the main thread */
+    event_loop.SetAlive(false);
+  }
+
+protected:
+  /* virtual methods from Thread */
+  void Run() noexcept override {
+    event_loop.Run();
+  }
+};
+
+/**
+ * Runs in the main thread; owns the #CloudShards, the #CloudJournal
+ * and the worker threads, and takes care of loading, compacting and
+ * expiring the data.
+ */
+class CloudManager final {
+  const AllocatedPath db_path;
+
+  EventLoop &event_loop;
+
+  CloudShards shards;
 
-  FileOutputStream fos(db_path);
+  CloudJournal journal;
 
+  std::forward_list<CloudThread> threads;
+
+  CoarseTimerEvent compact_timer, expire_timer;
+
+public:
+  CloudManager(AllocatedPath &&_db_path, EventLoop &_event_loop,
+               SocketAddress bind_address, unsigned n_threads)
+    :db_path(std::move(_db_path)), event_loop(_event_loop),
+     shards(std::min(4 * n_threads, CloudShards::MAX_SHARDS)),
+     journal(db_path, shards),
+     compact_timer(event_loop, BIND_THIS_METHOD(OnCompactTimer)),
+     expire_timer(event_loop, BIND_THIS_METHOD(OnExpireTimer))
   {
-    Serialiser s(fos);
-    CloudData::Save(s);
-    s.Flush();
+    for (unsigned i = 0; i < n_threads; ++i)
+      threads.emplace_front(event_loop, shards, bind_address,
+                            n_threads > 1);
+
+#ifndef _WIN32
+    SignalMonitorRegister(SIGINT, BIND_THIS_METHOD(OnQuitSignal));
+    SignalMonitorRegister(SIGTERM, BIND_THIS_METHOD(OnQuitSignal));
+    SignalMonitorRegister(SIGQUIT, BIND_THIS_METHOD(OnQuitSignal));
+
+    SignalMonitorRegister(SIGHUP, BIND_THIS_METHOD(OnReloadSignal));
+    SignalMonitorRegister(SIGUSR1, BIND_THIS_METHOD(OnDumpSignal));
+#endif
+
+    ScheduleCompact();
+    ScheduleExpire();
+  }
+
+  /**
+   * Load the snapshot and replay the journal.
+   */
+  void Load();
+
+  void Start() {
+    journal.Start();
+    shards.SetJournal(journal);
+
+    for (auto &i : threads)
+      i.Start();
+  }
+
+  /**
+   * Stop the worker threads and write a final snapshot.
+   */
+  void Stop() noexcept {
+    for (auto &i : threads)
+      i.Stop();
+
+    journal.Stop();
+  }
+
+private:
+  void OnCompactTimer() noexcept {
+    journal.RequestCompaction();
+    ScheduleCompact();
+  }
+
+  void ScheduleCompact() {
+    compact_timer.Schedule(std::chrono::minutes(10));
+  }
+
+  void OnExpireTimer() noexcept {
+    shards.Expire(event_loop.SteadyNow() - std::chrono::minutes(10));
+    ScheduleExpire();
+  }
+
+  void ScheduleExpire() {
+    expire_timer.Schedule(std::chrono::minutes(5));
+  }
+
+#ifndef _WIN32
+  void OnQuitSignal() noexcept {
+    event_loop.Break();
+  }
+
+  void OnReloadSignal() noexcept {
+    journal.RequestCompaction();
+  }
+
+  void OnDumpSignal() noexcept {
+    shards.DumpClients();
+  }
+#endif
+};
+
+void
+CloudManager::Load()
+{
+  try {
+    FileReader fr(db_path);
+    Deserialiser s(fr);
+    shards.Load(s);
+  } catch (const std::runtime_error &e) {
+    cerr << "Failed to load database" << endl;
+    PrintException(e);
   }
 
-  fos.Commit();
+  journal.Replay(shards);
 }
 
 int
 main(int argc, char **argv)
 try {
-  if (argc != 2) {
-    cerr << "Usage: " << argv[0] << " DBPATH" << endl;
+  if (argc < 2 || argc > 3) {
+    cerr << "Usage: " << argv[0] << " DBPATH [THREADS]" << endl;
     return EXIT_FAILURE;
   }
 
   const Path db_path(argv[1]);
 
+  unsigned n_threads = std::max(std::thread::hardware_concurrency(), 1U);
+  if (argc > 2) {
+    char *endptr;
+    n_threads = strtoul(argv[2], &endptr, 10);
+    if (endptr == argv[2] || *endptr != 0 || n_threads < 1 ||
+        4 * n_threads > CloudShards::MAX_SHARDS) {
+      cerr << "Invalid number of threads" << endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  n_threads = std::min(n_threads, CloudShards::MAX_SHARDS / 4);
+
   EventLoop event_loop;
   SignalMonitorInit(event_loop);
   AtScopeExit() { SignalMonitorFinish(); };
 
-  CloudServer server(db_path, event_loop,
-                     IPv4Address(CloudServer::GetDefaultPort()));
+  CloudManager server(db_path, event_loop,
+                      IPv4Address(CloudServer::GetDefaultPort()),
+                      n_threads);
 
-  try {
-    server.Load();
-  } catch (const std::runtime_error &e) {
-    cerr << "Failed to load database" << endl;
-    PrintException(e);
-  }
+  server.Load();
+  server.Start();
 
   event_loop.Run();
 
-  server.Save();
+  server.Stop();
 
   return EXIT_SUCCESS;
 } catch (const std::exception &exception) {
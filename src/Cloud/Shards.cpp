@@ -0,0 +1,357 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Shards.hpp"
+#include "Journal.hpp"
+#include "Geo/Boost/RangeBox.hpp"
+#include "Tracking/SkyLines/Protocol.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+/**
+ * The width and height of a cell in degrees.  This should be larger
+ * than the range of a query, so a query touches only few cells.
+ */
+static constexpr double CELL_SIZE = 1;
+
+CloudShards::CloudShards(unsigned _n_shards)
+  :n_shards(_n_shards),
+   shards(new Shard[n_shards]),
+   keys(new KeyPartition[N_KEY_PARTITIONS])
+{
+  assert(n_shards > 0);
+  assert(n_shards <= MAX_SHARDS);
+}
+
+CloudShards::~CloudShards() noexcept = default;
+
+[[gnu::const]]
+static int
+ToCell(Angle angle) noexcept
+{
+  return (int)std::floor(angle.Degrees() / CELL_SIZE);
+}
+
+[[gnu::const]]
+static unsigned
+HashCell(int x, int y) noexcept
+{
+  return (unsigned)x * 73856093U ^ (unsigned)y * 19349663U;
+}
+
+unsigned
+CloudShards::GetShardIndex(const GeoPoint &location) const noexcept
+{
+  return HashCell(ToCell(location.longitude), ToCell(location.latitude))
+    % n_shards;
+}
+
+CloudShards::ShardSet
+CloudShards::FindShards(GeoPoint location, double range) const noexcept
+{
+  const auto box = BoostRangeBox(location, range);
+  const int west = ToCell(box.min_corner().longitude);
+  const int east = ToCell(box.max_corner().longitude);
+  const int south = ToCell(box.min_corner().latitude);
+  const int north = ToCell(box.max_corner().latitude);
+
+  ShardSet set;
+
+  if (west > east ||
+      unsigned(east - west + 1) * unsigned(north - south + 1) > n_shards) {
+    /* wraps around the antimeridian, or covers so many cells that
+       each shard is probably affected */
+    for (unsigned i = 0; i < n_shards; ++i)
+      set.set(i);
+    return set;
+  }
+
+  for (int y = south; y <= north; ++y)
+    for (int x = west; x <= east; ++x)
+      set.set(HashCell(x, y) % n_shards);
+
+  return set;
+}
+
+unsigned
+CloudShards::Make(SocketAddress address, uint64_t key,
+                  const GeoPoint &location, int altitude)
+{
+  auto &partition = GetKeyPartition(key);
+  const std::scoped_lock partition_lock{partition.mutex};
+
+  const unsigned new_index = GetShardIndex(location);
+  auto &new_shard = shards[new_index];
+
+  auto i = partition.shards.find(key);
+  if (i == partition.shards.end()) {
+    auto client = std::make_shared<CloudClient>(address, key, next_id++,
+                                                location, altitude);
+
+    {
+      const std::scoped_lock lock{new_shard.mutex};
+      new_shard.data.clients.Insert(*client);
+
+      if (journal != nullptr)
+        journal->AddClient(*client);
+    }
+
+    partition.shards.emplace(key, new_index);
+    return client->id;
+  }
+
+  if (i->second == new_index) {
+    const std::scoped_lock lock{new_shard.mutex};
+    auto *client = new_shard.data.clients.Find(key);
+    assert(client != nullptr);
+    new_shard.data.clients.Refresh(*client, address, location, altitude);
+
+    if (journal != nullptr)
+      journal->AddClient(*client);
+
+    return client->id;
+  }
+
+  /* the client has moved to a cell owned by another shard */
+
+  auto &old_shard = shards[i->second];
+  const std::scoped_lock lock{old_shard.mutex, new_shard.mutex};
+
+  auto *client = old_shard.data.clients.Find(key);
+  assert(client != nullptr);
+
+  /* hold a reference while the client is in neither shard */
+  const auto ptr = client->shared_from_this();
+  old_shard.data.clients.Remove(*client);
+
+  client->Refresh(address);
+  client->location = location;
+  client->altitude = altitude;
+  new_shard.data.clients.Insert(*client);
+
+  if (journal != nullptr)
+    journal->AddClient(*client);
+
+  i->second = new_index;
+  return client->id;
+}
+
+bool
+CloudShards::Refresh(uint64_t key, SocketAddress address)
+{
+  auto &partition = GetKeyPartition(key);
+  const std::scoped_lock partition_lock{partition.mutex};
+
+  auto i = partition.shards.find(key);
+  if (i == partition.shards.end())
+    return false;
+
+  auto &shard = shards[i->second];
+  const std::scoped_lock lock{shard.mutex};
+
+  auto *client = shard.data.clients.Find(key);
+  assert(client != nullptr);
+  shard.data.clients.Refresh(*client, address);
+
+  if (journal != nullptr)
+    journal->AddClient(*client);
+
+  return true;
+}
+
+SkyLinesTracking::Thermal
+CloudShards::AddThermal(uint64_t client_key,
+                        const AGeoPoint &bottom_location,
+                        const AGeoPoint &top_location,
+                        double lift)
+{
+  /* thermals are indexed by their top location (see
+     CloudThermalIndexable) */
+  auto &shard = shards[GetShardIndex(top_location)];
+  const std::scoped_lock lock{shard.mutex};
+
+  const auto &thermal = shard.data.thermals.Make(client_key,
+                                                 bottom_location,
+                                                 top_location, lift);
+
+  if (journal != nullptr)
+    journal->AddThermal(thermal);
+
+  return thermal.Pack();
+}
+
+void
+CloudShards::Expire(std::chrono::steady_clock::time_point before)
+{
+  std::vector<uint64_t> expired;
+
+  for (unsigned i = 0; i < n_shards; ++i) {
+    auto &shard = shards[i];
+
+    /* collect the candidates first; they cannot be removed right
+       away, because that would require locking the key directory
+       while the shard is locked */
+    expired.clear();
+
+    {
+      const std::scoped_lock lock{shard.mutex};
+      for (const auto &client : shard.data.clients)
+        if (client.stamp < before)
+          expired.push_back(client.key);
+    }
+
+    for (const uint64_t key : expired) {
+      auto &partition = GetKeyPartition(key);
+      const std::scoped_lock partition_lock{partition.mutex};
+
+      auto j = partition.shards.find(key);
+      if (j == partition.shards.end() || j->second != i)
+        /* moved to another shard meanwhile */
+        continue;
+
+      const std::scoped_lock lock{shard.mutex};
+      auto *client = shard.data.clients.Find(key);
+      assert(client != nullptr);
+
+      if (client->stamp < before) {
+        shard.data.clients.Remove(*client);
+        partition.shards.erase(j);
+
+        if (journal != nullptr)
+          journal->RemoveClient(key);
+      }
+    }
+  }
+}
+
+void
+CloudShards::DumpClients()
+{
+  for (unsigned i = 0; i < n_shards; ++i) {
+    auto &shard = shards[i];
+    const std::scoped_lock lock{shard.mutex};
+    shard.data.DumpClients();
+  }
+}
+
+void
+CloudShards::Save(Serialiser &s) const
+{
+  /* copy everything into one CloudData instance, locking only one
+     shard at a time */
+
+  const auto copy = std::make_unique<CloudData>();
+
+  for (unsigned i = 0; i < n_shards; ++i) {
+    const auto &shard = shards[i];
+    const std::scoped_lock lock{shard.mutex};
+
+    for (const auto &client : shard.data.clients)
+      copy->clients.Insert(*std::make_shared<CloudClient>(client));
+
+    for (const auto &thermal : shard.data.thermals)
+      copy->thermals.Insert(*std::make_shared<CloudThermal>(thermal));
+  }
+
+  copy->clients.SetNextId(next_id);
+  copy->Save(s);
+}
+
+void
+CloudShards::InsertClient(const CloudClient &src)
+{
+  auto &partition = GetKeyPartition(src.key);
+  const std::scoped_lock partition_lock{partition.mutex};
+
+  if (partition.shards.contains(src.key))
+    /* duplicate */
+    return;
+
+  const unsigned index = GetShardIndex(src.location);
+  auto &shard = shards[index];
+  const std::scoped_lock lock{shard.mutex};
+
+  shard.data.clients.Insert(*std::make_shared<CloudClient>(src));
+  partition.shards.emplace(src.key, index);
+}
+
+void
+CloudShards::Load(Deserialiser &s)
+{
+  const auto data = std::make_unique<CloudData>();
+  data->Load(s);
+
+  next_id = data->clients.GetNextId();
+
+  for (const auto &client : data->clients)
+    InsertClient(client);
+
+  for (const auto &thermal : data->thermals) {
+    auto &shard = shards[GetShardIndex(thermal.top_location)];
+    const std::scoped_lock lock{shard.mutex};
+    shard.data.thermals.Insert(*std::make_shared<CloudThermal>(thermal));
+  }
+}
+
+void
+CloudShards::RemoveClient(KeyPartition &partition, uint64_t key)
+{
+  auto i = partition.shards.find(key);
+  if (i == partition.shards.end())
+    return;
+
+  auto &shard = shards[i->second];
+  const std::scoped_lock lock{shard.mutex};
+
+  auto *client = shard.data.clients.Find(key);
+  assert(client != nullptr);
+  shard.data.clients.Remove(*client);
+  partition.shards.erase(i);
+}
+
+void
+CloudShards::ReplayClient(const CloudClient &src)
+{
+  {
+    auto &partition = GetKeyPartition(src.key);
+    const std::scoped_lock partition_lock{partition.mutex};
+    RemoveClient(partition, src.key);
+  }
+
+  InsertClient(src);
+
+  if (src.id >= next_id)
+    next_id = src.id + 1;
+}
+
+void
+CloudShards::ReplayRemoveClient(uint64_t key)
+{
+  auto &partition = GetKeyPartition(key);
+  const std::scoped_lock partition_lock{partition.mutex};
+  RemoveClient(partition, key);
+}
+
+void
+CloudShards::ReplayThermal(const CloudThermal &src)
+{
+  auto &shard = shards[GetShardIndex(src.top_location)];
+  const std::scoped_lock lock{shard.mutex};
+
+  /* time stamps are stored with a resolution of one second, and
+     their conversion depends on the clock offset at the time the
+     file was written */
+  constexpr auto tolerance = std::chrono::seconds(2);
+
+  for (const auto &i : shard.data.thermals.QueryWithinRange(src.top_location,
+                                                            1))
+    if (i->client_key == src.client_key &&
+        i->top_location == src.top_location &&
+        i->time > src.time - tolerance && i->time < src.time + tolerance)
+      /* already in the snapshot */
+      return;
+
+  shard.data.thermals.Insert(*std::make_shared<CloudThermal>(src));
+}
@@ -0,0 +1,248 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Data.hpp"
+#include "thread/Mutex.hxx"
+
+#include <atomic>
+#include <bitset>
+#include <chrono>
+#include <memory>
+#include <unordered_map>
+
+class SocketAddress;
+class CloudJournal;
+namespace SkyLinesTracking { struct Thermal; }
+
+/**
+ * The #CloudData of the server, partitioned into shards, so several
+ * threads can work on it concurrently.  Each shard is protected by
+ * its own mutex.
+ *
+ * Clients and thermals are assigned to shards by the geographic cell
+ * they are located in.  A range query visits all shards which own a
+ * cell overlapping the range, one at a time.  Lookups by client key
+ * go through a separate (also partitioned) directory which maps the
+ * key to the shard.
+ *
+ * Lock order: key directory partition before shard; never more than
+ * two shards at a time, and only via std::scoped_lock.  The
+ * #CloudJournal mutex is locked last.
+ */
+class CloudShards {
+public:
+  static constexpr unsigned MAX_SHARDS = 64;
+
+private:
+  static constexpr unsigned N_KEY_PARTITIONS = 64;
+
+  using ShardSet = std::bitset<MAX_SHARDS>;
+
+  struct Shard {
+    mutable Mutex mutex;
+    CloudData data;
+  };
+
+  struct KeyPartition {
+    Mutex mutex;
+
+    /**
+     * Maps each client key to the index of the shard containing
+     * the #CloudClient.
+     */
+    std::unordered_map<uint64_t, unsigned> shards;
+  };
+
+  const unsigned n_shards;
+
+  /**
+   * Allocated on the heap because each #CloudData is large.
+   */
+  const std::unique_ptr<Shard[]> shards;
+
+  const std::unique_ptr<KeyPartition[]> keys;
+
+  /**
+   * The public id assigned to the next new #CloudClient.
+   */
+  std::atomic_uint next_id{1};
+
+  /**
+   * If set, all modifications are recorded in this journal.
+   */
+  CloudJournal *journal = nullptr;
+
+public:
+  explicit CloudShards(unsigned _n_shards);
+  ~CloudShards() noexcept;
+
+  CloudShards(const CloudShards &) = delete;
+  CloudShards &operator=(const CloudShards &) = delete;
+
+  /**
+   * Start recording modifications in the given journal.  Must be
+   * called before the worker threads are started.
+   */
+  void SetJournal(CloudJournal &_journal) noexcept {
+    journal = &_journal;
+  }
+
+  /**
+   * Create a new #CloudClient, or refresh the existing one.  If it
+   * has moved to a cell owned by another shard, it is moved to that
+   * shard.
+   *
+   * @return the public id of the client
+   */
+  unsigned Make(SocketAddress address, uint64_t key,
+                const GeoPoint &location, int altitude);
+
+  /**
+   * Refresh the address and time stamp of an existing client.
+   *
+   * @return false if there is no client with this key
+   */
+  bool Refresh(uint64_t key, SocketAddress address);
+
+  /**
+   * Invoke a function with a reference to the #CloudClient with the
+   * given key.  The function must not access this object.
+   *
+   * @return false if there is no client with this key
+   */
+  template<typename F>
+  bool WithClient(uint64_t key, F &&f) {
+    auto &partition = GetKeyPartition(key);
+    const std::scoped_lock partition_lock{partition.mutex};
+
+    auto i = partition.shards.find(key);
+    if (i == partition.shards.end())
+      return false;
+
+    auto &shard = shards[i->second];
+    const std::scoped_lock lock{shard.mutex};
+
+    auto *client = shard.data.clients.Find(key);
+    if (client == nullptr)
+      return false;
+
+    f(*client);
+    return true;
+  }
+
+  /**
+   * Invoke a function for each client within the given range.  It
+   * returns false to stop the iteration.  The function must not
+   * access this object.
+   */
+  template<typename F>
+  void VisitClients(GeoPoint location, double range, F &&f) const {
+    VisitShards(location, range, [&](const CloudData &data){
+      for (const auto &client : data.clients.QueryWithinRange(location,
+                                                              range))
+        if (!f(*client))
+          return false;
+      return true;
+    });
+  }
+
+  /**
+   * Like VisitClients(), but for thermals.
+   */
+  template<typename F>
+  void VisitThermals(GeoPoint location, double range, F &&f) const {
+    VisitShards(location, range, [&](const CloudData &data){
+      for (const auto &thermal : data.thermals.QueryWithinRange(location,
+                                                                range))
+        if (!f(*thermal))
+          return false;
+      return true;
+    });
+  }
+
+  SkyLinesTracking::Thermal AddThermal(uint64_t client_key,
+                                       const AGeoPoint &bottom_location,
+                                       const AGeoPoint &top_location,
+                                       double lift);
+
+  /**
+   * Remove all clients which have not submitted anything since the
+   * given time stamp.
+   */
+  void Expire(std::chrono::steady_clock::time_point before);
+
+  void DumpClients();
+
+  /**
+   * Write all shards in the #CloudData format.
+   */
+  void Save(Serialiser &s) const;
+
+  /**
+   * Load data in the #CloudData format and distribute it among the
+   * shards.
+   */
+  void Load(Deserialiser &s);
+
+  /**
+   * Apply a #CloudClient record from the journal: add the client, or
+   * replace the existing one with the same key.
+   */
+  void ReplayClient(const CloudClient &src);
+
+  /**
+   * Apply a "client removed" record from the journal.
+   */
+  void ReplayRemoveClient(uint64_t key);
+
+  /**
+   * Apply a #CloudThermal record from the journal.  The thermal is
+   * ignored if it is already present, because the journal may
+   * overlap with the snapshot.
+   */
+  void ReplayThermal(const CloudThermal &src);
+
+private:
+  [[gnu::pure]]
+  KeyPartition &GetKeyPartition(uint64_t key) const noexcept {
+    return keys[key % N_KEY_PARTITIONS];
+  }
+
+  [[gnu::pure]]
+  unsigned GetShardIndex(const GeoPoint &location) const noexcept;
+
+  /**
+   * Determine the shards owning the cells which overlap the given
+   * range.
+   */
+  [[gnu::pure]]
+  ShardSet FindShards(GeoPoint location, double range) const noexcept;
+
+  /**
+   * Invoke a function for each shard returned by FindShards(), with
+   * its mutex locked.  The function returns false to stop.
+   */
+  template<typename F>
+  void VisitShards(GeoPoint location, double range, F &&f) const {
+    const auto set = FindShards(location, range);
+    for (unsigned i = 0; i < n_shards; ++i) {
+      if (!set.test(i))
+        continue;
+
+      const auto &shard = shards[i];
+      const std::scoped_lock lock{shard.mutex};
+      if (!f(shard.data))
+        break;
+    }
+  }
+
+  void InsertClient(const CloudClient &src);
+
+  /**
+   * Remove the client with the given key, if it exists.  The caller
+   * must hold the lock of the key directory partition.
+   */
+  void RemoveClient(KeyPartition &partition, uint64_t key);
+};
@@ -10,6 +10,10 @@ ContestComputer::ContestComputer(const Trace &trace_full,
   :contest_manager(Contest::OLC_SPRINT, trace_full, trace_triangle, trace_sprint, true)
 {
   contest_manager.SetIncremental(true);
+
+  /* don't let a long triangle search stall the calculation thread;
+     it will be continued in the next iteration */
+  contest_manager.SetTriangleTimeBudget(std::chrono::milliseconds(200));
 }
 
 void
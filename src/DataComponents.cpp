@@ -5,6 +5,7 @@
 #include "Engine/Airspace/Airspaces.hpp"
 #include "Engine/Waypoint/Waypoints.hpp"
 #include "Topography/TopographyStore.hpp"
+#include "Topography/AsyncCacheBuilder.hpp"
 #include "Terrain/RasterTerrain.hpp"
 
 DataComponents::DataComponents() noexcept
@@ -6,6 +6,7 @@
 #include <memory>
 
 class TopographyStore;
+class AsyncTopographyCacheBuilder;
 class RasterTerrain;
 class Waypoints;
 class Airspaces;
@@ -22,6 +23,11 @@ struct DataComponents {
 
   std::unique_ptr<TopographyStore> topography;
 
+  /**
+   * Builds the topography cache files in the background.
+   */
+  std::unique_ptr<AsyncTopographyCacheBuilder> topography_cache_builder;
+
   std::unique_ptr<RasterTerrain> terrain;
 
   DataComponents() noexcept;
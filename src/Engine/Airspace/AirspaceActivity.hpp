@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <cstdint>
+
 class AirspaceActivity {
   struct Days
   {
@@ -83,6 +85,17 @@ public:
   constexpr bool Matches(AirspaceActivity _mask) const noexcept {
     return mask.value & _mask.mask.value;
   }
+
+  /**
+   * Returns the raw bit mask, e.g. for storing it in a file.
+   */
+  constexpr uint8_t GetMask() const noexcept {
+    return mask.value;
+  }
+
+  constexpr void SetMask(uint8_t value) noexcept {
+    mask.value = value;
+  }
 };
 
 static_assert(sizeof(AirspaceActivity) == 1, "Wrong size");
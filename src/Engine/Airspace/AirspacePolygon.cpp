@@ -4,6 +4,8 @@
 #include "AirspacePolygon.hpp"
 #include "Geo/Flat/FlatProjection.hpp"
 #include "Geo/Flat/FlatRay.hpp"
+#include "Geo/Flat/FlatBoundingBox.hpp"
+#include "Geo/ConvexHull/PolygonInterior.hpp"
 #include "AirspaceIntersectSort.hpp"
 #include "AirspaceIntersectionVector.hpp"
 
@@ -52,9 +54,24 @@ AirspacePolygon::GetCenter() const noexcept
   return GeoPoint(Angle::Native(lon), Angle::Native(lat));
 }
 
+void
+AirspacePolygon::Project(const FlatProjection &projection) noexcept
+{
+  AbstractAirspace::Project(projection);
+
+  if (m_border.size() >= PolygonEdgeIndex::MIN_POINTS)
+    edge_index.Update(m_border);
+  else
+    edge_index.Clear();
+}
+
 bool
 AirspacePolygon::Inside(const GeoPoint &loc) const noexcept
 {
+  if (edge_index.IsDefined())
+    return PolygonInterior(loc, m_border.begin(),
+                           edge_index.GetBandEdges(loc.latitude));
+
   return m_border.IsInside(loc);
 }
 
@@ -67,14 +84,26 @@ AirspacePolygon::Intersects(const GeoPoint &start, const GeoPoint &end,
 
   AirspaceIntersectSort sorter(start, *this);
 
-  for (auto it = m_border.begin(); it + 1 != m_border.end(); ++it) {
-
+  const auto check_edge = [&](SearchPointVector::const_iterator it){
     const FlatRay r_seg(it->GetFlatLocation(), (it + 1)->GetFlatLocation());
     auto t = ray.DistinctIntersection(r_seg);
     if (t >= 0)
       sorter.add(t, projection.Unproject(ray.Parametric(t)));
+  };
+
+  if (edge_index.IsDefined()) {
+    FlatBoundingBox box(ray.point);
+    box.Expand(ray.point + ray.vector);
+
+    if (edge_index.VisitEdges(m_border, box, [&](unsigned edge){
+          check_edge(std::next(m_border.begin(), edge));
+        }))
+      return sorter.all();
   }
 
+  for (auto it = m_border.begin(); it + 1 != m_border.end(); ++it)
+    check_edge(it);
+
   return sorter.all();
 }
 
@@ -4,6 +4,8 @@
 #pragma once
 
 #include "AbstractAirspace.hpp"
+#include "PolygonEdgeIndex.hpp"
+
 #include <vector>
 
 #ifdef DO_PRINT
@@ -12,6 +14,14 @@
 
 /** General polygon form airspace */
 class AirspacePolygon final : public AbstractAirspace {
+  /**
+   * Speeds up Inside() and Intersects() for polygons with many
+   * points.  It is built by Project(), which is called while the
+   * #Airspaces container is being modified; queries may then run
+   * concurrently without building anything.
+   */
+  PolygonEdgeIndex edge_index;
+
 public:
   /**
    * Constructor.  For testing, pts vector is a cloud of points,
@@ -29,6 +39,7 @@ public:
   void MakeConvex() noexcept {
     m_border.PruneInterior();
     is_convex = TriState::TRUE;
+    edge_index.Clear();
   }
 
   /* virtual methods from class AbstractAirspace */
@@ -41,6 +52,9 @@ public:
   GeoPoint ClosestPoint(const GeoPoint &loc,
                         const FlatProjection &projection) const noexcept override;
 
+protected:
+  void Project(const FlatProjection &projection) noexcept override;
+
 public:
 #ifdef DO_PRINT
   friend std::ostream &operator<<(std::ostream &f,
@@ -3,14 +3,27 @@
 
 #include "AirspaceWarningManager.hpp"
 #include "Geo/GeoVector.hpp"
+#include "Geo/Flat/FlatRay.hpp"
 #include "Airspaces.hpp"
 #include "AbstractAirspace.hpp"
 #include "AirspaceIntersectionVisitor.hpp"
 #include "AirspaceAircraftPerformance.hpp"
 #include "Task/Stats/TaskStats.hpp"
+#include "util/StaticArray.hxx"
 
 static constexpr double CRUISE_FILTER_FACT = 0.5;
 
+/**
+ * A predicted flight path, to be checked by
+ * AirspaceWarningManager::UpdatePredicted().
+ */
+struct AirspaceWarningManager::Prediction {
+  GeoPoint location;
+  AirspaceAircraftPerformance perf;
+  AirspaceWarning::State warning_state;
+  FloatDuration max_time;
+};
+
 AirspaceWarningManager::AirspaceWarningManager(const AirspaceWarningConfig &_config,
                                                const Airspaces &_airspaces)
   :airspaces(_airspaces)
@@ -118,11 +131,32 @@ AirspaceWarningManager::Update(const AircraftState& state,
   for (auto &w : warnings)
     w.SaveState();
 
+  // update both filters even though we are using only one
+  cruise_filter.Update(state);
+  circling_filter.Update(state);
+
+  /* calculate all predicted paths first, so the airspaces affected
+     by any of them can be collected with one query */
+  const std::optional<Prediction> predictions[] = {
+    PredictGlide(state, glide_polar),
+    PredictFilter(circling),
+    PredictTask(state, glide_polar, task_stats),
+  };
+
+  StaticArray<GeoPoint, std::size(predictions)> predicted_locations;
+  for (const auto &i : predictions)
+    if (i)
+      predicted_locations.push_back(i->location);
+
+  CollectCandidates(state, predicted_locations);
+
   // check from strongest to weakest alerts
   UpdateInside(state, glide_polar);
-  UpdateGlide(state, glide_polar);
-  UpdateFilter(state, circling);
-  UpdateTask(state, glide_polar, task_stats);
+  for (const auto &i : predictions)
+    if (i)
+      UpdatePredicted(state, *i);
+
+  candidates.clear();
 
   // action changes
   for (auto it = warnings.begin(), end = warnings.end(); it != end;) {
@@ -158,7 +192,6 @@ class AirspaceIntersectionWarningVisitor final
   const AirspaceWarning::State warning_state;
   const FloatDuration max_time;
   bool found = false;
-  const double max_alt;
   bool mode_inside = false;
 
 public:
@@ -170,7 +203,6 @@ public:
    * @param warning_manager Warning manager to add items to
    * @param warning_state Type of warning
    * @param max_time Time limit of intercept
-   * @param max_alt Maximum height of base to allow (optional)
    *
    * @return Initialised object
    */
@@ -178,31 +210,25 @@ public:
                                      const AirspaceAircraftPerformance &_perf,
                                      AirspaceWarningManager &_warning_manager,
                                      const AirspaceWarning::State _warning_state,
-                                     const FloatDuration _max_time,
-                                     const double _max_alt = -1):
+                                     const FloatDuration _max_time):
     state(_state),
     perf(_perf),
     warning_manager(_warning_manager),
     warning_state(_warning_state),
-    max_time(_max_time),
-    max_alt(_max_alt)
+    max_time(_max_time)
   {
   }
 
   /**
-   * Check whether this intersection should be added to, or updated in, the warning manager
+   * Check whether this intersection should be added to, or updated
+   * in, the warning manager.  The caller has already checked whether
+   * the airspace is active and enabled and whether its base is low
+   * enough.
    *
    * @param airspace Airspace corresponding to current intersection
    */
   void Intersection(ConstAirspacePtr &airspace_ptr) noexcept {
     const auto &airspace = *airspace_ptr;
-    if (!airspace.IsActive())
-      return; // ignore inactive airspaces completely
-
-    if (!(warning_manager.GetConfig().IsClassEnabled(airspace.GetClassOrType()) || 
-	      warning_manager.GetConfig().IsClassEnabled(airspace.GetTypeOrClass())) ||
-        ExcludeAltitude(airspace))
-      return;
 
     AirspaceWarning *warning = warning_manager.GetWarningPtr(airspace);
     if (warning == nullptr || warning->IsStateAccepted(warning_state)) {
@@ -244,30 +270,14 @@ public:
   void SetMode(bool m) {
     mode_inside = m;
   }
-
-private:
-  bool ExcludeAltitude(const AbstractAirspace& airspace) {
-    if (max_alt <= 0)
-      return false;
-
-    return (airspace.GetBaseAltitude(state) > max_alt);
-  }
 };
 
 
-bool 
-AirspaceWarningManager::UpdatePredicted(const AircraftState& state, 
-                                        const GeoPoint &location_predicted,
-                                        const AirspaceAircraftPerformance &perf,
-                                        const AirspaceWarning::State warning_state,
-                                        const FloatDuration max_time) noexcept
+void
+AirspaceWarningManager::CollectCandidates(const AircraftState &state,
+                                          std::span<const GeoPoint> predicted) noexcept
 {
-  // this is the time limit of intrusions, beyond which we are not interested.
-  // it can be the minimum of the user set warning time, or the time of the 
-  // task segment
-
-  const auto max_time_limit = std::min(FloatDuration{config.warning_time},
-                                       max_time);
+  candidates.clear();
 
   // the ceiling is the max height for predicted intrusions, given
   // that you may be climbing.  the ceiling is nominally set at 1000m
@@ -280,40 +290,80 @@ AirspaceWarningManager::UpdatePredicted(const AircraftState& state,
   const auto ceiling = state.altitude
     + std::max((unsigned)1000, config.altitude_warning_margin);
 
-  AirspaceIntersectionWarningVisitor visitor(state, perf, 
-                                             *this, 
-                                             warning_state, max_time_limit,
-                                             ceiling);
+  const auto flat_location = GetProjection().ProjectInteger(state.location);
 
-  airspaces.VisitIntersecting(state.location, location_predicted, visitor);
+  for (const auto &i : airspaces.QuerySwept(state.location, predicted)) {
+    const AbstractAirspace &airspace = i.GetAirspace();
+    if (// ignore inactive airspaces completely
+        !airspace.IsActive() ||
+        !(config.IsClassEnabled(airspace.GetClassOrType()) || config.IsClassEnabled(airspace.GetTypeOrClass())))
+      continue;
 
-  visitor.SetMode(true);
+    const FlatBoundingBox &box = i;
+    candidates.push_back({
+        &i,
+        box.IsInside(flat_location) && i.IsInside(state.location),
+        ceiling <= 0 || airspace.GetBaseAltitude(state) <= ceiling,
+      });
+  }
+}
 
-  for (const auto &i : airspaces.QueryInside(state.location)) {
-    visitor.Visit(i.GetAirspacePtr());
+bool 
+AirspaceWarningManager::UpdatePredicted(const AircraftState& state, 
+                                        const Prediction &prediction) noexcept
+{
+  // this is the time limit of intrusions, beyond which we are not interested.
+  // it can be the minimum of the user set warning time, or the time of the 
+  // task segment
+
+  const auto max_time_limit = std::min(FloatDuration{config.warning_time},
+                                       prediction.max_time);
+
+  AirspaceIntersectionWarningVisitor visitor(state, prediction.perf,
+                                             *this, 
+                                             prediction.warning_state,
+                                             max_time_limit);
+
+  const FlatProjection &projection = GetProjection();
+  const FlatRay ray(projection.ProjectInteger(state.location),
+                    projection.ProjectInteger(prediction.location));
+
+  for (const auto &i : candidates) {
+    const FlatBoundingBox &box = *i.airspace;
+    if (i.below_ceiling && box.Intersects(ray) &&
+        visitor.SetIntersections(i.airspace->Intersects(state.location,
+                                                        prediction.location,
+                                                        projection)))
+      visitor.Visit(i.airspace->GetAirspacePtr());
   }
 
+  visitor.SetMode(true);
+
+  for (const auto &i : candidates)
+    if (i.below_ceiling && i.inside)
+      visitor.Visit(i.airspace->GetAirspacePtr());
+
   return visitor.Found();
 }
 
 
-bool 
-AirspaceWarningManager::UpdateTask(const AircraftState &state,
-                                   const GlidePolar &glide_polar,
-                                   const TaskStats &task_stats)
+std::optional<AirspaceWarningManager::Prediction>
+AirspaceWarningManager::PredictTask(const AircraftState &state,
+                                    const GlidePolar &glide_polar,
+                                    const TaskStats &task_stats) const noexcept
 {
   if (!glide_polar.IsValid())
-    return false;
+    return std::nullopt;
 
   const ElementStat &current_leg = task_stats.current_leg;
 
   if (!task_stats.task_valid || !current_leg.location_remaining.IsValid())
-    return false;
+    return std::nullopt;
 
   const GlideResult &solution = current_leg.solution_remaining;
   if (!solution.IsOk() || !solution.IsAchievable())
     /* glide solver failed, cannot continue */
-    return false;
+    return std::nullopt;
 
   const AirspaceAircraftPerformance perf_task(glide_polar,
                                               current_leg.solution_remaining);
@@ -327,47 +377,41 @@ AirspaceWarningManager::UpdateTask(const AircraftState &state,
        the configured warning time */
     location_tp = state.location.IntermediatePoint(location_tp, max_distance);
 
-  return UpdatePredicted(state, location_tp, perf_task,
-                          AirspaceWarning::WARNING_TASK, time_remaining);
+  return Prediction{location_tp, perf_task,
+                    AirspaceWarning::WARNING_TASK, time_remaining};
 }
 
 
-bool 
-AirspaceWarningManager::UpdateFilter(const AircraftState& state, const bool circling)
+std::optional<AirspaceWarningManager::Prediction>
+AirspaceWarningManager::PredictFilter(const bool circling) const noexcept
 {
-  // update both filters even though we are using only one
-  cruise_filter.Update(state);
-  circling_filter.Update(state);
-
-  const GeoPoint location_predicted = circling?
-    circling_filter.GetPredictedState(prediction_time_filter).location:
-    cruise_filter.GetPredictedState(prediction_time_filter).location;
-
   if (circling) 
-    return UpdatePredicted(state, location_predicted,
-                           AirspaceAircraftPerformance(circling_filter),
-                            AirspaceWarning::WARNING_FILTER, prediction_time_filter);
+    return Prediction{
+      circling_filter.GetPredictedState(prediction_time_filter).location,
+      AirspaceAircraftPerformance(circling_filter),
+      AirspaceWarning::WARNING_FILTER, prediction_time_filter,
+    };
   else
-    return UpdatePredicted(state, location_predicted,
-                           AirspaceAircraftPerformance(cruise_filter),
-                            AirspaceWarning::WARNING_FILTER, prediction_time_filter);
+    return Prediction{
+      cruise_filter.GetPredictedState(prediction_time_filter).location,
+      AirspaceAircraftPerformance(cruise_filter),
+      AirspaceWarning::WARNING_FILTER, prediction_time_filter,
+    };
 }
 
 
-bool 
-AirspaceWarningManager::UpdateGlide(const AircraftState &state,
-                                    const GlidePolar &glide_polar)
+std::optional<AirspaceWarningManager::Prediction>
+AirspaceWarningManager::PredictGlide(const AircraftState &state,
+                                     const GlidePolar &glide_polar) const noexcept
 {
   if (!glide_polar.IsValid())
-    return false;
+    return std::nullopt;
 
-  const GeoPoint location_predicted = 
-    state.GetPredictedState(prediction_time_glide).location;
-
-  const AirspaceAircraftPerformance perf_glide(glide_polar);
-  return UpdatePredicted(state, location_predicted,
-                          perf_glide,
-                          AirspaceWarning::WARNING_GLIDE, prediction_time_glide);
+  return Prediction{
+    state.GetPredictedState(prediction_time_glide).location,
+    AirspaceAircraftPerformance(glide_polar),
+    AirspaceWarning::WARNING_GLIDE, prediction_time_glide,
+  };
 }
 
 bool
@@ -379,14 +423,14 @@ AirspaceWarningManager::UpdateInside(const AircraftState& state,
 
   bool found = false;
 
-  for (const auto &i : airspaces.QueryInside(state.location)) {
-    const auto airspace = i.GetAirspacePtr();
+  for (const auto &i : candidates) {
+    if (!i.inside)
+      continue;
+
+    const auto airspace = i.airspace->GetAirspacePtr();
 
     const AltitudeState &altitude = state;
-    if (// ignore inactive airspaces
-        !airspace->IsActive() ||
-        !(config.IsClassEnabled(airspace->GetClassOrType()) || config.IsClassEnabled(airspace->GetTypeOrClass())) ||
-        !airspace->Inside(altitude))
+    if (!airspace->Inside(altitude))
       continue;
 
     AirspaceWarning *warning = GetWarningPtr(*airspace);
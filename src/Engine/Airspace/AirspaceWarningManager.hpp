@@ -10,7 +10,12 @@
 #include "util/Serial.hpp"
 
 #include <list>
+#include <optional>
+#include <span>
+#include <vector>
 
+struct GeoPoint;
+class Airspace;
 class TaskStats;
 class GlidePolar;
 class Airspaces;
@@ -43,6 +48,30 @@ class AirspaceWarningManager {
 
   AirspaceWarningList warnings;
 
+  /**
+   * An airspace which may be affected by the current position or one
+   * of the predicted paths; see CollectCandidates().
+   */
+  struct Candidate {
+    const Airspace *airspace;
+
+    /**
+     * Is the current position inside the lateral boundary?
+     */
+    bool inside;
+
+    /**
+     * Is the airspace base below the ceiling for predicted intrusions?
+     */
+    bool below_ceiling;
+  };
+
+  /**
+   * The active and enabled airspaces near the aircraft, collected by
+   * Update() with one query and examined by all checks.
+   */
+  std::vector<Candidate> candidates;
+
   /**
    * This number is incremented each time this object is modified.
    */
@@ -245,15 +274,25 @@ public:
   bool IsActive(const AbstractAirspace &airspace) const noexcept;
 
 private:
-  bool UpdateTask(const AircraftState &state, const GlidePolar &glide_polar,
-                  const TaskStats &task_stats);
-  bool UpdateFilter(const AircraftState& state, const bool circling);
-  bool UpdateGlide(const AircraftState& state, const GlidePolar &glide_polar);
+  struct Prediction;
+
+  std::optional<Prediction> PredictTask(const AircraftState &state,
+                                        const GlidePolar &glide_polar,
+                                        const TaskStats &task_stats) const noexcept;
+  std::optional<Prediction> PredictFilter(bool circling) const noexcept;
+  std::optional<Prediction> PredictGlide(const AircraftState &state,
+                                         const GlidePolar &glide_polar) const noexcept;
+
+  /**
+   * Fill #candidates with the airspaces which may be affected by
+   * the current position or by a flight to one of the given
+   * predicted locations.
+   */
+  void CollectCandidates(const AircraftState &state,
+                         std::span<const GeoPoint> predicted) noexcept;
+
   bool UpdateInside(const AircraftState& state, const GlidePolar &glide_polar);
 
-  bool UpdatePredicted(const AircraftState& state, 
-                       const GeoPoint &location_predicted,
-                       const AirspaceAircraftPerformance &perf,
-                       const AirspaceWarning::State warning_state,
-                       FloatDuration max_time) noexcept;
+  bool UpdatePredicted(const AircraftState& state,
+                       const Prediction &prediction) noexcept;
 };
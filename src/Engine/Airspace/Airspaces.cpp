@@ -41,6 +41,21 @@ Airspaces::QueryIntersecting(const GeoPoint &a, const GeoPoint &b) const noexcep
   return {airspace_tree.qbegin(bgi::intersects(line)), airspace_tree.qend()};
 }
 
+Airspaces::const_iterator_range
+Airspaces::QuerySwept(const GeoPoint &location,
+                      std::span<const GeoPoint> ends) const noexcept
+{
+  if (IsEmpty())
+    // nothing to do
+    return {airspace_tree.qend(), airspace_tree.qend()};
+
+  FlatBoundingBox box(task_projection.ProjectInteger(location));
+  for (const auto &end : ends)
+    box.Expand(task_projection.ProjectInteger(end));
+
+  return {airspace_tree.qbegin(bgi::intersects(box)), airspace_tree.qend()};
+}
+
 void
 Airspaces::VisitIntersecting(const GeoPoint &loc, const GeoPoint &end,
                              bool include_inside,
@@ -83,9 +98,21 @@ Airspaces::Optimise() noexcept
     airspace_tree.clear();
   }
 
-  for (auto &i : tmp_as) {
-    Airspace as(std::move(i), task_projection);
-    airspace_tree.insert(as);
+  if (airspace_tree.empty()) {
+    /* build the whole tree in one step; the boost R-tree
+       constructor uses a packing algorithm, which is faster than
+       inserting one by one and results in a better tree */
+    AirspaceVector v;
+    v.reserve(tmp_as.size());
+    for (auto &i : tmp_as)
+      v.emplace_back(std::move(i), task_projection);
+
+    airspace_tree = AirspaceTree(v);
+  } else {
+    for (auto &i : tmp_as) {
+      Airspace as(std::move(i), task_projection);
+      airspace_tree.insert(as);
+    }
   }
 
   tmp_as.clear();
@@ -12,6 +12,7 @@
 #include "Atmosphere/Pressure.hpp"
 
 #include <deque>
+#include <span>
 
 class RasterTerrain;
 class AirspaceIntersectionVisitor;
@@ -139,6 +140,17 @@ public:
   const_iterator_range QueryIntersecting(const GeoPoint &a,
                                          const GeoPoint &b) const noexcept;
 
+  /**
+   * Query airspaces which may be touched on the way from #location to
+   * any of the given end points (bounding box check only).  This is
+   * one query for the whole swept area, for callers which examine
+   * several predicted paths at a time.  The result is in no specific
+   * order.
+   */
+  [[gnu::pure]]
+  const_iterator_range QuerySwept(const GeoPoint &location,
+                                  std::span<const GeoPoint> ends) const noexcept;
+
   /**
    * Call visitor class on airspaces intersected by vector.
    * Note that the visitor is not instantiated separately for each match
@@ -7,14 +7,37 @@
 void
 Airspaces::SetGroundLevels(const RasterTerrain &terrain) noexcept
 {
-  for (auto &v : QueryAll()) {
+  /* look up the heights of the airspace centers in chunks, using
+     small buffers on the stack */
+  constexpr std::size_t CHUNK_SIZE = 64;
+  const Airspace *airspaces[CHUNK_SIZE];
+  GeoPoint locations[CHUNK_SIZE];
+  TerrainHeight heights[CHUNK_SIZE];
+  std::size_t n = 0;
+
+  RasterTerrain::Lease map(terrain);
+
+  const auto flush = [&](){
+    map->GetHeights({locations, n}, heights, false);
+
+    for (std::size_t i = 0; i < n; ++i)
+      airspaces[i]->SetGroundLevel(heights[i].GetValueOr0());
+
+    n = 0;
+  };
+
+  for (const auto &v : QueryAll()) {
     // If we don't need the ground level we don't have to calculate it
     if (!v.NeedGroundLevel())
       continue;
 
-    FlatGeoPoint c_flat = v.GetCenter();
-    GeoPoint g = task_projection.Unproject(c_flat);
-    v.SetGroundLevel(terrain.GetTerrainHeight(g).GetValueOr0());
+    airspaces[n] = &v;
+    locations[n] = task_projection.Unproject(v.GetCenter());
+
+    if (++n == CHUNK_SIZE)
+      flush();
   }
-}
 
+  if (n > 0)
+    flush();
+}
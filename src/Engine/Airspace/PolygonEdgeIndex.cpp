@@ -0,0 +1,125 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "PolygonEdgeIndex.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <numeric>
+
+/**
+ * Fill a "compressed" bucket list: first count the edges per bucket,
+ * then store them.
+ *
+ * @param visit_buckets a function which invokes its second parameter
+ * for each bucket the given edge belongs to
+ */
+template<typename V>
+static void
+FillBuckets(std::vector<unsigned> &start, std::vector<unsigned> &items,
+            std::size_t n_buckets, unsigned n_edges,
+            V &&visit_buckets) noexcept
+{
+  start.assign(n_buckets + 1, 0);
+  for (unsigned edge = 0; edge < n_edges; ++edge)
+    visit_buckets(edge, [&start](std::size_t bucket){
+      ++start[bucket + 1];
+    });
+
+  std::partial_sum(start.begin(), start.end(), start.begin());
+
+  items.resize(start.back());
+  std::vector<unsigned> fill(start.begin(), std::prev(start.end()));
+  for (unsigned edge = 0; edge < n_edges; ++edge)
+    visit_buckets(edge, [&items, &fill, edge](std::size_t bucket){
+      items[fill[bucket]++] = edge;
+    });
+}
+
+void
+PolygonEdgeIndex::Clear() noexcept
+{
+  band_start.clear();
+  band_edges.clear();
+  cell_start.clear();
+  cell_edges.clear();
+}
+
+void
+PolygonEdgeIndex::Update(const SearchPointVector &border) noexcept
+{
+  assert(border.size() >= 2);
+
+  const unsigned n_edges = border.size() - 1;
+
+  /* latitude bands */
+
+  const auto [lat_min, lat_max] =
+    std::minmax_element(border.begin(), border.end(),
+                        [](const SearchPoint &a, const SearchPoint &b){
+                          return a.GetLocation().latitude < b.GetLocation().latitude;
+                        });
+
+  const unsigned n_bands = std::clamp(n_edges / 4, 1U, 4096U);
+  band_origin = lat_min->GetLocation().latitude;
+  const double lat_range = (lat_max->GetLocation().latitude - band_origin).Native();
+  band_factor = lat_range > 0 ? n_bands / lat_range : 0;
+
+  FillBuckets(band_start, band_edges, n_bands, n_edges,
+              [this, &border](unsigned edge, auto &&f){
+                unsigned a = GetBand(border[edge].GetLocation().latitude);
+                unsigned b = GetBand(border[edge + 1].GetLocation().latitude);
+                if (a > b)
+                  std::swap(a, b);
+
+                for (unsigned i = a; i <= b; ++i)
+                  f(i);
+              });
+
+  /* flat grid */
+
+  const FlatBoundingBox bounds = border.CalculateBoundingbox();
+  const unsigned side = std::max(1U, (unsigned)std::ceil(std::sqrt(n_edges / 2.)));
+
+  grid_origin = bounds.GetLowerLeft();
+  cell_size = std::max(bounds.GetWidth(), bounds.GetHeight()) / side + 1;
+  grid_columns = bounds.GetWidth() / cell_size + 1;
+  grid_rows = bounds.GetHeight() / cell_size + 1;
+
+  FillBuckets(cell_start, cell_edges, grid_columns * grid_rows, n_edges,
+              [this, &border](unsigned edge, auto &&f){
+                const auto a = border[edge].GetFlatLocation();
+                const auto b = border[edge + 1].GetFlatLocation();
+
+                const unsigned column_min = GetColumn(std::min(a.x, b.x));
+                const unsigned column_max = GetColumn(std::max(a.x, b.x));
+                const unsigned row_min = GetRow(std::min(a.y, b.y));
+                const unsigned row_max = GetRow(std::max(a.y, b.y));
+
+                for (unsigned row = row_min; row <= row_max; ++row)
+                  for (unsigned column = column_min; column <= column_max; ++column)
+                    f(row * grid_columns + column);
+              });
+}
+
+inline unsigned
+PolygonEdgeIndex::GetBand(Angle latitude) const noexcept
+{
+  const unsigned n_bands = band_start.size() - 1;
+  const double band = (latitude - band_origin).Native() * band_factor;
+  return band > 0 ? std::min(unsigned(band), n_bands - 1) : 0;
+}
+
+std::span<const unsigned>
+PolygonEdgeIndex::GetBandEdges(Angle latitude) const noexcept
+{
+  assert(IsDefined());
+
+  if (latitude < band_origin)
+    return {};
+
+  const unsigned band = GetBand(latitude);
+  return std::span{band_edges}.subspan(band_start[band],
+                                       band_start[band + 1] - band_start[band]);
+}
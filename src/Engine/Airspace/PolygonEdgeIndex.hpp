@@ -0,0 +1,155 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Geo/SearchPointVector.hpp"
+#include "Geo/Flat/FlatGeoPoint.hpp"
+#include "Geo/Flat/FlatBoundingBox.hpp"
+#include "Math/Angle.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <span>
+#include <vector>
+
+/**
+ * A spatial index over the edges of a closed polygon, to avoid
+ * walking the whole boundary of large airspaces for each query.
+ * Edges are identified by the index of their start point.
+ *
+ * There are two structures: a list of latitude bands for the
+ * point-in-polygon test (which works on geographic coordinates), and
+ * a uniform grid over the projected (flat) coordinates for segment
+ * intersection tests.
+ */
+class PolygonEdgeIndex {
+  /**
+   * The first latitude band starts here.
+   */
+  Angle band_origin;
+
+  /**
+   * Number of latitude bands per native angle unit.
+   */
+  double band_factor;
+
+  /**
+   * Band i contains the edges band_edges[band_start[i]] up to (but
+   * excluding) band_edges[band_start[i+1]].
+   */
+  std::vector<unsigned> band_start, band_edges;
+
+  /**
+   * The lower left corner of the grid.
+   */
+  FlatGeoPoint grid_origin;
+
+  /**
+   * The width and height of one grid cell in flat units.
+   */
+  unsigned cell_size;
+
+  unsigned grid_columns, grid_rows;
+
+  /**
+   * Cell i contains the edges cell_edges[cell_start[i]] up to (but
+   * excluding) cell_edges[cell_start[i+1]].  The cells are stored
+   * row by row.
+   */
+  std::vector<unsigned> cell_start, cell_edges;
+
+public:
+  /**
+   * Polygons with fewer points are not worth indexing.
+   */
+  static constexpr std::size_t MIN_POINTS = 32;
+
+  bool IsDefined() const noexcept {
+    return !band_start.empty();
+  }
+
+  void Clear() noexcept;
+
+  /**
+   * Build the index.  The border must be closed (i.e. the last point
+   * equals the first one) and projected.
+   */
+  void Update(const SearchPointVector &border) noexcept;
+
+  /**
+   * Returns the edges which may cross the parallel at the given
+   * latitude.
+   */
+  [[gnu::pure]]
+  std::span<const unsigned> GetBandEdges(Angle latitude) const noexcept;
+
+  /**
+   * Invoke a function for each edge whose bounding box may overlap
+   * the given box.  Each edge is visited once, in no particular
+   * order.
+   *
+   * @param border the border this index was built from
+   * @param f a function which accepts the edge index
+   * @return false if the box covers so much of the polygon that the
+   * index cannot help (without invoking the function); the caller
+   * should check all edges then
+   */
+  template<typename F>
+  bool VisitEdges(const SearchPointVector &border, const FlatBoundingBox &box,
+                  F &&f) const noexcept {
+    assert(IsDefined());
+
+    if (box.GetRight() < grid_origin.x || box.GetTop() < grid_origin.y ||
+        box.GetLeft() >= grid_origin.x + int(grid_columns * cell_size) ||
+        box.GetBottom() >= grid_origin.y + int(grid_rows * cell_size))
+      return true;
+
+    const unsigned column_min = GetColumn(box.GetLeft());
+    const unsigned column_max = GetColumn(box.GetRight());
+    const unsigned row_min = GetRow(box.GetBottom());
+    const unsigned row_max = GetRow(box.GetTop());
+
+    const unsigned n_cells = (column_max - column_min + 1) * (row_max - row_min + 1);
+    if (n_cells * 2 > grid_columns * grid_rows)
+      return false;
+
+    for (unsigned row = row_min; row <= row_max; ++row) {
+      for (unsigned column = column_min; column <= column_max; ++column) {
+        const unsigned cell = row * grid_columns + column;
+        for (unsigned i = cell_start[cell]; i < cell_start[cell + 1]; ++i) {
+          const unsigned edge = cell_edges[i];
+
+          /* an edge is stored in all cells of its bounding box;
+             visit it only in the first of those which is inside
+             the given box */
+          const auto a = border[edge].GetFlatLocation();
+          const auto b = border[edge + 1].GetFlatLocation();
+          if (row == std::max(row_min, GetRow(std::min(a.y, b.y))) &&
+              column == std::max(column_min, GetColumn(std::min(a.x, b.x))))
+            f(edge);
+        }
+      }
+    }
+
+    return true;
+  }
+
+private:
+  [[gnu::pure]]
+  unsigned GetBand(Angle latitude) const noexcept;
+
+  [[gnu::pure]]
+  unsigned GetColumn(int x) const noexcept {
+    return x > grid_origin.x
+      ? std::min(unsigned(x - grid_origin.x) / cell_size, grid_columns - 1)
+      : 0;
+  }
+
+  [[gnu::pure]]
+  unsigned GetRow(int y) const noexcept {
+    return y > grid_origin.y
+      ? std::min(unsigned(y - grid_origin.y) / cell_size, grid_rows - 1)
+      : 0;
+  }
+};
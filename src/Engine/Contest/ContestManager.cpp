@@ -2,6 +2,11 @@
 // Copyright The XCSoar Project
 
 #include "ContestManager.hpp"
+#include "thread/Parallel.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <span>
 
 ContestManager::ContestManager(const Contest _contest,
                                const Trace &trace_full,
@@ -9,6 +14,7 @@ ContestManager::ContestManager(const Contest _contest,
                                const Trace &trace_sprint,
                                bool predict_triangle) noexcept
   :contest(_contest),
+   parallel(GetProcessorCount() > 1),
    olc_sprint(trace_sprint),
    olc_fai(trace_triangle, predict_triangle),
    olc_classic(trace_full),
@@ -49,6 +55,15 @@ ContestManager::SetIncremental(bool incremental) noexcept
   charron_large.SetIncremental(incremental);
 }
 
+void
+ContestManager::SetTriangleTimeBudget(FloatDuration budget) noexcept
+{
+  olc_fai.SetTimeBudget(budget);
+  xcontest_triangle.SetTimeBudget(budget);
+  dhv_xc_triangle.SetTimeBudget(budget);
+  weglide_fai.SetTimeBudget(budget);
+}
+
 void
 ContestManager::SetPredicted(const TracePoint &predicted) noexcept
 {
@@ -120,11 +135,15 @@ ContestManager::SetHandicap(unsigned handicap) noexcept
 static bool
 RunContest(AbstractContest &_contest,
            ContestResult &result, ContestTraceVector &solution,
+           FloatDuration &solve_time,
            bool exhaustive) noexcept
 {
+  const auto start = std::chrono::steady_clock::now();
+
   // run solver, return immediately if further processing is required
   // by subsequent calls
   SolverResult r = _contest.Solve(exhaustive);
+  solve_time += std::chrono::steady_clock::now() - start;
   if (r != SolverResult::VALID)
     return false;
 
@@ -140,128 +159,145 @@ RunContest(AbstractContest &_contest,
   return true;
 }
 
+bool
+ContestManager::RunContest(AbstractContest &_contest, std::size_t i,
+                           bool exhaustive) noexcept
+{
+  return ::RunContest(_contest, stats.result[i], stats.solution[i],
+                      solve_times[i], exhaustive);
+}
+
+bool
+ContestManager::RunContests(std::span<AbstractContest *const> contests,
+                            bool exhaustive) noexcept
+{
+  assert(contests.size() <= ContestStatistics::N);
+
+  /* each solver writes only to its own slot of #stats, and all of
+     them only read the Trace objects */
+  std::array<bool, ContestStatistics::N> results{};
+
+  if (parallel && contests.size() > 1) {
+    if (pool == nullptr) {
+      /* the threads are kept for subsequent calls */
+      own_pool = std::make_unique<WorkerPool>(std::min<unsigned>(GetProcessorCount(),
+                                                                 ContestStatistics::N) - 1);
+      pool = own_pool.get();
+    }
+
+    pool->Run(contests.size(), [&](unsigned i){
+      results[i] = RunContest(*contests[i], i, exhaustive);
+    });
+  } else
+    for (std::size_t i = 0; i < contests.size(); ++i)
+      results[i] = RunContest(*contests[i], i, exhaustive);
+
+  return std::any_of(results.begin(), results.end(),
+                     [](bool b){ return b; });
+}
+
 bool
 ContestManager::UpdateIdle(bool exhaustive) noexcept
 {
   bool retval = false;
 
+  solve_times.fill({});
+
   switch (contest) {
   case Contest::NONE:
     break;
 
   case Contest::OLC_SPRINT:
-    retval = RunContest(olc_sprint, stats.result[0],
-                        stats.solution[0], exhaustive);
+    retval = RunContest(olc_sprint, 0, exhaustive);
     break;
 
   case Contest::OLC_FAI:
-    retval = RunContest(olc_fai, stats.result[0],
-                        stats.solution[0], exhaustive);
+    retval = RunContest(olc_fai, 0, exhaustive);
     break;
 
   case Contest::OLC_CLASSIC:
-    retval = RunContest(olc_classic, stats.result[0],
-                        stats.solution[0], exhaustive);
+    retval = RunContest(olc_classic, 0, exhaustive);
     break;
 
   case Contest::OLC_LEAGUE:
-    retval = RunContest(olc_classic, stats.result[1],
-                        stats.solution[1], exhaustive);
+    retval = RunContest(olc_classic, 1, exhaustive);
 
     olc_league.Feed(stats.solution[1]);
 
-    retval |= RunContest(olc_league, stats.result[0],
-                         stats.solution[0], exhaustive);
+    retval |= RunContest(olc_league, 0, exhaustive);
     break;
 
-  case Contest::OLC_PLUS:
-    retval = RunContest(olc_classic, stats.result[0],
-                        stats.solution[0], exhaustive);
-
-    retval |= RunContest(olc_fai, stats.result[1],
-                         stats.solution[1], exhaustive);
+  case Contest::OLC_PLUS: {
+    AbstractContest *const contests[] = {&olc_classic, &olc_fai};
+    retval = RunContests(contests, exhaustive);
 
     if (retval) {
       olc_plus.Feed(stats.result[0], stats.solution[0],
                     stats.result[1], stats.solution[1]);
 
-      RunContest(olc_plus, stats.result[2],
-                 stats.solution[2], exhaustive);
+      RunContest(olc_plus, 2, exhaustive);
     }
 
     break;
+  }
 
   case Contest::DMST:
-    retval = RunContest(dmst_quad, stats.result[0],
-                        stats.solution[0], exhaustive);
+    retval = RunContest(dmst_quad, 0, exhaustive);
     break;
 
-  case Contest::XCONTEST:
-    retval = RunContest(xcontest_free, stats.result[0],
-                        stats.solution[0], exhaustive);
-    retval |= RunContest(xcontest_triangle, stats.result[1],
-                         stats.solution[1], exhaustive);
+  case Contest::XCONTEST: {
+    AbstractContest *const contests[] = {&xcontest_free, &xcontest_triangle};
+    retval = RunContests(contests, exhaustive);
     break;
+  }
 
-  case Contest::DHV_XC:
-    retval = RunContest(dhv_xc_free, stats.result[0],
-                        stats.solution[0], exhaustive);
-    retval |= RunContest(dhv_xc_triangle, stats.result[1],
-                         stats.solution[1], exhaustive);
+  case Contest::DHV_XC: {
+    AbstractContest *const contests[] = {&dhv_xc_free, &dhv_xc_triangle};
+    retval = RunContests(contests, exhaustive);
     break;
+  }
 
   case Contest::SIS_AT:
-    retval = RunContest(sis_at, stats.result[0],
-                        stats.solution[0], exhaustive);
+    retval = RunContest(sis_at, 0, exhaustive);
     break;
 
   case Contest::NET_COUPE:
-    retval = RunContest(net_coupe, stats.result[0],
-                        stats.solution[0], exhaustive);
+    retval = RunContest(net_coupe, 0, exhaustive);
     break;
 
-  case Contest::WEGLIDE_FREE:
-    retval = RunContest(weglide_distance, stats.result[0],
-                        stats.solution[0], exhaustive);
-
-    retval |= RunContest(weglide_fai, stats.result[1],
-                         stats.solution[1], exhaustive);
-
-    retval |= RunContest(weglide_or, stats.result[2],
-                         stats.solution[2], exhaustive);
+  case Contest::WEGLIDE_FREE: {
+    AbstractContest *const contests[] = {
+      &weglide_distance, &weglide_fai, &weglide_or,
+    };
+    retval = RunContests(contests, exhaustive);
 
     if (retval) {
       weglide_free.Feed(stats.result[0], stats.solution[0],
                         stats.result[1], stats.solution[1],
                         stats.result[2], stats.solution[2]);
 
-      RunContest(weglide_free, stats.result[3],
-                 stats.solution[3], exhaustive);
+      RunContest(weglide_free, 3, exhaustive);
     }
     break;
+  }
 
   case Contest::WEGLIDE_DISTANCE:
-    retval = RunContest(weglide_distance, stats.result[0],
-                        stats.solution[0], exhaustive);
+    retval = RunContest(weglide_distance, 0, exhaustive);
     break;
 
   case Contest::WEGLIDE_FAI:
-    retval = RunContest(weglide_fai, stats.result[0],
-                        stats.solution[0], exhaustive);
+    retval = RunContest(weglide_fai, 0, exhaustive);
     break;
 
   case Contest::WEGLIDE_OR:
-    retval = RunContest(weglide_or, stats.result[0],
-                        stats.solution[0], exhaustive);
+    retval = RunContest(weglide_or, 0, exhaustive);
     break;
 
   case Contest::CHARRON:
-    retval = RunContest(charron_large, stats.result[0],
-                        stats.solution[0], exhaustive);
+    retval = RunContest(charron_large, 0, exhaustive);
 
     if (!retval) {
-      retval = RunContest(charron_small, stats.result[0],
-                          stats.solution[0], exhaustive);
+      retval = RunContest(charron_small, 0, exhaustive);
     }
     break;
 
@@ -274,6 +310,7 @@ void
 ContestManager::Reset() noexcept
 {
   stats.Reset();
+  solve_times.fill({});
   olc_sprint.Reset();
   olc_fai.Reset();
   olc_classic.Reset();
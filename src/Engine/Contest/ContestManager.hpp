@@ -20,6 +20,12 @@
 #include "Solvers/WeglideOR.hpp"
 #include "Solvers/Charron.hpp"
 #include "ContestStatistics.hpp"
+#include "time/FloatDuration.hxx"
+#include "thread/WorkerPool.hpp"
+
+#include <array>
+#include <memory>
+#include <span>
 
 class Trace;
 
@@ -34,6 +40,26 @@ class ContestManager
 
   ContestStatistics stats;
 
+  /**
+   * The time spent by the solver(s) for each #ContestStatistics
+   * slot during the last UpdateIdle() call.
+   */
+  std::array<FloatDuration, ContestStatistics::N> solve_times;
+
+  /**
+   * Run independent solvers in parallel?  This is only enabled if
+   * there is more than one CPU.
+   */
+  bool parallel;
+
+  /**
+   * The threads which run independent solvers; either #own_pool
+   * (created on demand) or one passed to SetWorkerPool().
+   */
+  WorkerPool *pool = nullptr;
+
+  std::unique_ptr<WorkerPool> own_pool;
+
   OLCSprint olc_sprint;
   OLCFAI olc_fai;
   OLCClassic olc_classic;
@@ -87,10 +113,41 @@ public:
 
   void SetHandicap(unsigned handicap) noexcept;
 
+  /**
+   * Limit the time spent by the triangle solvers in each
+   * non-exhaustive UpdateIdle() call; an unfinished search is
+   * resumed by the next call.  Pass zero to disable the limit.
+   *
+   * @see TriangleContest::SetTimeBudget()
+   */
+  void SetTriangleTimeBudget(FloatDuration budget) noexcept;
+
+  /**
+   * Enable or disable running independent solvers (e.g. the free and
+   * the triangle solver of XContest) in parallel threads.  The
+   * result is the same either way.
+   */
+  void SetParallel(bool _parallel) noexcept {
+    parallel = _parallel;
+  }
+
+  /**
+   * Run the solvers in the given #WorkerPool instead of creating
+   * threads just for this object.  It must remain valid as long as
+   * this object is used.
+   */
+  void SetWorkerPool(WorkerPool &_pool) noexcept {
+    pool = &_pool;
+  }
+
   /**
    * Update internal states (non-essential) for housework,
    * or where functions are slow and would cause loss to real-time performance.
    *
+   * Independent solvers may run in parallel threads; they only read
+   * the #Trace objects, which must not be modified until this method
+   * returns.
+   *
    * @param exhaustive true to find the final solution, false stops
    * after a number of iterations (incremental search)
    * @return True if internal state changed
@@ -124,4 +181,30 @@ public:
   const ContestStatistics &GetStats() const noexcept {
     return stats;
   }
+
+  /**
+   * How much (wall clock) time did the solver(s) producing
+   * ContestStatistics::result[i] take in the last UpdateIdle() call?
+   */
+  FloatDuration GetSolveTime(std::size_t i) const noexcept {
+    return solve_times[i];
+  }
+
+private:
+  /**
+   * Run one solver and store its result in slot #i of #stats.
+   *
+   * @return true if the result was updated
+   */
+  bool RunContest(AbstractContest &_contest, std::size_t i,
+                  bool exhaustive) noexcept;
+
+  /**
+   * Run independent solvers, possibly in parallel; the result of
+   * contests[i] is stored in slot #i of #stats.
+   *
+   * @return true if at least one result was updated
+   */
+  bool RunContests(std::span<AbstractContest *const> contests,
+                   bool exhaustive) noexcept;
 };
@@ -197,7 +197,7 @@ ContestDijkstra::AddStartEdges() noexcept
        destination != end; destination.IncrementPointIndex()) {
     // only add points that are valid for the finish
     if (!incremental ||
-        GetPoint(destination).GetIntegerAltitude() <= max_altitude)
+        columns.GetIntegerAltitude(destination.GetPointIndex()) <= max_altitude)
       LinkStart(destination);
   }
 }
@@ -222,18 +222,23 @@ ContestDijkstra::AddEdges(const ScanTaskPoint origin,
   const auto &origin_tp = GetPoint(origin);
   const unsigned weight = GetStageWeight(origin.GetStageNumber());
 
+  /* scan the destinations in the contiguous arrays instead of
+     dereferencing a TracePoint pointer for each one */
+  const auto altitudes = columns.GetAltitudes();
+  const auto locations = columns.GetLocations();
+  const auto flat_locations = columns.GetFlatLocations();
+
   bool previous_above = false;
   for (const ScanTaskPoint end(destination.GetStageNumber(), n_points);
        destination != end; destination.IncrementPointIndex()) {
-    const auto destination_tp = GetPoint(destination);
-    const bool above = destination_tp.GetIntegerAltitude() >= min_altitude;
+    const unsigned i = destination.GetPointIndex();
+    const bool above = (int)altitudes[i] >= min_altitude;
 
     /* Check if the distance is withing the minimum distance.
        Also allows zero distance legs, because if a minimum distance is set not
        all solutions will use all legs. */
-    if (origin_tp.GetFlatLocation() == destination_tp.GetFlatLocation() ||
-        CheckMinDistance(origin_tp.GetLocation(),
-                         destination_tp.GetLocation())) {
+    if (origin_tp.GetFlatLocation() == flat_locations[i] ||
+        CheckMinDistance(origin_tp.GetLocation(), locations[i])) {
       if (above) {
         const value_type d = weight * CalcEdgeDistance(origin, destination);
         Link(destination, origin, d);
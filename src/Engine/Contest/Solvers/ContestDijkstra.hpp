@@ -123,7 +123,8 @@ protected:
   [[gnu::pure]]
   value_type CalcEdgeDistance(const ScanTaskPoint s1,
                               const ScanTaskPoint s2) const noexcept {
-    return GetPoint(s1).FlatDistanceTo(GetPoint(s2));
+    return columns.GetFlatLocation(s1.GetPointIndex())
+      .Distance(columns.GetFlatLocation(s2.GetPointIndex()));
   }
 
   bool Link(const ScanTaskPoint node, const ScanTaskPoint parent,
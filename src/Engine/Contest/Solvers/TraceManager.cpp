@@ -77,6 +77,7 @@ TraceManager::ClearTrace() noexcept
   append_serial = modify_serial = Serial();
   trace_dirty = true;
   trace.clear();
+  columns.clear();
   n_points = 0;
   predicted = TracePoint::Invalid();
 }
@@ -86,6 +87,7 @@ TraceManager::UpdateTraceFull() noexcept
 {
   trace.reserve(trace_master.GetMaxSize());
   trace_master.GetPoints(trace);
+  trace_master.GetPoints(columns);
   n_points = trace.size();
 
   if (n_points > 0 && predicted.IsDefined())
@@ -108,6 +110,7 @@ TraceManager::UpdateTraceTail() noexcept
     /* no new points */
     return false;
 
+  trace_master.SyncPoints(columns);
   n_points = trace.size();
 
   if (n_points > 0 && predicted.IsDefined())
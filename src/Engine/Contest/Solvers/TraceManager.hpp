@@ -6,6 +6,7 @@
 #include "util/Serial.hpp"
 #include "Trace/Trace.hpp"
 #include "Trace/Vector.hpp"
+#include "Trace/Columns.hpp"
 #include "Trace/Point.hpp"
 
 class TraceManager {
@@ -35,6 +36,13 @@ protected:
    */
   TracePointerVector trace;
 
+  /**
+   * A copy of the attributes of #trace as contiguous arrays, for
+   * loops which scan many points.  It is always kept in step with
+   * #trace.
+   */
+  TraceColumns columns;
+
   /** Number of points in current trace set */
   unsigned n_points;
 
@@ -59,7 +59,8 @@ TriangleContest::Reset() noexcept
   closing_pairs.Clear();
   ClearTrace();
 
-  ResetBranchAndBound();
+  AbortSearch();
+  search_elapsed = {};
   AbstractContest::Reset();
 }
 
@@ -67,9 +68,43 @@ void
 TriangleContest::ResetBranchAndBound() noexcept
 {
   running = false;
+  timed_out = false;
   branch_and_bound.clear();
 }
 
+void
+TriangleContest::AbortSearch() noexcept
+{
+  ResetBranchAndBound();
+  search.active = false;
+  search.pairs.clear();
+  search.close_look.Clear();
+  partial = false;
+}
+
+TriangleContest::Progress
+TriangleContest::GetProgress() const noexcept
+{
+  Progress progress{};
+  progress.elapsed = search_elapsed;
+  progress.running = IsSearching();
+
+  if (n_points == 0)
+    return progress;
+
+  const double scale = trace_master.GetProjection().GetApproximateScale();
+
+  unsigned best = best_d;
+  if (search.active)
+    best = std::max(best, search.best_triangle.distance);
+  progress.best_distance = best * scale;
+
+  if (running && !branch_and_bound.empty())
+    progress.upper_bound = branch_and_bound.rbegin()->first * scale;
+
+  return progress;
+}
+
 [[gnu::pure]]
 static double
 CalcLegDistance(const ContestTraceVector &solution,
@@ -127,14 +162,25 @@ TriangleContest::Solve(bool exhaustive) noexcept
     return SolverResult::FAILED;
   }
 
-  if (!running) {
+  if (exhaustive && search.active)
+    /* an exhaustive run must not continue a search which was
+       interrupted by the time budget; start over */
+    AbortSearch();
+
+  if (IsSearching() && CheckMasterSerial())
+    /* the master trace has been thinned while the search was
+       suspended, which invalidates our TracePoint pointers */
+    AbortSearch();
+
+  const bool resuming = IsSearching();
+  if (!resuming) {
     // branch and bound is currently in finished state, update trace
     UpdateTrace(exhaustive);
   }
 
-  if (!is_complete || running) {
+  if (!is_complete || resuming) {
     if (n_points < 3) {
-      ResetBranchAndBound();
+      AbortSearch();
       return SolverResult::FAILED;
     }
 
@@ -150,91 +196,151 @@ TriangleContest::Solve(bool exhaustive) noexcept
   }
 }
 
-inline void
-TriangleContest::SolveTriangle(bool exhaustive) noexcept
+void
+TriangleContest::StartSearch() noexcept
 {
-  Candidate best_triangle{.distance = best_d};
-  ClosingPair best_closing_pair;
+  search.pairs.clear();
+  search.next = 0;
+  search.close_look.Clear();
+  search.close_look_added = false;
+  search.best_triangle = {.distance = best_d};
+  search.best_closing_pair = {};
+  search.active = true;
 
-  if (exhaustive || !predict) {
-    ClosingPairs relaxed_pairs;
+  ClosingPairs relaxed_pairs;
 
-    unsigned relax = n_points * 0.03;
+  unsigned relax = n_points * 0.03;
 
-    // for all closed trace loops
-    for (auto closing_pair = closing_pairs.closing_pairs.begin();
-         closing_pair != closing_pairs.closing_pairs.end();
-         ++closing_pair) {
+  // for all closed trace loops
+  for (auto closing_pair = closing_pairs.closing_pairs.begin();
+       closing_pair != closing_pairs.closing_pairs.end();
+       ++closing_pair) {
 
-      auto already_relaxed = relaxed_pairs.FindRange(*closing_pair);
-      if (already_relaxed.first != 0 || already_relaxed.second != 0)
-        // this pair is already relaxed... continue with next
-        continue;
+    auto already_relaxed = relaxed_pairs.FindRange(*closing_pair);
+    if (already_relaxed.first != 0 || already_relaxed.second != 0)
+      // this pair is already relaxed... continue with next
+      continue;
 
-      unsigned relax_first = closing_pair->first;
-      unsigned relax_last = closing_pair->second;
+    unsigned relax_first = closing_pair->first;
+    unsigned relax_last = closing_pair->second;
 
-      const unsigned max_first = closing_pair->first + relax;
-      const unsigned max_last = closing_pair->second + relax;
+    const unsigned max_first = closing_pair->first + relax;
+    const unsigned max_last = closing_pair->second + relax;
 
-      for (auto relaxed = std::next(closing_pair);
-           relaxed != closing_pairs.closing_pairs.end() &&
-           relaxed->first <= max_first && relaxed->second <= max_last;
-           ++relaxed)
-        relax_last = std::max(relax_last, relaxed->second);
+    for (auto relaxed = std::next(closing_pair);
+         relaxed != closing_pairs.closing_pairs.end() &&
+         relaxed->first <= max_first && relaxed->second <= max_last;
+         ++relaxed)
+      relax_last = std::max(relax_last, relaxed->second);
 
-      relaxed_pairs.Insert({relax_first, relax_last});
-    }
+    relaxed_pairs.Insert({relax_first, relax_last});
+  }
 
-    // TODO: reverse sort relaxed pairs according to number of contained points
+  // TODO: reverse sort relaxed pairs according to number of contained points
 
-    ClosingPairs close_look;
+  search.pairs.assign(relaxed_pairs.closing_pairs.begin(),
+                      relaxed_pairs.closing_pairs.end());
+}
 
-#if GCC_CHECK_VERSION(12,0)
-    // yes, we do want relaxed_pair to be a copy
-#pragma GCC diagnostic ignored "-Wrange-loop-construct"
-#endif
+bool
+TriangleContest::ContinueSearch(bool exhaustive, Deadline deadline) noexcept
+{
+  while (true) {
+    if (search.next == search.pairs.size()) {
+      if (search.close_look_added)
+        return true;
+
+      /* all relaxed pairs are done; now examine the unrelaxed pairs
+         which need a closer look */
+      search.pairs.insert(search.pairs.end(),
+                          search.close_look.closing_pairs.begin(),
+                          search.close_look.closing_pairs.end());
+      search.close_look_added = true;
+      continue;
+    }
 
-    for (const auto relaxed_pair : relaxed_pairs.closing_pairs) {
+    const ClosingPair pair = search.pairs[search.next];
+    const auto triangle = RunBranchAndBound(pair.first, pair.second,
+                                            search.best_triangle.distance,
+                                            exhaustive, deadline);
 
-      const auto triangle = RunBranchAndBound(relaxed_pair.first,
-                                              relaxed_pair.second,
-                                              best_triangle.distance, exhaustive);
+    if (triangle.distance > search.best_triangle.distance) {
+      // solution is better than best_triangle
 
-      if (triangle.distance > best_triangle.distance) {
-        // solution is better than best_triangle
+      if (search.close_look_added) {
+        search.best_closing_pair = pair;
+        search.best_triangle = triangle;
+      } else {
         // only if triangle is inside a unrelaxed pair...
 
         auto unrelaxed = closing_pairs.FindRange({triangle.tp1, triangle.tp2});
         if (unrelaxed.first != 0 || unrelaxed.second != 0) {
           // fortunately it is inside a unrelaxed closing pair :-)
-          best_closing_pair = unrelaxed;
-          best_triangle = triangle;
+          search.best_closing_pair = unrelaxed;
+          search.best_triangle = triangle;
         } else {
           // otherwise we should solve the triangle again for every unrelaxed pair
           // contained inside the current relaxed pair. *damn!*
-          for (const auto closing_pair : closing_pairs.closing_pairs) {
-            if (closing_pair.first >= relaxed_pair.first &&
-                closing_pair.second <= relaxed_pair.second)
-              close_look.Insert(closing_pair);
-         }
-       }
+          for (const auto &closing_pair : closing_pairs.closing_pairs) {
+            if (closing_pair.first >= pair.first &&
+                closing_pair.second <= pair.second)
+              search.close_look.Insert(closing_pair);
+          }
+        }
       }
     }
 
-    for (const auto &close_look_pair : close_look.closing_pairs) {
-      const auto triangle = RunBranchAndBound(close_look_pair.first,
-                                              close_look_pair.second,
-                                              best_triangle.distance, exhaustive);
+    if (timed_out)
+      /* resume this closing pair with the next call */
+      return false;
+
+    ++search.next;
+  }
+}
+
+inline void
+TriangleContest::SolveTriangle(bool exhaustive) noexcept
+{
+  using std::chrono::steady_clock;
 
-      if (triangle.distance > best_triangle.distance) {
-        // solution is better than best_triangle
+  const auto start_time = steady_clock::now();
+  const Deadline deadline = !exhaustive && time_budget > FloatDuration{}
+    ? start_time + std::chrono::duration_cast<steady_clock::duration>(time_budget)
+    : Deadline::max();
 
-        best_closing_pair = close_look_pair;
-        best_triangle = triangle;
+  if (!IsSearching())
+    search_elapsed = {};
+
+  Candidate best_triangle{.distance = best_d};
+  ClosingPair best_closing_pair;
+
+  if (exhaustive || !predict) {
+    if (!search.active)
+      StartSearch();
+
+    const bool finished = ContinueSearch(exhaustive, deadline);
+    search_elapsed += steady_clock::now() - start_time;
+
+    if (!finished) {
+      /* out of time; publish the best triangle found so far and
+         continue with the next call */
+      if (search.best_triangle.distance > best_d) {
+        solution.resize(5);
+
+        solution[0] = TraceManager::GetPoint(search.best_closing_pair.first);
+        solution[1] = TraceManager::GetPoint(search.best_triangle.tp1);
+        solution[2] = TraceManager::GetPoint(search.best_triangle.tp2);
+        solution[3] = TraceManager::GetPoint(search.best_triangle.tp3);
+        solution[4] = TraceManager::GetPoint(search.best_closing_pair.second);
+        partial = true;
       }
+
+      return;
     }
 
+    search.active = false;
+    best_triangle = search.best_triangle;
+    best_closing_pair = search.best_closing_pair;
   } else {
     /**
      * We're currently running in predictive, non-exhaustive mode, so we use
@@ -242,7 +348,9 @@ TriangleContest::SolveTriangle(bool exhaustive) noexcept
      * solver...
      */
     const auto triangle = RunBranchAndBound(0, n_points - 1,
-                                            best_triangle.distance, false);
+                                            best_triangle.distance, false,
+                                            deadline);
+    search_elapsed += steady_clock::now() - start_time;
 
     if (triangle.distance > best_triangle.distance) {
       // solution is better than best_triangle
@@ -252,6 +360,8 @@ TriangleContest::SolveTriangle(bool exhaustive) noexcept
     }
   }
 
+  partial = false;
+
   if (best_triangle.distance > 0) {
     solution.resize(5);
 
@@ -266,10 +376,9 @@ TriangleContest::SolveTriangle(bool exhaustive) noexcept
   }
 }
 
-
 TriangleContest::Candidate
 TriangleContest::RunBranchAndBound(unsigned from, unsigned to, unsigned worst_d,
-                                   bool exhaustive) noexcept
+                                   bool exhaustive, Deadline deadline) noexcept
 {
   /* Some general information about the branch and bound method can be found here:
    * http://eaton.math.rpi.edu/faculty/Mitchell/papers/leeejem.html
@@ -278,6 +387,8 @@ TriangleContest::RunBranchAndBound(unsigned from, unsigned to, unsigned worst_d,
    * http://www.penguin.cz/~ondrap/algorithm.pdf
    */
 
+  timed_out = false;
+
   // Return early if this tp-range can't beat the current best_d...
   // Assume a maximum speed of 100 m/s
   const unsigned fastskiprange = GetPoint(to).DeltaTime(GetPoint(from)).count() * 100;
@@ -323,6 +434,14 @@ TriangleContest::RunBranchAndBound(unsigned from, unsigned to, unsigned worst_d,
     if (iterations > max_iterations || branch_and_bound.size() > max_tree_size)
       break;
 
+    // suspend if the time budget is exceeded; checking the clock is
+    // not free, so do it only every 64 iterations
+    if (deadline != Deadline::max() && iterations % 64 == 0 &&
+        std::chrono::steady_clock::now() >= deadline) {
+      timed_out = true;
+      break;
+    }
+
     // first clean up tree, removeing all nodes with d_max < worst_d
     branch_and_bound.erase(branch_and_bound.begin(), branch_and_bound.lower_bound(worst_d));
 
@@ -429,10 +548,11 @@ ContestResult
 TriangleContest::CalculateResult() const noexcept
 {
   ContestResult result;
-  result.time = (is_complete && is_closed)
+  const bool valid = (is_complete || partial) && is_closed;
+  result.time = valid
     ? solution[4].DeltaTime(solution[0])
     : FloatDuration{};
-  result.distance = (is_complete && is_closed)
+  result.distance = valid
     ? CalcLegDistance(solution, 0) + CalcLegDistance(solution, 1) + CalcLegDistance(solution, 2)
     : 0.;
   result.score = ApplyHandicap(result.distance * 0.001);
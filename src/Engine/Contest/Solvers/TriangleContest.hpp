@@ -8,9 +8,12 @@
 #include "TraceManager.hpp"
 #include "Trace/Point.hpp"
 #include "Geo/Flat/FlatBoundingBox.hpp"
+#include "time/FloatDuration.hxx"
 
+#include <chrono>
 #include <map>
 #include <utility> // for std::swap()
+#include <vector>
 
 /**
  * Specialisation of AbstractContest for OLC Triangle (triangle) rules
@@ -65,6 +68,30 @@ private:
    */
   unsigned tick_iterations;
 
+  /**
+   * If positive, then a non-exhaustive Solve() call returns after
+   * spending roughly this much time in the branch and bound search;
+   * the search is resumed by the next call.
+   */
+  FloatDuration time_budget{};
+
+  /**
+   * Set by RunBranchAndBound() if it returned because the time
+   * budget was exceeded.
+   */
+  bool timed_out = false;
+
+  /**
+   * Does #solution contain the best triangle of an interrupted
+   * search (see #time_budget)?
+   */
+  bool partial = false;
+
+  /**
+   * The time spent on the current (or last) search.
+   */
+  FloatDuration search_elapsed{};
+
   /**
    * Hard limits for number of iterations and tree size.
    */
@@ -257,7 +284,71 @@ private:
 
   std::multimap<unsigned, CandidateSet> branch_and_bound;
 
+  /**
+   * The state of the non-predictive search over all closing pairs,
+   * which can be interrupted when the #time_budget is exceeded.
+   */
+  struct Search {
+    /**
+     * The (relaxed) closing pairs to be examined, followed by the
+     * "close look" pairs once all relaxed pairs are done.
+     */
+    std::vector<ClosingPair> pairs;
+
+    /**
+     * Index of the next element of #pairs to be examined.
+     */
+    std::size_t next;
+
+    /**
+     * Unrelaxed closing pairs which need a closer look because a
+     * triangle was found in a relaxed pair only.
+     */
+    ClosingPairs close_look;
+
+    /**
+     * Have the #close_look pairs been appended to #pairs already?
+     */
+    bool close_look_added;
+
+    Candidate best_triangle;
+    ClosingPair best_closing_pair;
+
+    /**
+     * Is a search in progress?
+     */
+    bool active = false;
+  } search;
+
 public:
+  /**
+   * Progress information about the current search.
+   */
+  struct Progress {
+    /**
+     * The (approximate) distance of the best triangle found so far
+     * [m].
+     */
+    double best_distance;
+
+    /**
+     * The (approximate) upper bound of the triangle distance within
+     * the closing pair being examined [m]; 0 if no search is in
+     * progress.
+     */
+    double upper_bound;
+
+    /**
+     * The time spent on the current (or last) search.
+     */
+    FloatDuration elapsed;
+
+    /**
+     * Will the next Solve() call continue an interrupted search?
+     */
+    bool running;
+  };
+
   TriangleContest(const Trace &_trace,
                   bool predict,
                   const unsigned finish_alt_diff = 1000) noexcept;
@@ -267,11 +358,37 @@ public:
   }
 
 private:
+  using Deadline = std::chrono::steady_clock::time_point;
+
+  bool IsSearching() const noexcept {
+    return running || search.active;
+  }
+
   bool FindClosingPairs(unsigned old_size) noexcept;
   void SolveTriangle(bool exhaustive) noexcept;
 
+  /**
+   * Initialise #search with the relaxed closing pairs.
+   */
+  void StartSearch() noexcept;
+
+  /**
+   * Continue the search over all closing pairs.
+   *
+   * @return true if the search is finished, false if it was
+   * interrupted because the deadline was reached
+   */
+  bool ContinueSearch(bool exhaustive, Deadline deadline) noexcept;
+
+  void AbortSearch() noexcept;
+
+  /**
+   * @param deadline return (with #timed_out set) when this time has
+   * been reached; the search can be resumed with the next call
+   */
   Candidate RunBranchAndBound(unsigned from, unsigned to, unsigned best_d,
-                              bool exhaustive) noexcept;
+                              bool exhaustive,
+                              Deadline deadline=Deadline::max()) noexcept;
 
   void UpdateTrace(bool force) noexcept override;
   void ResetBranchAndBound() noexcept;
@@ -293,6 +410,17 @@ public:
     max_tree_size = _max_tree_size;
   };
 
+  /**
+   * Limit the time spent by non-exhaustive Solve() calls.  Pass
+   * zero to disable the limit.
+   */
+  void SetTimeBudget(FloatDuration _time_budget) noexcept {
+    time_budget = _time_budget;
+  }
+
+  [[gnu::pure]]
+  Progress GetProgress() const noexcept;
+
   /* virtual methods from AbstractContest */
   void Reset() noexcept override;
   SolverResult Solve(bool exhaustive) noexcept override;
@@ -9,6 +9,8 @@
 #include "util/GlobalSliceAllocator.hxx"
 #include "Geo/Flat/FlatProjection.hpp"
 
+#include <algorithm>
+
 #define REACH_SWEEP (ROUTEPOLAR_Q1-BUFFER)
 
 static bool
@@ -155,17 +157,32 @@ FlatTriangleFanTree::UpdateTerrainBase(const FlatGeoPoint o,
     return;
   }
 
-  for (const auto &x : fan.GetVertices()) {
-    const FlatGeoPoint av = (o + x) * 0.5;
-    const GeoPoint p = parms.projection.Unproject(av);
-    const auto h = parms.terrain->GetHeight(p);
-
-    if (h.IsWater())
-      /* water: assume 0m MSL */
-      parms.terrain_counter++;
-    else if (!h.IsInvalid()) {
-      parms.terrain_counter++;
-      parms.terrain_base += h.GetValue();
+  /* look up the heights in chunks, using small buffers on the stack
+     instead of allocating arrays for the whole fan */
+  constexpr std::size_t CHUNK_SIZE = 64;
+  GeoPoint locations[CHUNK_SIZE];
+  TerrainHeight heights[CHUNK_SIZE];
+
+  for (auto vertices = fan.GetVertices(); !vertices.empty();) {
+    const auto chunk = vertices.first(std::min(vertices.size(), CHUNK_SIZE));
+    vertices = vertices.subspan(chunk.size());
+
+    std::transform(chunk.begin(), chunk.end(), locations,
+                   [o, &parms](const FlatGeoPoint &x){
+                     const FlatGeoPoint av = (o + x) * 0.5;
+                     return parms.projection.Unproject(av);
+                   });
+
+    parms.terrain->GetHeights({locations, chunk.size()}, heights, false);
+
+    for (const auto h : std::span{heights, chunk.size()}) {
+      if (h.IsWater())
+        /* water: assume 0m MSL */
+        parms.terrain_counter++;
+      else if (!h.IsInvalid()) {
+        parms.terrain_counter++;
+        parms.terrain_base += h.GetValue();
+      }
     }
   }
 
@@ -0,0 +1,116 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Point.hpp"
+
+#include <cassert>
+#include <span>
+#include <vector>
+
+/**
+ * A copy of a #Trace in chronological order, stored as one array
+ * per attribute ("structure of arrays").  Solvers which look at one
+ * or two attributes of many points can scan these arrays linearly
+ * instead of following the pointers of the #Trace nodes.
+ *
+ * Use Trace::GetPoints() to fill it and Trace::SyncPoints() to append
+ * new points; after the #Trace has been thinned (see
+ * Trace::GetModifySerial()), it must be filled again.
+ */
+class TraceColumns {
+  using Time = TracePoint::Time;
+
+  std::vector<Time> times;
+  std::vector<GeoPoint> locations;
+  std::vector<FlatGeoPoint> flat_locations;
+  std::vector<RoughAltitude> altitudes;
+  std::vector<RoughVSpeed> varios;
+
+public:
+  std::size_t size() const noexcept {
+    return times.size();
+  }
+
+  bool empty() const noexcept {
+    return times.empty();
+  }
+
+  void clear() noexcept {
+    times.clear();
+    locations.clear();
+    flat_locations.clear();
+    altitudes.clear();
+    varios.clear();
+  }
+
+  void reserve(std::size_t n) noexcept {
+    times.reserve(n);
+    locations.reserve(n);
+    flat_locations.reserve(n);
+    altitudes.reserve(n);
+    varios.reserve(n);
+  }
+
+  /**
+   * @param point a point which has been projected already
+   */
+  void push_back(const TracePoint &point) noexcept {
+    times.push_back(point.GetTime());
+    locations.push_back(point.GetLocation());
+    flat_locations.push_back(point.GetFlatLocation());
+    altitudes.push_back(point.GetAltitude());
+    varios.push_back(point.GetVario());
+  }
+
+  std::span<const Time> GetTimes() const noexcept {
+    return times;
+  }
+
+  std::span<const GeoPoint> GetLocations() const noexcept {
+    return locations;
+  }
+
+  std::span<const FlatGeoPoint> GetFlatLocations() const noexcept {
+    return flat_locations;
+  }
+
+  std::span<const RoughAltitude> GetAltitudes() const noexcept {
+    return altitudes;
+  }
+
+  std::span<const RoughVSpeed> GetVarios() const noexcept {
+    return varios;
+  }
+
+  Time GetTime(std::size_t i) const noexcept {
+    assert(i < size());
+
+    return times[i];
+  }
+
+  const GeoPoint &GetLocation(std::size_t i) const noexcept {
+    assert(i < size());
+
+    return locations[i];
+  }
+
+  FlatGeoPoint GetFlatLocation(std::size_t i) const noexcept {
+    assert(i < size());
+
+    return flat_locations[i];
+  }
+
+  int GetIntegerAltitude(std::size_t i) const noexcept {
+    assert(i < size());
+
+    return (int)altitudes[i];
+  }
+
+  double GetVario(std::size_t i) const noexcept {
+    assert(i < size());
+
+    return varios[i];
+  }
+};
@@ -3,6 +3,7 @@
 
 #include "Trace.hpp"
 #include "Vector.hpp"
+#include "Columns.hpp"
 #include "util/GlobalSliceAllocator.hxx"
 
 #include <algorithm>
@@ -411,6 +412,32 @@ Trace::SyncPoints(TracePointerVector &v) const noexcept
   return true;
 }
 
+void
+Trace::GetPoints(TraceColumns &v) const noexcept
+{
+  v.clear();
+  v.reserve(size());
+  for (const auto &i : *this)
+    v.push_back(i);
+}
+
+bool
+Trace::SyncPoints(TraceColumns &v) const noexcept
+{
+  assert(v.size() <= size());
+
+  if (v.size() == size())
+    /* no news */
+    return false;
+
+  v.reserve(size());
+  for (auto i = std::prev(end(), size() - v.size()); i != end(); ++i)
+    v.push_back(*i);
+
+  assert(v.size() == size());
+  return true;
+}
+
 void
 Trace::GetPoints(TracePointVector &v, const Time min_time,
                  const GeoPoint &location,
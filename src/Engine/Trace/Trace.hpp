@@ -20,6 +20,7 @@
 
 class TracePointVector;
 class TracePointerVector;
+class TraceColumns;
 
 /**
  * This class uses a smart thinning algorithm to limit the number of items
@@ -385,6 +386,21 @@ public:
    */
   bool SyncPoints(TracePointerVector &v) const noexcept;
 
+  /**
+   * Retrieve all trace points (sorted by time) as a #TraceColumns
+   * object.
+   */
+  void GetPoints(TraceColumns &v) const noexcept;
+
+  /**
+   * Update the given #TraceColumns after points were appended to this
+   * object.  This must not be called after thinning has occurred,
+   * see GetModifySerial().
+   *
+   * @return true if new points were added
+   */
+  bool SyncPoints(TraceColumns &v) const noexcept;
+
   /**
    * Fill the vector with trace points, not before #min_time, minimum
    * resolution #min_distance.
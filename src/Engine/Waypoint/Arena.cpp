@@ -0,0 +1,60 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Arena.hpp"
+#include "Waypoint.hpp"
+
+#include <new>
+
+/**
+ * The number of waypoints per chunk.  With the current size of
+ * #Waypoint, one chunk is roughly 64 kB.
+ */
+static constexpr std::size_t CHUNK_SIZE = 256;
+
+class WaypointArena::Chunk {
+  /**
+   * The number of constructed elements in #storage.
+   */
+  std::size_t n = 0;
+
+  alignas(Waypoint) std::byte storage[CHUNK_SIZE * sizeof(Waypoint)];
+
+  Waypoint *GetData() noexcept {
+    return std::launder(reinterpret_cast<Waypoint *>(storage));
+  }
+
+public:
+  /* user-provided, so std::make_shared() does not zero #storage */
+  Chunk() noexcept {}
+
+  ~Chunk() noexcept {
+    std::destroy_n(GetData(), n);
+  }
+
+  Chunk(const Chunk &) = delete;
+  Chunk &operator=(const Chunk &) = delete;
+
+  bool IsFull() const noexcept {
+    return n == CHUNK_SIZE;
+  }
+
+  Waypoint &Add(Waypoint &&wp) noexcept {
+    return *new(storage + n++ * sizeof(Waypoint)) Waypoint(std::move(wp));
+  }
+};
+
+WaypointArena::WaypointArena() noexcept = default;
+WaypointArena::~WaypointArena() noexcept = default;
+
+WaypointPtr
+WaypointArena::Add(Waypoint &&wp) noexcept
+{
+  if (!current || current->IsFull())
+    /* the previous chunk stays alive as long as there are
+       references to its waypoints */
+    current = std::make_shared<Chunk>();
+
+  Waypoint &w = current->Add(std::move(wp));
+  return WaypointPtr(current, &w);
+}
@@ -0,0 +1,51 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Ptr.hpp"
+
+#include <cstddef>
+#include <memory>
+
+/**
+ * Allocates #Waypoint objects in large contiguous chunks instead of
+ * one heap allocation per object.  This reduces heap fragmentation
+ * and improves cache locality when walking over many waypoints
+ * (e.g. Waypoints::VisitWithinRange()).
+ *
+ * The returned #WaypointPtr instances share ownership of the whole
+ * chunk (via the aliasing constructor of std::shared_ptr), so they
+ * remain valid even after Clear() or after the arena has been
+ * destructed.  A chunk is freed only after the last #WaypointPtr
+ * pointing into it has been released; the memory of erased
+ * waypoints is therefore not reused.
+ */
+class WaypointArena {
+  class Chunk;
+
+  /**
+   * The chunk which new waypoints are added to.
+   */
+  std::shared_ptr<Chunk> current;
+
+public:
+  WaypointArena() noexcept;
+  ~WaypointArena() noexcept;
+
+  WaypointArena(const WaypointArena &) = delete;
+  WaypointArena &operator=(const WaypointArena &) = delete;
+
+  /**
+   * Move the given #Waypoint into the arena.
+   */
+  WaypointPtr Add(Waypoint &&wp) noexcept;
+
+  /**
+   * Stop adding to the current chunk.  Existing #WaypointPtr
+   * instances remain valid.
+   */
+  void Clear() noexcept {
+    current.reset();
+  }
+};
@@ -250,6 +250,7 @@ Waypoints::Clear() noexcept
   home = nullptr;
   name_tree.Clear();
   waypoint_tree.clear();
+  arena.Clear();
   next_id = 1;
 }
 
@@ -305,7 +306,7 @@ Waypoints::Replace(const WaypointPtr &orig, Waypoint &&replacement) noexcept
       ScheduleOptimise();
   }
 
-  WaypointPtr new_ptr(new Waypoint(std::move(replacement)));
+  WaypointPtr new_ptr = arena.Add(std::move(replacement));
   name_tree.Add(new_ptr);
 
   auto f = waypoint_tree.FindNearestIf(waypoint_tree.GetPosition(orig), 0,
@@ -5,6 +5,7 @@
 
 #include "Ptr.hpp"
 #include "Waypoint.hpp"
+#include "Arena.hpp"
 #include "Geo/Flat/TaskProjection.hpp"
 #include "util/RadixTree.hpp"
 #include "util/QuadTree.hxx"
@@ -60,6 +61,11 @@ class Waypoints {
 
   unsigned next_id = 1;
 
+  /**
+   * Storage for waypoints added with Append(Waypoint &&).
+   */
+  WaypointArena arena;
+
   WaypointTree waypoint_tree;
   WaypointNameTree name_tree;
   TaskProjection task_projection;
@@ -102,7 +108,7 @@ public:
    * @param wp Waypoint to add to internal store
    */
   WaypointPtr Append(Waypoint &&wp) noexcept {
-    WaypointPtr ptr(new Waypoint(std::move(wp)));
+    WaypointPtr ptr = arena.Add(std::move(wp));
     Append(ptr);
     return ptr;
   }
@@ -4,8 +4,34 @@
 #include "FlarmNetDatabase.hpp"
 #include "util/StringAPI.hxx"
 
+#include <algorithm>
 #include <cassert>
 
+/**
+ * Compares two records by callsign, and records with the same
+ * callsign by their position in the array (which is the order of
+ * insertion).
+ */
+struct FlarmNetCallSignLess {
+  const std::vector<FlarmNetRecord> &records;
+
+  [[gnu::pure]]
+  bool operator()(uint32_t a, uint32_t b) const noexcept {
+    const int cmp = StringCompare(records[a].callsign, records[b].callsign);
+    return cmp != 0 ? cmp < 0 : a < b;
+  }
+
+  [[gnu::pure]]
+  bool operator()(uint32_t a, const TCHAR *b) const noexcept {
+    return StringCompare(records[a].callsign, b) < 0;
+  }
+
+  [[gnu::pure]]
+  bool operator()(const TCHAR *a, uint32_t b) const noexcept {
+    return StringCompare(a, records[b].callsign) < 0;
+  }
+};
+
 void
 FlarmNetDatabase::Insert(const FlarmNetRecord &record) noexcept
 {
@@ -14,50 +40,135 @@ FlarmNetDatabase::Insert(const FlarmNetRecord &record) noexcept
     /* ignore malformed records */
     return;
 
-  map.insert(std::make_pair(id, record));
+  const auto i = std::lower_bound(by_id.begin(), by_id.end(), id,
+                                  [](const IdEntry &e, FlarmId _id){
+                                    return e.id < _id;
+                                  });
+  if (i != by_id.end() && i->id == id)
+    /* already exists */
+    return;
+
+  const uint32_t index = records.size();
+  records.push_back(record);
+  by_id.insert(i, {id, index});
+
+  const FlarmNetCallSignLess less{records};
+  by_callsign.insert(std::upper_bound(by_callsign.begin(), by_callsign.end(),
+                                      index, less),
+                     index);
 }
 
-const FlarmNetRecord *
-FlarmNetDatabase::FindFirstRecordByCallSign(const TCHAR *cn) const noexcept
+void
+FlarmNetDatabase::Insert(std::vector<FlarmNetRecord> &&src) noexcept
 {
-  for (const auto &[id, record] : map) {
-    assert(id.IsDefined());
+  std::vector<IdEntry> new_ids;
+  new_ids.reserve(src.size());
+
+  for (std::size_t i = 0; i < src.size(); ++i) {
+    FlarmId id = src[i].GetId();
+    if (id.IsDefined())
+      new_ids.push_back({id, uint32_t(i)});
+    /* else: ignore malformed records */
+  }
 
-    if (StringIsEqual(record.callsign, cn))
-      return &record;
+  const auto id_less = [](const IdEntry &a, const IdEntry &b){
+    return a.id < b.id;
+  };
+
+  /* stable: the first of several records with the same id wins */
+  std::stable_sort(new_ids.begin(), new_ids.end(), id_less);
+  new_ids.erase(std::unique(new_ids.begin(), new_ids.end(),
+                            [](const IdEntry &a, const IdEntry &b){
+                              return a.id == b.id;
+                            }),
+                new_ids.end());
+
+  if (!by_id.empty())
+    std::erase_if(new_ids, [this](const IdEntry &e){
+      return FindRecordById(e.id) != nullptr;
+    });
+
+  records.reserve(records.size() + new_ids.size());
+  for (auto &e : new_ids) {
+    records.push_back(std::move(src[e.record]));
+    e.record = records.size() - 1;
   }
 
-  return NULL;
+  const std::size_t old_size = by_id.size();
+  by_id.insert(by_id.end(), new_ids.begin(), new_ids.end());
+  std::inplace_merge(by_id.begin(), by_id.begin() + old_size, by_id.end(),
+                     id_less);
+
+  SortCallSigns();
+}
+
+void
+FlarmNetDatabase::SortCallSigns() noexcept
+{
+  by_callsign.resize(records.size());
+  for (std::size_t i = 0; i < by_callsign.size(); ++i)
+    by_callsign[i] = i;
+
+  std::sort(by_callsign.begin(), by_callsign.end(),
+            FlarmNetCallSignLess{records});
+}
+
+const FlarmNetRecord *
+FlarmNetDatabase::FindRecordById(FlarmId id) const noexcept
+{
+  const auto i = std::lower_bound(by_id.begin(), by_id.end(), id,
+                                  [](const IdEntry &e, FlarmId _id){
+                                    return e.id < _id;
+                                  });
+  return i != by_id.end() && i->id == id
+    ? &records[i->record]
+    : nullptr;
+}
+
+std::pair<std::vector<uint32_t>::const_iterator,
+          std::vector<uint32_t>::const_iterator>
+FlarmNetDatabase::FindCallSign(const TCHAR *cn) const noexcept
+{
+  assert(cn != nullptr);
+
+  return std::equal_range(by_callsign.begin(), by_callsign.end(), cn,
+                          FlarmNetCallSignLess{records});
+}
+
+const FlarmNetRecord *
+FlarmNetDatabase::FindFirstRecordByCallSign(const TCHAR *cn) const noexcept
+{
+  const auto [begin, end] = FindCallSign(cn);
+  return begin != end
+    ? &records[*begin]
+    : nullptr;
 }
 
 unsigned
 FlarmNetDatabase::FindRecordsByCallSign(const TCHAR *cn,
                                         const FlarmNetRecord *array[],
-                                        [[maybe_unused]] unsigned size) const noexcept
+                                        unsigned size) const noexcept
 {
   unsigned count = 0;
 
-  for (const auto &[id, record] : map) {
-    assert(id.IsDefined());
-
-    if (StringIsEqual(record.callsign, cn))
-      array[count++] = &record;
-  }
+  const auto [begin, end] = FindCallSign(cn);
+  for (auto i = begin; i != end && count < size; ++i)
+    array[count++] = &records[*i];
 
   return count;
 }
 
 unsigned
 FlarmNetDatabase::FindIdsByCallSign(const TCHAR *cn, FlarmId array[],
-                                    [[maybe_unused]] unsigned size) const noexcept
+                                    unsigned size) const noexcept
 {
   unsigned count = 0;
 
-  for (const auto &[id, record] : map) {
+  const auto [begin, end] = FindCallSign(cn);
+  for (auto i = begin; i != end && count < size; ++i) {
+    const FlarmId id = records[*i].GetId();
     assert(id.IsDefined());
-
-    if (StringIsEqual(record.callsign, cn))
-      array[count++] = id;
+    array[count++] = id;
   }
 
   return count;
@@ -6,39 +6,72 @@
 #include "Id.hpp"
 #include "FlarmNetRecord.hpp"
 
-#include <map>
+#include <cstdint>
+#include <vector>
 #include <tchar.h>
 
 /**
  * An in-memory representation of the FlarmNet.org database.
+ *
+ * The records are stored in a flat array.  Two sorted index arrays
+ * refer to them: one by FLARM id and one by callsign, both of which
+ * are searched with a binary search.
  */
 class FlarmNetDatabase {
-  typedef std::map<FlarmId, FlarmNetRecord> RecordMap;
-  RecordMap map;
+  struct IdEntry {
+    FlarmId id;
+
+    /**
+     * Index into #records.
+     */
+    uint32_t record;
+  };
+
+  std::vector<FlarmNetRecord> records;
+
+  /**
+   * Sorted by #IdEntry::id; each id occurs only once.
+   */
+  std::vector<IdEntry> by_id;
+
+  /**
+   * Indices into #records, sorted by callsign.
+   */
+  std::vector<uint32_t> by_callsign;
 
 public:
   bool IsEmpty() const noexcept {
-    return map.empty();
+    return records.empty();
   }
 
   void Clear() noexcept {
-    map.clear();
+    records.clear();
+    by_id.clear();
+    by_callsign.clear();
   }
 
+  /**
+   * Add one record.  Records with a malformed id or with an id which
+   * already exists are ignored.
+   *
+   * This invalidates all pointers returned by this object.
+   */
   void Insert(const FlarmNetRecord &record) noexcept;
 
+  /**
+   * Add many records at once.  This is much faster than calling
+   * Insert() for each of them, because the indexes are sorted only
+   * once.  If an id occurs more than once, the first record wins.
+   */
+  void Insert(std::vector<FlarmNetRecord> &&src) noexcept;
+
   /**
    * Finds a FLARMNetRecord object based on the given FLARM id
    * @param id FLARM id
    * @return FLARMNetRecord object
    */
   [[gnu::pure]]
-  const FlarmNetRecord *FindRecordById(FlarmId id) const noexcept {
-    auto i = map.find(id);
-    return i != map.end()
-      ? &i->second
-      : NULL;
-  }
+  const FlarmNetRecord *FindRecordById(FlarmId id) const noexcept;
 
   /**
    * Finds a FLARMNetRecord object based on the given Callsign
@@ -56,11 +89,22 @@ public:
 
   [[gnu::pure]]
   auto begin() const noexcept {
-    return map.begin();
+    return records.begin();
   }
 
   [[gnu::pure]]
   auto end() const noexcept {
-    return map.end();
+    return records.end();
   }
+
+private:
+  /**
+   * Returns the range of #by_callsign with the given callsign.
+   */
+  [[gnu::pure]]
+  std::pair<std::vector<uint32_t>::const_iterator,
+            std::vector<uint32_t>::const_iterator>
+  FindCallSign(const TCHAR *cn) const noexcept;
+
+  void SortCallSigns() noexcept;
 };
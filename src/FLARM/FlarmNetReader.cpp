@@ -13,9 +13,44 @@
 #include "util/UTF8.hpp"
 #endif
 
+#include <vector>
+
 #include <stdio.h>
 #include <stdlib.h>
 
+[[gnu::const]]
+static constexpr int
+ParseHexDigit(char ch) noexcept
+{
+  if (ch >= '0' && ch <= '9')
+    return ch - '0';
+  else if (ch >= 'a' && ch <= 'f')
+    return ch - 'a' + 10;
+  else if (ch >= 'A' && ch <= 'F')
+    return ch - 'A' + 10;
+  else
+    return -1;
+}
+
+/**
+ * Parse two hexadecimal digits.  Like strtoul(), this stops at the
+ * first invalid character.
+ */
+[[gnu::const]]
+static constexpr unsigned char
+ParseHexByte(char a, char b) noexcept
+{
+  const int high = ParseHexDigit(a);
+  if (high < 0)
+    return 0;
+
+  const int low = ParseHexDigit(b);
+  if (low < 0)
+    return high;
+
+  return high * 16 + low;
+}
+
 /**
  * Decodes the FlarmNet.org file and puts the wanted
  * characters into the res pointer
@@ -34,16 +69,11 @@ LoadString(const char *bytes, size_t length, TCHAR *res, [[maybe_unused]] size_t
 
   TCHAR *p = res;
 
-  char tmp[3];
-  tmp[2] = 0;
-
   while (bytes < end) {
-    tmp[0] = *bytes++;
-    tmp[1] = *bytes++;
-
     /* FLARMNet files are ISO-Latin-1, which is kind of short-sighted */
 
-    const unsigned char ch = (unsigned char)strtoul(tmp, NULL, 16);
+    const unsigned char ch = ParseHexByte(bytes[0], bytes[1]);
+    bytes += 2;
 #ifdef _UNICODE
     /* Latin-1 can be converted to WIN32 wchar_t by casting */
     *p++ = ch;
@@ -110,15 +140,17 @@ FlarmNetReader::LoadFile(NLineReader &reader, FlarmNetDatabase &database)
   if (line == NULL)
     return 0;
 
-  int itemCount = 0;
+  /* collect all records first and let the database sort its indexes
+     only once */
+  std::vector<FlarmNetRecord> records;
   while ((line = reader.ReadLine()) != NULL) {
-    FlarmNetRecord record;
-    if (LoadRecord(record, line)) {
-      database.Insert(record);
-      itemCount++;
-    }
+    FlarmNetRecord &record = records.emplace_back();
+    if (!LoadRecord(record, line))
+      records.pop_back();
   }
 
+  const unsigned itemCount = records.size();
+  database.Insert(std::move(records));
   return itemCount;
 }
 
@@ -82,6 +82,29 @@ PolygonInterior(const GeoPoint &P,
   return wn != 0;
 }
 
+bool
+PolygonInterior(const GeoPoint &P,
+                SearchPointVector::const_iterator begin,
+                std::span<const unsigned> edges)
+{
+  int    wn = 0;    // the winding number counter
+
+  for (const unsigned edge : edges) {
+    const auto i = std::next(begin, edge), next = std::next(i);
+
+    // same as above
+    if (i->GetLocation().latitude <= P.latitude) {
+      if (next->GetLocation().latitude > P.latitude)
+        if (isLeft(i->GetLocation(), next->GetLocation(), P) > 0)
+          ++wn;
+    } else {
+      if (next->GetLocation().latitude <= P.latitude)
+        if (isLeft(i->GetLocation(), next->GetLocation(), P) < 0)
+          --wn;
+    }
+  }
+  return wn != 0;
+}
 
 bool
 PolygonInterior(const FlatGeoPoint &P,
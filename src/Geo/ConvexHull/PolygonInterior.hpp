@@ -5,6 +5,8 @@
 
 #include "Geo/SearchPointVector.hpp"
 
+#include <span>
+
 struct GeoPoint;
 struct FlatGeoPoint;
 class SearchPoint;
@@ -24,3 +26,15 @@ bool
 PolygonInterior(const FlatGeoPoint &p,
                 SearchPointVector::const_iterator begin,
                 SearchPointVector::const_iterator end);
+
+/**
+ * Like PolygonInterior(), but check only the given edges; each edge
+ * is specified by the index of its start point.  The caller (e.g. an
+ * edge index) must ensure that all edges which cross the parallel
+ * through #p are included.
+ */
+[[gnu::pure]]
+bool
+PolygonInterior(const GeoPoint &p,
+                SearchPointVector::const_iterator begin,
+                std::span<const unsigned> edges);
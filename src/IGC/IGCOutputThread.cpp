@@ -0,0 +1,241 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "IGCOutputThread.hpp"
+#include "io/BufferedOutputStream.hxx"
+#include "util/SpanCast.hxx"
+
+#include <algorithm>
+#include <utility>
+
+#include <string.h>
+
+static constexpr auto WRITE_INTERVAL = std::chrono::seconds(1);
+
+IGCOutputThread::IGCOutputThread(Sink &_sink,
+                                 std::chrono::steady_clock::duration _sync_interval)
+  :Thread("IGCWriter"),
+   sink(_sink), sync_interval(_sync_interval),
+   next_sync(std::chrono::steady_clock::now() + _sync_interval)
+{
+  grecord.Initialize();
+
+  Start();
+}
+
+IGCOutputThread::~IGCOutputThread() noexcept
+{
+  try {
+    Flush();
+  } catch (...) {
+    /* nobody left to report this to */
+  }
+
+  {
+    const std::scoped_lock lock{mutex};
+    quit = true;
+    cond.notify_one();
+  }
+
+  Join();
+}
+
+inline void
+IGCOutputThread::CheckError()
+{
+  if (failed.load(std::memory_order_acquire)) {
+    const std::scoped_lock lock{mutex};
+    std::rethrow_exception(error);
+  }
+}
+
+std::size_t
+IGCOutputThread::Push(std::string_view src) noexcept
+{
+  const std::size_t h = head.load(std::memory_order_relaxed);
+  const std::size_t t = tail.load(std::memory_order_acquire);
+
+  const std::size_t n = std::min(src.size(), RING_SIZE - (h - t));
+  const std::size_t offset = h % RING_SIZE;
+  const std::size_t first = std::min(n, RING_SIZE - offset);
+
+  memcpy(ring.data() + offset, src.data(), first);
+  memcpy(ring.data(), src.data() + first, n - first);
+
+  head.store(h + n, std::memory_order_release);
+  return n;
+}
+
+inline void
+IGCOutputThread::MoveOverflow() noexcept
+{
+  overflow.erase(0, Push(overflow));
+}
+
+void
+IGCOutputThread::Append(std::string_view line)
+{
+  CheckError();
+
+  if (!overflow.empty())
+    MoveOverflow();
+
+  const std::size_t n = overflow.empty() ? Push(line) : 0;
+  if (n < line.size()) {
+    overflow.append(line.substr(n));
+    overflow.push_back('\n');
+  } else if (Push("\n") == 0)
+    overflow.push_back('\n');
+
+  /* don't wait for the next timer tick if the ring buffer is getting
+     full */
+  if (head.load(std::memory_order_relaxed) -
+      tail.load(std::memory_order_relaxed) >= RING_SIZE / 2)
+    cond.notify_one();
+}
+
+void
+IGCOutputThread::Barrier(bool sign)
+{
+  std::unique_lock lock{mutex};
+
+  while (true) {
+    if (error)
+      std::rethrow_exception(error);
+
+    MoveOverflow();
+
+    /* if the overflow buffer doesn't fit into the ring buffer at
+       once, this takes several rounds */
+    const bool last = overflow.empty();
+    if (last && sign)
+      sign_requested = true;
+
+    const unsigned serial = ++request_serial;
+    cond.notify_one();
+    done_cond.wait(lock, [this, serial]{
+      return done_serial == serial || error;
+    });
+
+    if (error)
+      std::rethrow_exception(error);
+
+    if (last)
+      break;
+  }
+}
+
+inline void
+IGCOutputThread::Feed(std::string_view src) noexcept
+{
+  while (!src.empty()) {
+    const auto newline = src.find('\n');
+    if (newline == src.npos) {
+      partial_line.append(src);
+      break;
+    }
+
+    if (partial_line.empty()) {
+      grecord.AppendRecordToBuffer(src.substr(0, newline));
+    } else {
+      partial_line.append(src.substr(0, newline));
+      grecord.AppendRecordToBuffer(partial_line);
+      partial_line.clear();
+    }
+
+    src = src.substr(newline + 1);
+  }
+}
+
+void
+IGCOutputThread::WriteRing()
+{
+  const std::size_t t = tail.load(std::memory_order_relaxed);
+  const std::size_t h = head.load(std::memory_order_acquire);
+  if (h == t)
+    return;
+
+  const std::size_t n = h - t;
+  const std::size_t offset = t % RING_SIZE;
+  const std::size_t first = std::min(n, RING_SIZE - offset);
+
+  const std::string_view a{ring.data() + offset, first};
+  const std::string_view b{ring.data(), n - first};
+
+  sink.Write(AsBytes(a));
+  if (!b.empty())
+    sink.Write(AsBytes(b));
+
+  Feed(a);
+  Feed(b);
+
+  tail.store(h, std::memory_order_release);
+  dirty = true;
+}
+
+void
+IGCOutputThread::WriteGRecord()
+{
+  grecord.FinalizeBuffer();
+
+  BufferedOutputStream buffered(sink);
+  grecord.WriteTo(buffered);
+  buffered.Flush();
+  dirty = true;
+}
+
+void
+IGCOutputThread::Sync()
+{
+  if (!dirty)
+    return;
+
+  sink.Sync();
+  dirty = false;
+  next_sync = std::chrono::steady_clock::now() + sync_interval;
+}
+
+void
+IGCOutputThread::Run() noexcept
+{
+  std::unique_lock lock{mutex};
+
+  while (true) {
+    if (!quit && request_serial == done_serial && !sign_requested)
+      cond.wait_for(lock, WRITE_INTERVAL);
+
+    const bool do_quit = quit;
+    const unsigned serial = request_serial;
+    const bool do_sync = serial != done_serial || do_quit;
+    const bool do_sign = std::exchange(sign_requested, false);
+
+    lock.unlock();
+
+    try {
+      WriteRing();
+
+      if (do_sign)
+        WriteGRecord();
+
+      if (do_sync || std::chrono::steady_clock::now() >= next_sync)
+        Sync();
+    } catch (...) {
+      lock.lock();
+      error = std::current_exception();
+      failed.store(true, std::memory_order_release);
+      done_cond.notify_all();
+
+      /* the producer will see the error and stop; wait for the
+         destructor */
+      cond.wait(lock, [this]{ return quit; });
+      return;
+    }
+
+    lock.lock();
+    done_serial = serial;
+    done_cond.notify_all();
+
+    if (do_quit)
+      break;
+  }
+}
@@ -0,0 +1,206 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Logger/GRecord.hpp"
+#include "thread/Thread.hpp"
+#include "thread/Mutex.hxx"
+#include "thread/Cond.hxx"
+#include "io/OutputStream.hxx"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <string>
+#include <string_view>
+
+/**
+ * Writes the lines of an IGC file on a separate thread, so the
+ * caller never waits for a (slow) SD card.
+ *
+ * The caller (the "producer") copies finished lines into a lock-free
+ * single-producer/single-consumer ring buffer.  If the ring buffer
+ * is full, lines are kept in a producer-side overflow buffer and
+ * moved to the ring buffer later; nothing is ever dropped and the
+ * producer never waits for the thread.
+ *
+ * The thread writes everything that has accumulated in the ring
+ * buffer once per second in one batch, updates the #GRecord digest
+ * with each line and calls Sink::Sync() every "sync interval", so a
+ * crash loses at most that much of the flight.
+ *
+ * I/O errors are reported by the next method call on the producer
+ * side.
+ */
+class IGCOutputThread final : Thread {
+public:
+  /**
+   * The destination of the IGC file.
+   */
+  class Sink : public OutputStream {
+  public:
+    /**
+     * Make all data written so far durable (i.e. fsync()).
+     *
+     * Throws on error.
+     */
+    virtual void Sync() = 0;
+  };
+
+  static constexpr std::chrono::steady_clock::duration DEFAULT_SYNC_INTERVAL =
+    std::chrono::seconds{10};
+
+private:
+  /**
+   * The size of the ring buffer; must be a power of two.  This holds
+   * several minutes of B records.
+   */
+  static constexpr std::size_t RING_SIZE = 32768;
+  static_assert((RING_SIZE & (RING_SIZE - 1)) == 0);
+
+  Sink &sink;
+
+  const std::chrono::steady_clock::duration sync_interval;
+
+  std::array<char, RING_SIZE> ring;
+
+  /**
+   * The total number of bytes written to / read from the ring
+   * buffer.  #head is modified only by the producer, #tail only by
+   * the thread.
+   */
+  std::atomic<std::size_t> head{0}, tail{0};
+
+  /**
+   * Data which did not fit into the ring buffer.  Only accessed by
+   * the producer.
+   */
+  std::string overflow;
+
+  Mutex mutex;
+
+  /**
+   * Wakes up the thread.
+   */
+  Cond cond;
+
+  /**
+   * Signalled by the thread after it has finished a request.
+   */
+  Cond done_cond;
+
+  /**
+   * Protected by #mutex.  The producer increments #request_serial to
+   * ask the thread to write and sync everything; the thread copies
+   * it to #done_serial when finished.
+   */
+  unsigned request_serial = 0, done_serial = 0;
+
+  /**
+   * Protected by #mutex.
+   */
+  bool sign_requested = false, quit = false;
+
+  /**
+   * The error which has stopped the thread.  Protected by #mutex.
+   */
+  std::exception_ptr error;
+
+  /**
+   * Set together with #error, can be checked without the mutex.
+   */
+  std::atomic_bool failed{false};
+
+  /* the following attributes are only accessed by the thread */
+
+  GRecord grecord;
+
+  /**
+   * The beginning of a line whose end has not yet arrived in the
+   * ring buffer.
+   */
+  std::string partial_line;
+
+  std::chrono::steady_clock::time_point next_sync;
+
+  /**
+   * Was data written since the last Sink::Sync() call?
+   */
+  bool dirty = false;
+
+public:
+  /**
+   * Start the thread.
+   *
+   * Throws on error.
+   *
+   * @param _sink the destination; must remain valid until this
+   * object is destructed
+   * @param _sync_interval the maximum time between two
+   * Sink::Sync() calls
+   */
+  explicit IGCOutputThread(Sink &_sink,
+                           std::chrono::steady_clock::duration _sync_interval=DEFAULT_SYNC_INTERVAL);
+
+  /**
+   * Write all pending lines (ignoring errors) and stop the thread.
+   */
+  ~IGCOutputThread() noexcept;
+
+  /**
+   * Append a line (without the line terminator) to the file.  This
+   * never blocks.
+   *
+   * Throws if the thread has failed.
+   */
+  void Append(std::string_view line);
+
+  /**
+   * Wait until all lines have been written and synced.
+   *
+   * Throws on error.
+   */
+  void Flush() {
+    Barrier(false);
+  }
+
+  /**
+   * Write all lines followed by the G record and wait until
+   * everything has been synced.  Append() must not be called after
+   * this.
+   *
+   * Throws on error.
+   */
+  void Sign() {
+    Barrier(true);
+  }
+
+private:
+  void CheckError();
+
+  /**
+   * Copy as much of the given data into the ring buffer as there is
+   * room for.
+   *
+   * @return the number of bytes copied
+   */
+  std::size_t Push(std::string_view src) noexcept;
+
+  void MoveOverflow() noexcept;
+
+  void Barrier(bool sign);
+
+  /**
+   * Write the contents of the ring buffer to the #sink.
+   */
+  void WriteRing();
+  void Feed(std::string_view src) noexcept;
+  void WriteGRecord();
+  void Sync();
+
+  /* virtual methods from Thread */
+  void Run() noexcept override;
+};
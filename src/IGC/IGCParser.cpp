@@ -12,6 +12,8 @@
 #include "util/StringAPI.hxx"
 #include "util/StringCompare.hxx"
 
+#include <algorithm>
+
 #include <stdlib.h>
 
 using std::string_view_literals::operator""sv;
@@ -208,6 +210,53 @@ ParseExtensionValueN(const char *p, const char *end, size_t n,
     value_r = value;
 }
 
+/**
+ * Apply the "I" record extensions to a "B" record.
+ *
+ * @param buffer the "B" record (null-termination is not necessary)
+ * @param line_length the length of the "B" record
+ */
+static void
+ParseExtensions(const char *buffer, std::size_t line_length,
+                const IGCExtensions &extensions, IGCFix &fix) noexcept
+{
+  fix.ClearExtensions();
+
+  for (auto i = extensions.begin(), end = extensions.end(); i != end; ++i) {
+    const IGCExtension &extension = *i;
+    assert(extension.start > 0);
+    assert(extension.finish >= extension.start);
+
+    if (extension.finish > line_length)
+      /* exceeds the input line length */
+      continue;
+
+    const char *start = buffer + extension.start - 1;
+    const char *finish = buffer + extension.finish;
+
+    if (StringIsEqual(extension.code, "ENL"))
+      ParseExtensionValue(start, finish, fix.enl);
+    else if (StringIsEqual(extension.code, "RPM"))
+      ParseExtensionValue(start, finish, fix.rpm);
+    else if (StringIsEqual(extension.code, "HDM"))
+      ParseExtensionValue(start, finish, fix.hdm);
+    else if (StringIsEqual(extension.code, "HDT"))
+      ParseExtensionValue(start, finish, fix.hdt);
+    else if (StringIsEqual(extension.code, "TRM"))
+      ParseExtensionValue(start, finish, fix.trm);
+    else if (StringIsEqual(extension.code, "TRT"))
+      ParseExtensionValue(start, finish, fix.trt);
+    else if (StringIsEqual(extension.code, "GSP"))
+      ParseExtensionValueN(start, finish, 3, fix.gsp);
+    else if (StringIsEqual(extension.code, "IAS"))
+      ParseExtensionValueN(start, finish, 3, fix.ias);
+    else if (StringIsEqual(extension.code, "TAS"))
+      ParseExtensionValueN(start, finish, 3, fix.tas);
+    else if (StringIsEqual(extension.code, "SIU"))
+      ParseExtensionValue(start, finish, fix.siu);
+  }
+}
+
 bool
 IGCParseFix(const char *buffer, const IGCExtensions &extensions, IGCFix &fix)
 {
@@ -240,46 +289,147 @@ IGCParseFix(const char *buffer, const IGCExtensions &extensions, IGCFix &fix)
 
   fix.time = time;
 
-  fix.ClearExtensions();
+  ParseExtensions(buffer, strlen(buffer), extensions, fix);
+  return true;
+}
 
-  const size_t line_length = strlen(buffer);
-  for (auto i = extensions.begin(), end = extensions.end(); i != end; ++i) {
-    const IGCExtension &extension = *i;
-    assert(extension.start > 0);
-    assert(extension.finish >= extension.start);
+static constexpr bool
+IsDigitsASCII(const char *p, std::size_t n) noexcept
+{
+  for (std::size_t i = 0; i < n; ++i)
+    if (!IsDigitASCII(p[i]))
+      return false;
 
-    if (extension.finish > line_length)
-      /* exceeds the input line length */
-      continue;
+  return true;
+}
 
-    const char *start = buffer + extension.start - 1;
-    const char *finish = buffer + extension.finish;
+/**
+ * Convert a string of digits which has already been checked with
+ * IsDigitsASCII().
+ */
+static constexpr unsigned
+ParseDigits(const char *p, std::size_t n) noexcept
+{
+  unsigned value = 0;
+  for (std::size_t i = 0; i < n; ++i)
+    value = value * 10 + unsigned(p[i] - '0');
+  return value;
+}
 
-    if (StringIsEqual(extension.code, "ENL"))
-      ParseExtensionValue(start, finish, fix.enl);
-    else if (StringIsEqual(extension.code, "RPM"))
-      ParseExtensionValue(start, finish, fix.rpm);
-    else if (StringIsEqual(extension.code, "HDM"))
-      ParseExtensionValue(start, finish, fix.hdm);
-    else if (StringIsEqual(extension.code, "HDT"))
-      ParseExtensionValue(start, finish, fix.hdt);
-    else if (StringIsEqual(extension.code, "TRM"))
-      ParseExtensionValue(start, finish, fix.trm);
-    else if (StringIsEqual(extension.code, "TRT"))
-      ParseExtensionValue(start, finish, fix.trt);
-    else if (StringIsEqual(extension.code, "GSP"))
-      ParseExtensionValueN(start, finish, 3, fix.gsp);
-    else if (StringIsEqual(extension.code, "IAS"))
-      ParseExtensionValueN(start, finish, 3, fix.ias);
-    else if (StringIsEqual(extension.code, "TAS"))
-      ParseExtensionValueN(start, finish, 3, fix.tas);
-    else if (StringIsEqual(extension.code, "SIU"))
-      ParseExtensionValue(start, finish, fix.siu);
+/**
+ * Parse a 5 column altitude field, which is either 5 digits or a
+ * minus sign followed by 4 digits.
+ */
+static constexpr bool
+ParseAltitudeField(const char *p, int &value_r) noexcept
+{
+  if (p[0] == '-') {
+    if (!IsDigitsASCII(p + 1, 4))
+      return false;
+
+    value_r = -int(ParseDigits(p + 1, 4));
+    return true;
   }
 
+  if (!IsDigitsASCII(p, 5))
+    return false;
+
+  value_r = ParseDigits(p, 5);
   return true;
 }
 
+/**
+ * Decode a well-formed "B" record from its fixed columns, without
+ * sscanf().
+ *
+ * @return 1 on success, 0 if the line is malformed and -1 if the
+ * line is unusual and needs to be parsed by the generic parser
+ */
+static int
+IGCFastParseFix(const char *p, std::size_t length,
+                const IGCExtensions &extensions, IGCFix &fix) noexcept
+{
+  /* BHHMMSSDDMMmmmNDDDMMmmmEVPPPPPGGGGG */
+  if (length < 35 ||
+      !IsDigitsASCII(p + 1, 6 + 7) || !IsDigitsASCII(p + 15, 8))
+    return -1;
+
+  int pressure_altitude, gps_altitude;
+  if (!ParseAltitudeField(p + 25, pressure_altitude) ||
+      !ParseAltitudeField(p + 30, gps_altitude))
+    return -1;
+
+  const BrokenTime time(ParseDigits(p + 1, 2), ParseDigits(p + 3, 2),
+                        ParseDigits(p + 5, 2));
+  if (!time.IsPlausible())
+    return 0;
+
+  const char valid_char = p[24];
+  if (valid_char == 'A')
+    fix.gps_valid = true;
+  else if (valid_char == 'V')
+    fix.gps_valid = false;
+  else
+    return 0;
+
+  const unsigned lat_degrees = ParseDigits(p + 7, 2);
+  const unsigned lat_minutes = ParseDigits(p + 9, 5);
+  const char lat_char = p[14];
+  const unsigned lon_degrees = ParseDigits(p + 15, 3);
+  const unsigned lon_minutes = ParseDigits(p + 18, 5);
+  const char lon_char = p[23];
+
+  if (lat_degrees >= 90 || lat_minutes >= 60000 ||
+      (lat_char != 'N' && lat_char != 'S'))
+    return 0;
+
+  if (lon_degrees >= 180 || lon_minutes >= 60000 ||
+      (lon_char != 'E' && lon_char != 'W'))
+    return 0;
+
+  fix.location.latitude = Angle::Degrees(lat_degrees +
+                                         lat_minutes / 60000.);
+  if (lat_char == 'S')
+    fix.location.latitude.Flip();
+
+  fix.location.longitude = Angle::Degrees(lon_degrees +
+                                          lon_minutes / 60000.);
+  if (lon_char == 'W')
+    fix.location.longitude.Flip();
+
+  fix.gps_altitude = gps_altitude;
+  fix.pressure_altitude = pressure_altitude;
+  fix.time = time;
+
+  ParseExtensions(p, length, extensions, fix);
+  return 1;
+}
+
+bool
+IGCParseFix(std::string_view line, const IGCExtensions &extensions,
+            IGCFix &fix) noexcept
+{
+  if (line.empty() || line.front() != 'B')
+    return false;
+
+  switch (IGCFastParseFix(line.data(), line.size(), extensions, fix)) {
+  case 1:
+    return true;
+
+  case 0:
+    return false;
+  }
+
+  /* fall back to the generic parser, which needs a null-terminated
+     copy; columns beyond the buffer size are ignored */
+  char buffer[256];
+  const std::size_t length = std::min(line.size(), sizeof(buffer) - 1);
+  std::copy_n(line.data(), length, buffer);
+  buffer[length] = 0;
+
+  return IGCParseFix(buffer, extensions, fix);
+}
+
 bool
 IGCParseLocation(const char *buffer, GeoPoint &location)
 {
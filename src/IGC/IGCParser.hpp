@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <string_view>
+
 struct IGCFix;
 struct IGCHeader;
 struct IGCExtensions;
@@ -52,6 +54,18 @@ IGCParseLocation(const char *buffer, GeoPoint &location);
 bool
 IGCParseFix(const char *buffer, const IGCExtensions &extensions, IGCFix &fix);
 
+/**
+ * Parse an IGC "B" record which does not need to be null-terminated.
+ * Well-formed records are decoded directly from their fixed columns,
+ * which is much faster than the generic parser; this is meant for
+ * bulk ingestion of many files.
+ *
+ * @return true on success, false if the line was not recognized
+ */
+bool
+IGCParseFix(std::string_view line, const IGCExtensions &extensions,
+            IGCFix &fix) noexcept;
+
 /**
  * Parse a time in IGC file format (HHMMSS).
  *
@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "IGCScanner.hpp"
+#include "IGCParser.hpp"
+#include "IGCFix.hpp"
+
+#include <algorithm>
+
+#include <string.h>
+
+using std::string_view_literals::operator""sv;
+
+/**
+ * Copy a line to a null-terminated buffer for the parsers which need
+ * one.  Overlong lines are truncated.
+ */
+template<std::size_t size>
+static const char *
+CopyLine(char (&buffer)[size], std::string_view line) noexcept
+{
+  const std::size_t length = std::min(line.size(), size - 1);
+  std::copy_n(line.data(), length, buffer);
+  buffer[length] = 0;
+  return buffer;
+}
+
+IGCScanner::IGCScanner(std::span<const std::byte> src) noexcept
+  :position((const char *)src.data()),
+   end(position + src.size())
+{
+  extensions.clear();
+}
+
+std::string_view
+IGCScanner::NextLine() noexcept
+{
+  const char *const start = position;
+  const char *newline = (const char *)
+    memchr(start, '\n', end - start);
+
+  const char *line_end;
+  if (newline != nullptr) {
+    line_end = newline;
+    position = newline + 1;
+  } else {
+    line_end = position = end;
+  }
+
+  if (line_end > start && line_end[-1] == '\r')
+    --line_end;
+
+  return {start, std::size_t(line_end - start)};
+}
+
+std::size_t
+IGCScanner::Read(std::span<IGCFix> dest) noexcept
+{
+  std::size_t n = 0;
+
+  while (n < dest.size() && position < end) {
+    const char *const line_start = position;
+    const std::string_view line = NextLine();
+    if (line.empty())
+      continue;
+
+    switch (line.front()) {
+    case 'B':
+      if (IGCParseFix(line, extensions, dest[n]))
+        ++n;
+      break;
+
+    case 'H':
+      if (line.starts_with("HFDTE"sv)) {
+        if (n > 0) {
+          /* return the fixes before the date change first */
+          position = line_start;
+          return n;
+        }
+
+        char buffer[64];
+        BrokenDate new_date;
+        if (IGCParseDateRecord(CopyLine(buffer, line), new_date))
+          date = new_date;
+      }
+
+      break;
+
+    case 'I':
+      {
+        char buffer[256];
+        IGCParseExtensions(CopyLine(buffer, line), extensions);
+      }
+
+      break;
+    }
+  }
+
+  return n;
+}
@@ -0,0 +1,67 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "IGCExtensions.hpp"
+#include "time/BrokenDate.hpp"
+
+#include <cstddef>
+#include <span>
+#include <string_view>
+
+struct IGCFix;
+
+/**
+ * Extracts "B" records from an IGC file which is completely in
+ * memory (e.g. mapped with #FileMapping).  Fixes are returned in
+ * chunks, and "I" records are applied to the following fixes.
+ *
+ * The input does not need to be null-terminated, and no line is
+ * copied unless it needs the generic (slow) parser.
+ */
+class IGCScanner {
+  const char *position;
+  const char *const end;
+
+  IGCExtensions extensions;
+
+  /**
+   * The most recent "HFDTE" record which has not yet been consumed
+   * by TakeDate().
+   */
+  BrokenDate date = BrokenDate::Invalid();
+
+public:
+  explicit IGCScanner(std::span<const std::byte> src) noexcept;
+
+  /**
+   * Fill the given buffer with the next fixes.  This stops early
+   * before a "HFDTE" record, so the caller can apply the new date
+   * (see TakeDate()) to the fixes which follow it.
+   *
+   * @return the number of fixes; 0 means the end of the file has
+   * been reached
+   */
+  std::size_t Read(std::span<IGCFix> dest) noexcept;
+
+  /**
+   * Has a new "HFDTE" record been parsed since the last call?  If
+   * yes, it is returned and cleared.
+   */
+  bool TakeDate(BrokenDate &date_r) noexcept {
+    if (!date.IsPlausible())
+      return false;
+
+    date_r = date;
+    date = BrokenDate::Invalid();
+    return true;
+  }
+
+private:
+  /**
+   * Return the next line (without the line terminator) and advance
+   * to the following one.
+   */
+  std::string_view NextLine() noexcept;
+};
@@ -7,29 +7,26 @@
 #include "NMEA/Info.hpp"
 #include "Version.hpp"
 #include "system/Path.hpp"
-#include "util/SpanCast.hxx"
 
 #include <cassert>
 
-IGCWriter::IGCWriter(Path path)
+IGCWriter::FileSink::FileSink(Path path)
   :file(path,
         /* we use CREATE_VISIBLE here so the user can recover partial
            IGC files after a crash/battery failure/etc. */
-        FileOutputStream::Mode::CREATE_VISIBLE),
-   buffered(file)
+        FileOutputStream::Mode::CREATE_VISIBLE) {}
+
+IGCWriter::IGCWriter(Path path,
+                     std::chrono::steady_clock::duration sync_interval)
+  :file(path), output(file, sync_interval)
 {
   fix.Clear();
-
-  grecord.Initialize();
 }
 
 void
 IGCWriter::CommitLine(std::string_view line)
 {
-  buffered.Write(AsBytes(line));
-  buffered.Write('\n');
-
-  grecord.AppendRecordToBuffer(line);
+  output.Append(line);
 }
 
 void
@@ -192,7 +189,6 @@ IGCWriter::LogPoint(const IGCFix &fix, int epe, int satellites)
           epe, satellites);
 
   WriteLine(b_record);
-  Flush();
 }
 
 void
@@ -256,10 +252,3 @@ IGCWriter::LogFRecord(const BrokenTime &time, const int *satellite_ids)
 
   WriteLine(f_record);
 }
-
-void
-IGCWriter::Sign()
-{
-  grecord.FinalizeBuffer();
-  grecord.WriteTo(buffered);
-}
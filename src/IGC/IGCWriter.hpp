@@ -3,12 +3,12 @@
 
 #pragma once
 
-#include "Logger/GRecord.hpp"
+#include "IGCOutputThread.hpp"
 #include "IGCFix.hpp"
 #include "io/FileOutputStream.hxx"
-#include "io/BufferedOutputStream.hxx"
 
 #include <array>
+#include <chrono>
 #include <string_view>
 
 #include <tchar.h>
@@ -19,11 +19,32 @@ struct BrokenDateTime;
 struct NMEAInfo;
 struct GeoPoint;
 
+/**
+ * Formats IGC records.  The file is written (and the G record
+ * calculated) by an #IGCOutputThread, so none of the methods waits
+ * for the SD card, except for Flush() and Sign().
+ */
 class IGCWriter {
-  FileOutputStream file;
-  BufferedOutputStream buffered;
+  class FileSink final : public IGCOutputThread::Sink {
+    FileOutputStream file;
 
-  GRecord grecord;
+  public:
+    explicit FileSink(Path path);
+
+    /* virtual methods from class OutputStream */
+    void Write(std::span<const std::byte> src) override {
+      file.Write(src);
+    }
+
+    /* virtual methods from class IGCOutputThread::Sink */
+    void Sync() override {
+      file.Sync();
+    }
+  };
+
+  FileSink file;
+
+  IGCOutputThread output;
 
   IGCFix fix;
 
@@ -32,14 +53,26 @@ class IGCWriter {
 public:
   /**
    * Throws on error.
+   *
+   * @param sync_interval the maximum time between two fsync() calls
    */
-  explicit IGCWriter(Path path);
+  explicit IGCWriter(Path path,
+                     std::chrono::steady_clock::duration sync_interval=IGCOutputThread::DEFAULT_SYNC_INTERVAL);
 
+  /**
+   * Wait until all records have been written to the file.
+   */
   void Flush() {
-    buffered.Flush();
+    output.Flush();
   }
 
-  void Sign();
+  /**
+   * Append the G record.  No other records may be written after
+   * this.
+   */
+  void Sign() {
+    output.Sign();
+  }
 
 private:
   /**
@@ -0,0 +1,264 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Parallel.hpp"
+#include "Operation/Operation.hpp"
+#include "thread/Thread.hpp"
+#include "util/StaticString.hxx"
+#include "util/StringAPI.hxx"
+#include "LogFile.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <exception>
+#include <list>
+#include <thread>
+
+using std::chrono::steady_clock;
+
+/**
+ * How often does the calling thread forward progress updates?
+ */
+static constexpr auto UPDATE_INTERVAL = std::chrono::milliseconds(200);
+
+/**
+ * The progress range passed to the caller's #OperationEnvironment.
+ */
+static constexpr unsigned PROGRESS_RANGE = 1024;
+
+class ParallelJobRunner::Item final
+  : public Thread, public OperationEnvironment {
+  ParallelJobRunner &runner;
+
+public:
+  const char *const name;
+
+  const Function function;
+
+  const std::vector<unsigned> depends;
+
+  /* the following fields are protected by ParallelJobRunner::mutex */
+
+  StaticString<128> text;
+
+  std::list<StaticString<256>> errors;
+
+  unsigned progress_range = 0, progress_position = 0;
+
+  bool finished = false;
+
+  /* the following fields may only be accessed by the calling thread
+     after #finished has been set */
+
+  steady_clock::duration duration{};
+
+  std::exception_ptr error;
+
+  Item(ParallelJobRunner &_runner, const char *_name,
+       Function &&_function, std::initializer_list<unsigned> _depends)
+    :Thread(_name), runner(_runner),
+     name(_name), function(std::move(_function)), depends(_depends)
+  {
+    text.clear();
+  }
+
+  /**
+   * How much of this job is done?  Caller must lock the mutex.
+   */
+  double GetFraction() const noexcept {
+    if (finished)
+      return 1;
+
+    if (progress_range == 0)
+      return 0;
+
+    return std::min(double(progress_position) / progress_range, 1.);
+  }
+
+private:
+  /* virtual methods from class Thread */
+  void Run() noexcept override {
+    runner.RunItem(*this);
+  }
+
+public:
+  /* virtual methods from class OperationEnvironment */
+  bool IsCancelled() const noexcept override {
+    return false;
+  }
+
+  void SetCancelHandler(std::function<void()>) noexcept override {}
+
+  void Sleep(steady_clock::duration _duration) noexcept override {
+    std::this_thread::sleep_for(_duration);
+  }
+
+  void SetErrorMessage(const TCHAR *_text) noexcept override {
+    const std::scoped_lock lock{runner.mutex};
+    errors.emplace_back(_text);
+  }
+
+  void SetText(const TCHAR *_text) noexcept override {
+    const std::scoped_lock lock{runner.mutex};
+    text = _text;
+  }
+
+  void SetProgressRange(unsigned range) noexcept override {
+    const std::scoped_lock lock{runner.mutex};
+    progress_range = range;
+  }
+
+  void SetProgressPosition(unsigned position) noexcept override {
+    const std::scoped_lock lock{runner.mutex};
+    progress_position = position;
+  }
+};
+
+ParallelJobRunner::ParallelJobRunner() noexcept = default;
+ParallelJobRunner::~ParallelJobRunner() noexcept = default;
+
+unsigned
+ParallelJobRunner::Add(const char *name, Function function,
+                       std::initializer_list<unsigned> depends)
+{
+  const unsigned index = items.size();
+  assert(std::all_of(depends.begin(), depends.end(),
+                     [index](unsigned i){ return i < index; }));
+
+  items.emplace_back(std::make_unique<Item>(*this, name,
+                                            std::move(function),
+                                            depends));
+  return index;
+}
+
+inline bool
+ParallelJobRunner::IsFinished(unsigned i) const noexcept
+{
+  return items[i]->finished;
+}
+
+void
+ParallelJobRunner::RunItem(Item &item) noexcept
+{
+  {
+    std::unique_lock lock{mutex};
+    cond.wait(lock, [this, &item]{
+      return std::all_of(item.depends.begin(), item.depends.end(),
+                         [this](unsigned i){ return IsFinished(i); });
+    });
+  }
+
+  const auto start = steady_clock::now();
+
+  try {
+    item.function(item);
+  } catch (...) {
+    item.error = std::current_exception();
+  }
+
+  item.duration = steady_clock::now() - start;
+
+  const std::scoped_lock lock{mutex};
+  item.finished = true;
+  cond.notify_all();
+}
+
+void
+ParallelJobRunner::Run(OperationEnvironment &env)
+{
+  const auto start = steady_clock::now();
+
+  std::vector<Item *> threads;
+  threads.reserve(items.size());
+
+  for (auto &item : items) {
+    try {
+      item->Start();
+      threads.push_back(item.get());
+    } catch (...) {
+      /* out of resources: run it in this thread; its dependencies
+         have been started already */
+      LogError(std::current_exception());
+      RunItem(*item);
+    }
+  }
+
+  env.SetProgressRange(PROGRESS_RANGE);
+
+  StaticString<128> text;
+  text.clear();
+
+  /* error messages are reported only after all jobs have finished,
+     because the #OperationEnvironment may show a modal dialog which
+     runs the event loop, and the event handlers may access the data
+     which is still being loaded */
+  std::list<StaticString<256>> errors;
+
+  std::unique_lock lock{mutex};
+
+  while (true) {
+    double fraction = 0;
+    const TCHAR *first_text = nullptr;
+    bool all_finished = true;
+
+    for (auto &item : items) {
+      fraction += item->GetFraction();
+      errors.splice(errors.end(), item->errors);
+
+      if (!item->finished) {
+        all_finished = false;
+
+        /* show the text of the first unfinished job */
+        if (first_text == nullptr && !item->text.empty())
+          first_text = item->text;
+      }
+    }
+
+    const bool text_changed = first_text != nullptr &&
+      !StringIsEqual(first_text, text);
+    if (text_changed)
+      text = first_text;
+
+    /* call the OperationEnvironment without holding the lock; it may
+       block while updating the UI */
+    lock.unlock();
+
+    if (text_changed)
+      env.SetText(text);
+
+    env.SetProgressPosition(unsigned(fraction * PROGRESS_RANGE /
+                                     std::max<std::size_t>(items.size(), 1)));
+
+    lock.lock();
+
+    if (all_finished)
+      break;
+
+    cond.wait_for(lock, UPDATE_INTERVAL);
+  }
+
+  lock.unlock();
+
+  for (auto *item : threads)
+    item->Join();
+
+  for (const auto &i : errors)
+    env.SetErrorMessage(i);
+
+  std::exception_ptr error;
+
+  for (const auto &item : items) {
+    LogFmt("{}: {} ms", item->name,
+           std::chrono::duration_cast<std::chrono::milliseconds>(item->duration).count());
+
+    if (!error)
+      error = item->error;
+  }
+
+  LogFmt("{} jobs finished after {} ms", items.size(),
+         std::chrono::duration_cast<std::chrono::milliseconds>(steady_clock::now() - start).count());
+
+  if (error)
+    std::rethrow_exception(error);
+}
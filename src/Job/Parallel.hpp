@@ -0,0 +1,74 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "thread/Mutex.hxx"
+#include "thread/Cond.hxx"
+
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <vector>
+
+class OperationEnvironment;
+
+/**
+ * Runs a set of jobs concurrently, each one in its own thread, and
+ * waits for all of them.  Meanwhile, the calling thread forwards the
+ * combined progress and the text of the first unfinished job to an
+ * #OperationEnvironment; therefore, that one may be an environment
+ * which updates the UI.  Error messages are forwarded after all jobs
+ * have finished.
+ *
+ * A job may depend on jobs which were added before it; it starts only
+ * after all of them have finished.
+ *
+ * When all jobs have finished, the wall time of each one is logged.
+ */
+class ParallelJobRunner {
+public:
+  using Function = std::function<void(OperationEnvironment &env)>;
+
+private:
+  class Item;
+
+  std::vector<std::unique_ptr<Item>> items;
+
+  Mutex mutex;
+
+  /**
+   * Signalled when a job finishes.
+   */
+  Cond cond;
+
+public:
+  ParallelJobRunner() noexcept;
+  ~ParallelJobRunner() noexcept;
+
+  ParallelJobRunner(const ParallelJobRunner &) = delete;
+  ParallelJobRunner &operator=(const ParallelJobRunner &) = delete;
+
+  /**
+   * Add a job.  It will be started by Run().
+   *
+   * @param name a short name for the log file
+   * @param depends the indexes of jobs (returned by previous Add()
+   * calls) which must have finished before this one starts
+   * @return the index of the new job
+   */
+  unsigned Add(const char *name, Function function,
+               std::initializer_list<unsigned> depends={});
+
+  /**
+   * Run all jobs and wait until they have finished.
+   *
+   * Rethrows the first exception thrown by a job (after all jobs
+   * have finished).
+   */
+  void Run(OperationEnvironment &env);
+
+private:
+  void RunItem(Item &item) noexcept;
+  bool IsFinished(unsigned i) const noexcept;
+};
@@ -65,8 +65,6 @@ LoggerImpl::StopLogger([[maybe_unused]] const NMEAInfo &gps_info)
   if (writer == nullptr)
     return;
 
-  writer->Flush();
-
   if (!simulator)
     writer->Sign();
 
@@ -105,10 +105,9 @@ GlueMapWindow::ExchangeBlackboard() noexcept
   /* copy device_blackboard to MapWindow */
 
   {
-    auto &device_blackboard = *backend_components->device_blackboard;
-    const std::lock_guard lock{device_blackboard.mutex};
-    ReadBlackboard(device_blackboard.Basic(),
-                   device_blackboard.Calculated());
+    auto [basic, calculated] =
+      backend_components->device_blackboard->LockGetSnapshots();
+    ReadBlackboard(std::move(basic), std::move(calculated));
   }
 
 #ifndef ENABLE_OPENGL
@@ -4,6 +4,17 @@
 #include "MapWindowBlackboard.hpp"
 #include "FLARM/Friends.hpp"
 
+MapWindowBlackboard::MapWindowBlackboard() noexcept
+{
+  /* this needs to be initialised because ReadBlackboard() uses the
+     previous FLARM traffic list */
+  auto basic = std::make_shared<MoreData>();
+  basic->Reset();
+  gps_info = std::move(basic);
+
+  calculated_info = std::make_shared<DerivedInfo>();
+}
+
 void
 MapWindowBlackboard::ReadComputerSettings(const ComputerSettings &settings) noexcept
 {
@@ -59,15 +70,26 @@ UpdateFadingTraffic(bool fade_traffic,
 }
 
 void
-MapWindowBlackboard::ReadBlackboard(const MoreData &nmea_info,
-				    const DerivedInfo &derived_info) noexcept
+MapWindowBlackboard::ReadBlackboard(std::shared_ptr<const MoreData> nmea_info,
+                                    std::shared_ptr<const DerivedInfo> derived_info) noexcept
 {
+  assert(nmea_info);
+  assert(derived_info);
+
   UpdateFadingTraffic(settings_map.fade_traffic,
-                      fading_flarm_traffic, gps_info.flarm.traffic,
-                      nmea_info.flarm.traffic,
-                      nmea_info.clock);
+                      fading_flarm_traffic, gps_info->flarm.traffic,
+                      nmea_info->flarm.traffic,
+                      nmea_info->clock);
 
-  gps_info = nmea_info;
-  calculated_info = derived_info;
+  gps_info = std::move(nmea_info);
+  calculated_info = std::move(derived_info);
+}
+
+void
+MapWindowBlackboard::ReadBlackboard(const MoreData &nmea_info,
+				    const DerivedInfo &derived_info) noexcept
+{
+  ReadBlackboard(std::make_shared<MoreData>(nmea_info),
+                 std::make_shared<DerivedInfo>(derived_info));
 }
 
@@ -3,24 +3,31 @@
 
 #pragma once
 
-#include "Blackboard/BaseBlackboard.hpp"
 #include "Blackboard/ComputerSettingsBlackboard.hpp"
 #include "Blackboard/MapSettingsBlackboard.hpp"
+#include "NMEA/MoreData.hpp"
+#include "NMEA/Derived.hpp"
 #include "thread/Debug.hpp"
 #include "UIState.hpp"
 
 #include <map>
+#include <memory>
 
 /**
  * Blackboard used by map window: provides read-only access to local
  * copies of data required by map window
- * 
+ *
+ * The basic and calculated data are immutable snapshots shared with
+ * the #DeviceBlackboard (see #BlackboardSnapshot); they are not
+ * copied for each frame.
  */
 class MapWindowBlackboard:
-  public BaseBlackboard,
   public ComputerSettingsBlackboard,
   public MapSettingsBlackboard
 {
+  std::shared_ptr<const MoreData> gps_info;
+  std::shared_ptr<const DerivedInfo> calculated_info;
+
   UIState ui_state;
 
   /**
@@ -30,24 +37,20 @@ class MapWindowBlackboard:
   std::map<FlarmId, FlarmTraffic> fading_flarm_traffic;
 
 protected:
-  MapWindowBlackboard() noexcept {
-    /* this needs to be initialised because ReadBlackboard() uses the
-       previous FLARM traffic list */
-    gps_info.Reset();
-  }
+  MapWindowBlackboard() noexcept;
 
   [[gnu::const]]
   const MoreData &Basic() const noexcept {
     assert(InDrawThread());
 
-    return BaseBlackboard::Basic();
+    return *gps_info;
   }
 
   [[gnu::const]]
   const DerivedInfo &Calculated() const noexcept {
     assert(InDrawThread());
 
-    return BaseBlackboard::Calculated();
+    return *calculated_info;
   }
 
   [[gnu::const]]
@@ -76,6 +79,8 @@ protected:
     return ui_state;
   }
 
+  void ReadBlackboard(std::shared_ptr<const MoreData> nmea_info,
+                      std::shared_ptr<const DerivedInfo> derived_info) noexcept;
   void ReadBlackboard(const MoreData &nmea_info,
                       const DerivedInfo &derived_info) noexcept;
   void ReadComputerSettings(const ComputerSettings &settings) noexcept;
@@ -45,6 +45,8 @@ MergeThread::Process() noexcept
 
   flarm_computer.Process(device_blackboard.SetBasic().flarm,
                          last_fix.flarm, basic);
+
+  device_blackboard.PublishBasic();
 }
 
 void
@@ -40,6 +40,7 @@
 #include "Device/MultipleDevices.hpp"
 #include "Topography/TopographyStore.hpp"
 #include "Topography/TopographyGlue.hpp"
+#include "Topography/AsyncCacheBuilder.hpp"
 #include "Audio/Features.hpp"
 #include "Audio/GlobalVolumeController.hpp"
 #include "Audio/VarioGlue.hpp"
@@ -78,7 +79,7 @@
 #include "Engine/Task/Ordered/OrderedTask.hpp"
 #include "Operation/VerboseOperationEnvironment.hpp"
 #include "Operation/PluggableOperationEnvironment.hpp"
-#include "Operation/SubOperationEnvironment.hpp"
+#include "Job/Parallel.hpp"
 #include "Widget/ProgressWidget.hpp"
 #include "PageActions.hpp"
 #include "Weather/Features.hpp"
@@ -414,32 +415,64 @@ Startup(UI::Display &display)
                          CommonInterface::SetComputerSettings(), gp);
   task_manager->SetGlidePolar(gp);
 
-  // Read the topography file(s)
   data_components->topography = std::make_unique<TopographyStore>();
-  {
-    LogString("Loading Topography File...");
-    operation.SetText(_("Loading Topography File..."));
-    LoadConfiguredTopography(*data_components->topography);
-    operation.SetProgressPosition(256);
-  }
 
-  // Read the waypoint files
-  LogString("ReadWaypoints");
+  /* read the topography, waypoint and airspace files in parallel;
+     they are independent of each other */
   {
-    SubOperationEnvironment sub_env(operation, 256, 512);
-    sub_env.SetText(_("Loading Waypoints..."));
-    WaypointGlue::LoadWaypoints(*data_components->waypoints,
-                                data_components->terrain.get(),
-                                sub_env);
+    const RasterTerrain *const terrain = data_components->terrain.get();
+    const AtmosphericPressure pressure = computer_settings.pressure;
+
+    ParallelJobRunner jobs;
+
+    // Read the topography file(s)
+    jobs.Add("topography", [](OperationEnvironment &env){
+      LogString("Loading Topography File...");
+      env.SetText(_("Loading Topography File..."));
+      LoadConfiguredTopography(*data_components->topography, file_cache);
+    });
+
+    // Read the waypoint files
+    const unsigned waypoints =
+      jobs.Add("waypoints", [terrain](OperationEnvironment &env){
+        LogString("ReadWaypoints");
+        env.SetText(_("Loading Waypoints..."));
+        WaypointGlue::LoadWaypoints(*data_components->waypoints,
+                                    terrain, file_cache, env);
+      });
+
+    // Read and parse the airfield info file
+    jobs.Add("waypoint details", [](OperationEnvironment &env){
+      try {
+        env.SetText(_("Loading Airfield Details File..."));
+        WaypointDetails::ReadFileFromProfile(*data_components->waypoints,
+                                             env);
+      } catch (...) {
+        LogError(std::current_exception());
+      }
+    }, {waypoints});
+
+    // Reads the airspace files
+    const unsigned airspace =
+      jobs.Add("airspace", [pressure](OperationEnvironment &env){
+        ReadAirspace(*data_components->airspaces, pressure, file_cache, env);
+      });
+
+    if (terrain != nullptr)
+      jobs.Add("airspace ground levels", [terrain](OperationEnvironment &){
+        SetAirspaceGroundLevels(*data_components->airspaces, *terrain);
+      }, {airspace});
+
+    jobs.Run(operation);
   }
 
-  // Read and parse the airfield info file
-  try {
-    SubOperationEnvironment sub_env(operation, 512, 768);
-    sub_env.SetText(_("Loading Airfield Details File..."));
-    WaypointDetails::ReadFileFromProfile(*data_components->waypoints, sub_env);
-  } catch (...) {
-    LogError(std::current_exception());
+  /* build the missing topography cache files for the next start;
+     until then, the shapefiles are used */
+  if (file_cache != nullptr) {
+    data_components->topography_cache_builder =
+      std::make_unique<AsyncTopographyCacheBuilder>();
+    BuildConfiguredTopographyCache(*data_components->topography_cache_builder,
+                                   *file_cache);
   }
 
   // Set the home waypoint
@@ -452,24 +485,15 @@ Startup(UI::Display &display)
 
   // ReSynchronise the blackboards here since SetHome touches them
   backend_components->device_blackboard->Merge();
+  /* the MergeThread has not been started yet; publish the startup
+     location for the snapshot readers */
+  backend_components->device_blackboard->PublishBasic();
   CommonInterface::ReadBlackboardBasic(backend_components->device_blackboard->Basic());
 
   // Scan for weather forecast
   LogString("RASP load");
   auto rasp = LoadConfiguredRasp();
 
-  // Reads the airspace files
-  {
-    SubOperationEnvironment sub_env(operation, 768, 1024);
-    ReadAirspace(*data_components->airspaces,
-                 computer_settings.pressure,
-                 sub_env);
-  }
-
-  if (data_components->terrain)
-    SetAirspaceGroundLevels(*data_components->airspaces,
-                            *data_components->terrain);
-
   {
     const AircraftState aircraft_state =
       ToAircraftState(backend_components->device_blackboard->Basic(),
@@ -10,7 +10,10 @@
 #include "Projection/WindowProjection.hpp"
 #endif
 
+#include <algorithm>
 #include <cassert>
+#include <cstdlib>
+#include <cstring>
 
 void
 HeightMatrix::SetSize(std::size_t _size) noexcept
@@ -77,4 +80,96 @@ HeightMatrix::Fill(const RasterMap &map, const WindowProjection &projection,
   }
 }
 
+inline void
+HeightMatrix::ScanRow(const RasterMap &map,
+                      const WindowProjection &projection,
+                      unsigned quantisation_pixels, IntPoint2D offset,
+                      unsigned y, unsigned x_begin, unsigned x_end,
+                      bool interpolate) noexcept
+{
+  assert(x_begin < x_end);
+  assert(x_end <= size.x);
+
+  /* RasterMap::ScanLine() needs at least two cells */
+  if (x_end - x_begin < 2) {
+    if (x_end < size.x)
+      ++x_end;
+    else
+      --x_begin;
+  }
+
+  const int q = quantisation_pixels;
+  const int origin_x = offset.x * q;
+
+  /* a whole row uses the same end point as Fill() does; partial
+     rows are only scanned if the cell width is exactly
+     quantisation_pixels */
+  const int screen_x_begin = origin_x + int(x_begin) * q;
+  const int screen_x_end = origin_x + (x_end == size.x
+                                       ? (int)projection.GetScreenSize().width
+                                       : int(x_end) * q);
+  const int screen_y = (offset.y + int(y)) * q;
+
+  map.ScanLine(projection.ScreenToGeo({screen_x_begin, screen_y}),
+               projection.ScreenToGeo({screen_x_end, screen_y}),
+               data.data() + y * size.x + x_begin, x_end - x_begin,
+               interpolate);
+}
+
+void
+HeightMatrix::Shift(const RasterMap &map, const WindowProjection &projection,
+                    unsigned quantisation_pixels,
+                    IntPoint2D delta, IntPoint2D offset,
+                    bool interpolate) noexcept
+{
+  assert(size.x >= 2);
+  assert(std::abs(delta.x) < (int)size.x);
+  assert(std::abs(delta.y) < (int)size.y);
+  assert(offset.x == 0 ||
+         projection.GetScreenSize().width % quantisation_pixels == 0);
+
+  const unsigned width = size.x, height = size.y;
+
+  /* the range of rows/columns which can be reused */
+  const unsigned keep_width = width - std::abs(delta.x);
+  const unsigned keep_height = height - std::abs(delta.y);
+  const unsigned dest_x = std::max(-delta.x, 0);
+  const unsigned dest_y = std::max(-delta.y, 0);
+  const unsigned src_x = std::max(delta.x, 0);
+  const unsigned src_y = std::max(delta.y, 0);
+
+  /* move the rows in an order which does not overwrite rows that
+     still need to be copied */
+  const auto move_row = [&](unsigned i){
+    std::memmove(data.data() + (dest_y + i) * width + dest_x,
+                 data.data() + (src_y + i) * width + src_x,
+                 keep_width * sizeof(TerrainHeight));
+  };
+
+  if (delta.y >= 0)
+    for (unsigned i = 0; i < keep_height; ++i)
+      move_row(i);
+  else
+    for (unsigned i = keep_height; i-- > 0;)
+      move_row(i);
+
+  /* load the exposed rows */
+  for (unsigned y = 0; y < dest_y; ++y)
+    ScanRow(map, projection, quantisation_pixels, offset,
+            y, 0, width, interpolate);
+  for (unsigned y = dest_y + keep_height; y < height; ++y)
+    ScanRow(map, projection, quantisation_pixels, offset,
+            y, 0, width, interpolate);
+
+  /* load the exposed columns of the other rows */
+  if (delta.x != 0) {
+    const unsigned x_begin = delta.x > 0 ? keep_width : 0;
+    const unsigned x_end = delta.x > 0 ? width : dest_x;
+
+    for (unsigned y = dest_y; y < dest_y + keep_height; ++y)
+      ScanRow(map, projection, quantisation_pixels, offset,
+              y, x_begin, x_end, interpolate);
+  }
+}
+
 #endif
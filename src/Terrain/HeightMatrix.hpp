@@ -44,6 +44,31 @@ public:
    */
   void Fill(const RasterMap &map, const WindowProjection &map_projection,
             unsigned quantisation_pixels, bool interpolate) noexcept;
+
+  /**
+   * Move the existing values by a whole number of cells and load
+   * only the cells which have been exposed from the #RasterMap.
+   * This is a cheaper alternative to Fill() after the map has been
+   * panned.
+   *
+   * All cells are sampled on the grid of the projection which was
+   * passed to the last Fill() call, even if the new projection is
+   * not aligned to it; this way, the (sub-cell) error does not
+   * accumulate.
+   *
+   * @param map_projection the projection passed to the last Fill()
+   * call
+   * @param delta the position of the new top-left cell within the
+   * current matrix; its absolute values must be smaller than the
+   * matrix size
+   * @param offset the position of the new top-left cell within the
+   * matrix of the last Fill() call; if the x component is not zero,
+   * the screen width must be a multiple of #quantisation_pixels
+   */
+  void Shift(const RasterMap &map, const WindowProjection &map_projection,
+             unsigned quantisation_pixels,
+             IntPoint2D delta, IntPoint2D offset,
+             bool interpolate) noexcept;
 #endif
 
   UnsignedPoint2D GetSize() const noexcept {
@@ -61,4 +86,16 @@ public:
   const TerrainHeight *GetDataEnd() const noexcept {
     return GetRow(size.y);
   }
+
+#ifndef ENABLE_OPENGL
+private:
+  /**
+   * Load the cells [x_begin, x_end) of one row from the #RasterMap.
+   *
+   * @param offset see Shift()
+   */
+  void ScanRow(const RasterMap &map, const WindowProjection &map_projection,
+               unsigned quantisation_pixels, IntPoint2D offset, unsigned y,
+               unsigned x_begin, unsigned x_end, bool interpolate) noexcept;
+#endif
 };
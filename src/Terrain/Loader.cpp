@@ -4,10 +4,12 @@
 #include "Loader.hpp"
 #include "RasterTileCache.hpp"
 #include "RasterProjection.hpp"
+#include "TileStore.hpp"
 #include "ZzipStream.hpp"
 #include "WorldFile.hpp"
 #include "Operation/Operation.hpp"
 #include "system/ConvertPathName.hpp"
+#include "thread/Parallel.hpp"
 #include "util/ScopeExit.hxx"
 
 extern "C" {
@@ -16,8 +18,23 @@ extern "C" {
 #include "jasper/jpc/jpc_t1cod.h"
 }
 
+#include <algorithm>
+#include <vector>
+
 #include <string.h>
 
+inline bool
+TerrainLoader::IsWantedTile(unsigned index) const noexcept
+{
+  /* check the subset first: the flags of tiles which belong to other
+     decoder threads may be modified concurrently */
+  if (!tile_subset.empty() &&
+      !std::binary_search(tile_subset.begin(), tile_subset.end(), index))
+    return false;
+
+  return raster_tile_cache.tiles.GetLinear(index).IsRequested();
+}
+
 long
 TerrainLoader::SkipMarkerSegment(long file_offset) const
 {
@@ -40,8 +57,7 @@ TerrainLoader::SkipMarkerSegment(long file_offset) const
     return 0;
 
   long skip_to = segment->file_offset;
-  while (segment->IsTileSegment() &&
-         !raster_tile_cache.tiles.GetLinear(segment->tile).IsRequested()) {
+  while (segment->IsTileSegment() && !IsWantedTile(segment->tile)) {
     ++segment;
     if (segment >= raster_tile_cache.segments.end())
       /* last segment is hidden; shouldn't happen either, because we
@@ -157,9 +173,13 @@ TerrainLoader::PutTileData(unsigned index,
                            RasterLocation start, RasterLocation end,
                            const struct jas_matrix &m)
 {
-  if (scan_overview)
+  if (scan_overview) {
     raster_tile_cache.PutOverviewTile(index, start, end, m);
 
+    if (store_writer != nullptr)
+      store_writer->Add(index, m);
+  }
+
   if (scan_tiles) {
     const std::lock_guard lock{mutex};
     raster_tile_cache.PutTileData(index, m);
@@ -213,8 +233,6 @@ LoadJPG2000(jas_stream_t *in, void *loader)
   /* allow really large maps, but specify a reasonable limit */
   opts.max_samples = size_t(1) << 31;
 
-  jpc_initluts();
-
   const auto dec = jpc_dec_create(&opts, in);
   if (dec == nullptr)
     throw std::runtime_error("jpc_dec_create() failed");
@@ -259,6 +277,8 @@ TerrainLoader::LoadOverview(struct zzip_dir *dir,
 
   raster_tile_cache.Reset();
 
+  jpc_initluts();
+
   try {
     LoadJPG2000(dir, path);
 
@@ -280,20 +300,51 @@ LoadTerrainOverview(struct zzip_dir *dir,
                     const char *path, const char *world_file,
                     RasterTileCache &raster_tile_cache,
                     bool all,
-                    OperationEnvironment &env)
+                    OperationEnvironment &env,
+                    RasterTileStoreWriter *store_writer)
 {
   /* fake a mutex - we don't need it for LoadTerrainOverview() */
   SharedMutex mutex;
 
-  TerrainLoader loader(mutex, raster_tile_cache, true, all, env);
+  TerrainLoader loader(mutex, raster_tile_cache, true, all, env,
+                       store_writer);
   loader.LoadOverview(dir, path, world_file);
 }
 
+void
+TerrainLoader::LoadJPG2000Parallel(std::span<struct zzip_dir *const> dirs,
+                                   const char *path,
+                                   std::span<const uint16_t> tiles)
+{
+  const unsigned n = dirs.size();
+  assert(n > 1);
+  assert(tiles.size() >= n);
+
+  /* distribute the tiles round-robin; each decoder skips the marker
+     segments of all other tiles */
+  std::vector<std::vector<uint16_t>> subsets(n);
+  for (std::size_t i = 0; i < tiles.size(); ++i)
+    subsets[i % n].push_back(tiles[i]);
+
+  for (auto &subset : subsets)
+    std::sort(subset.begin(), subset.end());
+
+  /* each thread gets its own stream and its own decoder context;
+     PutTileData() serialises access to the RasterTileCache */
+  RunParallel(n, [&](unsigned i){
+    TerrainLoader worker(mutex, raster_tile_cache, false, true, env);
+    worker.tile_subset = subsets[i];
+    worker.LoadJPG2000(dirs[i], path);
+  });
+}
+
 inline void
-TerrainLoader::UpdateTiles(struct zzip_dir *dir, const char *path,
+TerrainLoader::UpdateTiles(std::span<struct zzip_dir *const> dirs,
+                           const char *path,
                            SignedRasterLocation p, unsigned radius)
 {
   assert(!scan_overview);
+  assert(!dirs.empty());
 
   {
     /* this write lock is necessary because
@@ -303,14 +354,38 @@ TerrainLoader::UpdateTiles(struct zzip_dir *dir, const char *path,
     if (!raster_tile_cache.PollTiles(p, radius))
       /* nothing to do */
       return;
+
+    if (!raster_tile_cache.LoadStoredTiles()) {
+      /* all requested tiles were found in the tile store; no need to
+         run the JPEG2000 decoder */
+      raster_tile_cache.FinishTileUpdate();
+      return;
+    }
   }
 
   AtScopeExit(this) { raster_tile_cache.FinishTileUpdate(); };
-  LoadJPG2000(dir, path);
+
+  jpc_initluts();
+
+  if (dirs.size() > 1) {
+    /* collect the tiles which still need to be decoded */
+    std::vector<uint16_t> tiles;
+    for (const auto i : raster_tile_cache.request_tiles)
+      if (raster_tile_cache.tiles.GetLinear(i).IsRequested())
+        tiles.push_back(i);
+
+    if (tiles.size() >= 2) {
+      LoadJPG2000Parallel(dirs.first(std::min(dirs.size(), tiles.size())),
+                          path, tiles);
+      return;
+    }
+  }
+
+  LoadJPG2000(dirs.front(), path);
 }
 
 void
-UpdateTerrainTiles(struct zzip_dir *dir, const char *path,
+UpdateTerrainTiles(std::span<struct zzip_dir *const> dirs, const char *path,
                    RasterTileCache &raster_tile_cache, SharedMutex &mutex,
                    SignedRasterLocation p, unsigned radius)
 {
@@ -319,18 +394,18 @@ UpdateTerrainTiles(struct zzip_dir *dir, const char *path,
 
   NullOperationEnvironment env;
   TerrainLoader loader(mutex, raster_tile_cache, false, true, env);
-  loader.UpdateTiles(dir, path, p, radius);
+  loader.UpdateTiles(dirs, path, p, radius);
 }
 
 void
-UpdateTerrainTiles(struct zzip_dir *dir, const char *path,
+UpdateTerrainTiles(std::span<struct zzip_dir *const> dirs, const char *path,
                    RasterTileCache &raster_tile_cache, SharedMutex &mutex,
                    const RasterProjection &projection,
                    const GeoPoint &location, double radius)
 {
   const auto raster_location = projection.ProjectCoarse(location);
 
-  UpdateTerrainTiles(dir, path, raster_tile_cache, mutex,
+  UpdateTerrainTiles(dirs, path, raster_tile_cache, mutex,
                      raster_location,
                      projection.DistancePixelsCoarse(radius));
 }
@@ -7,10 +7,12 @@
 #include "thread/SharedMutex.hpp"
 
 #include <cstdint>
+#include <span>
 
 struct zzip_dir;
 struct GeoPoint;
 class RasterTileCache;
+class RasterTileStoreWriter;
 class RasterProjection;
 class OperationEnvironment;
 
@@ -23,6 +25,19 @@ class TerrainLoader {
 
   OperationEnvironment &env;
 
+  /**
+   * If not nullptr, then all decoded tiles are written to this tile
+   * store (only while scanning the overview).
+   */
+  RasterTileStoreWriter *const store_writer;
+
+  /**
+   * If not empty, then this loader decodes only the requested tiles
+   * in this (sorted) list.  This is used to split the work among
+   * several decoder threads.
+   */
+  std::span<const uint16_t> tile_subset;
+
   /**
    * The number of remaining segments after the current one.
    */
@@ -31,11 +46,12 @@ class TerrainLoader {
 public:
   TerrainLoader(SharedMutex &_mutex, RasterTileCache &_rtc,
                 bool _scan_overview, bool _scan_all,
-                OperationEnvironment &_env)
+                OperationEnvironment &_env,
+                RasterTileStoreWriter *_store_writer=nullptr)
     :mutex(_mutex), raster_tile_cache(_rtc),
      scan_overview(_scan_overview),
      scan_tiles(!_scan_overview || _scan_all),
-     env(_env) {}
+     env(_env), store_writer(_store_writer) {}
 
   /**
    * Throws on error.
@@ -45,8 +61,12 @@ public:
 
   /**
    * Throws on error.
+   *
+   * @param dirs one or more handles to the same map file; if there
+   * is more than one, then the tiles are decoded in parallel, one
+   * thread per handle
    */
-  void UpdateTiles(struct zzip_dir *dir, const char *path,
+  void UpdateTiles(std::span<struct zzip_dir *const> dirs, const char *path,
                    SignedRasterLocation p, unsigned radius);
 
   /* callback methods for libjasper (via jas_rtc.cpp) */
@@ -67,11 +87,26 @@ public:
                    const struct jas_matrix &m);
 
 private:
+  /**
+   * Shall the given tile be decoded by this loader?
+   */
+  [[gnu::pure]]
+  bool IsWantedTile(unsigned index) const noexcept;
+
   /**
    * Throws on error.
    */
   void LoadJPG2000(struct zzip_dir *dir, const char *path);
 
+  /**
+   * Decode the requested tiles with several decoders in parallel.
+   *
+   * Throws on error.
+   */
+  void LoadJPG2000Parallel(std::span<struct zzip_dir *const> dirs,
+                           const char *path,
+                           std::span<const uint16_t> tiles);
+
   void ParseBounds(const char *data);
 };
 
@@ -81,31 +116,55 @@ private:
  * @param all load not only overview, but all tiles?  On large files,
  * this is a very expensive operation.  This option was designed for
  * small RASP files only.
+ * @param store_writer if not nullptr, then all decoded tiles are
+ * written to this tile store; the caller is responsible for calling
+ * RasterTileStoreWriter::Commit()
  */
 void
 LoadTerrainOverview(struct zzip_dir *dir,
                     const char *path, const char *world_file,
                     RasterTileCache &raster_tile_cache,
                     bool all,
-                    OperationEnvironment &env);
+                    OperationEnvironment &env,
+                    RasterTileStoreWriter *store_writer=nullptr);
 
 static inline void
 LoadTerrainOverview(struct zzip_dir *dir,
                     RasterTileCache &tile_cache,
-                    OperationEnvironment &env)
+                    OperationEnvironment &env,
+                    RasterTileStoreWriter *store_writer=nullptr)
 {
   LoadTerrainOverview(dir, "terrain.jp2", "terrain.j2w",
-                      tile_cache, false, env);
+                      tile_cache, false, env, store_writer);
 }
 
 /**
  * Throws on error.
+ *
+ * @param dirs one or more handles to the same map file; with more
+ * than one, the tiles are decoded in parallel
  */
 void
-UpdateTerrainTiles(struct zzip_dir *dir, const char *path,
+UpdateTerrainTiles(std::span<struct zzip_dir *const> dirs, const char *path,
                    RasterTileCache &raster_tile_cache, SharedMutex &mutex,
                    SignedRasterLocation p, unsigned radius);
 
+static inline void
+UpdateTerrainTiles(struct zzip_dir *dir, const char *path,
+                   RasterTileCache &raster_tile_cache, SharedMutex &mutex,
+                   SignedRasterLocation p, unsigned radius)
+{
+  UpdateTerrainTiles({&dir, 1}, path, raster_tile_cache, mutex, p, radius);
+}
+
+static inline void
+UpdateTerrainTiles(std::span<struct zzip_dir *const> dirs,
+                   RasterTileCache &tile_cache, SharedMutex &mutex,
+                   SignedRasterLocation p, unsigned radius)
+{
+  UpdateTerrainTiles(dirs, "terrain.jp2", tile_cache, mutex, p, radius);
+}
+
 static inline void
 UpdateTerrainTiles(struct zzip_dir *dir,
                    RasterTileCache &tile_cache, SharedMutex &mutex,
@@ -115,17 +174,27 @@ UpdateTerrainTiles(struct zzip_dir *dir,
 }
 
 void
-UpdateTerrainTiles(struct zzip_dir *dir, const char *path,
+UpdateTerrainTiles(std::span<struct zzip_dir *const> dirs, const char *path,
                    RasterTileCache &raster_tile_cache, SharedMutex &mutex,
                    const RasterProjection &projection,
                    const GeoPoint &location, double radius);
 
+static inline void
+UpdateTerrainTiles(std::span<struct zzip_dir *const> dirs,
+                   RasterTileCache &tile_cache, SharedMutex &mutex,
+                   const RasterProjection &projection,
+                   const GeoPoint &location, double radius)
+{
+  UpdateTerrainTiles(dirs, "terrain.jp2", tile_cache, mutex,
+                     projection, location, radius);
+}
+
 static inline void
 UpdateTerrainTiles(struct zzip_dir *dir,
                    RasterTileCache &tile_cache, SharedMutex &mutex,
                    const RasterProjection &projection,
                    const GeoPoint &location, double radius)
 {
-  UpdateTerrainTiles(dir, "terrain.jp2", tile_cache, mutex,
+  UpdateTerrainTiles({&dir, 1}, tile_cache, mutex,
                      projection, location, radius);
 }
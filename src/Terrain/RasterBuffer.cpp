@@ -13,7 +13,25 @@ RasterBuffer::Resize(RasterLocation _size) noexcept
   assert(_size.x > 0);
   assert(_size.y > 0);
 
-  data.GrowDiscard(_size.x, _size.y);
+  if (IsAttached())
+    storage = nullptr;
+
+  storage.GrowDiscard(_size.Area());
+  data = storage.data();
+  size = _size;
+}
+
+void
+RasterBuffer::Attach(std::span<const TerrainHeight> src,
+                     RasterLocation _size) noexcept
+{
+  assert(_size.x > 0);
+  assert(_size.y > 0);
+  assert(src.size() >= _size.Area());
+
+  storage = nullptr;
+  data = src.data();
+  size = _size;
 }
 
 TerrainHeight
@@ -243,7 +261,7 @@ TerrainHeight
 RasterBuffer::GetMaximum() const noexcept
 {
   return IsDefined()
-    ? *std::max_element(data.begin(), data.end(),
+    ? *std::max_element(data, data + size.Area(),
                         [](TerrainHeight a, TerrainHeight b) {
                           return a.GetValue() < b.GetValue();
                         })
@@ -6,26 +6,51 @@
 #include "RasterTraits.hpp"
 #include "RasterLocation.hpp"
 #include "Height.hpp"
-#include "util/AllocatedGrid.hxx"
+#include "util/AllocatedArray.hxx"
 #include "util/Compiler.h"
 
+#include <cassert>
+#include <span>
+
 class RasterBuffer {
-  AllocatedGrid<TerrainHeight> data;
+  /**
+   * The memory owned by this object.  It is unused if this buffer
+   * refers to external memory (see Attach()).
+   */
+  AllocatedArray<TerrainHeight> storage;
+
+  /**
+   * Pointer to the first value; points either into #storage or to
+   * external (read-only) memory.  nullptr if this buffer is
+   * undefined.
+   */
+  const TerrainHeight *data = nullptr;
+
+  RasterLocation size{0, 0};
 
 public:
   RasterBuffer() noexcept = default;
-  RasterBuffer(unsigned _width, unsigned _height) noexcept
-    :data(_width, _height) {}
+  RasterBuffer(unsigned _width, unsigned _height) noexcept {
+    Resize({_width, _height});
+  }
 
   RasterBuffer(const RasterBuffer &) = delete;
   RasterBuffer &operator=(const RasterBuffer &) = delete;
 
   bool IsDefined() const noexcept {
-    return data.IsDefined();
+    return data != nullptr;
+  }
+
+  /**
+   * Does this buffer refer to external memory instead of owning its
+   * data?
+   */
+  bool IsAttached() const noexcept {
+    return data != nullptr && data != storage.data();
   }
 
   RasterLocation GetSize() const noexcept {
-    return {data.GetWidth(), data.GetHeight()};
+    return size;
   }
 
   RasterLocation GetFineSize() const noexcept {
@@ -33,23 +58,41 @@ public:
   }
 
   TerrainHeight *GetData() noexcept {
-    return data.begin();
+    assert(!IsAttached());
+
+    return storage.data();
   }
 
   const TerrainHeight *GetData() const noexcept {
-    return data.begin();
+    return data;
   }
 
   const TerrainHeight *GetDataAt(RasterLocation p) const noexcept {
-    return data.GetPointerAt(p.x, p.y);
+    assert(p.x < size.x);
+    assert(p.y < size.y);
+
+    return data + p.y * size.x + p.x;
   }
 
   void Reset() noexcept {
-    data.Reset();
+    storage = nullptr;
+    data = nullptr;
+    size = {0, 0};
   }
 
+  /**
+   * Allocate (owned) memory for the given size, discarding old data.
+   */
   void Resize(RasterLocation _size) noexcept;
 
+  /**
+   * Let this buffer refer to external memory (e.g. a memory-mapped
+   * file) instead of copying the values.  The caller is responsible
+   * for keeping the memory valid until Reset() is called.
+   */
+  void Attach(std::span<const TerrainHeight> src,
+              RasterLocation _size) noexcept;
+
   [[gnu::pure]]
   TerrainHeight GetInterpolated(unsigned lx, unsigned ly,
                                 unsigned ix, unsigned iy) const noexcept;
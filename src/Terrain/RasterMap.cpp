@@ -35,6 +35,37 @@ RasterMap::GetInterpolatedHeight(const GeoPoint &location) const noexcept
   return raster_tile_cache.GetInterpolatedHeight(pt);
 }
 
+void
+RasterMap::GetHeights(std::span<const GeoPoint> locations,
+                      TerrainHeight *dest, bool interpolate) const noexcept
+{
+  /* project chunks of locations into a small buffer first; this
+     loop has no branches and can be vectorised by the compiler */
+  constexpr std::size_t CHUNK_SIZE = 64;
+  RasterLocation buffer[CHUNK_SIZE];
+
+  while (!locations.empty()) {
+    const auto chunk = locations.first(std::min(locations.size(), CHUNK_SIZE));
+    locations = locations.subspan(chunk.size());
+
+    if (interpolate) {
+      std::transform(chunk.begin(), chunk.end(), buffer,
+                     [this](const GeoPoint &location){
+                       return RasterLocation(projection.ProjectFine(location));
+                     });
+      raster_tile_cache.GetInterpolatedHeights({buffer, chunk.size()}, dest);
+    } else {
+      std::transform(chunk.begin(), chunk.end(), buffer,
+                     [this](const GeoPoint &location){
+                       return RasterLocation(projection.ProjectCoarse(location));
+                     });
+      raster_tile_cache.GetHeights({buffer, chunk.size()}, dest);
+    }
+
+    dest += chunk.size();
+  }
+}
+
 void
 RasterMap::ScanLine(const GeoPoint &start, const GeoPoint &end,
                     TerrainHeight *buffer, unsigned size,
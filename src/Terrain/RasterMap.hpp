@@ -7,6 +7,8 @@
 #include "RasterTileCache.hpp"
 #include "Geo/GeoPoint.hpp"
 
+#include <span>
+
 class OperationEnvironment;
 
 class RasterMap {
@@ -95,6 +97,17 @@ public:
   [[gnu::pure]]
   TerrainHeight GetInterpolatedHeight(const GeoPoint &location) const noexcept;
 
+  /**
+   * Determine the heights of many locations at once.  This is
+   * equivalent to calling GetHeight() or GetInterpolatedHeight() for
+   * each location, but cheaper; it works best if adjacent locations
+   * are close to each other.
+   *
+   * @param dest an array with as many elements as #locations
+   */
+  void GetHeights(std::span<const GeoPoint> locations,
+                  TerrainHeight *dest, bool interpolate) const noexcept;
+
   /**
    * Scan a straight line and fill the buffer with the specified
    * number of samples along the line.
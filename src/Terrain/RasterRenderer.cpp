@@ -3,6 +3,7 @@
 
 #include "Terrain/RasterRenderer.hpp"
 #include "Terrain/RasterMap.hpp"
+#include "Terrain/RasterShading.hpp"
 #include "Math/Constants.hpp"
 #include "Screen/Layout.hpp"
 #include "ui/canvas/Ramp.hpp"
@@ -14,6 +15,7 @@
 
 #include <algorithm> // for std::clamp()
 #include <cassert>
+#include <cmath>
 #include <cstdint>
 
 /**
@@ -59,25 +61,6 @@ TerrainShading(const int illum, RGB8Color color) noexcept
     return RawColor(color.Red(), color.Green(), color.Blue());
 }
 
-static constexpr unsigned
-ContourInterval(unsigned h, unsigned contour_height_scale) noexcept
-{
-  return std::min(254u, h >> contour_height_scale);
-}
-
-[[gnu::const]]
-static unsigned
-ContourInterval(const TerrainHeight h, const unsigned contour_height_scale)
-{
-  if (h.IsSpecial()) [[unlikely]]
-    return 0;
-
-  if (h.GetValue() <= 0)
-    return 0;
-
-  return ContourInterval(h.GetValue(), contour_height_scale);
-}
-
 RasterRenderer::RasterRenderer() noexcept = default;
 
 RasterRenderer::~RasterRenderer() noexcept
@@ -166,10 +149,73 @@ RasterRenderer::ScanMap(const RasterMap &map,
 
   last_quantisation_pixels = quantisation_pixels;
 #else
-  height_matrix.Fill(map, projection, quantisation_pixels, true);
+  if (const auto shift = FindScanShift(projection)) {
+    /* the map has been panned: move the old values and scan only
+       the strips which have been exposed */
+    const IntPoint2D delta = *shift - scan_offset;
+    if (delta.x != 0 || delta.y != 0)
+      height_matrix.Shift(map, scan_projection, quantisation_pixels,
+                          delta, *shift, true);
+    scan_offset = *shift;
+  } else {
+    height_matrix.Fill(map, projection, quantisation_pixels, true);
+    scan_projection = projection;
+    scan_offset = {0, 0};
+  }
 #endif
 }
 
+#ifndef ENABLE_OPENGL
+
+std::optional<IntPoint2D>
+RasterRenderer::FindScanShift(const WindowProjection &projection) const noexcept
+{
+  if (!scan_projection.IsValid() ||
+      projection.GetScreenSize() != scan_projection.GetScreenSize() ||
+      projection.GetScreenAngle() != scan_projection.GetScreenAngle() ||
+      projection.GetScale() != scan_projection.GetScale())
+    return std::nullopt;
+
+  const int q = quantisation_pixels;
+
+  /* where is the new top-left corner on the old screen? */
+  const auto p = scan_projection.GeoToScreen(projection.ScreenToGeo({0, 0}));
+  const IntPoint2D shift{
+    (int)lround(double(p.x) / q),
+    (int)lround(double(p.y) / q),
+  };
+
+  const UnsignedPoint2D size = height_matrix.GetSize();
+  const IntPoint2D delta = shift - scan_offset;
+  if (std::abs(delta.x) >= (int)size.x || std::abs(delta.y) >= (int)size.y)
+    /* nothing can be reused */
+    return std::nullopt;
+
+  if (shift.x != 0 && projection.GetScreenSize().width % q != 0)
+    /* the cells are not exactly "q" pixels wide, and shifting
+       horizontally would move them off the grid */
+    return std::nullopt;
+
+  /* verify that the screen corners map to the same locations
+     (i.e. the projection has not been scaled or rotated); the
+     rounding above allows up to half a cell in each direction */
+  const double max_error = q * 0.75 / projection.GetScale();
+  const PixelPoint offset{shift.x * q, shift.y * q};
+  const PixelSize screen_size = projection.GetScreenSize();
+  for (const PixelPoint corner : {
+      PixelPoint{0, 0},
+      PixelPoint{(int)screen_size.width, 0},
+      PixelPoint{0, (int)screen_size.height},
+      PixelPoint{(int)screen_size.width, (int)screen_size.height},
+    })
+    if (projection.ScreenToGeo(corner).DistanceS(scan_projection.ScreenToGeo(corner + offset)) > max_error)
+      return std::nullopt;
+
+  return shift;
+}
+
+#endif
+
 void
 RasterRenderer::GenerateImage(bool do_shading,
                               unsigned height_scale,
@@ -187,6 +233,10 @@ RasterRenderer::GenerateImage(bool do_shading,
     contour_column_base = new unsigned char[height_matrix.GetSize().x];
   }
 
+  height_row.GrowDiscard(height_matrix.GetSize().x);
+  contour_row.GrowDiscard(height_matrix.GetSize().x);
+  illumination_row.GrowDiscard(height_matrix.GetSize().x);
+
   if (quantisation_effective == 0) {
     do_shading = false;
     do_contour = false;
@@ -209,64 +259,46 @@ void
 RasterRenderer::GenerateUnshadedImage(const unsigned height_scale,
                                       const unsigned contour_height_scale) noexcept
 {
-  const auto *src = height_matrix.GetData();
+  const unsigned width = height_matrix.GetSize().x;
   const RawColor *oColorBuf = color_table + 64 * 256;
   RawColor *dest = image->GetTopRow();
 
-  for (unsigned y = height_matrix.GetSize().y; y > 0; --y) {
+  for (unsigned y = 0; y < height_matrix.GetSize().y; ++y) {
+    const auto *src = height_matrix.GetRow(y);
     RawColor *p = dest;
     dest = image->GetNextRow(dest);
 
-    unsigned contour_row_base = ContourInterval(*src, contour_height_scale);
-    unsigned char *contour_this_column_base = contour_column_base;
+    RasterShading::QuantiseHeightRow(height_row.data(), src, width,
+                                     height_scale);
+    RasterShading::QuantiseHeightRow(contour_row.data(), src, width,
+                                     contour_height_scale);
 
-    for (unsigned x = height_matrix.GetSize().x; x > 0; --x) {
-      const auto e = *src++;
-      if (!e.IsSpecial()) [[likely]] {
-        unsigned h = std::max(0, (int)e.GetValue());
+    unsigned contour_row_base = contour_row[0];
 
-        const unsigned contour_interval =
-          ContourInterval(h, contour_height_scale);
+    for (unsigned x = 0; x < width; ++x) {
+      const auto e = src[x];
+      if (!e.IsSpecial()) [[likely]] {
+        const unsigned h = height_row[x];
+        const unsigned contour_interval = contour_row[x];
 
-        h = std::min(254u, h >> height_scale);
         if (contour_interval != contour_row_base ||
-            contour_interval != *contour_this_column_base) [[unlikely]] {
-          *p++ = oColorBuf[(int)h - 64 * 256];
-          *contour_this_column_base = contour_row_base = contour_interval;
+            contour_interval != contour_column_base[x]) [[unlikely]] {
+          p[x] = oColorBuf[(int)h - 64 * 256];
+          contour_column_base[x] = contour_row_base = contour_interval;
         } else {
-          *p++ = oColorBuf[h];
+          p[x] = oColorBuf[h];
         }
       } else if (e.IsWater()) {
         // we're in the water, so look up the color for water
-        *p++ = oColorBuf[255];
+        p[x] = oColorBuf[255];
       } else {
         /* outside the terrain file bounds: white background */
-        *p++ = RawColor(0xff, 0xff, 0xff);
+        p[x] = RawColor(0xff, 0xff, 0xff);
       }
-      contour_this_column_base++;
-
     }
   }
 }
 
-/**
- * Clip the difference between two adjacent terrain height values to
- * sane bounds.  This works around integer overflows in the
- * GenerateSlopeImage() formula when the map file is broken, avoiding
- * the sqrt() call with a negative argument.
- */
-static constexpr int
-ClipHeightDelta(int d) noexcept
-{
-  return std::clamp(d, -512, 512);
-}
-
-static constexpr int
-ClipHeightDelta(TerrainHeight a, TerrainHeight b) noexcept
-{
-  return ClipHeightDelta(a.GetValue() - b.GetValue());
-}
-
 // JMW: if zoomed right in (e.g. one unit is larger than terrain
 // grid), then increase the step size to be equal to the terrain
 // grid for purposes of calculating slope, to avoid shading problems
@@ -280,120 +312,115 @@ RasterRenderer::GenerateSlopeImage(unsigned height_scale,
 {
   assert(quantisation_effective > 0);
 
-  const auto border = PixelRect{PixelSize{height_matrix.GetSize()}}
-    .WithPadding(quantisation_effective);
+  const unsigned q = quantisation_effective;
+  const unsigned width = height_matrix.GetSize().x;
+  const unsigned height = height_matrix.GetSize().y;
 
-  const unsigned height_slope_factor =
+  const RasterShading::SlopeParameters sp{
+    sx, sy, sz, contrast,
     std::clamp((unsigned)pixel_size, 1u,
                /* this upper limit avoids integer overflows in the
                   "mag" formula; it effectively limits "dd2" so
                   calculating its square will not overflow */
-               8192u / (quantisation_effective * quantisation_effective));
-  
-  const auto *src = height_matrix.GetData();
+               8192u / (q * q)),
+  };
+
+  /* the columns whose left and right neighbours are both "q" pixels
+     away; these are handled by the (vectorised)
+     CalculateIlluminationRow() */
+  const unsigned interior_begin = std::min(q, width);
+  const unsigned interior_end = width > 2 * q ? width - q : interior_begin;
+
   const RawColor *oColorBuf = color_table + 64 * 256;
+  int8_t *const illumination = illumination_row.data();
 
   RawColor *dest = image->GetTopRow();
 
-  for (unsigned y = 0; y < height_matrix.GetSize().y; ++y) {
-    const unsigned row_plus_index = y < (unsigned)border.bottom
-      ? quantisation_effective
-      : height_matrix.GetSize().y - 1 - y;
-    const unsigned row_plus_offset = height_matrix.GetSize().x * row_plus_index;
+  for (unsigned y = 0; y < height; ++y) {
+    const auto *src = height_matrix.GetRow(y);
+
+    const unsigned row_plus_index = std::min(q, height - 1 - y);
+    const std::size_t row_plus_offset = std::size_t(width) * row_plus_index;
 
-    const unsigned row_minus_index = y >= quantisation_effective
-      ? quantisation_effective : y;
-    const unsigned row_minus_offset = height_matrix.GetSize().x * row_minus_index;
+    const unsigned row_minus_index = std::min(q, y);
+    const std::size_t row_minus_offset = std::size_t(width) * row_minus_index;
 
     const unsigned p31 = row_plus_index + row_minus_index;
 
     RawColor *p = dest;
     dest = image->GetNextRow(dest);
 
-    unsigned contour_row_base = ContourInterval(*src, contour_height_scale);
-    unsigned char *contour_this_column_base = contour_column_base;
-
-    for (unsigned x = 0; x < height_matrix.GetSize().x; ++x, ++src) {
-      const auto e = *src;
+    RasterShading::QuantiseHeightRow(height_row.data(), src, width,
+                                     height_scale);
+    RasterShading::QuantiseHeightRow(contour_row.data(), src, width,
+                                     contour_height_scale);
+
+    unsigned begin = interior_begin, end = interior_end;
+    if (p31 > 0 && begin < end)
+      RasterShading::CalculateIlluminationRow(illumination + begin,
+                                              src + begin, end - begin,
+                                              q,
+                                              row_minus_offset,
+                                              row_plus_offset,
+                                              p31, sp);
+    else
+      begin = end = width;
+
+    /* the edges (and single-row images) need special care, because
+       there are fewer than "q" pixels to one of the neighbours */
+    const auto calculate_edge = [&](unsigned x){
+      const unsigned column_plus_index = std::min(q, width - 1 - x);
+      const unsigned column_minus_index = std::min(q, x);
+
+      const auto *center = src + x;
+      assert(center - row_minus_offset >= height_matrix.GetData());
+      assert(center + row_plus_offset < height_matrix.GetDataEnd());
+
+      illumination[x] =
+        RasterShading::CalculateIllumination(*(center - row_minus_offset),
+                                             center[row_plus_offset],
+                                             *(center - column_minus_index),
+                                             center[column_plus_index],
+                                             column_plus_index + column_minus_index,
+                                             p31, sp);
+    };
+
+    for (unsigned x = 0; x < begin; ++x)
+      calculate_edge(x);
+    for (unsigned x = end; x < width; ++x)
+      calculate_edge(x);
+
+    unsigned contour_row_base = contour_row[0];
+
+    for (unsigned x = 0; x < width; ++x) {
+      const auto e = src[x];
       if (!e.IsSpecial()) [[likely]] {
-        unsigned h = std::max(0, (int)e.GetValue());
-
-        const unsigned contour_interval =
-          ContourInterval(h, contour_height_scale);
-
-        h = std::min(254u, h >> height_scale);
-
-        // no need to calculate slope if undefined height or sea level
-
-        // Y direction
-        assert(src - row_minus_offset >= height_matrix.GetData());
-        assert(src + row_plus_offset >= height_matrix.GetData());
-        assert(src - row_minus_offset < height_matrix.GetDataEnd());
-        assert(src + row_plus_offset < height_matrix.GetDataEnd());
-
-        // X direction
+        const unsigned h = height_row[x];
+        const int illum = illumination[x];
 
-        const unsigned column_plus_index = x < (unsigned)border.right
-          ? quantisation_effective
-          : height_matrix.GetSize().x - 1 - x;
-        const unsigned column_minus_index = x >= (unsigned)border.left
-          ? quantisation_effective : x;
-
-        assert(src - column_minus_index >= height_matrix.GetData());
-        assert(src + column_plus_index >= height_matrix.GetData());
-        assert(src - column_minus_index < height_matrix.GetDataEnd());
-        assert(src + column_plus_index < height_matrix.GetDataEnd());
-
-        const auto h_above = src[-(int)row_minus_offset];
-        const auto h_below = src[row_plus_offset];
-        const auto h_left = src[-(int)column_minus_index];
-        const auto h_right = src[column_plus_index];
-
-        if (h_above.IsSpecial() || h_below.IsSpecial() ||
-            h_left.IsSpecial() || h_right.IsSpecial()) [[unlikely]] {
+        if (illum == RasterShading::NO_SLOPE) [[unlikely]] {
           /* some "special" terrain value surrounding us (water or
              invalid), skip slope calculation */
-          *p++ = oColorBuf[h];
-          contour_this_column_base++;
+          p[x] = oColorBuf[h];
           continue;
         }
 
+        const unsigned contour_interval = contour_row[x];
         if (contour_interval != contour_row_base ||
-            contour_interval != *contour_this_column_base) [[unlikely]] {
-
-          *contour_this_column_base++ = contour_row_base = contour_interval;
-          *p++ = oColorBuf[int(h) - 64 * 256];
+            contour_interval != contour_column_base[x]) [[unlikely]] {
+          contour_column_base[x] = contour_row_base = contour_interval;
+          p[x] = oColorBuf[int(h) - 64 * 256];
           continue;
         }
 
-        const int p32 = ClipHeightDelta(h_above, h_below);
-        const int p22 = ClipHeightDelta(h_right, h_left);
-
-        const unsigned p20 = column_plus_index + column_minus_index;
-
-        const int dd0 = p22 * int(p31);
-        const int dd1 = int(p20) * p32;
-        const unsigned dd2 = p20 * p31 * height_slope_factor;
-        const int num = (int(dd2) * sz + dd0 * sx + dd1 * sy);
-        const unsigned square_mag = dd0 * dd0 + dd1 * dd1 + dd2 * dd2;
-        const unsigned mag = (unsigned)sqrt(square_mag);
-        /* this is a workaround for a SIGFPE (division by zero)
-           observed by our users on some Android devices (e.g. Nexus
-           7), even though we did our best to make sure that the
-           integer arithmetics above can't overflow */
-        /* TODO: debug this problem and replace this workaround */
-        const int sval = num / int(mag|1);
-        const int sindex = (sval - sz) * contrast / 128;
-        *p++ = oColorBuf[int(h) + 256 * std::clamp(sindex, -63, 63)];
+        p[x] = oColorBuf[int(h) + 256 * illum];
       } else if (e.IsWater()) {
         // we're in the water, so look up the color for water
-        *p++ = oColorBuf[255];
+        p[x] = oColorBuf[255];
       } else {
         /* outside the terrain file bounds: white background */
-        *p++ = RawColor(0xff, 0xff, 0xff);
+        p[x] = RawColor(0xff, 0xff, 0xff);
       }
-      contour_this_column_base++;
-
     }
   }
 }
@@ -453,10 +480,10 @@ void
 RasterRenderer::ContourStart(const unsigned contour_height_scale) noexcept
 {
   // initialise column to first row
-  const auto *src = height_matrix.GetData();
-  unsigned char *col_base = contour_column_base;
-  for (unsigned x = height_matrix.GetSize().x; x > 0; --x)
-    *col_base++ = ContourInterval(*src++, contour_height_scale);
+  RasterShading::QuantiseHeightRow(contour_column_base,
+                                   height_matrix.GetData(),
+                                   height_matrix.GetSize().x,
+                                   contour_height_scale);
 }
 
 void
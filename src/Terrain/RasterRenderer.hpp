@@ -4,9 +4,16 @@
 #pragma once
 
 #include "Terrain/HeightMatrix.hpp"
+#include "util/AllocatedArray.hxx"
+
+#include <cstdint>
 
 #ifdef ENABLE_OPENGL
 #include "Geo/GeoBounds.hpp"
+#else
+#include "Projection/WindowProjection.hpp"
+
+#include <optional>
 #endif
 
 static constexpr unsigned NUM_COLOR_RAMP_LEVELS = 13;
@@ -48,6 +55,19 @@ class RasterRenderer {
    * texture has to be redrawn.
    */
   GeoBounds bounds = GeoBounds::Invalid();
+#else
+  /**
+   * The projection of the last full #HeightMatrix scan; invalid if
+   * the #HeightMatrix cannot be reused.
+   */
+  WindowProjection scan_projection;
+
+  /**
+   * The position of the current #HeightMatrix within the one
+   * scanned with #scan_projection (in cells).  This is updated each
+   * time the matrix is shifted after panning.
+   */
+  IntPoint2D scan_offset;
 #endif
 
   HeightMatrix height_matrix;
@@ -55,6 +75,13 @@ class RasterRenderer {
 
   unsigned char *contour_column_base = nullptr;
 
+  /**
+   * Scratch buffers for one row of the image: the color table index,
+   * the contour interval and the illumination of each pixel.
+   */
+  AllocatedArray<uint8_t> height_row, contour_row;
+  AllocatedArray<int8_t> illumination_row;
+
   double pixel_size;
 
   RawColor *color_table = nullptr;
@@ -74,11 +101,19 @@ public:
     return height_matrix.GetSize();
   }
 
-#ifdef ENABLE_OPENGL
+  /**
+   * Discard the previous scan, e.g. because the terrain has changed.
+   */
   void Invalidate() noexcept {
+#ifdef ENABLE_OPENGL
     bounds.SetInvalid();
+#else
+    scan_projection = {};
+#endif
   }
 
+#ifdef ENABLE_OPENGL
+
   /**
    * Calculate a new #quantisation_pixels value.
    *
@@ -147,4 +182,19 @@ protected:
 
 private:
   void ContourStart(unsigned contour_height_scale) noexcept;
+
+#ifndef ENABLE_OPENGL
+  /**
+   * Check whether the given projection differs from #scan_projection
+   * only by a translation, so the #HeightMatrix can be shifted
+   * instead of being scanned again.  The translation is rounded to
+   * whole cells, i.e. the terrain image may be off by up to half a
+   * cell until the next full scan.
+   *
+   * @return the position of the projection's top-left cell within
+   * the #scan_projection matrix
+   */
+  [[gnu::pure]]
+  std::optional<IntPoint2D> FindScanShift(const WindowProjection &projection) const noexcept;
+#endif
 };
@@ -0,0 +1,393 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "RasterShading.hpp"
+#include "util/Compiler.h"
+
+#include <cassert>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wcast-align"
+#endif
+
+namespace RasterShading {
+
+/**
+ * Values below this one are "special".
+ */
+static constexpr int16_t SPECIAL_BELOW = -29999;
+static_assert(!TerrainHeight(SPECIAL_BELOW).IsSpecial());
+static_assert(TerrainHeight(SPECIAL_BELOW - 1).IsSpecial());
+
+#ifdef __SSE2__
+
+static constexpr std::size_t QUANTISE_STEP = 16;
+static constexpr std::size_t ILLUMINATION_STEP = 8;
+
+[[gnu::always_inline]]
+static inline __m128i
+LoadHeights(const TerrainHeight *p) noexcept
+{
+  return _mm_loadu_si128((const __m128i *)p);
+}
+
+[[gnu::always_inline]]
+static inline __m128i
+QuantiseHeights8(__m128i v, __m128i shift) noexcept
+{
+  v = _mm_max_epi16(v, _mm_setzero_si128());
+  v = _mm_srl_epi16(v, shift);
+  return _mm_min_epi16(v, _mm_set1_epi16(254));
+}
+
+static std::size_t
+QuantiseHeightRowSIMD(uint8_t *gcc_restrict dest,
+                      const TerrainHeight *gcc_restrict src,
+                      std::size_t n, unsigned _shift) noexcept
+{
+  const __m128i shift = _mm_cvtsi32_si128(_shift);
+
+  std::size_t i = 0;
+  for (; i + QUANTISE_STEP <= n; i += QUANTISE_STEP) {
+    const __m128i lo = QuantiseHeights8(LoadHeights(src + i), shift);
+    const __m128i hi = QuantiseHeights8(LoadHeights(src + i + 8), shift);
+    _mm_storeu_si128((__m128i *)(dest + i), _mm_packus_epi16(lo, hi));
+  }
+
+  return i;
+}
+
+struct IlluminationConstants {
+  __m128 p20, p31, dd2_sz, dd2_square, sx, sy, sz, contrast;
+
+  IlluminationConstants(unsigned _p20, unsigned _p31,
+                        const SlopeParameters &sp) noexcept {
+    const float dd2 = float(_p20 * _p31 * sp.height_slope_factor);
+    p20 = _mm_set1_ps(float(_p20));
+    p31 = _mm_set1_ps(float(_p31));
+    dd2_sz = _mm_set1_ps(dd2 * float(sp.sz));
+    dd2_square = _mm_set1_ps(dd2 * dd2);
+    sx = _mm_set1_ps(float(sp.sx));
+    sy = _mm_set1_ps(float(sp.sy));
+    sz = _mm_set1_ps(float(sp.sz));
+    contrast = _mm_set1_ps(float(sp.contrast));
+  }
+};
+
+/**
+ * Sign-extend four 16 bit integers and convert them to float.
+ */
+[[gnu::always_inline]]
+static inline __m128
+ToFloat(__m128i v) noexcept
+{
+  return _mm_cvtepi32_ps(_mm_srai_epi32(v, 16));
+}
+
+[[gnu::always_inline]]
+static inline __m128i
+Illuminate4(__m128 p22, __m128 p32, const IlluminationConstants &c) noexcept
+{
+  const __m128 dd0 = _mm_mul_ps(p22, c.p31);
+  const __m128 dd1 = _mm_mul_ps(p32, c.p20);
+
+  const __m128 num = _mm_add_ps(_mm_add_ps(c.dd2_sz, _mm_mul_ps(dd0, c.sx)),
+                                _mm_mul_ps(dd1, c.sy));
+  const __m128 square_mag = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dd0, dd0),
+                                                  _mm_mul_ps(dd1, dd1)),
+                                       c.dd2_square);
+
+  const __m128i mag = _mm_or_si128(_mm_cvttps_epi32(_mm_sqrt_ps(square_mag)),
+                                   _mm_set1_epi32(1));
+  const __m128 sval =
+    _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_div_ps(num, _mm_cvtepi32_ps(mag))));
+
+  __m128 sindex = _mm_mul_ps(_mm_mul_ps(_mm_sub_ps(sval, c.sz), c.contrast),
+                             _mm_set1_ps(1.f / 128));
+  sindex = _mm_min_ps(_mm_max_ps(sindex, _mm_set1_ps(-63)),
+                      _mm_set1_ps(63));
+  return _mm_cvttps_epi32(sindex);
+}
+
+[[gnu::always_inline]]
+static inline __m128i
+ClipHeightDelta8(__m128i a, __m128i b) noexcept
+{
+  const __m128i d = _mm_subs_epi16(a, b);
+  return _mm_min_epi16(_mm_max_epi16(d, _mm_set1_epi16(-512)),
+                       _mm_set1_epi16(512));
+}
+
+static std::size_t
+CalculateIlluminationRowSIMD(int8_t *gcc_restrict dest,
+                             const TerrainHeight *gcc_restrict src,
+                             std::size_t n,
+                             unsigned column_offset,
+                             std::size_t row_minus_offset,
+                             std::size_t row_plus_offset,
+                             unsigned p31,
+                             const SlopeParameters &sp) noexcept
+{
+  const IlluminationConstants c(column_offset * 2, p31, sp);
+  const __m128i special_below = _mm_set1_epi16(SPECIAL_BELOW);
+  const __m128i no_slope = _mm_set1_epi16(NO_SLOPE);
+
+  std::size_t i = 0;
+  for (; i + ILLUMINATION_STEP <= n; i += ILLUMINATION_STEP) {
+    const TerrainHeight *p = src + i;
+    const __m128i above = LoadHeights(p - row_minus_offset);
+    const __m128i below = LoadHeights(p + row_plus_offset);
+    const __m128i left = LoadHeights(p - column_offset);
+    const __m128i right = LoadHeights(p + column_offset);
+
+    const __m128i special =
+      _mm_or_si128(_mm_or_si128(_mm_cmplt_epi16(above, special_below),
+                                _mm_cmplt_epi16(below, special_below)),
+                   _mm_or_si128(_mm_cmplt_epi16(left, special_below),
+                                _mm_cmplt_epi16(right, special_below)));
+
+    const __m128i p32 = ClipHeightDelta8(above, below);
+    const __m128i p22 = ClipHeightDelta8(right, left);
+
+    const __m128i lo = Illuminate4(ToFloat(_mm_unpacklo_epi16(p22, p22)),
+                                   ToFloat(_mm_unpacklo_epi16(p32, p32)),
+                                   c);
+    const __m128i hi = Illuminate4(ToFloat(_mm_unpackhi_epi16(p22, p22)),
+                                   ToFloat(_mm_unpackhi_epi16(p32, p32)),
+                                   c);
+
+    __m128i result = _mm_packs_epi32(lo, hi);
+    result = _mm_or_si128(_mm_and_si128(special, no_slope),
+                          _mm_andnot_si128(special, result));
+    _mm_storel_epi64((__m128i *)(dest + i), _mm_packs_epi16(result, result));
+  }
+
+  return i;
+}
+
+#elif defined(__ARM_NEON)
+
+static constexpr std::size_t QUANTISE_STEP = 8;
+static constexpr std::size_t ILLUMINATION_STEP = 8;
+
+[[gnu::always_inline]]
+static inline int16x8_t
+LoadHeights(const TerrainHeight *p) noexcept
+{
+  return vld1q_s16((const int16_t *)p);
+}
+
+static std::size_t
+QuantiseHeightRowSIMD(uint8_t *gcc_restrict dest,
+                      const TerrainHeight *gcc_restrict src,
+                      std::size_t n, unsigned _shift) noexcept
+{
+  const int16x8_t shift = vdupq_n_s16(-int16_t(_shift));
+  const uint16x8_t max = vdupq_n_u16(254);
+
+  std::size_t i = 0;
+  for (; i + QUANTISE_STEP <= n; i += QUANTISE_STEP) {
+    const int16x8_t v = vmaxq_s16(LoadHeights(src + i), vdupq_n_s16(0));
+    const uint16x8_t q = vminq_u16(vshlq_u16(vreinterpretq_u16_s16(v), shift),
+                                   max);
+    vst1_u8(dest + i, vmovn_u16(q));
+  }
+
+  return i;
+}
+
+struct IlluminationConstants {
+  float32x4_t p20, p31, dd2_sz, dd2_square, sz, contrast;
+  float sx, sy;
+
+  IlluminationConstants(unsigned _p20, unsigned _p31,
+                        const SlopeParameters &sp) noexcept {
+    const float dd2 = float(_p20 * _p31 * sp.height_slope_factor);
+    p20 = vdupq_n_f32(float(_p20));
+    p31 = vdupq_n_f32(float(_p31));
+    dd2_sz = vdupq_n_f32(dd2 * float(sp.sz));
+    dd2_square = vdupq_n_f32(dd2 * dd2);
+    sz = vdupq_n_f32(float(sp.sz));
+    contrast = vdupq_n_f32(float(sp.contrast));
+    sx = float(sp.sx);
+    sy = float(sp.sy);
+  }
+};
+
+[[gnu::always_inline]]
+static inline float32x4_t
+SquareRoot(float32x4_t v) noexcept
+{
+#ifdef __aarch64__
+  return vsqrtq_f32(v);
+#else
+  /* ARMv7 NEON has no square root instruction; use the reciprocal
+     square root estimate with two Newton-Raphson steps (v is never
+     zero here) */
+  float32x4_t r = vrsqrteq_f32(v);
+  r = vmulq_f32(r, vrsqrtsq_f32(vmulq_f32(v, r), r));
+  r = vmulq_f32(r, vrsqrtsq_f32(vmulq_f32(v, r), r));
+  return vmulq_f32(v, r);
+#endif
+}
+
+[[gnu::always_inline]]
+static inline float32x4_t
+Divide(float32x4_t a, float32x4_t b) noexcept
+{
+#ifdef __aarch64__
+  return vdivq_f32(a, b);
+#else
+  /* ARMv7 NEON has no division instruction; use the reciprocal
+     estimate with two Newton-Raphson steps */
+  float32x4_t r = vrecpeq_f32(b);
+  r = vmulq_f32(r, vrecpsq_f32(b, r));
+  r = vmulq_f32(r, vrecpsq_f32(b, r));
+  return vmulq_f32(a, r);
+#endif
+}
+
+[[gnu::always_inline]]
+static inline int32x4_t
+Illuminate4(int16x4_t _p22, int16x4_t _p32,
+            const IlluminationConstants &c) noexcept
+{
+  const float32x4_t dd0 = vmulq_f32(vcvtq_f32_s32(vmovl_s16(_p22)), c.p31);
+  const float32x4_t dd1 = vmulq_f32(vcvtq_f32_s32(vmovl_s16(_p32)), c.p20);
+
+  const float32x4_t num = vaddq_f32(vaddq_f32(c.dd2_sz, vmulq_n_f32(dd0, c.sx)),
+                                    vmulq_n_f32(dd1, c.sy));
+  const float32x4_t square_mag =
+    vaddq_f32(vaddq_f32(vmulq_f32(dd0, dd0), vmulq_f32(dd1, dd1)),
+              c.dd2_square);
+
+  const int32x4_t mag = vorrq_s32(vcvtq_s32_f32(SquareRoot(square_mag)),
+                                  vdupq_n_s32(1));
+  const float32x4_t sval =
+    vcvtq_f32_s32(vcvtq_s32_f32(Divide(num, vcvtq_f32_s32(mag))));
+
+  float32x4_t sindex = vmulq_n_f32(vmulq_f32(vsubq_f32(sval, c.sz),
+                                             c.contrast),
+                                   1.f / 128);
+  sindex = vminq_f32(vmaxq_f32(sindex, vdupq_n_f32(-63)), vdupq_n_f32(63));
+  return vcvtq_s32_f32(sindex);
+}
+
+[[gnu::always_inline]]
+static inline int16x8_t
+ClipHeightDelta8(int16x8_t a, int16x8_t b) noexcept
+{
+  const int16x8_t d = vqsubq_s16(a, b);
+  return vminq_s16(vmaxq_s16(d, vdupq_n_s16(-512)), vdupq_n_s16(512));
+}
+
+static std::size_t
+CalculateIlluminationRowSIMD(int8_t *gcc_restrict dest,
+                             const TerrainHeight *gcc_restrict src,
+                             std::size_t n,
+                             unsigned column_offset,
+                             std::size_t row_minus_offset,
+                             std::size_t row_plus_offset,
+                             unsigned p31,
+                             const SlopeParameters &sp) noexcept
+{
+  const IlluminationConstants c(column_offset * 2, p31, sp);
+  const int16x8_t special_below = vdupq_n_s16(SPECIAL_BELOW);
+  const int16x8_t no_slope = vdupq_n_s16(NO_SLOPE);
+
+  std::size_t i = 0;
+  for (; i + ILLUMINATION_STEP <= n; i += ILLUMINATION_STEP) {
+    const TerrainHeight *p = src + i;
+    const int16x8_t above = LoadHeights(p - row_minus_offset);
+    const int16x8_t below = LoadHeights(p + row_plus_offset);
+    const int16x8_t left = LoadHeights(p - column_offset);
+    const int16x8_t right = LoadHeights(p + column_offset);
+
+    const uint16x8_t special =
+      vorrq_u16(vorrq_u16(vcltq_s16(above, special_below),
+                          vcltq_s16(below, special_below)),
+                vorrq_u16(vcltq_s16(left, special_below),
+                          vcltq_s16(right, special_below)));
+
+    const int16x8_t p32 = ClipHeightDelta8(above, below);
+    const int16x8_t p22 = ClipHeightDelta8(right, left);
+
+    const int32x4_t lo = Illuminate4(vget_low_s16(p22), vget_low_s16(p32), c);
+    const int32x4_t hi = Illuminate4(vget_high_s16(p22), vget_high_s16(p32), c);
+
+    const int16x8_t result = vbslq_s16(special, no_slope,
+                                       vcombine_s16(vmovn_s32(lo),
+                                                    vmovn_s32(hi)));
+    vst1_s8(dest + i, vmovn_s16(result));
+  }
+
+  return i;
+}
+
+#else
+
+static constexpr std::size_t
+QuantiseHeightRowSIMD(uint8_t *, const TerrainHeight *,
+                      std::size_t, unsigned) noexcept
+{
+  return 0;
+}
+
+static constexpr std::size_t
+CalculateIlluminationRowSIMD(int8_t *, const TerrainHeight *, std::size_t,
+                             unsigned, std::size_t, std::size_t,
+                             unsigned, const SlopeParameters &) noexcept
+{
+  return 0;
+}
+
+#endif
+
+void
+QuantiseHeightRow(uint8_t *dest, const TerrainHeight *src, std::size_t n,
+                  unsigned shift) noexcept
+{
+  for (std::size_t i = QuantiseHeightRowSIMD(dest, src, n, shift); i < n; ++i)
+    dest[i] = QuantiseHeight(src[i], shift);
+}
+
+void
+CalculateIlluminationRow(int8_t *dest, const TerrainHeight *src,
+                         std::size_t n,
+                         unsigned column_offset,
+                         std::size_t row_minus_offset,
+                         std::size_t row_plus_offset,
+                         unsigned p31,
+                         const SlopeParameters &sp) noexcept
+{
+  assert(column_offset > 0);
+  assert(p31 > 0);
+  assert(sp.height_slope_factor > 0);
+
+  std::size_t i = CalculateIlluminationRowSIMD(dest, src, n, column_offset,
+                                               row_minus_offset,
+                                               row_plus_offset,
+                                               p31, sp);
+
+  for (; i < n; ++i) {
+    const TerrainHeight *p = src + i;
+    dest[i] = CalculateIllumination(p[-(std::ptrdiff_t)row_minus_offset],
+                                    p[row_plus_offset],
+                                    p[-(std::ptrdiff_t)column_offset],
+                                    p[column_offset],
+                                    column_offset * 2, p31, sp);
+  }
+}
+
+} // namespace RasterShading
+
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif
@@ -0,0 +1,122 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Height.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * The per-pixel math of #RasterRenderer.  The "Row" functions operate
+ * on a whole row of pixels; depending on the target CPU, they are
+ * implemented with SSE2 or NEON instructions.  The scalar functions
+ * are the reference implementation, and are used for the remainders
+ * and for the image edges.
+ */
+namespace RasterShading {
+
+/**
+ * Illumination value for pixels whose slope could not be calculated
+ * because one of the neighbours is "special" (water or invalid).
+ */
+static constexpr int8_t NO_SLOPE = INT8_MIN;
+
+struct SlopeParameters {
+  /**
+   * The sun vector.
+   */
+  int sx, sy, sz;
+
+  int contrast;
+
+  unsigned height_slope_factor;
+};
+
+/**
+ * Convert a terrain height to an index for the color table (or to a
+ * contour interval): negative and special values are mapped to 0, and
+ * the result is clipped to 254 (255 is reserved for water).
+ */
+[[gnu::const]]
+static inline unsigned
+QuantiseHeight(TerrainHeight h, unsigned shift) noexcept
+{
+  return std::min(254u, unsigned(std::max(0, int(h.GetValue()))) >> shift);
+}
+
+/**
+ * Clip the difference between two adjacent terrain height values to
+ * sane bounds.  This works around integer overflows in the
+ * slope formula when the map file is broken.
+ */
+[[gnu::const]]
+static inline int
+ClipHeightDelta(TerrainHeight a, TerrainHeight b) noexcept
+{
+  return std::clamp(a.GetValue() - b.GetValue(), -512, 512);
+}
+
+/**
+ * Calculate the illumination of one pixel from its four neighbours.
+ *
+ * @param p20 the distance between the left and the right neighbour
+ * @param p31 the distance between the upper and the lower neighbour
+ * @return a value between -63 and 63 or #NO_SLOPE
+ */
+[[gnu::pure]]
+static inline int
+CalculateIllumination(TerrainHeight above, TerrainHeight below,
+                      TerrainHeight left, TerrainHeight right,
+                      unsigned p20, unsigned p31,
+                      const SlopeParameters &sp) noexcept
+{
+  if (above.IsSpecial() || below.IsSpecial() ||
+      left.IsSpecial() || right.IsSpecial()) [[unlikely]]
+    return NO_SLOPE;
+
+  const int p32 = ClipHeightDelta(above, below);
+  const int p22 = ClipHeightDelta(right, left);
+
+  const float dd0 = float(p22 * int(p31));
+  const float dd1 = float(int(p20) * p32);
+  const float dd2 = float(p20 * p31 * sp.height_slope_factor);
+  const float num = dd2 * float(sp.sz) + dd0 * float(sp.sx) + dd1 * float(sp.sy);
+  const int mag = int(std::sqrt(dd0 * dd0 + dd1 * dd1 + dd2 * dd2));
+  const int sval = int(num / float(mag | 1));
+  const float sindex = float(sval - sp.sz) * float(sp.contrast) * (1.f / 128);
+  return int(std::clamp(sindex, -63.f, 63.f));
+}
+
+/**
+ * Apply QuantiseHeight() to a row of pixels.
+ */
+void
+QuantiseHeightRow(uint8_t *dest, const TerrainHeight *src, std::size_t n,
+                  unsigned shift) noexcept;
+
+/**
+ * Apply CalculateIllumination() to a row of pixels which are not at
+ * the image edge, i.e. all four neighbours are within the height
+ * matrix.
+ *
+ * @param column_offset the distance to the left and right neighbour
+ * (i.e. half of "p20")
+ * @param row_minus_offset the (negative) offset of the upper neighbour
+ * @param row_plus_offset the offset of the lower neighbour
+ * @param p31 the distance between the upper and the lower neighbour
+ * (in rows); must be positive
+ */
+void
+CalculateIlluminationRow(int8_t *dest, const TerrainHeight *src,
+                         std::size_t n,
+                         unsigned column_offset,
+                         std::size_t row_minus_offset,
+                         std::size_t row_plus_offset,
+                         unsigned p31,
+                         const SlopeParameters &sp) noexcept;
+
+} // namespace RasterShading
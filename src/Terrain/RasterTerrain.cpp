@@ -3,19 +3,37 @@
 
 #include "RasterTerrain.hpp"
 #include "Loader.hpp"
+#include "TileStore.hpp"
 #include "Profile/Profile.hpp"
 #include "io/ZipArchive.hpp"
 #include "io/FileCache.hpp"
 #include "io/FileOutputStream.hxx"
+#include "io/FileMapping.hpp"
 #include "io/BufferedOutputStream.hxx"
 #include "io/Reader.hxx"
 #include "io/BufferedReader.hxx"
 #include "system/ConvertPathName.hpp"
 #include "Operation/Operation.hpp"
+#include "thread/Parallel.hpp"
 #include "util/ConvertString.hpp"
+#include "util/StaticArray.hxx"
 #include "LogFile.hpp"
 
+#include <algorithm>
+
 static const TCHAR *const terrain_cache_name = _T("terrain");
+static const TCHAR *const terrain_tiles_cache_name = _T("terrain-tiles");
+
+/**
+ * Keep a copy of all decoded tiles in the #FileCache?  This trades
+ * disk space for much less CPU usage while the map is being panned
+ * or zoomed.  Disabled on Android, where storage is scarce.
+ */
+#ifdef ANDROID
+static constexpr bool enable_tile_store = false;
+#else
+static constexpr bool enable_tile_store = true;
+#endif
 
 inline bool
 RasterTerrain::LoadCache(FileCache &cache, Path path)
@@ -45,18 +63,53 @@ RasterTerrain::SaveCache(FileCache &cache, Path path) const
   os->Commit();
 }
 
+void
+RasterTerrain::LoadTileStore(FileCache &cache, Path path) noexcept
+{
+  auto mapping = cache.Map(terrain_tiles_cache_name, path);
+  if (!mapping)
+    return;
+
+  try {
+    map.GetTileCache().SetTileStore(std::make_unique<RasterTileStore>(std::move(mapping)));
+  } catch (...) {
+    LogError(std::current_exception(), "Failed to load terrain tile store");
+    cache.Flush(terrain_tiles_cache_name);
+  }
+}
+
+std::unique_ptr<RasterTileStoreWriter>
+RasterTerrain::CreateTileStore(FileCache &cache, Path path) noexcept
+try {
+  return std::make_unique<RasterTileStoreWriter>(cache.Save(terrain_tiles_cache_name,
+                                                            path));
+} catch (...) {
+  LogError(std::current_exception(), "Failed to create terrain tile store");
+  return nullptr;
+}
+
 inline void
 RasterTerrain::Load(Path path, FileCache *cache,
                     OperationEnvironment &operation)
 {
   try {
-    if (LoadCache(cache, path))
+    if (LoadCache(cache, path)) {
+      if (enable_tile_store)
+        LoadTileStore(*cache, path);
       return;
+    }
   } catch (...) {
     LogError(std::current_exception(), "Failed to load terrain cache");
   }
 
-  LoadTerrainOverview(archive.get(), map.GetTileCache(), operation);
+  /* the overview scan decodes all tiles anyway; this is the chance
+     to populate the tile store at little extra cost */
+  std::unique_ptr<RasterTileStoreWriter> store_writer;
+  if (enable_tile_store && cache != nullptr)
+    store_writer = CreateTileStore(*cache, path);
+
+  LoadTerrainOverview(archive.get(), map.GetTileCache(), operation,
+                      store_writer.get());
 
   map.UpdateProjection();
 
@@ -67,13 +120,23 @@ RasterTerrain::Load(Path path, FileCache *cache,
       LogError(std::current_exception(), "Failed to save terrain cache");
     }
   }
+
+  if (store_writer) {
+    try {
+      store_writer->Commit();
+      store_writer.reset();
+      LoadTileStore(*cache, path);
+    } catch (...) {
+      LogError(std::current_exception(), "Failed to save terrain tile store");
+    }
+  }
 }
 
 std::unique_ptr<RasterTerrain>
 RasterTerrain::OpenTerrain(FileCache *cache, Path path,
                            OperationEnvironment &operation)
 {
-  auto rt = std::make_unique<RasterTerrain>(ZipArchive{path});
+  auto rt = std::make_unique<RasterTerrain>(ZipArchive{path}, path);
   rt->Load(path, cache, operation);
   return rt;
 }
@@ -91,6 +154,23 @@ try {
   return nullptr;
 }
 
+inline void
+RasterTerrain::OpenDecoderArchives() noexcept
+{
+  const unsigned n_threads = std::min(GetProcessorCount(),
+                                      MAX_DECODER_THREADS);
+
+  while (!decoder_archives_failed &&
+         decoder_archives.size() + 1 < n_threads) {
+    try {
+      decoder_archives.emplace_back(path);
+    } catch (...) {
+      LogError(std::current_exception(), "Failed to open map file");
+      decoder_archives_failed = true;
+    }
+  }
+}
+
 bool
 RasterTerrain::UpdateTiles(const GeoPoint &location, double radius) noexcept
 {
@@ -98,8 +178,15 @@ RasterTerrain::UpdateTiles(const GeoPoint &location, double radius) noexcept
   if (!tile_cache.IsValid())
     return false;
 
+  OpenDecoderArchives();
+
+  StaticArray<struct zzip_dir *, MAX_DECODER_THREADS> dirs;
+  dirs.append(archive.get());
+  for (auto &i : decoder_archives)
+    dirs.append(i.get());
+
   try {
-    UpdateTerrainTiles(archive.get(), tile_cache, mutex,
+    UpdateTerrainTiles(dirs, tile_cache, mutex,
                        map.GetProjection(), location, radius);
   } catch (...) {
     LogError(std::current_exception(), "Failed to update terrain tiles");
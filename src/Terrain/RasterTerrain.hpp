@@ -7,12 +7,15 @@
 #include "Geo/GeoPoint.hpp"
 #include "thread/Guard.hpp"
 #include "io/ZipArchive.hpp"
+#include "system/Path.hpp"
 
 #include <memory>
+#include <vector>
 
 class Path;
 class FileCache;
 class OperationEnvironment;
+class RasterTileStoreWriter;
 
 /**
  * Class to manage raster terrain database, potentially with caching
@@ -25,16 +28,36 @@ public:
   friend class WaypointVisitorMap; // for intersection rendering
 
 private:
+  /**
+   * The maximum number of threads decoding tiles in parallel.
+   */
+  static constexpr unsigned MAX_DECODER_THREADS = 4;
+
+  const AllocatedPath path;
+
   ZipArchive archive;
 
+  /**
+   * Additional handles to the map file, one for each additional
+   * decoder thread (libzzip handles must not be shared among
+   * threads).  They are opened on demand by UpdateTiles().
+   */
+  std::vector<ZipArchive> decoder_archives;
+
+  /**
+   * Has opening one of the #decoder_archives failed?  Then don't try
+   * again, and use only the ones which have been opened already.
+   */
+  bool decoder_archives_failed = false;
+
   RasterMap map;
 
 public:
   /**
    * Constructor.  Returns uninitialised object.
    */
-  explicit RasterTerrain(ZipArchive &&_archive) noexcept
-    :Guard<RasterMap>(map), archive(std::move(_archive)) {}
+  RasterTerrain(ZipArchive &&_archive, Path _path) noexcept
+    :Guard<RasterMap>(map), path(_path), archive(std::move(_archive)) {}
 
   const Serial &GetSerial() const noexcept {
     return map.GetSerial();
@@ -84,9 +107,27 @@ private:
    */
   void SaveCache(FileCache &cache, Path path) const;
 
+  /**
+   * Map the terrain tile store (if one exists).
+   */
+  void LoadTileStore(FileCache &cache, Path path) noexcept;
+
+  /**
+   * Create a new terrain tile store which will be filled while the
+   * overview is being loaded.  Returns nullptr on error.
+   */
+  static std::unique_ptr<RasterTileStoreWriter> CreateTileStore(FileCache &cache,
+                                                                Path path) noexcept;
+
   /**
    * Throws on error.
    */
   void Load(Path path, FileCache *cache,
             OperationEnvironment &operation);
+
+  /**
+   * Open the #decoder_archives (if not already done and if no
+   * previous attempt has failed).
+   */
+  void OpenDecoderArchives() noexcept;
 };
@@ -2,6 +2,7 @@
 // Copyright The XCSoar Project
 
 #include "RasterTileCache.hpp"
+#include "TileStore.hpp"
 #include "Math/Angle.hpp"
 #include "io/BufferedOutputStream.hxx"
 #include "io/BufferedReader.hxx"
@@ -16,6 +17,13 @@ extern "C" {
 #include <string.h>
 #include <algorithm>
 
+RasterTileCache::RasterTileCache() noexcept
+{
+  Reset();
+}
+
+RasterTileCache::~RasterTileCache() noexcept = default;
+
 static void
 CopyOverviewRow(TerrainHeight *gcc_restrict dest, const jas_seqent_t *gcc_restrict src,
                 unsigned width, unsigned skip) noexcept
@@ -68,6 +76,31 @@ RasterTileCache::PutTileData(unsigned index,
   tile.CopyFrom(m);
 }
 
+bool
+RasterTileCache::LoadStoredTiles() noexcept
+{
+  bool remaining = false;
+
+  for (const unsigned i : request_tiles) {
+    RasterTile &tile = tiles.GetLinear(i);
+    if (!tile.IsRequested() || tile.IsLoaded())
+      continue;
+
+    const auto data = tile_store != nullptr
+      ? tile_store->GetTile(i, tile.size)
+      : std::span<const TerrainHeight>{};
+    if (data.empty()) {
+      remaining = true;
+      continue;
+    }
+
+    tile.buffer.Attach(data, tile.size);
+    tile.ClearRequest();
+  }
+
+  return remaining;
+}
+
 struct RTDistanceSort {
   const RasterTileCache &rtc;
 
@@ -177,6 +210,79 @@ RasterTileCache::GetInterpolatedHeight(RasterLocation l) const noexcept
   return overview.GetInterpolated({RasterTraits::ToOverview(l.x), RasterTraits::ToOverview(l.y)});
 }
 
+/**
+ * Remembers the tile which was used for the previous point of a
+ * batch, to skip the division and the grid lookup if the next point
+ * is in the same tile.
+ */
+class RasterTileCache::TileCursor {
+  const RasterTileCache &cache;
+
+  const RasterTile *tile = nullptr;
+  RasterLocation start, end;
+
+public:
+  explicit TileCursor(const RasterTileCache &_cache) noexcept
+    :cache(_cache) {}
+
+  /**
+   * @param p a pixel location within the map
+   */
+  const RasterTile &Get(RasterLocation p) noexcept {
+    assert(p.x < cache.size.x);
+    assert(p.y < cache.size.y);
+
+    if (tile == nullptr ||
+        p.x < start.x || p.x >= end.x ||
+        p.y < start.y || p.y >= end.y) [[unlikely]] {
+      const RasterLocation t{p.x / cache.tile_size.x, p.y / cache.tile_size.y};
+      tile = &cache.tiles.Get(t.x, t.y);
+      start = {t.x * cache.tile_size.x, t.y * cache.tile_size.y};
+      end = start + RasterLocation{cache.tile_size.x, cache.tile_size.y};
+    }
+
+    return *tile;
+  }
+};
+
+void
+RasterTileCache::GetHeights(std::span<const RasterLocation> points,
+                            TerrainHeight *dest) const noexcept
+{
+  TileCursor cursor(*this);
+
+  for (const auto p : points) {
+    if (p.x >= size.x || p.y >= size.y)
+      *dest++ = TerrainHeight::Invalid();
+    else if (const auto &tile = cursor.Get(p); tile.IsLoaded())
+      *dest++ = tile.GetHeight(p);
+    else
+      *dest++ = overview.GetInterpolated(p << (RasterTraits::SUBPIXEL_BITS - RasterTraits::OVERVIEW_BITS));
+  }
+}
+
+void
+RasterTileCache::GetInterpolatedHeights(std::span<const RasterLocation> points,
+                                        TerrainHeight *dest) const noexcept
+{
+  TileCursor cursor(*this);
+
+  for (const auto l : points) {
+    if (l.x >= overview_size_fine.x || l.y >= overview_size_fine.y) {
+      *dest++ = TerrainHeight::Invalid();
+      continue;
+    }
+
+    const auto [px, ix] = RasterTraits::CalcSubpixel(l.x);
+    const auto [py, iy] = RasterTraits::CalcSubpixel(l.y);
+
+    if (const auto &tile = cursor.Get({px, py}); tile.IsLoaded())
+      *dest++ = tile.GetInterpolatedHeight(px, py, ix, iy);
+    else
+      *dest++ = overview.GetInterpolated({RasterTraits::ToOverview(l.x), RasterTraits::ToOverview(l.y)});
+  }
+}
+
 void
 RasterTileCache::SetSize(UnsignedPoint2D _size,
                          Point2D<uint_least16_t> _tile_size,
@@ -219,6 +325,21 @@ RasterTileCache::Reset() noexcept
 
   for (auto &i : tiles)
     i.Unload();
+
+  /* after all tiles have been unloaded, nobody refers to the mapped
+     tile store anymore */
+  tile_store.reset();
+}
+
+void
+RasterTileCache::SetTileStore(std::unique_ptr<RasterTileStore> &&_tile_store) noexcept
+{
+  /* unload tiles which may refer to the old tile store */
+  for (auto &i : tiles)
+    if (i.buffer.IsAttached())
+      i.Unload();
+
+  tile_store = std::move(_tile_store);
 }
 
 const RasterTileCache::MarkerSegmentInfo *
@@ -7,12 +7,16 @@
 #include "RasterTile.hpp"
 #include "RasterLocation.hpp"
 #include "Geo/GeoBounds.hpp"
+#include "util/AllocatedGrid.hxx"
 #include "util/StaticArray.hxx"
 #include "util/Serial.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <memory>
 #include <optional>
+#include <span>
 
 static constexpr unsigned  RASTER_SLOPE_FACT = 12;
 
@@ -20,6 +24,7 @@ struct jas_matrix;
 struct GridLocation;
 class BufferedOutputStream;
 class BufferedReader;
+class RasterTileStore;
 
 class RasterTileCache {
   static constexpr unsigned MAX_RTC_TILES = 4096;
@@ -105,6 +110,13 @@ protected:
 
   StaticArray<MarkerSegmentInfo, 8192> segments;
 
+  /**
+   * An optional memory-mapped file containing decoded tiles.  If
+   * present, tiles are activated from there instead of being decoded
+   * by the JPEG2000 decoder.
+   */
+  std::unique_ptr<RasterTileStore> tile_store;
+
   /**
    * An array that is used to sort the requested tiles by distance.
    * This is only used by PollTiles() internally, but is stored in the
@@ -113,9 +125,8 @@ protected:
   StaticArray<uint16_t, MAX_RTC_TILES> request_tiles;
 
 public:
-  RasterTileCache() noexcept {
-    Reset();
-  }
+  RasterTileCache() noexcept;
+  ~RasterTileCache() noexcept;
 
   RasterTileCache(const RasterTileCache &) = delete;
   RasterTileCache &operator=(const RasterTileCache &) = delete;
@@ -127,6 +138,8 @@ public:
   }
 
 protected:
+  class TileCursor;
+
   void ScanTileLine(GridLocation start, GridLocation end,
                     TerrainHeight *buffer, unsigned size,
                     bool interpolate) const noexcept;
@@ -150,6 +163,25 @@ public:
   [[gnu::pure]]
   TerrainHeight GetInterpolatedHeight(RasterLocation p) const noexcept;
 
+  /**
+   * Call GetHeight() for each of the given pixel locations.
+   * Consecutive points within the same tile share the tile lookup;
+   * this is fastest if the points are sorted by proximity.
+   *
+   * @param dest an array with as many elements as #points
+   */
+  void GetHeights(std::span<const RasterLocation> points,
+                  TerrainHeight *dest) const noexcept;
+
+  /**
+   * Call GetInterpolatedHeight() for each of the given sub-pixel
+   * locations.
+   *
+   * @param dest an array with as many elements as #points
+   */
+  void GetInterpolatedHeights(std::span<const RasterLocation> points,
+                              TerrainHeight *dest) const noexcept;
+
   /**
    * Scan a straight line and fill the buffer with the specified
    * number of samples along the line.
@@ -219,10 +251,30 @@ public:
     return bounds.IsValid();
   }
 
+  /**
+   * Use the given tile store for loading tiles.  This must be called
+   * after the overview has been loaded, because Reset() discards the
+   * tile store.
+   */
+  void SetTileStore(std::unique_ptr<RasterTileStore> &&_tile_store) noexcept;
+
+  bool HasTileStore() const noexcept {
+    return tile_store != nullptr;
+  }
+
   const Serial &GetSerial() const noexcept {
     return serial;
   }
 
+  /**
+   * Returns the number of tiles which are currently loaded.
+   */
+  [[gnu::pure]]
+  unsigned CountLoadedTiles() const noexcept {
+    return std::count_if(tiles.begin(), tiles.end(),
+                         [](const RasterTile &tile){ return tile.IsLoaded(); });
+  }
+
   void Reset() noexcept;
 
   const GeoBounds &GetBounds() const noexcept {
@@ -260,6 +312,15 @@ public:
 
   bool PollTiles(SignedRasterLocation p, unsigned radius) noexcept;
 
+  /**
+   * Activate requested tiles from the tile store (if any), without
+   * decoding them.  Call this after PollTiles().
+   *
+   * @return true if there are still requested tiles which need to be
+   * decoded
+   */
+  bool LoadStoredTiles() noexcept;
+
   void PutTileData(unsigned index, const struct jas_matrix &m) noexcept;
 
   void FinishTileUpdate() noexcept;
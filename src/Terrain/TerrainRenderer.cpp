@@ -354,6 +354,11 @@ TerrainRenderer::Generate(const WindowProjection &map_projection,
     return true;
 
   compare_projection = CompareProjection(map_projection);
+
+  if (terrain_serial != terrain.GetSerial())
+    /* new tiles have been loaded: the old height matrix cannot be
+       reused */
+    raster_renderer.Invalidate();
 #endif
 
   terrain_serial = terrain.GetSerial();
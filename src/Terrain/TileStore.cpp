@@ -0,0 +1,148 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "TileStore.hpp"
+#include "io/FileMapping.hpp"
+#include "io/FileOutputStream.hxx"
+#include "util/SpanCast.hxx"
+
+extern "C" {
+#include "jasper/jas_seq.h"
+}
+
+#include <stdexcept>
+
+#include <string.h>
+
+using namespace RasterTileStoreFormat;
+
+/**
+ * Refuse to store more tiles than RasterTileCache can handle.
+ */
+static constexpr unsigned MAX_TILES = 4096;
+
+RasterTileStore::RasterTileStore(std::unique_ptr<FileMapping> &&_mapping)
+  :mapping(std::move(_mapping)), raw(*mapping)
+{
+  if (raw.size() < sizeof(Trailer))
+    throw std::runtime_error("Terrain tile store too small");
+
+  Trailer trailer;
+  memcpy(&trailer, raw.data() + raw.size() - sizeof(trailer),
+         sizeof(trailer));
+
+  if (trailer.magic != MAGIC || trailer.version != VERSION ||
+      trailer.n_tiles == 0 || trailer.n_tiles > MAX_TILES ||
+      trailer.index_offset % ALIGNMENT != 0 ||
+      trailer.index_offset + trailer.n_tiles * sizeof(Entry) + sizeof(trailer) != raw.size())
+    throw std::runtime_error("Malformed terrain tile store");
+
+  index = FromBytesStrict<const Entry>(raw.subspan(trailer.index_offset,
+                                                   trailer.n_tiles * sizeof(Entry)));
+
+  for (const auto &e : index)
+    if (e.offset != 0 &&
+        (e.offset % ALIGNMENT != 0 ||
+         e.offset + uint64_t(e.width) * e.height * sizeof(TerrainHeight) > trailer.index_offset))
+      throw std::runtime_error("Malformed terrain tile store index");
+}
+
+RasterTileStore::~RasterTileStore() noexcept = default;
+
+std::span<const TerrainHeight>
+RasterTileStore::GetTile(unsigned i, RasterLocation size) const noexcept
+{
+  if (i >= index.size())
+    return {};
+
+  const auto &e = index[i];
+  if (e.offset == 0 || e.width != size.x || e.height != size.y)
+    return {};
+
+  return FromBytesStrict<const TerrainHeight>(raw.subspan(e.offset,
+                                                          size.Area() * sizeof(TerrainHeight)));
+}
+
+RasterTileStoreWriter::RasterTileStoreWriter(std::unique_ptr<FileOutputStream> &&_file) noexcept
+  :file(std::move(_file)), os(*file), position(file->Tell()) {}
+
+RasterTileStoreWriter::~RasterTileStoreWriter() noexcept = default;
+
+void
+RasterTileStoreWriter::Pad()
+{
+  static constexpr std::byte zero[ALIGNMENT]{};
+
+  const std::size_t n = (ALIGNMENT - position % ALIGNMENT) % ALIGNMENT;
+  os.Write(std::span{zero, n});
+  position += n;
+}
+
+inline void
+RasterTileStoreWriter::WriteTile(const struct jas_matrix &m)
+{
+  const unsigned width = m.numcols_, height = m.numrows_;
+
+  row.GrowDiscard(width);
+
+  for (unsigned y = 0; y != height; ++y) {
+    const jas_seqent_t *gcc_restrict src = m.rows_[y];
+    TerrainHeight *gcc_restrict dest = row.data();
+
+    for (unsigned x = 0; x < width; ++x)
+      dest[x] = TerrainHeight(src[x]);
+
+    os.Write(std::as_bytes(std::span{dest, width}));
+  }
+
+  position += uint64_t(width) * height * sizeof(TerrainHeight);
+}
+
+void
+RasterTileStoreWriter::Add(unsigned i, const struct jas_matrix &m) noexcept
+{
+  if (error || i >= MAX_TILES || m.numcols_ <= 0 || m.numrows_ <= 0)
+    return;
+
+  try {
+    if (position + uint64_t(m.numcols_) * m.numrows_ * sizeof(TerrainHeight) > MAX_SIZE)
+      throw std::runtime_error("Terrain tile store too large");
+
+    Pad();
+
+    if (i >= index.size())
+      index.resize(i + 1, Entry{});
+
+    auto &e = index[i];
+    e.offset = position;
+    e.width = m.numcols_;
+    e.height = m.numrows_;
+
+    WriteTile(m);
+  } catch (...) {
+    error = std::current_exception();
+  }
+}
+
+void
+RasterTileStoreWriter::Commit()
+{
+  if (error)
+    std::rethrow_exception(error);
+
+  if (index.empty())
+    throw std::runtime_error("No terrain tiles decoded");
+
+  Pad();
+
+  Trailer trailer{};
+  trailer.magic = MAGIC;
+  trailer.version = VERSION;
+  trailer.n_tiles = index.size();
+  trailer.index_offset = position;
+
+  os.Write(std::as_bytes(std::span{index}));
+  os.Write(ReferenceAsBytes(trailer));
+  os.Flush();
+  file->Commit();
+}
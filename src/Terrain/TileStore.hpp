@@ -0,0 +1,149 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "RasterLocation.hpp"
+#include "Height.hpp"
+#include "io/BufferedOutputStream.hxx"
+#include "util/AllocatedArray.hxx"
+
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <span>
+#include <vector>
+
+struct jas_matrix;
+class FileMapping;
+class FileOutputStream;
+
+/**
+ * On-disk layout of the "terrain tile store": a flat file containing
+ * the decoded 16 bit heights of all tiles, each one starting at an
+ * aligned file offset, so the file can be mapped into memory and
+ * tiles can be activated without running the JPEG2000 decoder.
+ *
+ * The tiles are followed by an index (one #Entry per tile) and a
+ * #Trailer at the very end of the file.  All offsets are absolute
+ * (i.e. include the #FileCache header).
+ */
+namespace RasterTileStoreFormat {
+
+static constexpr uint32_t MAGIC = 0x5452534c;
+static constexpr uint32_t VERSION = 1;
+
+/**
+ * Tiles and the index start at file offsets which are a multiple of
+ * this value.
+ */
+static constexpr std::size_t ALIGNMENT = 4096;
+
+/**
+ * Give up writing the tile store if it gets larger than this.  This
+ * must be smaller than the limit implemented by #FileMapping.
+ */
+static constexpr uint64_t MAX_SIZE = 768 * 1024 * 1024;
+
+struct Entry {
+  /**
+   * The file offset of the first value; 0 if this tile is not
+   * present.
+   */
+  uint64_t offset;
+
+  uint32_t width, height;
+};
+
+struct Trailer {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t n_tiles;
+  uint32_t reserved;
+  uint64_t index_offset;
+};
+
+} // namespace RasterTileStoreFormat
+
+/**
+ * Read-only access to a memory-mapped terrain tile store.
+ */
+class RasterTileStore {
+  std::unique_ptr<FileMapping> mapping;
+
+  std::span<const std::byte> raw;
+  std::span<const RasterTileStoreFormat::Entry> index;
+
+public:
+  /**
+   * Throws on error (malformed file).
+   */
+  explicit RasterTileStore(std::unique_ptr<FileMapping> &&_mapping);
+  ~RasterTileStore() noexcept;
+
+  RasterTileStore(const RasterTileStore &) = delete;
+  RasterTileStore &operator=(const RasterTileStore &) = delete;
+
+  /**
+   * Look up the decoded values of a tile.
+   *
+   * @param size the expected tile size
+   * @return the tile values (row by row) or an empty span if the
+   * tile is not present or has a different size
+   */
+  [[gnu::pure]]
+  std::span<const TerrainHeight> GetTile(unsigned i,
+                                         RasterLocation size) const noexcept;
+};
+
+/**
+ * Creates a terrain tile store while the JPEG2000 file is being
+ * decoded.
+ */
+class RasterTileStoreWriter {
+  const std::unique_ptr<FileOutputStream> file;
+
+  BufferedOutputStream os;
+
+  /**
+   * The current absolute file offset.
+   */
+  uint64_t position;
+
+  std::vector<RasterTileStoreFormat::Entry> index;
+
+  AllocatedArray<TerrainHeight> row;
+
+  /**
+   * The first error which occurred in Add().  It will be rethrown
+   * by Commit().
+   */
+  std::exception_ptr error;
+
+public:
+  /**
+   * @param _file a new file (e.g. obtained from FileCache::Save())
+   */
+  explicit RasterTileStoreWriter(std::unique_ptr<FileOutputStream> &&_file) noexcept;
+  ~RasterTileStoreWriter() noexcept;
+
+  RasterTileStoreWriter(const RasterTileStoreWriter &) = delete;
+  RasterTileStoreWriter &operator=(const RasterTileStoreWriter &) = delete;
+
+  /**
+   * Append a decoded tile.  Errors are postponed until Commit(),
+   * because this method is called from within the decoder.
+   */
+  void Add(unsigned i, const struct jas_matrix &m) noexcept;
+
+  /**
+   * Write the index and make the file visible.
+   *
+   * Throws on error.
+   */
+  void Commit();
+
+private:
+  void Pad();
+  void WriteTile(const struct jas_matrix &m);
+};
@@ -0,0 +1,83 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "AsyncCacheBuilder.hpp"
+#include "TopographyStore.hpp"
+#include "TopographyCache.hpp"
+#include "Job/Job.hpp"
+#include "io/ZipArchive.hpp"
+#include "io/ZipLineReader.hpp"
+#include "system/Path.hpp"
+#include "thread/Util.hpp"
+#include "LogFile.hpp"
+
+class AsyncTopographyCacheBuilder::BuilderJob final : public Job {
+  FileCache &cache;
+  const AllocatedPath path;
+  const unsigned layout_scale;
+
+public:
+  BuilderJob(FileCache &_cache, Path _path, unsigned _layout_scale) noexcept
+    :cache(_cache), path(_path), layout_scale(_layout_scale) {}
+
+  void Run(OperationEnvironment &env) override {
+    /* this is not urgent; don't slow down the UI and the
+       calculations */
+    SetThreadIdlePriority();
+
+    /* this uses its own ZipArchive, because the one of the
+       #TopographyStore in use must not be accessed by this thread */
+    ZipArchive archive{path};
+    ZipLineReaderA reader(archive.get(), "topology.tpl");
+
+    const TopographyCacheOptions options{
+      cache, path, layout_scale, true, &env,
+    };
+
+    /* the files are discarded; only the cache files remain */
+    TopographyStore store;
+    store.Load(reader, nullptr, archive.get(), &options);
+  }
+};
+
+AsyncTopographyCacheBuilder::AsyncTopographyCacheBuilder() noexcept = default;
+
+AsyncTopographyCacheBuilder::~AsyncTopographyCacheBuilder() noexcept
+{
+  Stop();
+}
+
+void
+AsyncTopographyCacheBuilder::Stop() noexcept
+{
+  if (!async.IsBusy())
+    return;
+
+  async.Cancel();
+
+  try {
+    async.Wait();
+  } catch (...) {
+    LogError(std::current_exception(),
+             "Failed to build topography cache");
+  }
+
+  job.reset();
+}
+
+void
+AsyncTopographyCacheBuilder::Start(FileCache &cache, Path path,
+                                   unsigned layout_scale) noexcept
+{
+  Stop();
+
+  job = std::make_unique<BuilderJob>(cache, path, layout_scale);
+
+  try {
+    async.Start(job.get(), env);
+  } catch (...) {
+    LogError(std::current_exception(),
+             "Failed to start the topography cache builder");
+    job.reset();
+  }
+}
@@ -0,0 +1,49 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Job/Async.hpp"
+#include "Operation/Operation.hpp"
+
+#include <memory>
+
+class FileCache;
+class Path;
+
+/**
+ * Builds the missing topography cache files (see
+ * #TopographyCacheFormat) of a map file in a separate thread.  This
+ * does not affect the #TopographyStore which is currently in use; it
+ * loads the new cache files the next time the map file is loaded.
+ */
+class AsyncTopographyCacheBuilder final {
+  class BuilderJob;
+
+  std::unique_ptr<BuilderJob> job;
+
+  NullOperationEnvironment env;
+
+  AsyncJobRunner async;
+
+public:
+  AsyncTopographyCacheBuilder() noexcept;
+
+  /**
+   * Cancels the job and waits for it to return.
+   */
+  ~AsyncTopographyCacheBuilder() noexcept;
+
+  /**
+   * Start building.  A job which is still running is cancelled.
+   *
+   * @param cache the cache; must remain valid until this object is
+   * destructed
+   * @param path the map file
+   * @param layout_scale see TopographyCacheOptions::layout_scale
+   */
+  void Start(FileCache &cache, Path path, unsigned layout_scale) noexcept;
+
+private:
+  void Stop() noexcept;
+};
@@ -48,12 +48,21 @@ TopographyThread::Tick() noexcept
   // TODO: call only once
   SetIdlePriority();
 
-  bool again = true;
-  while (next_projection.IsValid() && again && !IsStopped()) {
+  if (next_projection.IsValid() && !IsStopped()) {
     const WindowProjection projection = next_projection;
 
-    const ScopeUnlock unlock(mutex);
-    again = store.ScanVisibility(projection, 1) > 0;
+    bool again;
+
+    {
+      const ScopeUnlock unlock(mutex);
+      again = store.ScanVisibility(projection, 1) > 0;
+    }
+
+    if (again && !IsStopped())
+      /* the update is not finished yet (each step loads a bounded
+         number of shapes); continue in the next tick, which will use
+         the latest projection */
+      TriggerAgain();
   }
 
   /* notify the client that we have updated the topography cache */
@@ -0,0 +1,424 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "TopographyCache.hpp"
+#include "XShape.hpp"
+#include "util/StringAPI.hxx"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+
+using namespace TopographyCacheFormat;
+
+/**
+ * The tile grid is sized so that each tile has roughly this number
+ * of shapes.
+ */
+static constexpr unsigned SHAPES_PER_TILE = 16;
+
+static constexpr unsigned MAX_TILE_GRID = 256;
+
+static_assert(sizeof(Record) == 64);
+static_assert(sizeof(XShape::Point) % alignof(uint32_t) == 0);
+
+#ifdef ENABLE_OPENGL
+static_assert(THINNING_LEVELS == XShape::THINNING_LEVELS);
+#endif
+
+[[gnu::pure]]
+static GeoBounds
+ImportBounds(double west, double south, double east, double north) noexcept
+{
+  return GeoBounds(GeoPoint(Angle::Radians(west), Angle::Radians(north)),
+                   GeoPoint(Angle::Radians(east), Angle::Radians(south)));
+}
+
+[[gnu::pure]]
+static GeoBounds
+ImportBounds(const Record &r) noexcept
+{
+  return ImportBounds(r.west, r.south, r.east, r.north);
+}
+
+/**
+ * Calculate the tile row or column which contains the given value.
+ * Values outside of the grid are clamped.
+ */
+[[gnu::const]]
+static unsigned
+ToTile(double value, double min, double max, unsigned n) noexcept
+{
+  if (max <= min)
+    return 0;
+
+  const double i = std::floor((value - min) / (max - min) * n);
+  if (!(i >= 0))
+    return 0;
+
+  return std::min(unsigned(std::min(i, double(n))), n - 1);
+}
+
+namespace {
+
+struct TileRange {
+  unsigned min_column, max_column, min_row, max_row;
+};
+
+}
+
+[[gnu::pure]]
+static TileRange
+ToTileRange(double west, double south, double east, double north,
+            const Trailer &trailer) noexcept
+{
+  return {
+    ToTile(west, trailer.west, trailer.east, trailer.tile_columns),
+    ToTile(east, trailer.west, trailer.east, trailer.tile_columns),
+    ToTile(south, trailer.south, trailer.north, trailer.tile_rows),
+    ToTile(north, trailer.south, trailer.north, trailer.tile_rows),
+  };
+}
+
+TopographyCacheWriter::TopographyCacheWriter(const GeoBounds &_bounds,
+                                             const TopographyCacheParameters &_parameters)
+  :bounds(_bounds), parameters(_parameters),
+   source(strings.Add(parameters.source))
+{
+}
+
+void
+TopographyCacheWriter::Add(const XShape &shape)
+{
+  Record r{};
+
+  const auto &shape_bounds = shape.get_bounds();
+  r.west = shape_bounds.GetWest().Radians();
+  r.south = shape_bounds.GetSouth().Radians();
+  r.east = shape_bounds.GetEast().Radians();
+  r.north = shape_bounds.GetNorth().Radians();
+
+  const auto shape_lines = shape.GetLines();
+  std::size_t n_points = 0;
+  for (const unsigned n : shape_lines)
+    n_points += n;
+
+  r.first_point = points.size() / sizeof(XShape::Point);
+  if (n_points > 0) {
+    const auto src = std::as_bytes(std::span{shape.GetPoints(), n_points});
+    points.insert(points.end(), src.begin(), src.end());
+  }
+
+  r.first_line = lines.size();
+  lines.insert(lines.end(), shape_lines.begin(), shape_lines.end());
+
+  if (const TCHAR *label = shape.GetLabel(); label != nullptr)
+    r.label = strings.Add(label);
+
+  r.type = shape.get_type();
+  r.num_lines = shape_lines.size();
+
+  std::fill(std::begin(r.indices), std::end(r.indices), NO_INDICES);
+
+#ifdef ENABLE_OPENGL
+  if (!shape_lines.empty() &&
+      (r.type == MS_SHAPE_LINE || r.type == MS_SHAPE_POLYGON)) {
+    for (unsigned level = 0; level < THINNING_LEVELS; ++level) {
+      if (r.type == MS_SHAPE_LINE && level == 0)
+        /* lines are drawn without indices at level 0 */
+        continue;
+
+      const auto i = shape.GetIndices(level, parameters.min_distance[level]);
+      if (i.indices == nullptr)
+        continue;
+
+      std::size_t n_counts, n_indices;
+      if (r.type == MS_SHAPE_LINE) {
+        n_counts = shape_lines.size();
+        n_indices = 0;
+        for (std::size_t j = 0; j < n_counts; ++j)
+          n_indices += i.count[j];
+      } else {
+        n_counts = 1;
+        n_indices = *i.count;
+      }
+
+      r.indices[level] = indices.size();
+      indices.insert(indices.end(), i.count, i.count + n_counts);
+      indices.insert(indices.end(), i.indices, i.indices + n_indices);
+    }
+  }
+#endif
+
+  records.push_back(r);
+}
+
+void
+TopographyCacheWriter::Save(FileCache &cache, const TCHAR *name,
+                            Path original_path) const
+{
+  const std::size_t n_points = points.size() / sizeof(XShape::Point);
+  if (n_points > UINT32_MAX || indices.size() > UINT32_MAX)
+    throw std::runtime_error("Topography too large for the cache");
+
+  Trailer trailer{};
+  trailer.magic = MAGIC;
+  trailer.version = VERSION;
+  trailer.n_records = records.size();
+  trailer.n_points = n_points;
+  trailer.n_lines = lines.size();
+  trailer.n_indices = indices.size();
+  trailer.point_size = sizeof(XShape::Point);
+  trailer.label_field = parameters.label_field;
+  std::copy(parameters.min_distance.begin(), parameters.min_distance.end(),
+            trailer.min_distance);
+  trailer.west = bounds.GetWest().Radians();
+  trailer.south = bounds.GetSouth().Radians();
+  trailer.east = bounds.GetEast().Radians();
+  trailer.north = bounds.GetNorth().Radians();
+
+  const unsigned grid =
+    std::clamp(unsigned(std::sqrt(double(records.size() / SHAPES_PER_TILE))),
+               1U, MAX_TILE_GRID);
+  trailer.tile_columns = trailer.tile_rows = grid;
+
+  /* build the tile index: count the shapes of each tile, then fill
+     the lists */
+
+  const std::size_t n_tiles = grid * grid;
+  std::vector<uint32_t> tile_starts(n_tiles + 1);
+
+  const auto for_each_tile = [&trailer](const Record &r, auto &&f){
+    const auto range = ToTileRange(r.west, r.south, r.east, r.north,
+                                   trailer);
+    for (unsigned row = range.min_row; row <= range.max_row; ++row)
+      for (unsigned column = range.min_column; column <= range.max_column;
+           ++column)
+        f(row * trailer.tile_columns + column);
+  };
+
+  for (const auto &r : records)
+    for_each_tile(r, [&tile_starts](std::size_t tile){
+      ++tile_starts[tile + 1];
+    });
+
+  for (std::size_t i = 0; i < n_tiles; ++i)
+    tile_starts[i + 1] += tile_starts[i];
+
+  std::vector<uint32_t> tile_shapes(tile_starts.back());
+  std::vector<uint32_t> tile_fill(tile_starts.begin(), tile_starts.end() - 1);
+  for (std::size_t i = 0; i < records.size(); ++i)
+    for_each_tile(records[i], [&tile_shapes, &tile_fill, i](std::size_t tile){
+      tile_shapes[tile_fill[tile]++] = i;
+    });
+
+  trailer.n_tile_shapes = tile_shapes.size();
+
+  const auto chars = strings.GetChars();
+  trailer.n_chars = chars.size();
+  trailer.source = source;
+
+  FlatCache::Writer writer(cache, name, original_path);
+
+  trailer.records_offset = writer.GetPosition();
+
+  writer.Write(records);
+  writer.Write(points);
+  writer.Write(tile_starts);
+  writer.Write(tile_shapes);
+  writer.Write(lines);
+  writer.Write(indices);
+  writer.Write(chars);
+  writer.Commit(trailer);
+}
+
+TopographyCacheFile::TopographyCacheFile(std::unique_ptr<FileMapping> &&_mapping)
+  :mapping(std::move(_mapping))
+{
+  FlatCache::Reader reader(*mapping);
+  trailer = reader.ReadTrailer<Trailer>();
+
+  if (trailer.magic != MAGIC || trailer.version != VERSION ||
+      trailer.point_size == 0 ||
+      trailer.point_size % alignof(uint32_t) != 0 ||
+      trailer.tile_columns == 0 || trailer.tile_rows == 0)
+    throw std::runtime_error("Malformed topography cache");
+
+  const std::size_t n_tiles =
+    std::size_t(trailer.tile_columns) * trailer.tile_rows;
+
+  reader.Seek(trailer.records_offset);
+  records = reader.Read<Record>(trailer.n_records);
+  points = reader.ReadBytes(uint64_t(trailer.n_points) * trailer.point_size);
+  tile_starts = reader.Read<uint32_t>(n_tiles + 1);
+  tile_shapes = reader.Read<uint32_t>(trailer.n_tile_shapes);
+  lines = reader.Read<uint16_t>(trailer.n_lines);
+  indices = reader.Read<uint16_t>(trailer.n_indices);
+  chars = reader.ReadStrings(trailer.n_chars);
+  reader.Finish();
+
+  /* throws if out of range; IsCompatible() relies on this */
+  FlatCache::GetString(chars, trailer.source);
+
+  if (tile_starts.front() != 0 ||
+      tile_starts.back() != trailer.n_tile_shapes ||
+      !std::is_sorted(tile_starts.begin(), tile_starts.end()))
+    throw std::runtime_error("Malformed topography cache index");
+
+  bounds = ImportBounds(trailer.west, trailer.south,
+                        trailer.east, trailer.north);
+  if (!bounds.Check())
+    throw std::runtime_error("Malformed topography cache bounds");
+
+  status.ResizeDiscard((records.size() + MS_ARRAY_BIT - 1) / MS_ARRAY_BIT);
+  std::fill(status.begin(), status.end(), 0);
+}
+
+TopographyCacheFile::~TopographyCacheFile() noexcept = default;
+
+bool
+TopographyCacheFile::IsCompatible(const TopographyCacheParameters &parameters) const noexcept
+{
+  return trailer.point_size == sizeof(XShape::Point) &&
+    trailer.label_field == parameters.label_field &&
+    std::equal(parameters.min_distance.begin(), parameters.min_distance.end(),
+               trailer.min_distance) &&
+    StringIsEqual(chars.data() + trailer.source, parameters.source);
+}
+
+bool
+TopographyCacheFile::WhichShapes(const GeoBounds &area) noexcept
+{
+  std::fill(status.begin(), status.end(), 0);
+
+  if (!area.Overlaps(bounds))
+    return false;
+
+  const auto range = ToTileRange(area.GetWest().Radians(),
+                                 area.GetSouth().Radians(),
+                                 area.GetEast().Radians(),
+                                 area.GetNorth().Radians(),
+                                 trailer);
+
+  for (unsigned row = range.min_row; row <= range.max_row; ++row) {
+    for (unsigned column = range.min_column; column <= range.max_column;
+         ++column) {
+      const std::size_t tile = row * trailer.tile_columns + column;
+      for (std::size_t j = tile_starts[tile]; j < tile_starts[tile + 1]; ++j) {
+        const std::size_t i = tile_shapes[j];
+        if (i >= records.size() || msGetBit(status.data(), i))
+          continue;
+
+        if (area.Overlaps(ImportBounds(records[i])))
+          msSetBit(status.data(), i, 1);
+      }
+    }
+  }
+
+  return true;
+}
+
+#ifdef ENABLE_OPENGL
+
+/**
+ * Check an index block and return its size.
+ *
+ * @return the number of elements, or 0 if the block is malformed
+ */
+[[gnu::pure]]
+static std::size_t
+CheckIndices(std::span<const uint16_t> src, uint8_t type,
+             std::size_t num_lines, std::size_t num_points) noexcept
+{
+  const std::size_t n_counts = type == MS_SHAPE_LINE ? num_lines : 1;
+  if (src.size() < n_counts)
+    return 0;
+
+  std::size_t n_indices = 0;
+  for (std::size_t i = 0; i < n_counts; ++i)
+    n_indices += src[i];
+
+  if (src.size() - n_counts < n_indices)
+    return 0;
+
+  for (const unsigned i : src.subspan(n_counts, n_indices))
+    if (i >= num_points)
+      return 0;
+
+  return n_counts + n_indices;
+}
+
+#endif
+
+std::unique_ptr<XShape>
+TopographyCacheFile::LoadShape(std::size_t i) const
+{
+  assert(i < records.size());
+
+  const auto &r = records[i];
+
+  /* the records are validated here and not on opening, to avoid
+     touching all pages of the mapping */
+
+  const auto shape_bounds = ImportBounds(r);
+  if (!shape_bounds.Check() || r.num_lines > XShape::MAX_LINES ||
+      r.first_line > lines.size() ||
+      r.num_lines > lines.size() - r.first_line ||
+      r.label >= chars.size())
+    throw std::runtime_error("Malformed topography cache record");
+
+  const auto shape_lines = lines.subspan(r.first_line, r.num_lines);
+
+  std::size_t n_points = 0;
+  for (const unsigned n : shape_lines)
+    n_points += n;
+
+  const auto all_points = FromBytesStrict<const XShape::Point>(points);
+  if (r.first_point > all_points.size() ||
+      n_points > all_points.size() - r.first_point)
+    throw std::runtime_error("Malformed topography cache record");
+
+  auto shape = std::make_unique<XShape>(shape_bounds, MS_SHAPE_TYPE(r.type),
+                                        shape_lines,
+                                        all_points.data() + r.first_point,
+                                        r.label != 0
+                                        ? chars.data() + r.label
+                                        : nullptr);
+
+#ifdef ENABLE_OPENGL
+  for (unsigned level = 0; level < THINNING_LEVELS; ++level) {
+    if (r.indices[level] == NO_INDICES)
+      continue;
+
+    if ((r.type != MS_SHAPE_LINE && r.type != MS_SHAPE_POLYGON) ||
+        r.num_lines == 0 || r.indices[level] >= indices.size() ||
+        CheckIndices(indices.subspan(r.indices[level]), r.type,
+                     r.num_lines, n_points) == 0)
+      throw std::runtime_error("Malformed topography cache indices");
+
+    shape->SetIndices(level, indices.data() + r.indices[level]);
+  }
+#endif
+
+  return shape;
+}
+
+std::unique_ptr<TopographyCacheFile>
+LoadTopographyCache(FileCache &cache, const TCHAR *name, Path original_path,
+                    const TopographyCacheParameters &parameters)
+{
+  std::unique_ptr<TopographyCacheFile> file;
+
+  if (!FlatCache::Load(cache, name, original_path,
+                       [&file](std::unique_ptr<FileMapping> &&mapping){
+                         file = std::make_unique<TopographyCacheFile>(std::move(mapping));
+                       }))
+    return nullptr;
+
+  if (!file->IsCompatible(parameters))
+    /* built with different settings; the caller will overwrite it */
+    return nullptr;
+
+  return file;
+}
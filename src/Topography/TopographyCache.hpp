@@ -0,0 +1,296 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Geo/GeoBounds.hpp"
+#include "io/FlatCache.hpp"
+#include "system/Path.hpp"
+#include "util/AllocatedArray.hxx"
+#include "shapelib/mapserver.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include <tchar.h>
+
+class XShape;
+class OperationEnvironment;
+
+/**
+ * On-disk layout of a topography cache file: the shapes of one
+ * shapefile, pre-processed so they can be used directly from a
+ * memory mapping, without decoding.
+ *
+ * This is a #FlatCache file which consists of an array of #Record,
+ * the points of all shapes (in the layout of XShape::Point, i.e.
+ * relative to the file center on OpenGL), the tile index, the line
+ * sizes, the pre-computed thinning and triangle index blocks (OpenGL
+ * only), a FlatCache::StringTable with the labels and a #Trailer at
+ * the very end.
+ *
+ * The tile index divides the bounds of the file into a grid; each
+ * tile has a list of the shapes which overlap it.
+ */
+namespace TopographyCacheFormat {
+
+static constexpr uint32_t MAGIC = 0x54504743;
+static constexpr uint32_t VERSION = 1;
+
+static constexpr std::size_t THINNING_LEVELS = 4;
+
+/**
+ * Value for Record::indices if there is no index block.
+ */
+static constexpr uint32_t NO_INDICES = UINT32_MAX;
+
+using FlatCache::StringRef;
+
+struct Record {
+  /**
+   * The bounds in radians.
+   */
+  double west, south, east, north;
+
+  /**
+   * The position of the first point in the point array.
+   */
+  uint32_t first_point;
+
+  /**
+   * The position of the first line size in the line array.
+   */
+  uint32_t first_line;
+
+  StringRef label;
+
+  uint8_t type, num_lines;
+
+  uint16_t reserved;
+
+  /**
+   * The positions of the index blocks in the index array for each
+   * thinning level (see XShape::GetIndices()); #NO_INDICES if there
+   * is none.
+   */
+  uint32_t indices[THINNING_LEVELS];
+};
+
+struct Trailer {
+  uint32_t magic;
+  uint32_t version;
+
+  uint32_t n_records, n_points, n_tile_shapes, n_lines, n_indices, n_chars;
+
+  /**
+   * sizeof(XShape::Point), which depends on the build.
+   */
+  uint32_t point_size;
+
+  int32_t label_field;
+
+  /**
+   * The minimum point distance which was used to build the index
+   * blocks of each thinning level.
+   */
+  float min_distance[THINNING_LEVELS];
+
+  uint16_t tile_columns, tile_rows;
+
+  /**
+   * The name of the shapefile; it is compared on loading, in
+   * addition to the size and modification time checked by
+   * #FileCache.
+   */
+  StringRef source;
+
+  /**
+   * The bounds of the shapefile in radians.  The tile grid covers
+   * these bounds.
+   */
+  double west, south, east, north;
+
+  uint64_t records_offset;
+};
+
+} // namespace TopographyCacheFormat
+
+/**
+ * Enables the topography cache, see TopographyStore::Load().
+ */
+struct TopographyCacheOptions {
+  FileCache &cache;
+
+  /**
+   * The file which contains the shapefiles (i.e. the map file).
+   * Cache files are rebuilt when it is modified.
+   */
+  Path original_path;
+
+  /**
+   * The value of Layout::Scale(1), see
+   * TopographyFile::GetMinimumShapeDistance().
+   */
+  unsigned layout_scale;
+
+  /**
+   * Build a new cache file from the shapefile if there is no
+   * up-to-date one?  This reads all shapes, which takes a long time
+   * on a big map; XCSoar does it only in the background (see
+   * #AsyncTopographyCacheBuilder) and uses the shapefile until the
+   * cache file exists.
+   */
+  bool build = false;
+
+  /**
+   * If not nullptr, building a cache file is aborted when this
+   * environment gets cancelled.
+   */
+  OperationEnvironment *env = nullptr;
+};
+
+/**
+ * The parameters which influence the contents of a topography cache
+ * file.  A cache file which was built with different parameters is
+ * not used.
+ */
+struct TopographyCacheParameters {
+  /**
+   * The name of the shapefile.
+   */
+  const TCHAR *source;
+
+  int label_field;
+
+  /**
+   * The minimum point distance for each thinning level (see
+   * TopographyFile::GetMinimumShapeDistance()).  Only used on
+   * OpenGL.
+   */
+  std::array<float, TopographyCacheFormat::THINNING_LEVELS> min_distance;
+};
+
+/**
+ * Collects the shapes of one shapefile and writes them to a
+ * topography cache file.
+ */
+class TopographyCacheWriter {
+  const GeoBounds bounds;
+
+  const TopographyCacheParameters parameters;
+
+  std::vector<TopographyCacheFormat::Record> records;
+  std::vector<std::byte> points;
+  std::vector<uint16_t> lines;
+  std::vector<uint16_t> indices;
+
+  /**
+   * The labels and the source name.
+   */
+  FlatCache::StringTable strings;
+
+  const TopographyCacheFormat::StringRef source;
+
+public:
+  /**
+   * @param bounds the bounds of the shapefile
+   */
+  TopographyCacheWriter(const GeoBounds &_bounds,
+                        const TopographyCacheParameters &_parameters);
+
+  /**
+   * Add the next shape.  On OpenGL, its index blocks are built (if
+   * that has not been done already) and copied.
+   */
+  void Add(const XShape &shape);
+
+  /**
+   * Throws on error.
+   */
+  void Save(FileCache &cache, const TCHAR *name, Path original_path) const;
+};
+
+/**
+ * A memory-mapped topography cache file.
+ */
+class TopographyCacheFile {
+  std::unique_ptr<FileMapping> mapping;
+
+  TopographyCacheFormat::Trailer trailer;
+
+  GeoBounds bounds;
+
+  std::span<const TopographyCacheFormat::Record> records;
+  std::span<const std::byte> points;
+  std::span<const uint32_t> tile_starts, tile_shapes;
+  std::span<const uint16_t> lines;
+  std::span<const uint16_t> indices;
+  std::span<const TCHAR> chars;
+
+  /**
+   * A bit for each shape: does it overlap the bounds passed to the
+   * last WhichShapes() call?  This has the same layout as
+   * shapefileObj::status.
+   */
+  AllocatedArray<ms_uint32> status;
+
+public:
+  /**
+   * Throws if the file is malformed.
+   */
+  explicit TopographyCacheFile(std::unique_ptr<FileMapping> &&_mapping);
+
+  ~TopographyCacheFile() noexcept;
+
+  TopographyCacheFile(const TopographyCacheFile &) = delete;
+  TopographyCacheFile &operator=(const TopographyCacheFile &) = delete;
+
+  /**
+   * Was this file built by this build with the given parameters?
+   * If not, it must not be used.
+   */
+  [[gnu::pure]]
+  bool IsCompatible(const TopographyCacheParameters &parameters) const noexcept;
+
+  std::size_t size() const noexcept {
+    return records.size();
+  }
+
+  const GeoBounds &GetBounds() const noexcept {
+    return bounds;
+  }
+
+  /**
+   * Select all shapes which overlap the given bounds (using the tile
+   * index).
+   *
+   * @return false if the bounds are outside of the file bounds
+   */
+  bool WhichShapes(const GeoBounds &area) noexcept;
+
+  ms_const_bitarray GetStatus() const noexcept {
+    return status.data();
+  }
+
+  /**
+   * Create an #XShape which refers to the data in the mapping.
+   *
+   * Throws if the shape is malformed.
+   */
+  std::unique_ptr<XShape> LoadShape(std::size_t i) const;
+};
+
+/**
+ * Open a topography cache file.
+ *
+ * Throws if the cache file is malformed; it is deleted in this case.
+ *
+ * @return nullptr if there is no up-to-date cache file which was
+ * built with the given parameters
+ */
+std::unique_ptr<TopographyCacheFile>
+LoadTopographyCache(FileCache &cache, const TCHAR *name, Path original_path,
+                    const TopographyCacheParameters &parameters);
@@ -2,16 +2,29 @@
 // Copyright The XCSoar Project
 
 #include "Topography/TopographyFile.hpp"
+#include "Topography/TopographyCache.hpp"
 #include "Topography/XShape.hpp"
 #include "Convert.hpp"
 #include "Projection/WindowProjection.hpp"
+#include "system/ConvertPathName.hpp"
 #include "util/ScopeExit.hxx"
+#include "util/tstring.hpp"
+#include "Operation/Operation.hpp"
+#include "LogFile.hpp"
 
 #include <zzip/lib.h>
 
 #include <algorithm>
 #include <stdexcept>
 
+/**
+ * The maximum number of shapes loaded by one Update() call.  A larger
+ * cache update is split over several calls, so the topography thread
+ * can pick up a new projection and the map can be redrawn in
+ * between.
+ */
+static constexpr unsigned MAX_LOAD_PER_UPDATE = 256;
+
 TopographyFile::TopographyFile(zzip_dir *_dir, const char *filename,
                                double _threshold,
                                double _label_threshold,
@@ -20,9 +33,9 @@ TopographyFile::TopographyFile(zzip_dir *_dir, const char *filename,
                                int _label_field,
                                ResourceId _icon, ResourceId _big_icon,
                                ResourceId _ultra_icon,
-                               unsigned _pen_width)
+                               unsigned _pen_width,
+                               const TopographyCacheOptions *cache_options)
   :dir(_dir),
-   file(dir, filename),
    label_field(_label_field),
    icon(_icon), big_icon(_big_icon), ultra_icon(_ultra_icon),
    pen_width(_pen_width),
@@ -30,7 +43,15 @@ TopographyFile::TopographyFile(zzip_dir *_dir, const char *filename,
    label_threshold(_label_threshold),
    important_label_threshold(_important_label_threshold)
 {
-  const std::size_t n_shapes = file.size();
+  if (cache_options != nullptr)
+    OpenCache(filename, *cache_options);
+
+  if (cache_file == nullptr)
+    file.emplace(dir, filename);
+
+  const std::size_t n_shapes = cache_file != nullptr
+    ? cache_file->size()
+    : file->size();
   constexpr std::size_t MAX_SHAPES = 16 * 1024 * 1024;
   if (n_shapes == 0)
     throw std::runtime_error{"Empty shapefile"};
@@ -38,13 +59,16 @@ TopographyFile::TopographyFile(zzip_dir *_dir, const char *filename,
   if (n_shapes > MAX_SHAPES)
     throw std::runtime_error{"Too many shapes in shapefile"};
 
-  const auto file_bounds = ImportRect(file.GetBounds());
+  const auto file_bounds = cache_file != nullptr
+    ? cache_file->GetBounds()
+    : ImportRect(file->GetBounds());
   if (!file_bounds.Check())
     throw std::runtime_error{"Malformed shapefile bounds"};
 
   center = file_bounds.GetCenter();
 
   shapes.ResizeDiscard(n_shapes);
+  update_position = n_shapes;
 
   if (dir != nullptr)
     ++dir->refcount;
@@ -67,10 +91,12 @@ TopographyFile::ClearCache() noexcept
     i.shape.reset();
 
   list.clear();
+  update_position = shapes.size();
 }
 
 static std::unique_ptr<XShape>
-LoadShape(ShapeFile &file, GeoPoint &center, std::size_t i, int label_field)
+ReadShape(ShapeFile &file, const GeoPoint &center, std::size_t i,
+          int label_field)
 {
   shapeObj shape;
   msInitShape(&shape);
@@ -84,43 +110,171 @@ LoadShape(ShapeFile &file, GeoPoint &center, std::size_t i, int label_field)
   return std::make_unique<XShape>(shape, center, label);
 }
 
-bool
-TopographyFile::Update(const WindowProjection &map_projection)
+void
+TopographyFile::OpenCache(const char *filename,
+                          const TopographyCacheOptions &options)
 {
-  if (map_projection.GetMapScale() > scale_threshold)
-    /* not visible, don't update cache now */
-    return false;
+  const PathName path{filename};
+  const tstring name = tstring{_T("topography-")} + Path{path}.GetBase().c_str();
 
-  const GeoBounds screenRect =
-    map_projection.GetScreenBounds();
-  if (cache_bounds.IsValid() && cache_bounds.IsInside(screenRect))
-    /* the cache is still fresh */
-    return false;
+  TopographyCacheParameters parameters{};
+  parameters.source = Path{path}.GetBase().c_str();
+  parameters.label_field = label_field;
+#ifdef ENABLE_OPENGL
+  for (unsigned level = 0; level < parameters.min_distance.size(); ++level)
+    parameters.min_distance[level] =
+      GetMinimumShapeDistance(level, options.layout_scale);
+#endif
 
-  cache_bounds = screenRect.Scale(2);
+  /* the shapefile is the original file unless it is inside the map
+     file */
+  const Path original_path = dir != nullptr
+    ? options.original_path
+    : Path{path};
+
+  try {
+    cache_file = LoadTopographyCache(options.cache, name.c_str(),
+                                     original_path, parameters);
+    if (cache_file != nullptr)
+      return;
+  } catch (...) {
+    LogError(std::current_exception(), "Failed to load topography cache");
+  }
 
-  // Test which shapes are inside the given bounds and save the
-  // status to file.status
-  switch (file.WhichShapes(dir, ConvertRect(cache_bounds))) {
-  case MS_FAILURE:
-    ClearCache();
-    throw std::runtime_error{"Failed to update shapefile"};
+  if (!options.build)
+    /* use the shapefile until the cache file has been built */
+    return;
 
-  case MS_DONE:
-    /* screen is outside of map bounds */
-    return false;
+  /* build a new cache file from the shapefile */
+
+  try {
+    ShapeFile shape_file(dir, filename);
+
+    const auto file_bounds = ImportRect(shape_file.GetBounds());
+    if (!file_bounds.Check())
+      return;
+
+    const auto file_center = file_bounds.GetCenter();
+
+    TopographyCacheWriter writer(file_bounds, parameters);
+    for (std::size_t i = 0; i < shape_file.size(); ++i) {
+      if (i % 256 == 0 && options.env != nullptr &&
+          options.env->IsCancelled())
+        return;
+
+      writer.Add(*ReadShape(shape_file, file_center, i, label_field));
+    }
+
+    writer.Save(options.cache, name.c_str(), original_path);
+
+    cache_file = LoadTopographyCache(options.cache, name.c_str(),
+                                     original_path, parameters);
+  } catch (...) {
+    LogError(std::current_exception(), "Failed to build topography cache");
+  }
+}
+
+std::unique_ptr<XShape>
+TopographyFile::LoadShape(std::size_t i)
+{
+  if (cache_file != nullptr)
+    return cache_file->LoadShape(i);
+
+  return ReadShape(*file, center, i, label_field);
+}
+
+/**
+ * Calculate the bounds of the shape cache: twice the screen, plus one
+ * more screen in the direction the screen has moved since the last
+ * calculation.
+ */
+[[gnu::pure]]
+static GeoBounds
+PredictCacheBounds(const GeoBounds &screen,
+                   const GeoPoint &previous_center) noexcept
+{
+  GeoBounds result = screen.Scale(2);
+  if (!previous_center.IsValid())
+    return result;
+
+  const GeoPoint center = screen.GetCenter();
+  const Angle width = screen.GetWidth(), height = screen.GetHeight();
+
+  /* ignore small movements, e.g. caused by zooming */
+  const Angle delta_longitude =
+    (center.longitude - previous_center.longitude).AsDelta();
+  const Angle delta_latitude = center.latitude - previous_center.latitude;
+
+  GeoPoint ahead = center;
+  if (delta_longitude > width / 8)
+    ahead.longitude += width * 2;
+  else if (delta_longitude < -width / 8)
+    ahead.longitude -= width * 2;
+
+  if (delta_latitude > height / 8)
+    ahead.latitude = std::min(center.latitude + height * 2,
+                              Angle::QuarterCircle());
+  else if (delta_latitude < -height / 8)
+    ahead.latitude = std::max(center.latitude - height * 2,
+                              -Angle::QuarterCircle());
+
+  ahead.longitude = ahead.longitude.AsDelta();
+  result.Extend(ahead);
+  return result;
+}
 
-  case MS_SUCCESS:
-    break;
+bool
+TopographyFile::StartUpdate(const GeoBounds &screen)
+{
+  cache_bounds = PredictCacheBounds(screen, last_screen_center);
+  last_screen_center = screen.GetCenter();
+
+  /* a pending update is obsolete now */
+  update_position = shapes.size();
+
+  if (cache_file != nullptr) {
+    if (!cache_file->WhichShapes(cache_bounds))
+      /* screen is outside of map bounds */
+      return false;
+  } else {
+    // Test which shapes are inside the given bounds and save the
+    // status to file.status
+    switch (file->WhichShapes(dir, ConvertRect(cache_bounds))) {
+    case MS_FAILURE:
+      ClearCache();
+      throw std::runtime_error{"Failed to update shapefile"};
+
+    case MS_DONE:
+      /* screen is outside of map bounds */
+      return false;
+
+    case MS_SUCCESS:
+      break;
+    }
   }
 
-  const auto status = file.GetStatus();
+  update_position = 0;
+  update_prev = list.before_begin();
+  return true;
+}
+
+void
+TopographyFile::ContinueUpdate()
+{
+  assert(IsUpdatePending());
+
+  const auto status = cache_file != nullptr
+    ? cache_file->GetStatus()
+    : file->GetStatus();
   assert(status != nullptr);
 
+  unsigned n_loaded = 0;
+
   // Iterate through the shapefile entries
-  auto prev = list.before_begin();
-  auto it = shapes.begin();
-  for (std::size_t i = 0; i < file.size(); ++i, ++it) {
+  auto prev = update_prev;
+  auto it = shapes.begin() + update_position;
+  std::size_t i = update_position;
+  for (; i < shapes.size() && n_loaded < MAX_LOAD_PER_UPDATE; ++i, ++it) {
     if (!msGetBit(status, i)) {
       // If the shape is outside the bounds
       // delete the shape from the cache
@@ -144,7 +298,16 @@ TopographyFile::Update(const WindowProjection &map_projection)
         assert(&*std::next(prev) != &*it);
 
         // shape isn't cached yet -> cache the shape
-        it->shape = LoadShape(file, center, i, label_field);
+        try {
+          it->shape = LoadShape(i);
+        } catch (...) {
+          /* skip this shape and continue after it next time */
+          update_position = i + 1;
+          update_prev = prev;
+          throw;
+        }
+
+        ++n_loaded;
 
         /* insert into linked list (protected) */
         {
@@ -159,8 +322,29 @@ TopographyFile::Update(const WindowProjection &map_projection)
     }
   }
 
-  assert(std::next(prev) == list.end());
+  assert(i < shapes.size() || std::next(prev) == list.end());
+
+  update_position = i;
+  update_prev = prev;
+}
 
+bool
+TopographyFile::Update(const WindowProjection &map_projection)
+{
+  if (map_projection.GetMapScale() > scale_threshold)
+    /* not visible, don't update cache now */
+    return false;
+
+  const GeoBounds screenRect =
+    map_projection.GetScreenBounds();
+  if (cache_bounds.IsValid() && cache_bounds.IsInside(screenRect)) {
+    if (!IsUpdatePending())
+      /* the cache is still fresh */
+      return false;
+  } else if (!StartUpdate(screenRect))
+    return false;
+
+  ContinueUpdate();
   return true;
 }
 
@@ -170,11 +354,11 @@ TopographyFile::LoadAll()
   // Iterate through the shapefile entries
   auto prev = list.before_begin();
   auto it = shapes.begin();
-  for (std::size_t i = 0; i < file.size(); ++i, ++it) {
+  for (std::size_t i = 0; i < shapes.size(); ++i, ++it) {
     if (it->shape == nullptr) {
       assert(&*std::next(prev) != &*it);
       // shape isn't cached yet -> cache the shape
-      it->shape = LoadShape(file, center, i, label_field);
+      it->shape = LoadShape(i);
       // update list pointer
       prev = list.insert_after(prev, *it);
     } else {
@@ -185,6 +369,10 @@ TopographyFile::LoadAll()
 
   assert(std::next(prev) == list.end());
 
+  /* everything is loaded; a pending update would not see the new
+     list elements */
+  update_position = shapes.size();
+
   ++serial;
 }
 
@@ -14,13 +14,17 @@
 
 #ifdef ENABLE_OPENGL
 #include "XShapePoint.hpp"
+#include "Geo/FAISphere.hpp"
 #endif
 
 #include <cassert>
 #include <memory>
+#include <optional>
 
 class WindowProjection;
 class XShape;
+class TopographyCacheFile;
+struct TopographyCacheOptions;
 struct zzip_dir;
 
 class TopographyFile {
@@ -35,7 +39,17 @@ class TopographyFile {
 
   zzip_dir *const dir;
 
-  ShapeFile file;
+  /**
+   * The shapefile.  It is not opened if the shapes are loaded from
+   * #cache_file.
+   */
+  std::optional<ShapeFile> file;
+
+  /**
+   * The pre-processed copy of the shapefile (see
+   * #TopographyCacheFormat).  If this is set, #file is not used.
+   */
+  std::unique_ptr<TopographyCacheFile> cache_file;
 
   /**
    * The center of shapefileObj::bounds.
@@ -80,6 +94,24 @@ class TopographyFile {
    */
   GeoBounds cache_bounds = GeoBounds::Invalid();
 
+  /**
+   * The center of the screen when #cache_bounds was last
+   * calculated; used to predict the direction of travel.
+   */
+  GeoPoint last_screen_center = GeoPoint::Invalid();
+
+  /**
+   * The shape index where the pending update (see Update()) will
+   * continue.  If there is no pending update, this equals the
+   * number of shapes.
+   */
+  std::size_t update_position;
+
+  /**
+   * The last #list element before #update_position.
+   */
+  ShapeList::iterator update_prev;
+
 public:
   /**
    * Protects #serial, #shapes, #first.
@@ -133,6 +165,9 @@ public:
    * @param label_threshold the zoom threshold for label rendering
    * @param important_label_threshold labels below this zoom threshold will
    * be rendered in default style
+   * @param cache_options if not nullptr, then the shapes are loaded
+   * from a topography cache file (if there is an up-to-date one or
+   * if TopographyCacheOptions::build is set)
    */
   TopographyFile(zzip_dir *dir, const char *shpname,
                  double threshold, double label_threshold,
@@ -142,7 +177,8 @@ public:
                  ResourceId icon=ResourceId::Null(),
                  ResourceId big_icon=ResourceId::Null(),
                  ResourceId ultra_icon=ResourceId::Null(),
-                 unsigned pen_width=1);
+                 unsigned pen_width=1,
+                 const TopographyCacheOptions *cache_options=nullptr);
 
   TopographyFile(const TopographyFile &) = delete;
 
@@ -242,15 +278,38 @@ public:
    */
   [[gnu::pure]]
   unsigned GetMinimumPointDistance(unsigned level) const noexcept;
+
+  /**
+   * @param layout_scale the value of Layout::Scale(1)
+   * @return the minimum distance between points which is passed to
+   * XShape::GetIndices()
+   */
+  [[gnu::pure]]
+  ShapeScalar GetMinimumShapeDistance(unsigned level,
+                                      unsigned layout_scale) const noexcept {
+    return ShapeScalar(GetMinimumPointDistance(level))
+      / (layout_scale * FAISphere::REARTH);
+  }
 #endif
 
   /**
+   * Update the shape cache for the given projection.  When the
+   * screen leaves the cached area, a new area is calculated (with
+   * some prefetching in the direction of travel), and the shapes are
+   * loaded over several calls, with a bounded number of shapes per
+   * call.
+   *
    * Throws on error.
    *
-   * @return true if new data from the topography file has been loaded
+   * @return true if the cache has been modified; call again (until
+   * it returns false) to finish a pending update
    */
   bool Update(const WindowProjection &map_projection);
 
+  bool IsUpdatePending() const noexcept {
+    return update_position < shapes.size();
+  }
+
   /**
    * Throws on error.
    *
@@ -260,4 +319,30 @@ public:
 
 protected:
   void ClearCache() noexcept;
+
+private:
+  /**
+   * Open the topography cache file, or build it from the shapefile
+   * (if TopographyCacheOptions::build is set).  Errors are logged.
+   */
+  void OpenCache(const char *filename, const TopographyCacheOptions &options);
+
+  /**
+   * Throws on error.
+   */
+  std::unique_ptr<XShape> LoadShape(std::size_t i);
+
+  /**
+   * Start a new update pass for the given screen bounds.
+   *
+   * @return false if no shapes need to be loaded
+   */
+  bool StartUpdate(const GeoBounds &screen);
+
+  /**
+   * Continue the pending update pass.
+   *
+   * Throws on error.
+   */
+  void ContinueUpdate();
 };
@@ -14,7 +14,6 @@
 #include "util/AllocatedArray.hxx"
 #include "util/tstring.hpp"
 #include "Geo/GeoClip.hpp"
-#include "Geo/FAISphere.hpp"
 
 #ifdef ENABLE_OPENGL
 #include "ui/canvas/opengl/VertexPointer.hpp"
@@ -176,8 +175,7 @@ TopographyFileRenderer::Paint(Canvas &canvas,
 #ifdef ENABLE_OPENGL
   const unsigned level = file.GetThinningLevel(map_scale);
   const ShapeScalar min_distance =
-    ShapeScalar(file.GetMinimumPointDistance(level))
-    / (Layout::Scale(1) * FAISphere::REARTH);
+    file.GetMinimumShapeDistance(level, Layout::Scale(1));
 
   glUniformMatrix4fv(OpenGL::solid_modelview, 1, GL_FALSE,
                      glm::value_ptr(ToGLM(projection, file.GetCenter())));
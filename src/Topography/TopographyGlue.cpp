@@ -3,10 +3,12 @@
 
 #include "Topography/TopographyGlue.hpp"
 #include "Topography/TopographyStore.hpp"
+#include "Topography/TopographyCache.hpp"
+#include "Topography/AsyncCacheBuilder.hpp"
+#include "Screen/Layout.hpp"
 #include "Language/Language.hpp"
 #include "Profile/Profile.hpp"
 #include "LogFile.hpp"
-#include "io/MapFile.hpp"
 #include "io/ZipArchive.hpp"
 #include "io/ZipLineReader.hpp"
 #include "system/Path.hpp"
@@ -16,14 +18,23 @@
  * the same ZIP file.
  */
 static bool
-LoadConfiguredTopographyZip(TopographyStore &store)
+LoadConfiguredTopographyZip(TopographyStore &store, FileCache *cache)
 try {
-  auto archive = OpenMapFile();
-  if (!archive)
+  const auto path = Profile::GetPath(ProfileKeys::MapFile);
+  if (path == nullptr)
     return false;
 
-  ZipLineReaderA reader(archive->get(), "topology.tpl");
-  store.Load(reader, nullptr, archive->get());
+  ZipArchive archive{path};
+
+  ZipLineReaderA reader(archive.get(), "topology.tpl");
+
+  if (cache != nullptr) {
+    const TopographyCacheOptions cache_options{
+      *cache, path, Layout::Scale(1U),
+    };
+    store.Load(reader, nullptr, archive.get(), &cache_options);
+  } else
+    store.Load(reader, nullptr, archive.get());
   return true;
 } catch (...) {
   LogError(std::current_exception(), "No topography in map file");
@@ -31,7 +42,18 @@ try {
 }
 
 bool
-LoadConfiguredTopography(TopographyStore &store)
+LoadConfiguredTopography(TopographyStore &store, FileCache *cache)
+{
+  return LoadConfiguredTopographyZip(store, cache);
+}
+
+void
+BuildConfiguredTopographyCache(AsyncTopographyCacheBuilder &builder,
+                               FileCache &cache) noexcept
 {
-  return LoadConfiguredTopographyZip(store);
+  const auto path = Profile::GetPath(ProfileKeys::MapFile);
+  if (path == nullptr)
+    return;
+
+  builder.Start(cache, path, Layout::Scale(1U));
 }
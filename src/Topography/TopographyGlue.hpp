@@ -4,6 +4,20 @@
 #pragma once
 
 class TopographyStore;
+class FileCache;
+class AsyncTopographyCacheBuilder;
 
+/**
+ * @param cache if not nullptr, then pre-processed copies of the
+ * shapefiles are stored there
+ */
 bool
-LoadConfiguredTopography(TopographyStore &store);
+LoadConfiguredTopography(TopographyStore &store, FileCache *cache);
+
+/**
+ * Start building the missing topography cache files of the
+ * configured map file in the background.
+ */
+void
+BuildConfiguredTopographyCache(AsyncTopographyCacheBuilder &builder,
+                               FileCache &cache) noexcept;
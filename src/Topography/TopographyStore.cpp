@@ -67,7 +67,8 @@ TopographyStore::LoadAll() noexcept
 
 void
 TopographyStore::Load(NLineReader &reader,
-                      Path directory, struct zzip_dir *zdir) noexcept
+                      Path directory, struct zzip_dir *zdir,
+                      const TopographyCacheOptions *cache_options) noexcept
 {
   Reset();
 
@@ -108,7 +109,7 @@ TopographyStore::Load(NLineReader &reader,
                               entry->color,
                               entry->shape_field,
                               entry->icon, entry->big_icon, entry->ultra_icon,
-                              entry->pen_width);
+                              entry->pen_width, cache_options);
     } catch (...) {
       LogError(std::current_exception());
     }
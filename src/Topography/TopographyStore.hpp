@@ -12,6 +12,7 @@ class Path;
 class WindowProjection;
 class NLineReader;
 struct zzip_dir;
+struct TopographyCacheOptions;
 
 /**
  * Class used to manage and render vector topography layers
@@ -64,7 +65,13 @@ public:
    */
   void LoadAll() noexcept;
 
+  /**
+   * @param cache_options if not nullptr, then the shapes are loaded
+   * from pre-processed topography cache files (see
+   * #TopographyCacheFormat) where available
+   */
   void Load(NLineReader &reader,
-            Path directory, struct zzip_dir *zdir = nullptr) noexcept;
+            Path directory, struct zzip_dir *zdir = nullptr,
+            const TopographyCacheOptions *cache_options = nullptr) noexcept;
   void Reset() noexcept;
 };
@@ -22,11 +22,19 @@
 struct GeoPoint;
 
 class XShape {
+public:
   static constexpr std::size_t MAX_LINES = 32;
 #ifdef ENABLE_OPENGL
   static constexpr std::size_t THINNING_LEVELS = 4;
 #endif
 
+#ifdef ENABLE_OPENGL
+  using Point = ShapePoint;
+#else
+  using Point = GeoPoint;
+#endif
+
+private:
   GeoBounds bounds;
 
   uint8_t type;
@@ -43,30 +51,34 @@ class XShape {
    */
   std::array<uint16_t, MAX_LINES> lines;
 
-#ifdef ENABLE_OPENGL
-  using Point = ShapePoint;
-#else
-  using Point = GeoPoint;
-#endif
-
   /**
-   * All points of all lines.
+   * All points of all lines.  This points to #allocated_points or
+   * into a memory-mapped topography cache file.
    */
-  std::unique_ptr<Point[]> points;
+  const Point *points = nullptr;
+
+  std::unique_ptr<Point[]> allocated_points;
 
 #ifdef ENABLE_OPENGL
   /**
    * Indices of polygon triangles or lines with reduced number of vertices.
    */
-  std::array<uint16_t *, THINNING_LEVELS> indices{};
+  std::array<const uint16_t *, THINNING_LEVELS> indices{};
 
   /**
    * For polygons this will contain the total number of triangle vertices
    * for each thinning level.
    * For lines there will be an array of size num_lines for each thinning
    * level, which contains the number of points for each line.
+   *
+   * The indices follow the counts in the same memory block.
    */
-  std::array<std::unique_ptr<uint16_t[]>, THINNING_LEVELS> index_count;
+  std::array<const uint16_t *, THINNING_LEVELS> index_count{};
+
+  /**
+   * The memory of the index blocks built by BuildIndices().
+   */
+  std::array<std::unique_ptr<uint16_t[]>, THINNING_LEVELS> allocated_indices;
 
   /**
    * The start offset in the #GLArrayBuffer (vertex buffer object).
@@ -75,7 +87,13 @@ class XShape {
   mutable unsigned offset;
 #endif
 
-  BasicAllocatedString<TCHAR> label;
+  BasicAllocatedString<TCHAR> allocated_label;
+
+  /**
+   * The label; this points to #allocated_label or into a
+   * memory-mapped topography cache file.
+   */
+  const TCHAR *label;
 
 public:
   /**
@@ -84,6 +102,16 @@ public:
   XShape(const shapeObj &shape, const GeoPoint &file_center,
          const char *label);
 
+  /**
+   * Construct an object which refers to pre-processed data, e.g. in
+   * a memory-mapped topography cache file.  Nothing is copied except
+   * for the line sizes; the points and the label must remain valid
+   * as long as this object exists.
+   */
+  XShape(const GeoBounds &bounds, MS_SHAPE_TYPE type,
+         std::span<const uint16_t> lines, const Point *points,
+         const TCHAR *label) noexcept;
+
   ~XShape() noexcept;
 
   XShape(const XShape &) = delete;
@@ -111,6 +139,16 @@ public:
   [[gnu::pure]]
   Indices GetIndices(int thinning_level,
                      ShapeScalar min_distance) const noexcept;
+
+  /**
+   * Use a pre-computed index block (counts followed by indices, see
+   * GetIndices()) for the given thinning level.  The block must
+   * remain valid as long as this object exists.
+   */
+  void SetIndices(unsigned thinning_level, const uint16_t *count) noexcept {
+    index_count[thinning_level] = count;
+    indices[thinning_level] = count + (type == MS_SHAPE_LINE ? num_lines : 1);
+  }
 #endif
 
   const GeoBounds &get_bounds() const noexcept {
@@ -126,10 +164,10 @@ public:
   }
 
   const Point *GetPoints() const noexcept {
-    return points.get();
+    return points;
   }
 
   const TCHAR *GetLabel() const noexcept {
-    return label.c_str();
+    return label;
   }
 };
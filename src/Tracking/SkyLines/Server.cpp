@@ -10,13 +10,30 @@
 #include "net/UniqueSocketDescriptor.hxx"
 #include "util/CRC16CCITT.hpp"
 
+#ifdef __linux__
+#include "net/MsgHdr.hxx"
+#endif
+
+#include <array>
+#include <stdexcept>
+#include <utility>
+
 static UniqueSocketDescriptor
-CreateBindUDP(SocketAddress address)
+CreateBindUDP(SocketAddress address, bool reuse_port)
 {
   UniqueSocketDescriptor s;
   if (!s.Create(address.GetFamily(), SOCK_DGRAM, 0))
     throw MakeSocketError("Failed to create socket");
 
+  if (reuse_port) {
+#ifdef __linux__
+    if (!s.SetReusePort())
+      throw MakeSocketError("Failed to set SO_REUSEPORT");
+#else
+    throw std::runtime_error("SO_REUSEPORT not supported");
+#endif
+  }
+
   if (!s.Bind(address))
     throw MakeSocketError("Failed to connect socket");
 
@@ -25,11 +42,29 @@ CreateBindUDP(SocketAddress address)
 
 namespace SkyLinesTracking {
 
+/**
+ * The buffers for one ReceiveBatch() call.  They are allocated once
+ * because they are too large for the stack.
+ */
+struct Server::ReceiveBuffers {
+  std::array<StaticSocketAddress, RECEIVE_BATCH> addresses;
+  std::array<std::array<std::byte, MAX_DATAGRAM_SIZE>, RECEIVE_BATCH> data;
+
+#ifdef __linux__
+  std::array<struct iovec, RECEIVE_BATCH> iov;
+  std::array<struct mmsghdr, RECEIVE_BATCH> msgs;
+#endif
+};
+
 Server::Server(EventLoop &event_loop,
-               SocketAddress server_address)
+               SocketAddress server_address, bool reuse_port)
   :socket(event_loop, BIND_THIS_METHOD(OnSocketReady),
-          CreateBindUDP(server_address).Release())
+          CreateBindUDP(server_address, reuse_port).Release()),
+   receive_buffers(std::make_unique<ReceiveBuffers>())
 {
+  send_queue.reserve(SEND_BATCH);
+  send_data.reserve(SEND_BATCH * MAX_DATAGRAM_SIZE / 4);
+
   socket.ScheduleRead();
 }
 
@@ -38,12 +73,12 @@ Server::~Server()
   socket.Close();
 }
 
-void
-Server::SendBuffer(SocketAddress address,
-                   std::span<const std::byte> buffer) noexcept
+inline void
+Server::SendNow(SocketAddress address,
+                std::span<const std::byte> buffer) noexcept
 {
   try {
-    ssize_t nbytes = socket.GetSocket().WriteNoWait(buffer);
+    ssize_t nbytes = socket.GetSocket().WriteNoWait(buffer, address);
     if (nbytes < 0)
       throw MakeSocketError("Failed to send");
   } catch (...) {
@@ -51,6 +86,71 @@ Server::SendBuffer(SocketAddress address,
   }
 }
 
+void
+Server::SendBuffer(SocketAddress address,
+                   std::span<const std::byte> buffer) noexcept
+{
+  if (!dispatching) {
+    SendNow(address, buffer);
+    return;
+  }
+
+  if (send_queue.size() >= SEND_BATCH)
+    FlushSendQueue();
+
+  send_queue.push_back({StaticSocketAddress{address},
+                        send_data.size(), buffer.size()});
+  send_data.insert(send_data.end(), buffer.begin(), buffer.end());
+}
+
+void
+Server::FlushSendQueue() noexcept
+{
+  /* don't queue while flushing; OnSendError() may send */
+  const bool old_dispatching = std::exchange(dispatching, false);
+
+#ifdef __linux__
+  std::array<struct iovec, SEND_BATCH> iov;
+  std::array<struct mmsghdr, SEND_BATCH> msgs;
+
+  const std::size_t n = send_queue.size();
+  for (std::size_t i = 0; i < n; ++i) {
+    const auto &q = send_queue[i];
+    iov[i] = {send_data.data() + q.position, q.size};
+    msgs[i].msg_hdr = MakeMsgHdr(q.address, {&iov[i], 1}, {});
+    msgs[i].msg_len = 0;
+  }
+
+  std::size_t i = 0;
+  while (i < n) {
+    int result = sendmmsg(socket.GetSocket().Get(), &msgs[i], n - i,
+                          MSG_DONTWAIT);
+    if (result > 0) {
+      i += result;
+      continue;
+    }
+
+    /* the first remaining datagram has failed; report and skip it */
+    const auto &q = send_queue[i];
+    try {
+      throw MakeSocketError("Failed to send");
+    } catch (...) {
+      OnSendError(q.address, std::current_exception());
+    }
+
+    ++i;
+  }
+#else
+  for (const auto &q : send_queue)
+    SendNow(q.address, std::span{send_data}.subspan(q.position, q.size));
+#endif
+
+  send_queue.clear();
+  send_data.clear();
+
+  dispatching = old_dispatching;
+}
+
 void
 Server::OnPing(const Client &client, unsigned id)
 {
@@ -163,25 +263,65 @@ Server::OnDatagramReceived(Client &&client,
 }
 
 void
-Server::OnSocketReady(unsigned) noexcept
-try {
-  // TODO: use recvmmsg() on Linux
+Server::ReceiveBatch()
+{
+  auto &b = *receive_buffers;
+
+#ifdef __linux__
+  for (std::size_t i = 0; i < RECEIVE_BATCH; ++i) {
+    b.iov[i] = {b.data[i].data(), b.data[i].size()};
+    b.msgs[i].msg_hdr = MakeMsgHdr(b.addresses[i], {&b.iov[i], 1}, {});
+    b.msgs[i].msg_len = 0;
+  }
 
-  Client client;
-  socklen_t address_size = sizeof(client.address);
-  char buffer[4096];
+  int n = recvmmsg(socket.GetSocket().Get(), b.msgs.data(), RECEIVE_BATCH,
+                   MSG_DONTWAIT, nullptr);
+  if (n < 0) {
+    if (IsSocketErrorReceiveWouldBlock(GetSocketError()))
+      return;
 
-  ssize_t nbytes = recvfrom(socket.GetSocket().Get(), buffer, sizeof(buffer),
-                            MSG_DONTWAIT,
-                            client.address, &address_size);
-  if (nbytes < 0)
     throw MakeSocketError("Failed to receive");
+  }
 
-  client.address.SetSize(address_size);
-  // TODO: set client.key
+  for (int i = 0; i < n; ++i) {
+    Client client;
+    client.address = b.addresses[i];
+    client.address.SetSize(b.msgs[i].msg_hdr.msg_namelen);
+    // TODO: set client.key
 
-  OnDatagramReceived(std::move(client), buffer, nbytes);
+    OnDatagramReceived(std::move(client), b.data[i].data(),
+                       b.msgs[i].msg_len);
+  }
+#else
+  for (std::size_t i = 0; i < RECEIVE_BATCH; ++i) {
+    Client client;
+    ssize_t nbytes = socket.GetSocket().ReadNoWait(b.data[i], client.address);
+    if (nbytes < 0) {
+      if (IsSocketErrorReceiveWouldBlock(GetSocketError()))
+        return;
+
+      throw MakeSocketError("Failed to receive");
+    }
+
+    // TODO: set client.key
+
+    OnDatagramReceived(std::move(client), b.data[i].data(), nbytes);
+  }
+#endif
+}
+
+void
+Server::OnSocketReady(unsigned) noexcept
+try {
+  dispatching = true;
+  ReceiveBatch();
+  dispatching = false;
+
+  FlushSendQueue();
 } catch (...) {
+  dispatching = false;
+  FlushSendQueue();
+
   socket.Close();
   OnError(std::current_exception());
 }
@@ -10,7 +10,9 @@
 #include <chrono>
 #include <cstdint>
 #include <exception>
+#include <memory>
 #include <span>
+#include <vector>
 
 struct GeoPoint;
 
@@ -23,8 +25,47 @@ namespace SkyLinesTracking {
  * virtual methods.
  */
 class Server {
+  /**
+   * The maximum number of datagrams received by one
+   * OnSocketReady() call.
+   */
+  static constexpr std::size_t RECEIVE_BATCH = 64;
+
+  /**
+   * The maximum number of queued replies; if the queue is full, it
+   * is flushed.
+   */
+  static constexpr std::size_t SEND_BATCH = 64;
+
+  static constexpr std::size_t MAX_DATAGRAM_SIZE = 4096;
+
   SocketEvent socket;
 
+  struct ReceiveBuffers;
+  const std::unique_ptr<ReceiveBuffers> receive_buffers;
+
+  /**
+   * A reply which has been queued by SendBuffer().
+   */
+  struct QueuedDatagram {
+    StaticSocketAddress address;
+
+    /**
+     * The location of the payload in #send_data.
+     */
+    std::size_t position, size;
+  };
+
+  std::vector<QueuedDatagram> send_queue;
+  std::vector<std::byte> send_data;
+
+  /**
+   * Is OnSocketReady() currently dispatching received datagrams?
+   * If yes, then SendBuffer() queues replies, to be sent in one
+   * batch.
+   */
+  bool dispatching = false;
+
 public:
   struct Client {
     StaticSocketAddress address;
@@ -32,7 +73,12 @@ public:
   };
 
 public:
-  Server(EventLoop &event_loop, SocketAddress server_address);
+  /**
+   * @param reuse_port set SO_REUSEPORT, to allow several #Server
+   * instances (e.g. one per thread) to share the port
+   */
+  Server(EventLoop &event_loop, SocketAddress server_address,
+         bool reuse_port=false);
 
   ~Server();
 
@@ -50,6 +96,11 @@ public:
     return socket.GetEventLoop();
   }
 
+  /**
+   * Send a datagram to a client.  While handling received
+   * datagrams, the reply is queued and sent later together with
+   * other replies.
+   */
   void SendBuffer(SocketAddress address,
                   std::span<const std::byte> buffer) noexcept;
 
@@ -59,7 +110,24 @@ public:
   }
 
 private:
+  void SendNow(SocketAddress address,
+               std::span<const std::byte> buffer) noexcept;
+
+  /**
+   * Send all replies queued by SendBuffer().
+   */
+  void FlushSendQueue() noexcept;
+
   void OnDatagramReceived(Client &&client, void *data, size_t length);
+
+  /**
+   * Receive up to #RECEIVE_BATCH datagrams and pass them to
+   * OnDatagramReceived().
+   *
+   * Throws on error.
+   */
+  void ReceiveBatch();
+
   void OnSocketReady(unsigned events) noexcept;
 
 protected:
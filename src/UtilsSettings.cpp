@@ -10,6 +10,7 @@
 #include "Waypoint/WaypointDetailsReader.hpp"
 #include "Topography/TopographyStore.hpp"
 #include "Topography/TopographyGlue.hpp"
+#include "Topography/AsyncCacheBuilder.hpp"
 #include "Dialogs/Dialogs.h"
 #include "Device/device.hpp"
 #include "Interface.hpp"
@@ -109,7 +110,7 @@ SettingsLeave(const UISettings &old_ui_settings)
   if (WaypointFileChanged || AirfieldFileChanged) {
     // re-load waypoints
     WaypointGlue::LoadWaypoints(way_points, data_components->terrain.get(),
-                                operation);
+                                file_cache, operation);
 
     try {
       WaypointDetails::ReadFileFromProfile(way_points, operation);
@@ -143,8 +144,12 @@ SettingsLeave(const UISettings &old_ui_settings)
 
     auto &topography = *data_components->topography;
     topography.Reset();
-    LoadConfiguredTopography(topography);
+    LoadConfiguredTopography(topography, file_cache);
     main_window.SetTopography(&topography);
+
+    if (data_components->topography_cache_builder)
+      BuildConfiguredTopographyCache(*data_components->topography_cache_builder,
+                                     *file_cache);
   }
 
   if (AirspaceFileChanged) {
@@ -157,7 +162,7 @@ SettingsLeave(const UISettings &old_ui_settings)
     airspace_database.Clear();
     ReadAirspace(airspace_database,
                  CommonInterface::GetComputerSettings().pressure,
-                 operation);
+                 file_cache, operation);
 
     if (data_components->terrain)
       SetAirspaceGroundLevels(airspace_database, *data_components->terrain);
@@ -0,0 +1,229 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "WaypointCache.hpp"
+#include "Factory.hpp"
+#include "Waypoint/Waypoints.hpp"
+#include "io/FlatCache.hpp"
+#include "util/StringAPI.hxx"
+
+#include <stdexcept>
+#include <vector>
+
+using namespace WaypointCacheFormat;
+
+static constexpr uint8_t FLAG_TURN_POINT = 0x1;
+static constexpr uint8_t FLAG_HOME = 0x2;
+static constexpr uint8_t FLAG_START_POINT = 0x4;
+static constexpr uint8_t FLAG_FINISH_POINT = 0x8;
+static constexpr uint8_t FLAG_WATCHED = 0x10;
+
+static uint8_t
+ExportFlags(Waypoint::Flags flags) noexcept
+{
+  uint8_t result = 0;
+  if (flags.turn_point)
+    result |= FLAG_TURN_POINT;
+  if (flags.home)
+    result |= FLAG_HOME;
+  if (flags.start_point)
+    result |= FLAG_START_POINT;
+  if (flags.finish_point)
+    result |= FLAG_FINISH_POINT;
+  if (flags.watched)
+    result |= FLAG_WATCHED;
+  return result;
+}
+
+static Waypoint::Flags
+ImportFlags(uint8_t src) noexcept
+{
+  Waypoint::Flags flags;
+  flags.turn_point = src & FLAG_TURN_POINT;
+  flags.home = src & FLAG_HOME;
+  flags.start_point = src & FLAG_START_POINT;
+  flags.finish_point = src & FLAG_FINISH_POINT;
+  flags.watched = src & FLAG_WATCHED;
+  return flags;
+}
+
+static void
+AddFiles(FlatCache::StringTable &strings, std::vector<StringRef> &refs,
+         const std::forward_list<tstring> &files,
+         uint32_t &position, uint32_t &n)
+{
+  position = refs.size();
+  n = 0;
+
+  for (const auto &i : files) {
+    refs.push_back(strings.Add(i));
+    ++n;
+  }
+}
+
+void
+SaveWaypointCache(FileCache &cache, const TCHAR *name, Path original_path,
+                  const TCHAR *source,
+                  std::span<const WaypointPtr> waypoints)
+{
+  FlatCache::StringTable strings;
+  std::vector<StringRef> refs;
+  std::vector<Record> records;
+  records.reserve(waypoints.size());
+
+  const StringRef source_ref = strings.Add(source);
+
+  for (const auto &wp : waypoints) {
+    Record r{};
+    r.latitude = wp->location.latitude.Radians();
+    r.longitude = wp->location.longitude.Radians();
+    r.elevation = wp->has_elevation ? wp->elevation : 0;
+    r.shortname = strings.Add(wp->shortname);
+    r.name = strings.Add(wp->name);
+    r.comment = strings.Add(wp->comment);
+    r.details = strings.Add(wp->details);
+    AddFiles(strings, refs, wp->files_embed,
+             r.files_embed, r.n_files_embed);
+#ifdef HAVE_RUN_FILE
+    AddFiles(strings, refs, wp->files_external,
+             r.files_external, r.n_files_external);
+#endif
+    r.original_id = wp->original_id;
+    r.radio_frequency = wp->radio_frequency.IsDefined()
+      ? wp->radio_frequency.GetKiloHertz()
+      : 0;
+    r.runway_direction = wp->runway.IsDirectionDefined()
+      ? int16_t(wp->runway.GetDirectionDegrees())
+      : int16_t(-1);
+    r.runway_length = wp->runway.IsLengthDefined()
+      ? wp->runway.GetLength()
+      : 0;
+    r.type = uint8_t(wp->type);
+    r.flags = ExportFlags(wp->flags);
+    r.has_elevation = wp->has_elevation;
+    records.push_back(r);
+  }
+
+  const auto chars = strings.GetChars();
+
+  FlatCache::Writer writer(cache, name, original_path);
+
+  Trailer trailer{};
+  trailer.magic = MAGIC;
+  trailer.version = VERSION;
+  trailer.n_records = records.size();
+  trailer.n_refs = refs.size();
+  trailer.n_chars = chars.size();
+  trailer.source = source_ref;
+  trailer.records_offset = writer.GetPosition();
+
+  writer.Write(records);
+  writer.Write(refs);
+  writer.Write(chars);
+  writer.Commit(trailer);
+}
+
+static bool
+IsValidFileList(uint32_t position, uint32_t n,
+                const Trailer &trailer) noexcept
+{
+  return position <= trailer.n_refs && n <= trailer.n_refs - position;
+}
+
+static bool
+IsValidRecord(const Record &r, const Trailer &trailer) noexcept
+{
+  return r.shortname < trailer.n_chars && r.name < trailer.n_chars &&
+    r.comment < trailer.n_chars && r.details < trailer.n_chars &&
+    IsValidFileList(r.files_embed, r.n_files_embed, trailer) &&
+    IsValidFileList(r.files_external, r.n_files_external, trailer) &&
+    r.runway_direction >= -1 && r.runway_direction < 360 &&
+    r.type <= uint8_t(Waypoint::Type::PGLANDING);
+}
+
+static std::forward_list<tstring>
+ImportFiles(std::span<const StringRef> refs, const TCHAR *chars)
+{
+  std::forward_list<tstring> files;
+  auto i = files.before_begin();
+  for (const auto ref : refs)
+    i = files.emplace_after(i, chars + ref);
+  return files;
+}
+
+static void
+LoadWaypointCache(std::span<const std::byte> raw, const TCHAR *source,
+                  Waypoints &waypoints, WaypointFactory factory)
+{
+  FlatCache::Reader reader(raw);
+  const auto trailer = reader.ReadTrailer<Trailer>();
+  if (trailer.magic != MAGIC || trailer.version != VERSION)
+    throw std::runtime_error("Malformed waypoint cache");
+
+  reader.Seek(trailer.records_offset);
+  const auto records = reader.Read<Record>(trailer.n_records);
+  const auto refs = reader.Read<StringRef>(trailer.n_refs);
+  const auto chars = reader.ReadStrings(trailer.n_chars);
+  reader.Finish();
+
+  for (const auto ref : refs)
+    if (ref >= trailer.n_chars)
+      throw std::runtime_error("Malformed waypoint cache strings");
+
+  for (const auto &r : records)
+    if (!IsValidRecord(r, trailer))
+      throw std::runtime_error("Malformed waypoint cache record");
+
+  if (!StringIsEqual(FlatCache::GetString(chars, trailer.source), source))
+    throw std::runtime_error("Waypoint cache is for a different file");
+
+  /* everything has been validated; now create the waypoints */
+
+  for (const auto &r : records) {
+    Waypoint wp = factory.Create(GeoPoint(Angle::Radians(r.longitude),
+                                          Angle::Radians(r.latitude)));
+    wp.shortname = chars.data() + r.shortname;
+    wp.name = chars.data() + r.name;
+    wp.comment = chars.data() + r.comment;
+    wp.details = chars.data() + r.details;
+    wp.files_embed = ImportFiles(refs.subspan(r.files_embed,
+                                              r.n_files_embed),
+                                 chars.data());
+#ifdef HAVE_RUN_FILE
+    wp.files_external = ImportFiles(refs.subspan(r.files_external,
+                                                 r.n_files_external),
+                                    chars.data());
+#endif
+    wp.original_id = r.original_id;
+
+    if (r.runway_direction >= 0)
+      wp.runway.SetDirectionDegrees(r.runway_direction);
+    wp.runway.SetLength(r.runway_length);
+
+    if (r.radio_frequency != 0)
+      wp.radio_frequency = RadioFrequency::FromKiloHertz(r.radio_frequency);
+
+    wp.type = Waypoint::Type(r.type);
+    wp.flags = ImportFlags(r.flags);
+
+    if (r.has_elevation) {
+      wp.elevation = r.elevation;
+      wp.has_elevation = true;
+    } else
+      factory.FallbackElevation(wp);
+
+    waypoints.Append(std::move(wp));
+  }
+}
+
+bool
+LoadWaypointCache(FileCache &cache, const TCHAR *name, Path original_path,
+                  const TCHAR *source,
+                  Waypoints &waypoints, WaypointFactory factory)
+{
+  return FlatCache::Load(cache, name, original_path,
+                         [&](std::unique_ptr<FileMapping> &&mapping){
+                           LoadWaypointCache(*mapping, source,
+                                             waypoints, factory);
+                         });
+}
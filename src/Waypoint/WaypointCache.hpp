@@ -0,0 +1,116 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Engine/Waypoint/Ptr.hpp"
+
+#include <cstdint>
+#include <span>
+#include <tchar.h>
+
+class FileCache;
+class Path;
+class Waypoints;
+class WaypointFactory;
+
+/**
+ * On-disk layout of a waypoint cache file: the parsed waypoints of
+ * one waypoint file in a flat layout which can be loaded without
+ * parsing the original file again.
+ *
+ * This is a #FlatCache file which consists of an array of #Record,
+ * an array of string references (for the file lists), a
+ * FlatCache::StringTable and a #Trailer at the very end.
+ */
+namespace WaypointCacheFormat {
+
+static constexpr uint32_t MAGIC = 0x57505443;
+static constexpr uint32_t VERSION = 1;
+
+/**
+ * See FlatCache::StringRef.
+ */
+using StringRef = uint32_t;
+
+struct Record {
+  /**
+   * The location in radians.
+   */
+  double latitude, longitude;
+
+  double elevation;
+
+  StringRef shortname, name, comment, details;
+
+  /**
+   * The position and size of the file lists in the string
+   * reference array.
+   */
+  uint32_t files_embed, n_files_embed;
+  uint32_t files_external, n_files_external;
+
+  uint32_t original_id;
+
+  /**
+   * The radio frequency in kHz; 0 if not defined.
+   */
+  uint32_t radio_frequency;
+
+  /**
+   * The runway direction in degrees; -1 if not defined.
+   */
+  int16_t runway_direction;
+
+  uint16_t runway_length;
+
+  uint8_t type, flags, has_elevation, reserved;
+};
+
+struct Trailer {
+  uint32_t magic;
+  uint32_t version;
+
+  uint32_t n_records, n_refs, n_chars;
+
+  /**
+   * The string which identifies the original file; it is compared
+   * on loading, in addition to the size and modification time
+   * checked by #FileCache.
+   */
+  StringRef source;
+
+  uint64_t records_offset;
+};
+
+} // namespace WaypointCacheFormat
+
+/**
+ * Write the given waypoints (which were all parsed from the same
+ * file) to a new cache file.
+ *
+ * Throws on error.
+ *
+ * @param source a string identifying the original file (e.g. its
+ * path and the name of the entry in a ZIP file)
+ */
+void
+SaveWaypointCache(FileCache &cache, const TCHAR *name, Path original_path,
+                  const TCHAR *source,
+                  std::span<const WaypointPtr> waypoints);
+
+/**
+ * Load waypoints from a cache file and append them to the
+ * #Waypoints container.  The waypoints are created by the given
+ * #WaypointFactory; those without an elevation get one from
+ * WaypointFactory::FallbackElevation().
+ *
+ * Throws if the cache file is malformed; it is deleted in this case
+ * and nothing has been appended.
+ *
+ * @return false if there is no up-to-date cache file
+ */
+bool
+LoadWaypointCache(FileCache &cache, const TCHAR *name, Path original_path,
+                  const TCHAR *source,
+                  Waypoints &waypoints, WaypointFactory factory);
@@ -2,6 +2,7 @@
 // Copyright The XCSoar Project
 
 #include "WaypointGlue.hpp"
+#include "WaypointCache.hpp"
 #include "Factory.hpp"
 #include "WaypointFileType.hpp"
 #include "Profile/Profile.hpp"
@@ -15,18 +16,101 @@
 #include "io/MapFile.hpp"
 #include "io/ZipArchive.hpp"
 
+#include <algorithm>
+#include <vector>
+
 namespace WaypointGlue {
 
+/**
+ * Load waypoints from the #FileCache if it is up to date; if not,
+ * call the given parser and save its result to a new cache file.
+ *
+ * Throws on error; the waypoints parsed before a parser error are
+ * added nonetheless (but not cached).
+ *
+ * @param parse a function which parses the original file into the
+ * given #Waypoints container
+ */
+template<typename P>
+static void
+LoadCachedWaypointFile(Waypoints &waypoints, FileCache *cache,
+                       const TCHAR *cache_name, Path original_path,
+                       WaypointOrigin origin,
+                       const RasterTerrain *terrain,
+                       P &&parse)
+{
+  const WaypointFactory factory(origin, terrain);
+
+  if (cache == nullptr) {
+    parse(waypoints, factory);
+    return;
+  }
+
+  try {
+    if (LoadWaypointCache(*cache, cache_name, original_path,
+                          original_path.c_str(), waypoints, factory))
+      return;
+  } catch (...) {
+    LogError(std::current_exception(), "Failed to load waypoint cache");
+  }
+
+  /* parse without terrain, because the cache must not depend on
+     it; the terrain elevation is applied below */
+  Waypoints parsed;
+
+  /* preserve the order of the file, which is what
+     Waypoints::Append() assigned ids in */
+  const auto get_list = [&parsed]{
+    std::vector<WaypointPtr> list(parsed.begin(), parsed.end());
+    std::sort(list.begin(), list.end(), [](const auto &a, const auto &b){
+      return a->id < b->id;
+    });
+    return list;
+  };
+
+  const auto move_all = [&](const std::vector<WaypointPtr> &list){
+    for (const auto &i : list) {
+      Waypoint wp = *i;
+      if (!wp.has_elevation)
+        factory.FallbackElevation(wp);
+      waypoints.Append(std::move(wp));
+    }
+  };
+
+  try {
+    parse(parsed, WaypointFactory(origin));
+  } catch (...) {
+    /* keep the waypoints which were parsed before the error, but
+       don't cache them */
+    move_all(get_list());
+    throw;
+  }
+
+  const auto list = get_list();
+
+  try {
+    SaveWaypointCache(*cache, cache_name, original_path,
+                      original_path.c_str(), list);
+  } catch (...) {
+    LogError(std::current_exception(), "Failed to save waypoint cache");
+  }
+
+  move_all(list);
+}
+
 static bool
-LoadWaypointFile(Waypoints &waypoints, Path path,
+LoadWaypointFile(Waypoints &waypoints, FileCache *cache,
+                 const TCHAR *cache_name, Path path,
                  WaypointFileType file_type,
                  WaypointOrigin origin,
                  const RasterTerrain *terrain,
                  ProgressListener &progress) noexcept
 try {
-  ReadWaypointFile(path, file_type, waypoints,
-                   WaypointFactory(origin, terrain),
-                   progress);
+  LoadCachedWaypointFile(waypoints, cache, cache_name, path, origin, terrain,
+                         [&](Waypoints &dest, WaypointFactory factory){
+                           ReadWaypointFile(path, file_type, dest, factory,
+                                            progress);
+                         });
   return true;
 } catch (...) {
   LogFormat(_T("Failed to read waypoint file: %s"), path.c_str());
@@ -35,14 +119,16 @@ try {
 }
 
 static bool
-LoadWaypointFile(Waypoints &waypoints, Path path,
+LoadWaypointFile(Waypoints &waypoints, FileCache *cache,
+                 const TCHAR *cache_name, Path path,
                  WaypointOrigin origin,
                  const RasterTerrain *terrain,
                  ProgressListener &progress) noexcept
 try {
-  ReadWaypointFile(path, waypoints,
-                   WaypointFactory(origin, terrain),
-                   progress);
+  LoadCachedWaypointFile(waypoints, cache, cache_name, path, origin, terrain,
+                         [&](Waypoints &dest, WaypointFactory factory){
+                           ReadWaypointFile(path, dest, factory, progress);
+                         });
   return true;
 } catch (...) {
   LogFormat(_T("Failed to read waypoint file: %s"), path.c_str());
@@ -50,16 +136,25 @@ try {
   return false;
 }
 
+/**
+ * @param archive_path the path of the ZIP file, which is used to
+ * check whether the cache file is up to date
+ */
 static bool
-LoadWaypointFile(Waypoints &waypoints, struct zzip_dir *dir, const char *path,
+LoadWaypointFile(Waypoints &waypoints, FileCache *cache,
+                 const TCHAR *cache_name, Path archive_path,
+                 struct zzip_dir *dir, const char *path,
                  WaypointFileType file_type,
                  WaypointOrigin origin,
                  const RasterTerrain *terrain,
                  ProgressListener &progressg) noexcept
 try {
-  ReadWaypointFile(dir, path, file_type, waypoints,
-                   WaypointFactory(origin, terrain),
-                   progressg);
+  LoadCachedWaypointFile(waypoints, cache, cache_name, archive_path,
+                         origin, terrain,
+                         [&](Waypoints &dest, WaypointFactory factory){
+                           ReadWaypointFile(dir, path, file_type, dest,
+                                            factory, progressg);
+                         });
   return true;
 } catch (...) {
   LogFormat(_T("Failed to read waypoint file: %s"), path);
@@ -69,7 +164,7 @@ try {
 
 bool
 LoadWaypoints(Waypoints &way_points, const RasterTerrain *terrain,
-              ProgressListener &progress)
+              FileCache *cache, ProgressListener &progress)
 {
   bool found = false;
 
@@ -79,19 +174,22 @@ LoadWaypoints(Waypoints &way_points, const RasterTerrain *terrain,
   // ### FIRST FILE ###
   auto path = Profile::GetPath(ProfileKeys::WaypointFile);
   if (path != nullptr)
-    found |= LoadWaypointFile(way_points, path, WaypointOrigin::PRIMARY,
+    found |= LoadWaypointFile(way_points, cache, _T("waypoints-primary"),
+                              path, WaypointOrigin::PRIMARY,
                               terrain, progress);
 
   // ### SECOND FILE ###
   path = Profile::GetPath(ProfileKeys::AdditionalWaypointFile);
   if (path != nullptr)
-    found |= LoadWaypointFile(way_points, path, WaypointOrigin::ADDITIONAL,
+    found |= LoadWaypointFile(way_points, cache, _T("waypoints-additional"),
+                              path, WaypointOrigin::ADDITIONAL,
                               terrain, progress);
 
   // ### WATCHED WAYPOINT/THIRD FILE ###
   path = Profile::GetPath(ProfileKeys::WatchedWaypointFile);
   if (path != nullptr)
-    found |= LoadWaypointFile(way_points, path, WaypointOrigin::WATCHED,
+    found |= LoadWaypointFile(way_points, cache, _T("waypoints-watched"),
+                              path, WaypointOrigin::WATCHED,
                               terrain, progress);
 
   // ### MAP/FOURTH FILE ###
@@ -100,12 +198,18 @@ LoadWaypoints(Waypoints &way_points, const RasterTerrain *terrain,
   if (!found) {
     try {
       if (auto archive = OpenMapFile()) {
-        found |= LoadWaypointFile(way_points, archive->get(), "waypoints.xcw",
+        const auto map_path = Profile::GetPath(ProfileKeys::MapFile);
+
+        found |= LoadWaypointFile(way_points, cache, _T("waypoints-map-xcw"),
+                                  map_path,
+                                  archive->get(), "waypoints.xcw",
                                   WaypointFileType::WINPILOT,
                                   WaypointOrigin::MAP,
                                   terrain, progress);
 
-        found |= LoadWaypointFile(way_points, archive->get(), "waypoints.cup",
+        found |= LoadWaypointFile(way_points, cache, _T("waypoints-map-cup"),
+                                  map_path,
+                                  archive->get(), "waypoints.cup",
                                   WaypointFileType::SEEYOU,
                                   WaypointOrigin::MAP,
                                   terrain, progress);
@@ -116,7 +220,8 @@ LoadWaypoints(Waypoints &way_points, const RasterTerrain *terrain,
     }
   }
   //Load user.cup
-  LoadWaypointFile(way_points, LocalPath(_T("user.cup")),
+  LoadWaypointFile(way_points, cache, _T("waypoints-user"),
+                   LocalPath(_T("user.cup")),
                    WaypointFileType::SEEYOU,
                    WaypointOrigin::USER, terrain, progress);
   // Optimise the waypoint list after attaching new waypoints
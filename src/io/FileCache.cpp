@@ -4,6 +4,7 @@
 #include "FileCache.hpp"
 #include "FileReader.hxx"
 #include "FileOutputStream.hxx"
+#include "FileMapping.hpp"
 #include "system/FileUtil.hpp"
 #include "util/SpanCast.hxx"
 
@@ -80,27 +81,40 @@ FileCache::Flush(const TCHAR *name)
   File::Delete(MakeCachePath(name));
 }
 
-std::unique_ptr<Reader>
-FileCache::Load(const TCHAR *name, Path original_path) noexcept
+/**
+ * Check whether the cache file exists and is not older than the
+ * original file.  A stale cache file gets deleted.
+ */
+static bool
+CheckCacheFile(Path original_path, Path path, FileInfo &original_info)
 {
-  FileInfo original_info;
   if (!GetRegularFileInfo(original_path, original_info))
-    return nullptr;
-
-  const auto path = MakeCachePath(name);
+    return false;
 
   FileInfo cached_info;
   if (!GetRegularFileInfo(path, cached_info))
-    return nullptr;
+    return false;
 
   /* if the original file is newer than the cache, discard the cache -
      unless the system clock is skewed (origina file's modification
      time is in the future) */
   if (original_info.mtime > cached_info.mtime && !original_info.IsFuture()) {
     File::Delete(path);
-    return nullptr;
+    return false;
   }
 
+  return true;
+}
+
+std::unique_ptr<Reader>
+FileCache::Load(const TCHAR *name, Path original_path) noexcept
+{
+  const auto path = MakeCachePath(name);
+
+  FileInfo original_info;
+  if (!CheckCacheFile(original_path, path, original_info))
+    return nullptr;
+
   try {
     auto r = std::make_unique<FileReader>(path);
 
@@ -120,6 +134,37 @@ FileCache::Load(const TCHAR *name, Path original_path) noexcept
   return nullptr;
 }
 
+std::unique_ptr<FileMapping>
+FileCache::Map(const TCHAR *name, Path original_path) noexcept
+{
+  const auto path = MakeCachePath(name);
+
+  FileInfo original_info;
+  if (!CheckCacheFile(original_path, path, original_info))
+    return nullptr;
+
+  try {
+    auto m = std::make_unique<FileMapping>(path);
+    const std::span<const std::byte> raw = *m;
+
+    unsigned magic;
+    struct FileInfo old_info;
+
+    if (raw.size() >= sizeof(magic) + sizeof(old_info)) {
+      memcpy(&magic, raw.data(), sizeof(magic));
+      memcpy(&old_info, raw.data() + sizeof(magic), sizeof(old_info));
+
+      if (magic == FILE_CACHE_MAGIC &&
+          old_info == original_info)
+        return m;
+    }
+  } catch (...) {
+  }
+
+  File::Delete(path);
+  return nullptr;
+}
+
 std::unique_ptr<FileOutputStream>
 FileCache::Save(const TCHAR *name, Path original_path)
 {
@@ -11,6 +11,7 @@
 
 class Reader;
 class FileOutputStream;
+class FileMapping;
 
 class FileCache {
   AllocatedPath cache_path;
@@ -32,6 +33,17 @@ public:
    */
   std::unique_ptr<Reader> Load(const TCHAR *name, Path original_path) noexcept;
 
+  /**
+   * Like Load(), but map the whole cache file into memory.  The
+   * mapping includes the #FileCache header, i.e. file offsets
+   * written after the header (see FileOutputStream::Tell()) can be
+   * used as offsets into the mapping.
+   *
+   * Returns nullptr on error.
+   */
+  std::unique_ptr<FileMapping> Map(const TCHAR *name,
+                                   Path original_path) noexcept;
+
   /**
    * Throws on error.
    */
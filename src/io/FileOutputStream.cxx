@@ -137,6 +137,18 @@ FileOutputStream::Sync()
 		throw FmtLastError("Failed to sync {}", GetPath());
 }
 
+void
+FileOutputStream::Truncate(uint64_t size)
+{
+	assert(IsDefined());
+
+	LARGE_INTEGER offset;
+	offset.QuadPart = size;
+	if (!SetFilePointerEx(handle, offset, nullptr, FILE_BEGIN) ||
+	    !SetEndOfFile(handle))
+		throw FmtLastError("Failed to truncate {}", GetPath());
+}
+
 void
 FileOutputStream::Commit()
 try {
@@ -237,6 +249,12 @@ FileOutputStream::OpenAppend(bool create)
 #endif
 		     path.c_str(), flags))
 		throw FmtErrno("Failed to append to {}", path);
+
+	/* O_APPEND moves the pointer only on the first write; move it
+	   now, so Tell() returns the size of the file (like on
+	   Windows) */
+	if (fd.Seek(fd.GetSize()) < 0)
+		throw FmtErrno("Failed to seek {}", path);
 }
 
 uint64_t
@@ -271,6 +289,15 @@ FileOutputStream::Sync()
 		throw FmtErrno("Failed to sync {}", GetPath());
 }
 
+void
+FileOutputStream::Truncate(uint64_t size)
+{
+	assert(IsDefined());
+
+	if (ftruncate(fd.Get(), size) < 0 || fd.Seek(size) < 0)
+		throw FmtErrno("Failed to truncate {}", GetPath());
+}
+
 void
 FileOutputStream::Commit()
 try {
@@ -137,6 +137,16 @@ public:
 	 */
 	void Sync();
 
+	/**
+	 * Discard everything after the given offset, e.g. to roll
+	 * back a partial write.  With #Mode::APPEND_EXISTING and
+	 * #Mode::APPEND_OR_CREATE, the next Write() appends at the
+	 * new end of the file.
+	 *
+	 * Throws on error.
+	 */
+	void Truncate(uint64_t size);
+
 	/**
 	 * Commit all data written to the file and make the file
 	 * visible on the specified path.
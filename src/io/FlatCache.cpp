@@ -0,0 +1,131 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "FlatCache.hpp"
+#include "FileOutputStream.hxx"
+
+#include <stdexcept>
+
+#include <string.h>
+
+namespace FlatCache {
+
+StringTable::StringTable() noexcept
+{
+  /* offset 0 is the empty string */
+  chars.push_back(_T('\0'));
+}
+
+StringRef
+StringTable::Add(tstring_view s)
+{
+  if (s.empty())
+    return 0;
+
+  const auto [i, inserted] = map.try_emplace(tstring{s}, chars.size());
+  if (inserted) {
+    if (chars.size() + s.size() >= UINT32_MAX)
+      throw std::runtime_error("String table too large for the cache");
+
+    chars.insert(chars.end(), s.begin(), s.end());
+    chars.push_back(_T('\0'));
+  }
+
+  return i->second;
+}
+
+Writer::Writer(FileCache &cache, const TCHAR *name, Path original_path)
+  :file(cache.Save(name, original_path)), os(*file),
+   position(file->Tell())
+{
+  Pad();
+}
+
+Writer::~Writer() noexcept = default;
+
+void
+Writer::Write(std::span<const std::byte> src)
+{
+  os.Write(src);
+  position += src.size();
+}
+
+void
+Writer::Pad()
+{
+  static constexpr std::byte zero[ALIGNMENT]{};
+
+  const std::size_t n = (ALIGNMENT - position % ALIGNMENT) % ALIGNMENT;
+  Write(std::span{zero, n});
+}
+
+void
+Writer::Commit(std::span<const std::byte> trailer)
+{
+  Pad();
+  Write(trailer);
+  os.Flush();
+  file->Commit();
+}
+
+void
+Reader::ReadTrailer(std::span<std::byte> dest)
+{
+  if (raw.size() < dest.size())
+    throw std::runtime_error("Cache file too small");
+
+  end = raw.size() - dest.size();
+  memcpy(dest.data(), raw.data() + end, dest.size());
+}
+
+void
+Reader::Seek(uint64_t offset)
+{
+  if (offset % ALIGNMENT != 0 || offset > end)
+    throw std::runtime_error("Malformed cache file");
+
+  position = offset;
+}
+
+std::span<const std::byte>
+Reader::ReadBytes(uint64_t size)
+{
+  if (size > end - position)
+    throw std::runtime_error("Malformed cache file");
+
+  const auto result = raw.subspan(position, size);
+  position += size;
+  return result;
+}
+
+std::span<const TCHAR>
+Reader::ReadStrings(std::size_t n)
+{
+  const auto chars = Read<TCHAR>(n);
+
+  /* the last string must be terminated; this guarantees that every
+     valid string reference points to a null-terminated string */
+  if (chars.empty() ||
+      chars.front() != _T('\0') || chars.back() != _T('\0'))
+    throw std::runtime_error("Malformed cache file strings");
+
+  return chars;
+}
+
+void
+Reader::Finish()
+{
+  if (end - position >= ALIGNMENT)
+    throw std::runtime_error("Malformed cache file");
+}
+
+const TCHAR *
+GetString(std::span<const TCHAR> chars, StringRef ref)
+{
+  if (ref >= chars.size())
+    throw std::runtime_error("Malformed cache file strings");
+
+  return chars.data() + ref;
+}
+
+} // namespace FlatCache
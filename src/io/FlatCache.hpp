@@ -0,0 +1,219 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "FileCache.hpp"
+#include "FileMapping.hpp"
+#include "BufferedOutputStream.hxx"
+#include "util/SpanCast.hxx"
+#include "util/tstring.hpp"
+#include "util/tstring_view.hxx"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include <tchar.h>
+
+/**
+ * Building blocks for #FileCache files with a "flat" layout: a
+ * sequence of arrays, each aligned to #ALIGNMENT bytes, followed by
+ * a fixed-size trailer at the very end of the file.  The trailer
+ * contains the sizes of all arrays and the offset of the first one;
+ * all offsets are absolute (i.e. include the #FileCache header), so
+ * they can be used as offsets into the mapping returned by
+ * FileCache::Map().
+ *
+ * The file format (the arrays, the trailer and how they are
+ * validated) is defined by the user of this library.
+ */
+namespace FlatCache {
+
+static constexpr std::size_t ALIGNMENT = 8;
+
+/**
+ * String references are offsets into a string table (in
+ * characters).  Offset 0 is always the empty string.
+ */
+using StringRef = uint32_t;
+
+/**
+ * Collects a table of null-terminated strings; each distinct string
+ * is stored only once.
+ */
+class StringTable {
+  std::vector<TCHAR> chars;
+  std::unordered_map<tstring, StringRef> map;
+
+public:
+  StringTable() noexcept;
+
+  std::span<const TCHAR> GetChars() const noexcept {
+    return chars;
+  }
+
+  StringRef Add(tstring_view s);
+};
+
+/**
+ * Writes a new cache file.
+ */
+class Writer {
+  std::unique_ptr<FileOutputStream> file;
+  BufferedOutputStream os;
+
+  uint64_t position;
+
+public:
+  /**
+   * Create the cache file and pad it to the first array.
+   *
+   * Throws on error.
+   */
+  Writer(FileCache &cache, const TCHAR *name, Path original_path);
+
+  ~Writer() noexcept;
+
+  Writer(const Writer &) = delete;
+  Writer &operator=(const Writer &) = delete;
+
+  /**
+   * Returns the offset of the next array.
+   */
+  uint64_t GetPosition() const noexcept {
+    return position;
+  }
+
+  /**
+   * Append data to the current array.
+   *
+   * Throws on error.
+   */
+  void Write(std::span<const std::byte> src);
+
+  template<typename T, std::size_t extent>
+  void Write(std::span<const T, extent> src) {
+    Write(std::span<const std::byte>{std::as_bytes(src)});
+  }
+
+  template<typename T>
+  void Write(const std::vector<T> &src) {
+    Write(std::span{src});
+  }
+
+  /**
+   * Finish the current array; the next one begins at an aligned
+   * offset.
+   *
+   * Throws on error.
+   */
+  void Pad();
+
+  /**
+   * Write the trailer and make the file visible.  Without this
+   * call, the file is discarded.
+   *
+   * Throws on error.
+   */
+  void Commit(std::span<const std::byte> trailer);
+
+  template<typename T>
+  void Commit(const T &trailer) {
+    Commit(std::span<const std::byte>{ReferenceAsBytes(trailer)});
+  }
+};
+
+/**
+ * Parses a mapped cache file.  All methods throw if the file is
+ * malformed.
+ */
+class Reader {
+  const std::span<const std::byte> raw;
+
+  /**
+   * The current position and the position of the trailer.
+   */
+  uint64_t position = 0, end = 0;
+
+public:
+  explicit Reader(std::span<const std::byte> _raw) noexcept
+    :raw(_raw) {}
+
+  /**
+   * Copy the trailer from the end of the file.  This must be called
+   * before any other method.
+   */
+  template<typename T>
+  T ReadTrailer() {
+    T trailer;
+    ReadTrailer(ReferenceAsWritableBytes(trailer));
+    return trailer;
+  }
+
+  void ReadTrailer(std::span<std::byte> dest);
+
+  /**
+   * Move to the first array.
+   */
+  void Seek(uint64_t offset);
+
+  /**
+   * Return the next array (without any alignment check).
+   */
+  std::span<const std::byte> ReadBytes(uint64_t size);
+
+  template<typename T>
+  std::span<const T> Read(std::size_t n) {
+    return FromBytesStrict<const T>(ReadBytes(uint64_t(n) * sizeof(T)));
+  }
+
+  /**
+   * Return the next array, which must be a string table built by
+   * #StringTable.
+   */
+  std::span<const TCHAR> ReadStrings(std::size_t n);
+
+  /**
+   * Check that only the padding before the trailer is left.
+   */
+  void Finish();
+};
+
+/**
+ * Look up a string in a table returned by Reader::ReadStrings().
+ *
+ * Throws if the reference is out of range.
+ */
+const TCHAR *
+GetString(std::span<const TCHAR> chars, StringRef ref);
+
+/**
+ * Map a cache file and pass it to the given function, which parses
+ * it.  If the function throws, the (malformed) cache file is deleted
+ * and the exception is rethrown.
+ *
+ * @param f a function which accepts a std::unique_ptr<FileMapping>
+ * @return false if there is no up-to-date cache file
+ */
+template<typename F>
+bool
+Load(FileCache &cache, const TCHAR *name, Path original_path, F &&f)
+{
+  auto mapping = cache.Map(name, original_path);
+  if (!mapping)
+    return false;
+
+  try {
+    f(std::move(mapping));
+    return true;
+  } catch (...) {
+    cache.Flush(name);
+    throw;
+  }
+}
+
+} // namespace FlatCache
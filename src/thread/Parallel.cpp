@@ -0,0 +1,111 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "Parallel.hpp"
+#include "Thread.hpp"
+
+#include <exception>
+#include <memory>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#ifdef HAVE_POSIX
+#include <unistd.h>
+#else
+#include <sysinfoapi.h>
+#endif
+
+unsigned
+GetProcessorCount() noexcept
+{
+#ifdef __linux__
+  cpu_set_t set;
+  if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+    const int n = CPU_COUNT(&set);
+    if (n > 0)
+      return n;
+  }
+#endif
+
+#ifdef HAVE_POSIX
+  const long n = sysconf(_SC_NPROCESSORS_ONLN);
+  return n > 0 ? unsigned(n) : 1;
+#else
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return info.dwNumberOfProcessors > 0 ? info.dwNumberOfProcessors : 1;
+#endif
+}
+
+namespace {
+
+class ParallelThread final : public Thread {
+  const std::function<void(unsigned)> &f;
+  const unsigned index;
+
+public:
+  std::exception_ptr error;
+
+  ParallelThread(const std::function<void(unsigned)> &_f,
+                 unsigned _index) noexcept
+    :Thread("Parallel"), f(_f), index(_index) {}
+
+private:
+  void Run() noexcept override {
+    try {
+      f(index);
+    } catch (...) {
+      error = std::current_exception();
+    }
+  }
+};
+
+} // anonymous namespace
+
+void
+RunParallel(unsigned n, const std::function<void(unsigned)> &f)
+{
+  std::vector<std::unique_ptr<ParallelThread>> threads;
+  threads.reserve(n);
+
+  unsigned i = 1;
+  for (; i < n; ++i) {
+    auto thread = std::make_unique<ParallelThread>(f, i);
+    try {
+      thread->Start();
+    } catch (...) {
+      /* out of resources: run the rest in this thread */
+      break;
+    }
+
+    threads.emplace_back(std::move(thread));
+  }
+
+  std::exception_ptr error;
+
+  const auto run = [&f, &error](unsigned index){
+    try {
+      f(index);
+    } catch (...) {
+      if (!error)
+        error = std::current_exception();
+    }
+  };
+
+  run(0);
+
+  for (; i < n; ++i)
+    run(i);
+
+  for (auto &thread : threads) {
+    thread->Join();
+    if (!error)
+      error = thread->error;
+  }
+
+  if (error)
+    std::rethrow_exception(error);
+}
@@ -0,0 +1,29 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include <functional>
+
+/**
+ * Determine the number of processors which are available to this
+ * process.  Never returns less than 1.
+ */
+[[gnu::pure]]
+unsigned
+GetProcessorCount() noexcept;
+
+/**
+ * Invoke a function once for each index in the range [0, n), each
+ * one in a separate thread, and wait until all of them have
+ * finished.  Index 0 is run in the calling thread.  New threads
+ * inherit the priority of the calling thread.
+ *
+ * If a thread cannot be created, the remaining indexes are run
+ * sequentially in the calling thread.
+ *
+ * Rethrows the first exception thrown by the function (after all
+ * threads have finished).
+ */
+void
+RunParallel(unsigned n, const std::function<void(unsigned)> &f);
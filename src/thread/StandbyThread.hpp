@@ -89,6 +89,17 @@ protected:
     Trigger();
   }
 
+  /**
+   * Schedule another Tick() call after the current one returns.
+   * This allows splitting a large job into several steps.  May only
+   * be called from within Tick(), with the mutex locked.
+   */
+  void TriggerAgain() noexcept {
+    assert(IsInside());
+
+    pending = true;
+  }
+
   /**
    * Is the thread currently working (i.e. inside Tick())?
    *
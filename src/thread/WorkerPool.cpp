@@ -0,0 +1,176 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "WorkerPool.hpp"
+#include "Thread.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <exception>
+
+struct WorkerPool::Batch {
+  const std::function<void(unsigned)> &f;
+
+  const unsigned n;
+
+  /* the following fields are protected by WorkerPool::mutex */
+
+  /**
+   * The index of the next job which has not been started yet.
+   */
+  unsigned next = 0;
+
+  /**
+   * The number of jobs which have been started but have not finished
+   * yet.
+   */
+  unsigned running = 0;
+
+  std::exception_ptr error;
+
+  /**
+   * Signalled when the last job has finished.
+   */
+  Cond done;
+
+  Batch(const std::function<void(unsigned)> &_f, unsigned _n) noexcept
+    :f(_f), n(_n) {}
+
+  bool IsExhausted() const noexcept {
+    return next == n;
+  }
+
+  bool IsFinished() const noexcept {
+    return IsExhausted() && running == 0;
+  }
+};
+
+class WorkerPool::Worker final : public Thread {
+  WorkerPool &pool;
+
+public:
+  explicit Worker(WorkerPool &_pool) noexcept
+    :Thread("WorkerPool"), pool(_pool) {}
+
+private:
+  /* virtual methods from class Thread */
+  void Run() noexcept override {
+    pool.WorkerRun();
+  }
+};
+
+WorkerPool::WorkerPool(unsigned _n_threads) noexcept
+  :n_threads(_n_threads) {}
+
+WorkerPool::~WorkerPool() noexcept
+{
+  {
+    const std::scoped_lock lock{mutex};
+    assert(queue.empty());
+    quit = true;
+    cond.notify_all();
+  }
+
+  for (auto &i : workers)
+    i.Join();
+}
+
+void
+WorkerPool::StartWorkers() noexcept
+{
+  if (started)
+    return;
+
+  started = true;
+
+  for (unsigned i = 0; i < n_threads; ++i) {
+    auto &worker = workers.emplace_front(*this);
+
+    try {
+      worker.Start();
+    } catch (...) {
+      /* out of resources: make do with the workers we have; the
+         callers run the remaining jobs themselves */
+      workers.pop_front();
+      break;
+    }
+  }
+}
+
+void
+WorkerPool::RunJob(std::unique_lock<Mutex> &lock, Batch &batch) noexcept
+{
+  assert(!batch.IsExhausted());
+
+  const unsigned i = batch.next++;
+  if (batch.IsExhausted()) {
+    /* no more jobs to be started: remove it from the queue (if it
+       was queued at all) */
+    const auto q = std::find(queue.begin(), queue.end(), &batch);
+    if (q != queue.end())
+      queue.erase(q);
+  }
+
+  ++batch.running;
+
+  lock.unlock();
+
+  std::exception_ptr error;
+  try {
+    batch.f(i);
+  } catch (...) {
+    error = std::current_exception();
+  }
+
+  lock.lock();
+
+  if (error && !batch.error)
+    batch.error = std::move(error);
+
+  --batch.running;
+  if (batch.IsFinished())
+    batch.done.notify_one();
+}
+
+void
+WorkerPool::Run(unsigned n, const std::function<void(unsigned)> &f)
+{
+  if (n == 0)
+    return;
+
+  Batch batch(f, n);
+
+  std::unique_lock lock{mutex};
+
+  if (n > 1 && n_threads > 0) {
+    StartWorkers();
+    queue.push_back(&batch);
+    cond.notify_all();
+  }
+
+  /* run jobs of this batch until there are none left; this never
+     waits for a worker to become available */
+  while (!batch.IsExhausted())
+    RunJob(lock, batch);
+
+  /* wait for the jobs which are still running in other threads */
+  batch.done.wait(lock, [&batch]{ return batch.IsFinished(); });
+
+  if (batch.error)
+    std::rethrow_exception(batch.error);
+}
+
+void
+WorkerPool::WorkerRun() noexcept
+{
+  std::unique_lock lock{mutex};
+
+  while (!quit) {
+    if (queue.empty()) {
+      cond.wait(lock);
+      continue;
+    }
+
+    RunJob(lock, *queue.front());
+  }
+}
@@ -0,0 +1,92 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#pragma once
+
+#include "Mutex.hxx"
+#include "Cond.hxx"
+
+#include <deque>
+#include <forward_list>
+#include <functional>
+
+/**
+ * A fixed set of threads which run batches of jobs.  The threads are
+ * started by the first Run() call and remain until this object is
+ * destructed, so callers which run small batches frequently don't
+ * pay for creating threads each time.
+ *
+ * The calling thread runs jobs of its own batch, too, and it never
+ * waits for a job which has not been started yet.  Therefore, Run()
+ * may be called by several threads at the same time and from within
+ * a job (e.g. a job which uses this pool to parallelise its own
+ * work).
+ */
+class WorkerPool {
+  struct Batch;
+  class Worker;
+
+  const unsigned n_threads;
+
+  Mutex mutex;
+
+  /**
+   * Wakes up the workers when a batch has been added.
+   */
+  Cond cond;
+
+  /**
+   * Batches which have jobs that have not been started yet.
+   * Protected by #mutex.
+   */
+  std::deque<Batch *> queue;
+
+  /**
+   * Protected by #mutex.
+   */
+  std::forward_list<Worker> workers;
+
+  /**
+   * Protected by #mutex.
+   */
+  bool started = false, quit = false;
+
+public:
+  /**
+   * @param _n_threads the number of worker threads (in addition to
+   * the threads calling Run()); zero means Run() runs all jobs in
+   * the calling thread
+   */
+  explicit WorkerPool(unsigned _n_threads) noexcept;
+  ~WorkerPool() noexcept;
+
+  WorkerPool(const WorkerPool &) = delete;
+  WorkerPool &operator=(const WorkerPool &) = delete;
+
+  unsigned GetThreadCount() const noexcept {
+    return n_threads;
+  }
+
+  /**
+   * Invoke a function once for each index in the range [0, n) and
+   * wait until all of them have finished.
+   *
+   * Rethrows the first exception thrown by the function (after all
+   * jobs have finished).
+   */
+  void Run(unsigned n, const std::function<void(unsigned)> &f);
+
+private:
+  /**
+   * Caller must lock the mutex.
+   */
+  void StartWorkers() noexcept;
+
+  /**
+   * Claim the next job of the given batch, run it without holding
+   * the lock and record its result.  Caller must lock the mutex.
+   */
+  void RunJob(std::unique_lock<Mutex> &lock, Batch &batch) noexcept;
+
+  void WorkerRun() noexcept;
+};
@@ -0,0 +1,188 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * This program compares the indexed AirspacePolygon::Inside() and
+ * AirspacePolygon::Intersects() with a linear walk over the whole
+ * boundary.  Query points are scattered over the bounding box of each
+ * polygon.  Example:
+ *
+ *   BenchmarkAirspacePolygon fuzzer/corpus/airspace/openair.txt
+ */
+
+#include "Airspace/AirspaceParser.hpp"
+#include "Engine/Airspace/Airspaces.hpp"
+#include "Engine/Airspace/AbstractAirspace.hpp"
+#include "Engine/Airspace/AirspaceIntersectSort.hpp"
+#include "Engine/Airspace/AirspaceIntersectionVector.hpp"
+#include "Engine/Airspace/PolygonEdgeIndex.hpp"
+#include "Geo/GeoBounds.hpp"
+#include "Geo/GeoVector.hpp"
+#include "Geo/Flat/FlatProjection.hpp"
+#include "Geo/Flat/FlatRay.hpp"
+#include "system/Args.hpp"
+#include "io/FileReader.hxx"
+#include "io/BufferedReader.hxx"
+#include "util/PrintException.hxx"
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include <stdio.h>
+
+static constexpr unsigned N_QUERIES = 1000;
+
+/**
+ * The length of the segments passed to Intersects() [m].
+ */
+static constexpr double SEGMENT_LENGTH = 2000;
+
+template<typename F>
+static double
+Measure(F &&f)
+{
+  const auto start = std::chrono::steady_clock::now();
+  f();
+  const std::chrono::duration<double> duration =
+    std::chrono::steady_clock::now() - start;
+  return duration.count();
+}
+
+/**
+ * The unindexed reference implementation of
+ * AirspacePolygon::Intersects().
+ */
+static AirspaceIntersectionVector
+LinearIntersects(const AbstractAirspace &airspace,
+                 const GeoPoint &start, const GeoPoint &end,
+                 const FlatProjection &projection)
+{
+  const FlatRay ray(projection.ProjectInteger(start),
+                    projection.ProjectInteger(end));
+
+  AirspaceIntersectSort sorter(start, airspace);
+
+  const auto &border = airspace.GetPoints();
+  for (auto it = border.begin(); it + 1 != border.end(); ++it) {
+    const FlatRay r_seg(it->GetFlatLocation(), (it + 1)->GetFlatLocation());
+    auto t = ray.DistinctIntersection(r_seg);
+    if (t >= 0)
+      sorter.add(t, projection.Unproject(ray.Parametric(t)));
+  }
+
+  return sorter.all();
+}
+
+static bool
+Equals(const AirspaceIntersectionVector &a,
+       const AirspaceIntersectionVector &b)
+{
+  return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                    [](const auto &x, const auto &y){
+                      return x.first == y.first && x.second == y.second;
+                    });
+}
+
+struct Result {
+  unsigned n_polygons = 0, n_indexed = 0, n_points = 0;
+  double inside_linear = 0, inside_indexed = 0;
+  double intersects_linear = 0, intersects_indexed = 0;
+  unsigned mismatches = 0;
+};
+
+static void
+BenchmarkPolygon(const AbstractAirspace &airspace,
+                 const FlatProjection &projection,
+                 std::mt19937 &rng, Result &result)
+{
+  const GeoBounds bounds = airspace.GetGeoBounds();
+  std::uniform_real_distribution<double>
+    lat(bounds.GetSouth().Degrees(), bounds.GetNorth().Degrees()),
+    lon(bounds.GetWest().Degrees(), bounds.GetEast().Degrees()),
+    bearing(0, 360);
+
+  std::vector<GeoPoint> points, ends;
+  points.reserve(N_QUERIES);
+  ends.reserve(N_QUERIES);
+  for (unsigned i = 0; i < N_QUERIES; ++i) {
+    points.emplace_back(Angle::Degrees(lon(rng)), Angle::Degrees(lat(rng)));
+    ends.push_back(GeoVector(SEGMENT_LENGTH, Angle::Degrees(bearing(rng)))
+                   .EndPoint(points.back()));
+  }
+
+  const auto &border = airspace.GetPoints();
+
+  ++result.n_polygons;
+  result.n_points += border.size();
+  if (border.size() >= PolygonEdgeIndex::MIN_POINTS)
+    ++result.n_indexed;
+
+  std::vector<bool> inside_linear(N_QUERIES), inside_indexed(N_QUERIES);
+  result.inside_linear += Measure([&]{
+    for (unsigned i = 0; i < N_QUERIES; ++i)
+      inside_linear[i] = border.IsInside(points[i]);
+  });
+  result.inside_indexed += Measure([&]{
+    for (unsigned i = 0; i < N_QUERIES; ++i)
+      inside_indexed[i] = airspace.Inside(points[i]);
+  });
+
+  if (inside_linear != inside_indexed)
+    ++result.mismatches;
+
+  /* short segments, like the ones checked for each GPS fix */
+  std::vector<AirspaceIntersectionVector> linear(N_QUERIES), indexed(N_QUERIES);
+  result.intersects_linear += Measure([&]{
+    for (unsigned i = 0; i < N_QUERIES; ++i)
+      linear[i] = LinearIntersects(airspace, points[i], ends[i],
+                                   projection);
+  });
+  result.intersects_indexed += Measure([&]{
+    for (unsigned i = 0; i < N_QUERIES; ++i)
+      indexed[i] = airspace.Intersects(points[i], ends[i], projection);
+  });
+
+  for (unsigned i = 0; i < N_QUERIES; ++i)
+    if (!Equals(linear[i], indexed[i]))
+      ++result.mismatches;
+}
+
+int main(int argc, char **argv)
+try {
+  Args args(argc, argv, "PATH...");
+
+  Airspaces airspaces;
+
+  do {
+    FileReader file_reader{args.ExpectNextPath()};
+    BufferedReader buffered_reader{file_reader};
+    ParseAirspaceFile(airspaces, buffered_reader);
+  } while (!args.IsEmpty());
+
+  airspaces.Optimise();
+
+  std::mt19937 rng;
+  Result result;
+
+  for (const auto &i : airspaces.QueryAll()) {
+    const AbstractAirspace &airspace = i.GetAirspace();
+    if (airspace.GetShape() == AbstractAirspace::Shape::POLYGON)
+      BenchmarkPolygon(airspace, airspaces.GetProjection(), rng, result);
+  }
+
+  const double n = double(result.n_polygons) * N_QUERIES;
+  printf("polygons=%u indexed=%u points=%u\n",
+         result.n_polygons, result.n_indexed, result.n_points);
+  printf("inside: linear=%.0f ns indexed=%.0f ns\n",
+         result.inside_linear / n * 1e9, result.inside_indexed / n * 1e9);
+  printf("intersects: linear=%.0f ns indexed=%.0f ns\n",
+         result.intersects_linear / n * 1e9,
+         result.intersects_indexed / n * 1e9);
+  printf("mismatches=%u\n", result.mismatches);
+
+  return result.mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
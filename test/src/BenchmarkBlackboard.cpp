@@ -0,0 +1,250 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * This program measures the data exchange between the MergeThread,
+ * the CalculationThread, the user interface and the map window for
+ * one tick, comparing copies of the blackboard structures made while
+ * holding the #DeviceBlackboard mutex with #BlackboardSnapshot.  It
+ * prints the number of copies, the number of bytes copied and the
+ * time the mutex was held per tick.
+ */
+
+#include "Blackboard/BlackboardSnapshot.hpp"
+#include "NMEA/MoreData.hpp"
+#include "NMEA/Derived.hpp"
+#include "thread/Mutex.hxx"
+#include "system/Args.hpp"
+
+#include <chrono>
+#include <memory>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static constexpr unsigned DEFAULT_TICKS = 10000;
+
+struct Stats {
+  unsigned copies = 0;
+  std::size_t bytes = 0;
+
+  unsigned locks = 0;
+  std::chrono::steady_clock::duration lock_held{}, max_lock_held{};
+
+  template<typename T>
+  void Copy(T &dest, const T &src) noexcept {
+    dest = src;
+    ++copies;
+    bytes += sizeof(T);
+  }
+
+  template<typename T>
+  void CountCopy() noexcept {
+    ++copies;
+    bytes += sizeof(T);
+  }
+
+  void Print(const char *name, unsigned n_ticks) const noexcept {
+    using std::chrono::duration_cast;
+    using std::chrono::nanoseconds;
+
+    printf("%s: %.1f copies, %zu bytes, %.1f locks, %.0f ns locked per tick (max %ld ns)\n",
+           name,
+           double(copies) / n_ticks,
+           bytes / n_ticks,
+           double(locks) / n_ticks,
+           double(duration_cast<nanoseconds>(lock_held).count()) / n_ticks,
+           long(duration_cast<nanoseconds>(max_lock_held).count()));
+  }
+};
+
+/**
+ * Measures how long the mutex is held.
+ */
+class ScopeMeasureLock {
+  Stats &stats;
+  const std::lock_guard<Mutex> lock;
+  const std::chrono::steady_clock::time_point start;
+
+public:
+  ScopeMeasureLock(Stats &_stats, Mutex &mutex) noexcept
+    :stats(_stats), lock(mutex),
+     start(std::chrono::steady_clock::now()) {}
+
+  ~ScopeMeasureLock() noexcept {
+    const auto duration = std::chrono::steady_clock::now() - start;
+    ++stats.locks;
+    stats.lock_held += duration;
+    if (duration > stats.max_lock_held)
+      stats.max_lock_held = duration;
+  }
+};
+
+/**
+ * The state of the threads which receive data from the device
+ * blackboard.
+ */
+struct Readers {
+  /* CalculationThread */
+  MoreData calc_basic;
+  DerivedInfo calc_calculated;
+
+  /* InterfaceBlackboard */
+  MoreData ui_basic;
+  DerivedInfo ui_calculated;
+
+  /* MapWindowBlackboard */
+  MoreData map_basic;
+  DerivedInfo map_calculated;
+  std::shared_ptr<const MoreData> map_basic_snapshot;
+  std::shared_ptr<const DerivedInfo> map_calculated_snapshot;
+};
+
+/**
+ * The old way: every reader copies the structures while holding the
+ * mutex.
+ */
+static void
+TickCopy(Mutex &mutex, MoreData &basic, DerivedInfo &calculated,
+         Readers &r, Stats &stats) noexcept
+{
+  /* MergeThread */
+  {
+    const ScopeMeasureLock lock(stats, mutex);
+    basic.clock += std::chrono::seconds{1};
+  }
+
+  /* CalculationThread */
+  {
+    const ScopeMeasureLock lock(stats, mutex);
+    stats.Copy(r.calc_basic, basic);
+  }
+
+  r.calc_calculated.altitude_agl = r.calc_basic.nav_altitude;
+
+  {
+    const ScopeMeasureLock lock(stats, mutex);
+    stats.Copy(calculated, r.calc_calculated);
+  }
+
+  /* user interface */
+  {
+    const ScopeMeasureLock lock(stats, mutex);
+    stats.Copy(r.ui_basic, basic);
+  }
+
+  {
+    const ScopeMeasureLock lock(stats, mutex);
+    stats.Copy(r.ui_calculated, calculated);
+  }
+
+  /* map window */
+  {
+    const ScopeMeasureLock lock(stats, mutex);
+    stats.Copy(r.map_basic, basic);
+    stats.Copy(r.map_calculated, calculated);
+  }
+}
+
+/**
+ * The new way: the writers publish snapshots, readers obtain a
+ * reference and copy (if at all) after releasing the mutex.
+ */
+static void
+TickSnapshot(Mutex &mutex, MoreData &basic,
+             BlackboardSnapshot<MoreData> &basic_snapshot,
+             BlackboardSnapshot<DerivedInfo> &calculated,
+             Readers &r, Stats &stats) noexcept
+{
+  /* MergeThread */
+  {
+    const ScopeMeasureLock lock(stats, mutex);
+    basic.clock += std::chrono::seconds{1};
+    basic_snapshot.Publish(basic);
+    stats.CountCopy<MoreData>();
+  }
+
+  /* CalculationThread */
+  std::shared_ptr<const MoreData> calc_basic;
+  {
+    const ScopeMeasureLock lock(stats, mutex);
+    calc_basic = basic_snapshot.GetSnapshot();
+  }
+
+  stats.Copy(r.calc_basic, *calc_basic);
+  calc_basic.reset();
+
+  r.calc_calculated.altitude_agl = r.calc_basic.nav_altitude;
+
+  auto &prepared = calculated.Prepare(r.calc_calculated);
+  stats.CountCopy<DerivedInfo>();
+
+  {
+    const ScopeMeasureLock lock(stats, mutex);
+    calculated.Commit(prepared);
+  }
+
+  /* user interface */
+  std::shared_ptr<const MoreData> ui_basic;
+  {
+    const ScopeMeasureLock lock(stats, mutex);
+    ui_basic = basic_snapshot.GetSnapshot();
+  }
+
+  stats.Copy(r.ui_basic, *ui_basic);
+
+  std::shared_ptr<const DerivedInfo> ui_calculated;
+  {
+    const ScopeMeasureLock lock(stats, mutex);
+    ui_calculated = calculated.GetSnapshot();
+  }
+
+  stats.Copy(r.ui_calculated, *ui_calculated);
+
+  /* map window: keeps the references until the next frame */
+  {
+    const ScopeMeasureLock lock(stats, mutex);
+    r.map_basic_snapshot = basic_snapshot.GetSnapshot();
+  }
+
+  {
+    const ScopeMeasureLock lock(stats, mutex);
+    r.map_calculated_snapshot = calculated.GetSnapshot();
+  }
+}
+
+int main(int argc, char **argv)
+{
+  Args args(argc, argv, "[TICKS]");
+  const unsigned n_ticks = args.IsEmpty() ? DEFAULT_TICKS : args.ExpectNextInt();
+  args.ExpectEnd();
+
+  if (n_ticks == 0)
+    args.UsageError();
+
+  printf("sizeof(MoreData)=%zu sizeof(DerivedInfo)=%zu\n",
+         sizeof(MoreData), sizeof(DerivedInfo));
+
+  Mutex mutex;
+  auto basic = std::make_unique<MoreData>();
+  auto calculated = std::make_unique<DerivedInfo>();
+  auto readers = std::make_unique<Readers>();
+
+  Stats copy_stats;
+  for (unsigned i = 0; i < n_ticks; ++i)
+    TickCopy(mutex, *basic, *calculated, *readers, copy_stats);
+
+  copy_stats.Print("copy", n_ticks);
+
+  auto basic_snapshot = std::make_unique<BlackboardSnapshot<MoreData>>();
+  auto calculated_snapshot = std::make_unique<BlackboardSnapshot<DerivedInfo>>();
+
+  Stats snapshot_stats;
+  for (unsigned i = 0; i < n_ticks; ++i)
+    TickSnapshot(mutex, *basic, *basic_snapshot, *calculated_snapshot,
+                 *readers, snapshot_stats);
+
+  snapshot_stats.Print("snapshot", n_ticks);
+
+  return EXIT_SUCCESS;
+}
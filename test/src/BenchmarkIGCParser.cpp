@@ -0,0 +1,138 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * This program compares the throughput of the line based IGC parser
+ * with the memory-mapped #IGCScanner, and verifies that both produce
+ * the same fixes.  Example:
+ *
+ *   BenchmarkIGCParser test/data/01lz1hq1.igc test/data/9crx3101.igc
+ */
+
+#include "IGC/IGCScanner.hpp"
+#include "IGC/IGCParser.hpp"
+#include "IGC/IGCExtensions.hpp"
+#include "IGC/IGCFix.hpp"
+#include "system/Args.hpp"
+#include "io/FileMapping.hpp"
+#include "io/MemoryReader.hxx"
+#include "io/BufferedLineReader.hpp"
+#include "util/PrintException.hxx"
+
+#include <array>
+#include <chrono>
+#include <forward_list>
+#include <vector>
+
+#include <stdio.h>
+
+static constexpr unsigned N_ITERATIONS = 20;
+
+template<typename F>
+static double
+Measure(F &&f)
+{
+  const auto start = std::chrono::steady_clock::now();
+  f();
+  const std::chrono::duration<double> duration =
+    std::chrono::steady_clock::now() - start;
+  return duration.count();
+}
+
+static std::vector<IGCFix>
+ParseLines(std::span<const std::byte> src)
+{
+  std::vector<IGCFix> fixes;
+
+  MemoryReader mr{src};
+  BufferedLineReader lr(mr);
+
+  IGCExtensions extensions;
+  extensions.clear();
+
+  while (const char *line = lr.ReadLine()) {
+    if (line[0] == 'B') {
+      IGCFix fix;
+      if (IGCParseFix(line, extensions, fix))
+        fixes.push_back(fix);
+    } else if (line[0] == 'I')
+      IGCParseExtensions(line, extensions);
+  }
+
+  return fixes;
+}
+
+static std::vector<IGCFix>
+Scan(std::span<const std::byte> src)
+{
+  std::vector<IGCFix> fixes;
+
+  IGCScanner scanner(src);
+  std::array<IGCFix, 256> chunk;
+  std::size_t n;
+  while ((n = scanner.Read(chunk)) > 0)
+    fixes.insert(fixes.end(), chunk.begin(), chunk.begin() + n);
+
+  return fixes;
+}
+
+static bool
+Equals(const IGCFix &a, const IGCFix &b)
+{
+  return a.time == b.time && a.location == b.location &&
+    a.gps_valid == b.gps_valid &&
+    a.gps_altitude == b.gps_altitude &&
+    a.pressure_altitude == b.pressure_altitude &&
+    a.enl == b.enl && a.rpm == b.rpm && a.hdm == b.hdm && a.hdt == b.hdt &&
+    a.trm == b.trm && a.trt == b.trt && a.gsp == b.gsp && a.ias == b.ias &&
+    a.tas == b.tas && a.siu == b.siu;
+}
+
+int main(int argc, char **argv)
+try {
+  Args args(argc, argv, "PATH...");
+
+  std::forward_list<FileMapping> files;
+  std::size_t n_bytes = 0, n_fixes = 0;
+  unsigned mismatches = 0;
+
+  do {
+    const auto &file = files.emplace_front(args.ExpectNextPath());
+    const std::span<const std::byte> src = file;
+    n_bytes += src.size();
+
+    const auto a = ParseLines(src), b = Scan(src);
+    n_fixes += a.size();
+
+    if (!std::equal(a.begin(), a.end(), b.begin(), b.end(), Equals))
+      ++mismatches;
+  } while (!args.IsEmpty());
+
+  std::size_t check_lines = 0, check_scanner = 0;
+
+  const double lines = Measure([&]{
+    for (unsigned i = 0; i < N_ITERATIONS; ++i)
+      for (const auto &file : files)
+        check_lines += ParseLines(file).size();
+  });
+
+  const double scanner = Measure([&]{
+    for (unsigned i = 0; i < N_ITERATIONS; ++i)
+      for (const auto &file : files)
+        check_scanner += Scan(file).size();
+  });
+
+  if (check_lines != check_scanner)
+    ++mismatches;
+
+  const double mb = double(n_bytes) * N_ITERATIONS / (1024 * 1024);
+  printf("bytes=%zu fixes=%zu\n", n_bytes, n_fixes);
+  printf("lines: %.1f MB/s\n", mb / lines);
+  printf("scanner: %.1f MB/s\n", mb / scanner);
+  printf("mismatches=%u\n", mismatches);
+
+  return mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
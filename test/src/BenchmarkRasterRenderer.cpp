@@ -0,0 +1,136 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * Render a fixed terrain window over and over and report the number
+ * of frames per second.  The "pan" run moves the map a few pixels per
+ * frame, like finger-panning does.
+ */
+
+#include "Terrain/RasterMap.hpp"
+#include "Terrain/RasterRenderer.hpp"
+#include "Terrain/Loader.hpp"
+#include "Operation/Operation.hpp"
+#include "Projection/WindowProjection.hpp"
+#include "Screen/Layout.hpp"
+#include "ui/canvas/Ramp.hpp"
+#include "Math/Angle.hpp"
+#include "system/Args.hpp"
+#include "io/ZipArchive.hpp"
+#include "util/NumberParser.hpp"
+#include "util/PrintException.hxx"
+
+#include <chrono>
+
+#include <stdio.h>
+
+unsigned Layout::scale_1024 = 1024;
+
+static constexpr ColorRamp terrain_colors[NUM_COLOR_RAMP_LEVELS] = {
+  {0, { 0x70, 0xc0, 0xa7 }},
+  {250, { 0xca, 0xe7, 0xb9 }},
+  {500, { 0xf4, 0xea, 0xaf }},
+  {750, { 0xdc, 0xb2, 0x82 }},
+  {1000, { 0xca, 0x8e, 0x72 }},
+  {1250, { 0xde, 0xc8, 0xbd }},
+  {1500, { 0xe3, 0xe4, 0xe9 }},
+  {1750, { 0xdb, 0xd9, 0xef }},
+  {2000, { 0xce, 0xcd, 0xf5 }},
+  {2250, { 0xc2, 0xc1, 0xfa }},
+  {2500, { 0xb7, 0xb9, 0xff }},
+  {5000, { 0xb7, 0xb9, 0xff }},
+  {6000, { 0xb7, 0xb9, 0xff }}
+};
+
+/**
+ * @param scan call RasterRenderer::ScanMap() for each frame
+ * @param pan move the map by this number of pixels for each frame;
+ * if zero, the renderer is invalidated, forcing a full scan
+ */
+static void
+Benchmark(const char *name, RasterRenderer &renderer,
+          const RasterMap &map, WindowProjection projection,
+          bool scan, PixelPoint pan, bool do_shading, unsigned n_frames)
+{
+  using std::chrono::steady_clock;
+
+  const auto start = steady_clock::now();
+
+  for (unsigned i = 0; i < n_frames; ++i) {
+    if (scan) {
+      if (pan.x == 0 && pan.y == 0)
+        renderer.Invalidate();
+      else {
+        projection.SetGeoLocation(projection.ScreenToGeo(projection.GetScreenOrigin() + pan));
+        projection.UpdateScreenBounds();
+      }
+
+      renderer.ScanMap(map, projection);
+    }
+
+    renderer.GenerateImage(do_shading, 4, 64, 192,
+                           Angle::Degrees(45), true);
+  }
+
+  const std::chrono::duration<double> duration = steady_clock::now() - start;
+  printf("%s: frames=%u time=%.3fs fps=%.1f\n",
+         name, n_frames, duration.count(), n_frames / duration.count());
+}
+
+int main(int argc, char **argv)
+try {
+  Args args(argc, argv, "PATH [FRAMES]");
+  const auto map_path = args.ExpectNextPath();
+  unsigned n_frames = 100;
+  if (!args.IsEmpty()) {
+    const char *s = args.GetNext();
+    char *endptr;
+    n_frames = ParseUnsigned(s, &endptr);
+    if (endptr == s || *endptr != 0 || n_frames < 1)
+      args.UsageError();
+  }
+  args.ExpectEnd();
+
+  ZipArchive archive(map_path);
+
+  RasterMap map;
+
+  {
+    NullOperationEnvironment operation;
+    LoadTerrainOverview(archive.get(), map.GetTileCache(), operation);
+  }
+
+  map.UpdateProjection();
+
+  SharedMutex mutex;
+  do {
+    UpdateTerrainTiles(archive.get(), map.GetTileCache(), mutex,
+                       map.GetProjection(),
+                       map.GetMapCenter(), 50000);
+  } while (map.IsDirty());
+
+  WindowProjection projection;
+  projection.SetScreenSize({800, 480});
+  projection.SetScaleFromRadius(50000);
+  projection.SetGeoLocation(map.GetMapCenter());
+  projection.SetScreenOrigin(400, 240);
+  projection.UpdateScreenBounds();
+
+  RasterRenderer renderer;
+  renderer.PrepareColorTable(terrain_colors, true, 4, 2);
+  renderer.ScanMap(map, projection);
+
+  Benchmark("unshaded", renderer, map, projection,
+            false, {0, 0}, false, n_frames);
+  Benchmark("shaded", renderer, map, projection,
+            false, {0, 0}, true, n_frames);
+  Benchmark("scan+shaded", renderer, map, projection,
+            true, {0, 0}, true, n_frames);
+  Benchmark("pan+shaded", renderer, map, projection,
+            true, {4, 2}, true, n_frames);
+
+  return EXIT_SUCCESS;
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
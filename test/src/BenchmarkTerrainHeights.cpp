@@ -0,0 +1,128 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * This program compares the throughput of RasterMap::GetHeight() /
+ * GetInterpolatedHeight() with the batched RasterMap::GetHeights().
+ * The query locations are arranged in rays around the map center,
+ * similar to what the reach calculation does.
+ */
+
+#include "Terrain/RasterMap.hpp"
+#include "Terrain/Loader.hpp"
+#include "Operation/Operation.hpp"
+#include "Geo/GeoVector.hpp"
+#include "system/Args.hpp"
+#include "io/ZipArchive.hpp"
+#include "util/NumberParser.hpp"
+#include "util/PrintException.hxx"
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include <stdio.h>
+
+static constexpr unsigned N_RAYS = 360;
+static constexpr unsigned N_SAMPLES_PER_RAY = 64;
+
+static std::vector<GeoPoint>
+MakeLocations(const RasterMap &map, double radius)
+{
+  std::vector<GeoPoint> locations;
+  locations.reserve(N_RAYS * N_SAMPLES_PER_RAY);
+
+  const GeoPoint center = map.GetMapCenter();
+  for (unsigned i = 0; i < N_RAYS; ++i) {
+    const Angle bearing = Angle::FullCircle() * i / N_RAYS;
+    for (unsigned j = 1; j <= N_SAMPLES_PER_RAY; ++j)
+      locations.push_back(GeoVector(radius * j / N_SAMPLES_PER_RAY,
+                                    bearing).EndPoint(center));
+  }
+
+  return locations;
+}
+
+template<typename F>
+static double
+Measure(unsigned n_iterations, F &&f)
+{
+  const auto start = std::chrono::steady_clock::now();
+  for (unsigned i = 0; i < n_iterations; ++i)
+    f();
+  const std::chrono::duration<double> duration =
+    std::chrono::steady_clock::now() - start;
+  return duration.count();
+}
+
+static void
+Benchmark(const RasterMap &map, std::span<const GeoPoint> locations,
+          bool interpolate, unsigned n_iterations)
+{
+  std::vector<TerrainHeight> single(locations.size()),
+    batch(locations.size());
+
+  const double single_time = Measure(n_iterations, [&]{
+    for (std::size_t i = 0; i < locations.size(); ++i)
+      single[i] = interpolate
+        ? map.GetInterpolatedHeight(locations[i])
+        : map.GetHeight(locations[i]);
+  });
+
+  const double batch_time = Measure(n_iterations, [&]{
+    map.GetHeights(locations, batch.data(), interpolate);
+  });
+
+  const auto n_points = double(locations.size()) * n_iterations;
+  printf("%s: single=%.1f Mpoints/s batch=%.1f Mpoints/s%s\n",
+         interpolate ? "interpolated" : "coarse",
+         n_points / single_time / 1e6,
+         n_points / batch_time / 1e6,
+         std::equal(single.begin(), single.end(), batch.begin(),
+                    [](TerrainHeight a, TerrainHeight b){
+                      return a.GetValue() == b.GetValue();
+                    }) ? "" : " MISMATCH");
+}
+
+int main(int argc, char **argv)
+try {
+  Args args(argc, argv, "PATH [ITERATIONS]");
+  const auto map_path = args.ExpectNextPath();
+  unsigned n_iterations = 100;
+  if (!args.IsEmpty()) {
+    const char *s = args.GetNext();
+    char *endptr;
+    n_iterations = ParseUnsigned(s, &endptr);
+    if (endptr == s || *endptr != 0 || n_iterations < 1)
+      args.UsageError();
+  }
+  args.ExpectEnd();
+
+  ZipArchive archive(map_path);
+
+  RasterMap map;
+
+  {
+    NullOperationEnvironment operation;
+    LoadTerrainOverview(archive.get(), map.GetTileCache(), operation);
+  }
+
+  map.UpdateProjection();
+
+  SharedMutex mutex;
+  do {
+    UpdateTerrainTiles(archive.get(), map.GetTileCache(), mutex,
+                       map.GetProjection(),
+                       map.GetMapCenter(), 50000);
+  } while (map.IsDirty());
+
+  const auto locations = MakeLocations(map, 40000);
+
+  Benchmark(map, locations, false, n_iterations);
+  Benchmark(map, locations, true, n_iterations);
+
+  return EXIT_SUCCESS;
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
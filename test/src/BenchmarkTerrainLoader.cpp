@@ -0,0 +1,76 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * This program measures how fast terrain tiles are decoded with a
+ * varying number of decoder threads.
+ */
+
+#include "Terrain/RasterTileCache.hpp"
+#include "Terrain/Loader.hpp"
+#include "Operation/Operation.hpp"
+#include "system/Args.hpp"
+#include "io/ZipArchive.hpp"
+#include "util/NumberParser.hpp"
+#include "util/PrintException.hxx"
+
+#include <chrono>
+#include <vector>
+
+#include <stdio.h>
+
+int main(int argc, char **argv)
+try {
+  Args args(argc, argv, "PATH [MAX_WORKERS]");
+  const auto map_path = args.ExpectNextPath();
+  unsigned max_workers = 4;
+  if (!args.IsEmpty()) {
+    const char *s = args.GetNext();
+    char *endptr;
+    max_workers = ParseUnsigned(s, &endptr);
+    if (endptr == s || *endptr != 0 || max_workers < 1)
+      args.UsageError();
+  }
+  args.ExpectEnd();
+
+  std::vector<ZipArchive> archives;
+  for (unsigned i = 0; i < max_workers; ++i)
+    archives.emplace_back(map_path);
+
+  std::vector<struct zzip_dir *> dirs;
+  for (auto &i : archives)
+    dirs.push_back(i.get());
+
+  for (unsigned n = 1; n <= max_workers; ++n) {
+    RasterTileCache rtc;
+
+    {
+      NullOperationEnvironment operation;
+      LoadTerrainOverview(dirs.front(), rtc, operation);
+    }
+
+    /* a radius which covers the whole map */
+    const unsigned radius = std::max(rtc.GetSize().x, rtc.GetSize().y);
+    const SignedRasterLocation center(rtc.GetSize().x / 2,
+                                      rtc.GetSize().y / 2);
+
+    SharedMutex mutex;
+
+    const auto start = std::chrono::steady_clock::now();
+    do {
+      UpdateTerrainTiles(std::span{dirs}.first(n), rtc, mutex,
+                         center, radius);
+    } while (rtc.IsDirty());
+    const std::chrono::duration<double> duration =
+      std::chrono::steady_clock::now() - start;
+
+    const unsigned n_tiles = rtc.CountLoadedTiles();
+    printf("workers=%u tiles=%u time=%.3fs tiles/s=%.1f\n",
+           n, n_tiles, duration.count(), n_tiles / duration.count());
+  }
+
+  return EXIT_SUCCESS;
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,218 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * This program measures the #Waypoints lookups GetNearest(),
+ * VisitWithinRange() and LookupName(), comparing waypoints stored in
+ * the #WaypointArena with waypoints allocated one by one.  The
+ * waypoints are loaded from a file or generated.  Examples:
+ *
+ *   BenchmarkWaypoints test/data/waypoints.cup
+ *   BenchmarkWaypoints --generate=50000
+ */
+
+#include "Waypoint/WaypointReader.hpp"
+#include "Waypoint/Factory.hpp"
+#include "Waypoint/Waypoints.hpp"
+#include "system/Args.hpp"
+#include "Operation/ConsoleOperationEnvironment.hpp"
+#include "util/PrintException.hxx"
+#include "util/StringCompare.hxx"
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <tchar.h>
+
+static constexpr unsigned N_QUERIES = 100000;
+
+template<typename F>
+static double
+Measure(F &&f)
+{
+  const auto start = std::chrono::steady_clock::now();
+  f();
+  const std::chrono::duration<double> duration =
+    std::chrono::steady_clock::now() - start;
+  return duration.count();
+}
+
+static void
+LoadWaypoints(Path path, Waypoints &waypoints)
+{
+  ConsoleOperationEnvironment operation;
+  ReadWaypointFile(path, waypoints,
+                   WaypointFactory(WaypointOrigin::NONE),
+                   operation);
+}
+
+/**
+ * Generate waypoints on a jittered grid around the Alps; roughly the
+ * density of a large turnpoint file.
+ */
+static void
+GenerateWaypoints(unsigned n, Waypoints &waypoints)
+{
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<double> jitter(-0.02, 0.02);
+
+  const unsigned columns = 250;
+  for (unsigned i = 0; i < n; ++i) {
+    const GeoPoint location(Angle::Degrees(5 + (i % columns) * 0.04 + jitter(rng)),
+                            Angle::Degrees(44 + (i / columns) * 0.03 + jitter(rng)));
+
+    Waypoint wp = WaypointFactory(WaypointOrigin::NONE).Create(location);
+    TCHAR name[32];
+    _stprintf(name, _T("WP%u"), i);
+    wp.name = name;
+    wp.comment = _T("generated");
+    wp.elevation = 500;
+    wp.has_elevation = true;
+    if (i % 10 == 0)
+      wp.type = Waypoint::Type::OUTLANDING;
+
+    waypoints.Append(std::move(wp));
+  }
+}
+
+/**
+ * Copy all waypoints to the other container, allocating each one
+ * separately on the heap (the layout used before #WaypointArena).
+ */
+static void
+CopyToHeap(const Waypoints &src, Waypoints &dest)
+{
+  std::vector<WaypointPtr> list(src.begin(), src.end());
+  std::sort(list.begin(), list.end(), [](const auto &a, const auto &b){
+    return a->id < b->id;
+  });
+
+  /* interleave with short-lived allocations to simulate a heap
+     which has been in use for a while */
+  std::vector<std::unique_ptr<std::byte[]>> garbage;
+
+  for (const auto &i : list) {
+    dest.Append(WaypointPtr(new Waypoint(*i)));
+    garbage.emplace_back(new std::byte[96]);
+    if (garbage.size() > 64)
+      garbage.erase(garbage.begin());
+  }
+}
+
+struct Result {
+  double nearest, visit, name;
+  std::size_t check;
+};
+
+static Result
+Run(const Waypoints &waypoints, const std::vector<GeoPoint> &queries,
+    const std::vector<tstring> &names)
+{
+  Result r{};
+
+  r.nearest = Measure([&]{
+    for (const auto &i : queries)
+      if (waypoints.GetNearest(i, 10000))
+        ++r.check;
+  });
+
+  r.visit = Measure([&]{
+    for (const auto &i : queries)
+      waypoints.VisitWithinRange(i, 20000, [&r](const WaypointPtr &){
+        ++r.check;
+      });
+  });
+
+  r.name = Measure([&]{
+    for (unsigned i = 0; i < queries.size(); ++i)
+      if (waypoints.LookupName(names[i % names.size()]))
+        ++r.check;
+  });
+
+  return r;
+}
+
+static void
+Print(const char *label, const Result &r, std::size_t n)
+{
+  const double scale = 1e9 / n;
+  printf("%s: nearest=%.0f ns visit=%.0f ns name=%.0f ns\n", label,
+         r.nearest * scale, r.visit * scale, r.name * scale);
+}
+
+int main(int argc, char **argv)
+try {
+  Args args(argc, argv, "[--generate=N] [PATH]");
+
+  unsigned generate = 0;
+
+  const char *arg;
+  while ((arg = args.PeekNext()) != nullptr && *arg == '-') {
+    args.Skip();
+
+    if (const char *value = StringAfterPrefix(arg, "--generate="))
+      generate = strtoul(value, nullptr, 10);
+    else
+      args.UsageError();
+  }
+
+  Waypoints arena_waypoints;
+  if (generate > 0)
+    GenerateWaypoints(generate, arena_waypoints);
+  else
+    LoadWaypoints(args.ExpectNextPath(), arena_waypoints);
+  args.ExpectEnd();
+
+  if (arena_waypoints.IsEmpty()) {
+    fprintf(stderr, "No waypoints\n");
+    return EXIT_FAILURE;
+  }
+
+  arena_waypoints.Optimise();
+
+  Waypoints heap_waypoints;
+  CopyToHeap(arena_waypoints, heap_waypoints);
+  heap_waypoints.Optimise();
+
+  std::vector<tstring> names;
+  for (const auto &i : arena_waypoints)
+    names.push_back(i->name);
+
+  /* query near random waypoints */
+  std::mt19937 rng(1);
+  std::uniform_int_distribution<std::size_t> pick(0, names.size() - 1);
+  std::uniform_real_distribution<double> offset(-0.05, 0.05);
+
+  std::vector<WaypointPtr> list(arena_waypoints.begin(),
+                                arena_waypoints.end());
+  std::vector<GeoPoint> queries;
+  queries.reserve(N_QUERIES);
+  for (unsigned i = 0; i < N_QUERIES; ++i) {
+    const auto &location = list[pick(rng)]->location;
+    queries.emplace_back(location.longitude + Angle::Degrees(offset(rng)),
+                         location.latitude + Angle::Degrees(offset(rng)));
+  }
+
+  std::shuffle(names.begin(), names.end(), rng);
+
+  const auto heap = Run(heap_waypoints, queries, names);
+  const auto arena = Run(arena_waypoints, queries, names);
+
+  printf("waypoints=%u queries=%u\n", arena_waypoints.size(), N_QUERIES);
+  Print("heap", heap, queries.size());
+  Print("arena", arena, queries.size());
+
+  if (heap.check != arena.check) {
+    fprintf(stderr, "Mismatch\n");
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,117 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * This program converts the topography of a map file to topography
+ * cache files (see #TopographyCacheFormat) in the given directory,
+ * which can be used as XCSoar's cache directory.  It prints the time
+ * needed to load all shapes from the shapefiles and from the cache
+ * files.
+ *
+ * The pre-computed triangles (OpenGL only) depend on the layout
+ * scale of the display, which is 1 by default.
+ */
+
+#include "Topography/TopographyStore.hpp"
+#include "Topography/TopographyFile.hpp"
+#include "Topography/TopographyCache.hpp"
+#include "Topography/XShape.hpp"
+#include "system/Args.hpp"
+#include "io/FileCache.hpp"
+#include "io/ZipArchive.hpp"
+#include "io/ZipLineReader.hpp"
+#include "util/PrintException.hxx"
+
+#include <chrono>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef ENABLE_OPENGL
+
+static void
+TriangulateAll(const TopographyFile &file, unsigned layout_scale)
+{
+  const std::lock_guard lock{file.mutex};
+
+  for (const XShape &shape : file) {
+    if (shape.get_type() == MS_SHAPE_POLYGON && !shape.GetLines().empty())
+      for (unsigned i = 0; i < XShape::THINNING_LEVELS; ++i)
+        shape.GetIndices(i, file.GetMinimumShapeDistance(i, layout_scale));
+  }
+}
+
+#endif
+
+static unsigned
+CountShapes(const TopographyStore &store)
+{
+  unsigned n = 0;
+  for (const auto &file : store) {
+    const std::lock_guard lock{file.mutex};
+    for ([[maybe_unused]] const XShape &shape : file)
+      ++n;
+  }
+
+  return n;
+}
+
+/**
+ * Load all shapes of all files and return the duration in seconds.
+ */
+static double
+LoadAll(Path path, const TopographyCacheOptions *cache_options,
+        [[maybe_unused]] unsigned layout_scale, unsigned &n_shapes)
+{
+  const auto start = std::chrono::steady_clock::now();
+
+  ZipArchive archive(path);
+  ZipLineReaderA reader(archive.get(), "topology.tpl");
+
+  TopographyStore topography;
+  topography.Load(reader, nullptr, archive.get(), cache_options);
+  topography.LoadAll();
+
+#ifdef ENABLE_OPENGL
+  for (const auto &file : topography)
+    TriangulateAll(file, layout_scale);
+#endif
+
+  const std::chrono::duration<double> duration =
+    std::chrono::steady_clock::now() - start;
+
+  n_shapes = CountShapes(topography);
+  return duration.count();
+}
+
+int main(int argc, char **argv)
+try {
+  Args args(argc, argv, "FILE.xcm CACHEDIR [LAYOUT_SCALE]");
+  const auto path = args.ExpectNextPath();
+  FileCache cache{args.ExpectNextPath()};
+  const unsigned layout_scale = args.IsEmpty() ? 1 : args.ExpectNextInt();
+  args.ExpectEnd();
+
+  if (layout_scale < 1)
+    args.UsageError();
+
+  const TopographyCacheOptions cache_options{
+    cache, path, layout_scale, true,
+  };
+
+  unsigned n_shapes;
+  const double shapefile = LoadAll(path, nullptr, layout_scale, n_shapes);
+  printf("shapefile: %u shapes in %.1f ms\n", n_shapes, shapefile * 1000);
+
+  const double convert = LoadAll(path, &cache_options, layout_scale,
+                                 n_shapes);
+  printf("convert: %u shapes in %.1f ms\n", n_shapes, convert * 1000);
+
+  const double cached = LoadAll(path, &cache_options, layout_scale, n_shapes);
+  printf("cache: %u shapes in %.1f ms\n", n_shapes, cached * 1000);
+
+  return EXIT_SUCCESS;
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
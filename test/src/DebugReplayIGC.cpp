@@ -2,17 +2,37 @@
 // Copyright The XCSoar Project
 
 #include "DebugReplayIGC.hpp"
-#include "io/FileLineReader.hpp"
-#include "IGC/IGCParser.hpp"
-#include "IGC/IGCFix.hpp"
+#include "io/FileMapping.hpp"
 #include "Units/System.hpp"
+#include "system/FileUtil.hpp"
 #include "system/Path.hpp"
 
+static std::span<const std::byte>
+ToSpan(const FileMapping *mapping) noexcept
+{
+  if (mapping == nullptr)
+    return {};
+
+  return *mapping;
+}
+
+DebugReplayIGC::DebugReplayIGC(std::unique_ptr<FileMapping> &&_mapping) noexcept
+  :mapping(std::move(_mapping)),
+   scanner(ToSpan(mapping.get())) {}
+
+DebugReplayIGC::~DebugReplayIGC() noexcept = default;
+
 DebugReplay*
 DebugReplayIGC::Create(Path input_file)
 {
-  FileLineReaderA *reader = new FileLineReaderA(input_file);
-  return new DebugReplayIGC(reader);
+  std::unique_ptr<FileMapping> mapping;
+
+  /* FileMapping refuses to map empty files, but those are valid
+     (without any fixes) */
+  if (File::GetSize(input_file) > 0 || !File::Exists(input_file))
+    mapping = std::make_unique<FileMapping>(input_file);
+
+  return new DebugReplayIGC(std::move(mapping));
 }
 
 bool
@@ -20,28 +40,24 @@ DebugReplayIGC::Next()
 {
   last_basic = computed_basic;
 
-  const char *line;
-  while ((line = reader->ReadLine()) != NULL) {
-    if (line[0] == 'B') {
-      IGCFix fix;
-      if (IGCParseFix(line, extensions, fix)) {
-        CopyFromFix(fix);
-
-        Compute();
-        return true;
-      }
-    } else if (line[0] == 'H') {
-      BrokenDate date;
-      if (memcmp(line, "HFDTE", 5) == 0 &&
-          IGCParseDateRecord(line, date)) {
-        (BrokenDate &)raw_basic.date_time_utc = date;
-        raw_basic.time_available.Clear();
-      }
-    } else if (line[0] == 'I') {
-      IGCParseExtensions(line, extensions);
+  if (current_fix == n_fixes) {
+    n_fixes = scanner.Read(fixes);
+    current_fix = 0;
+
+    BrokenDate date;
+    if (scanner.TakeDate(date)) {
+      (BrokenDate &)raw_basic.date_time_utc = date;
+      raw_basic.time_available.Clear();
     }
   }
 
+  if (current_fix < n_fixes) {
+    CopyFromFix(fixes[current_fix++]);
+
+    Compute();
+    return true;
+  }
+
   if (computed_basic.time_available)
     flying_computer.Finish(calculated.flight, computed_basic.time);
 
@@ -3,22 +3,36 @@
 
 #pragma once
 
-#include "DebugReplayFile.hpp"
-#include "IGC/IGCExtensions.hpp"
-#include "io/FileLineReader.hpp"
+#include "DebugReplay.hpp"
+#include "IGC/IGCScanner.hpp"
+#include "IGC/IGCFix.hpp"
 
-struct IGCFix;
+#include <array>
+#include <memory>
 
-class DebugReplayIGC : public DebugReplayFile {
-  IGCExtensions extensions;
+class FileMapping;
+class Path;
+
+class DebugReplayIGC : public DebugReplay {
+  /**
+   * The IGC file; nullptr if the file is empty.
+   */
+  const std::unique_ptr<FileMapping> mapping;
+
+  IGCScanner scanner;
+
+  /**
+   * Fixes are parsed in chunks; this is the current chunk.
+   */
+  std::array<IGCFix, 256> fixes;
+  std::size_t n_fixes = 0, current_fix = 0;
 
 private:
-  DebugReplayIGC(FileLineReaderA *_reader)
-    : DebugReplayFile(_reader) {
-    extensions.clear();
-  }
+  explicit DebugReplayIGC(std::unique_ptr<FileMapping> &&_mapping) noexcept;
 
 public:
+  ~DebugReplayIGC() noexcept;
+
   virtual bool Next();
 
   static DebugReplay *Create(Path input_file);
@@ -48,6 +48,15 @@ static ContestManager weglide_free(Contest::WEGLIDE_FREE,
 static ContestManager charron(Contest::CHARRON,
                               full_trace, triangle_trace, sprint_trace);
 
+static void
+PrintSolveTimes(const char *name, const ContestManager &manager)
+{
+  fprintf(stderr, "%s:", name);
+  for (std::size_t i = 0; i < ContestStatistics::N; ++i)
+    fprintf(stderr, " %.3fs", manager.GetSolveTime(i).count());
+  fputc('\n', stderr);
+}
+
 static int
 TestContest(DebugReplay &replay)
 {
@@ -94,6 +103,17 @@ TestContest(DebugReplay &replay)
 
   putchar('\n');
 
+  PrintSolveTimes("classic", olc_classic);
+  PrintSolveTimes("fai", olc_fai);
+  PrintSolveTimes("league", olc_league);
+  PrintSolveTimes("plus", olc_plus);
+  PrintSolveTimes("dmst", dmst);
+  PrintSolveTimes("xcontest", xcontest);
+  PrintSolveTimes("sis_at", sis_at);
+  PrintSolveTimes("netcoupe", olc_netcoupe);
+  PrintSolveTimes("weglide", weglide_free);
+  PrintSolveTimes("charron", charron);
+
   std::cout << "classic\n";
   PrintHelper::print(olc_classic.GetStats().GetResult());
   std::cout << "league\n";
@@ -0,0 +1,425 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+/*
+ * This program floods a SkyLines tracking server (e.g.
+ * xcsoar-cloud-server) with fixes and pings from many simulated
+ * clients and reports how many packets per second were sent and
+ * answered.  Example:
+ *
+ *   RunSkyLinesLoad localhost 500 10
+ *
+ * The simulated clients are spread over the given number of sockets,
+ * each one with its own source port and its own thread.  A server
+ * which distributes datagrams over several threads with SO_REUSEPORT
+ * chooses the thread by the source address, so one socket would
+ * reach only one server thread; use several times as many sockets as
+ * the server has threads.
+ *
+ * With "--server", the program launches the given xcsoar-cloud-server
+ * binary with 1 to N threads (using a temporary database) and
+ * measures each one:
+ *
+ *   RunSkyLinesLoad --sockets=32 --server=output/UNIX/bin/xcsoar-cloud-server \
+ *     --threads=8 localhost 5000 10
+ */
+
+#include "Tracking/SkyLines/Assemble.hpp"
+#include "Tracking/SkyLines/Protocol.hpp"
+#include "Geo/GeoPoint.hpp"
+#include "net/Resolver.hxx"
+#include "net/AddressInfo.hxx"
+#include "net/SocketError.hxx"
+#include "net/UniqueSocketDescriptor.hxx"
+#include "system/Error.hxx"
+#include "system/Args.hpp"
+#include "util/ByteOrder.hxx"
+#include "util/NumberParser.hpp"
+#include "util/PrintException.hxx"
+#include "util/StringCompare.hxx"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef HAVE_POSIX
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include <stdio.h>
+
+using namespace std::chrono;
+
+/**
+ * The maximum number of pings which have not been answered yet.
+ * When this is reached, the program waits for ACKs (or assumes that
+ * the pings were lost).
+ */
+static constexpr unsigned WINDOW = 256;
+
+static constexpr unsigned DEFAULT_PORT = 5597;
+
+static unsigned
+ParseUnsignedArg(Args &args, const char *s)
+{
+  char *endptr;
+  unsigned value = ParseUnsigned(s, &endptr);
+  if (endptr == s || *endptr != 0 || value < 1)
+    args.UsageError();
+  return value;
+}
+
+static unsigned
+ParseUnsignedArg(Args &args, unsigned default_value)
+{
+  if (args.IsEmpty())
+    return default_value;
+
+  return ParseUnsignedArg(args, args.GetNext());
+}
+
+struct Statistics {
+  unsigned long sent = 0, received = 0, acks = 0, lost = 0;
+
+  Statistics &operator+=(const Statistics &other) noexcept {
+    sent += other.sent;
+    received += other.received;
+    acks += other.acks;
+    lost += other.lost;
+    return *this;
+  }
+};
+
+template<typename T>
+static void
+Send(SocketDescriptor s, const T &packet, Statistics &statistics)
+{
+  if (s.Write({(const std::byte *)&packet, sizeof(packet)}) < 0)
+    throw MakeSocketError("Failed to send");
+
+  ++statistics.sent;
+}
+
+/**
+ * Receive all pending datagrams.
+ *
+ * @return the number of ACK packets
+ */
+static unsigned
+ReceiveAll(SocketDescriptor s, Statistics &statistics)
+{
+  unsigned n_acks = 0;
+
+  std::byte buffer[4096];
+  ssize_t nbytes;
+  while ((nbytes = s.ReadNoWait(buffer)) >= 0) {
+    ++statistics.received;
+
+    const auto &header = *(const SkyLinesTracking::Header *)buffer;
+    if ((std::size_t)nbytes >= sizeof(header) &&
+        FromBE16(header.type) == SkyLinesTracking::ACK)
+      ++n_acks;
+  }
+
+  if (!IsSocketErrorReceiveWouldBlock(GetSocketError()))
+    throw MakeSocketError("Failed to receive");
+
+  statistics.acks += n_acks;
+  return n_acks;
+}
+
+static UniqueSocketDescriptor
+ConnectSocket(SocketAddress address)
+{
+  UniqueSocketDescriptor s;
+  if (!s.Create(address.GetFamily(), SOCK_DGRAM, 0))
+    throw MakeSocketError("Failed to create socket");
+
+  /* connect() binds the socket to a new ephemeral port, therefore
+     each socket has a different source address */
+  if (!s.Connect(address))
+    throw MakeSocketError("Failed to connect socket");
+
+  return s;
+}
+
+/**
+ * Simulate the clients which are assigned to one socket, i.e. those
+ * whose number modulo #n_sockets is #socket_index.
+ */
+static void
+RunSocket(SocketAddress address, unsigned socket_index, unsigned n_sockets,
+          unsigned n_clients, steady_clock::time_point end,
+          Statistics &statistics)
+{
+  const auto s = ConnectSocket(address);
+
+  const GeoPoint center(Angle::Degrees(7.7), Angle::Degrees(51.5));
+
+  unsigned outstanding = 0;
+  uint16_t id = 0;
+
+  for (unsigned round = 0; steady_clock::now() < end; ++round) {
+    const uint32_t time = round * 1000;
+
+    for (unsigned i = socket_index; i < n_clients; i += n_sockets) {
+      const uint64_t key = 0x10000 + i;
+
+      const GeoPoint location(center.longitude + Angle::Degrees(0.001 * (i % 100)),
+                              center.latitude + Angle::Degrees(0.001 * (i / 100)));
+
+      Send(s, SkyLinesTracking::MakeFix(key,
+                                        SkyLinesTracking::FixPacket::FLAG_LOCATION |
+                                        SkyLinesTracking::FixPacket::FLAG_ALTITUDE,
+                                        time, location, Angle::Zero(),
+                                        0, 0, 1000, 0, 0),
+           statistics);
+      Send(s, SkyLinesTracking::MakePing(key, id++), statistics);
+      ++outstanding;
+
+      const unsigned n_acks = ReceiveAll(s, statistics);
+      outstanding -= std::min(n_acks, outstanding);
+
+      while (outstanding >= WINDOW) {
+        if (s.WaitReadable(100) <= 0) {
+          /* no reply for a while: assume the pings were lost */
+          statistics.lost += outstanding;
+          outstanding = 0;
+          break;
+        }
+
+        const unsigned n = ReceiveAll(s, statistics);
+        outstanding -= std::min(n, outstanding);
+      }
+    }
+  }
+
+  /* collect the late replies */
+  while (outstanding > 0 && s.WaitReadable(200) > 0) {
+    const unsigned n = ReceiveAll(s, statistics);
+    outstanding -= std::min(n, outstanding);
+  }
+
+  statistics.lost += outstanding;
+}
+
+/**
+ * Run the load generator with one thread per socket.
+ */
+static Statistics
+RunLoad(SocketAddress address, unsigned n_sockets, unsigned n_clients,
+        unsigned n_seconds)
+{
+  std::vector<Statistics> statistics(n_sockets);
+  std::vector<std::exception_ptr> errors(n_sockets);
+
+  const auto end = steady_clock::now() + seconds(n_seconds);
+
+  std::vector<std::thread> threads;
+  threads.reserve(n_sockets);
+
+  for (unsigned i = 0; i < n_sockets; ++i)
+    threads.emplace_back([&, i]{
+      try {
+        RunSocket(address, i, n_sockets, n_clients, end, statistics[i]);
+      } catch (...) {
+        errors[i] = std::current_exception();
+      }
+    });
+
+  for (auto &i : threads)
+    i.join();
+
+  for (const auto &i : errors)
+    if (i)
+      std::rethrow_exception(i);
+
+  Statistics total;
+  for (const auto &i : statistics)
+    total += i;
+  return total;
+}
+
+static void
+PrintStatistics(const Statistics &statistics, duration<double> elapsed)
+{
+  printf("sent=%lu (%.0f pkt/s) received=%lu (%.0f pkt/s)\n",
+         statistics.sent, statistics.sent / elapsed.count(),
+         statistics.received, statistics.received / elapsed.count());
+  printf("acks=%lu lost=%lu\n", statistics.acks, statistics.lost);
+}
+
+#ifdef HAVE_POSIX
+
+/**
+ * Wait until the server answers a ping.
+ */
+static bool
+WaitServerReady(SocketAddress address)
+{
+  const auto s = ConnectSocket(address);
+
+  for (unsigned i = 0; i < 50; ++i) {
+    /* errors ("connection refused") are expected while the server is
+       starting */
+    const auto ping = SkyLinesTracking::MakePing(1, i);
+    if (s.Write({(const std::byte *)&ping, sizeof(ping)}) > 0 &&
+        s.WaitReadable(100) > 0) {
+      std::byte buffer[4096];
+      if (s.ReadNoWait(buffer) > 0)
+        return true;
+    }
+
+    std::this_thread::sleep_for(milliseconds(100));
+  }
+
+  return false;
+}
+
+/**
+ * A server process launched by this program.
+ */
+class ServerProcess {
+  pid_t pid;
+
+public:
+  ServerProcess(const char *program, const char *db_path, unsigned n_threads)
+  {
+    const std::string threads_string = std::to_string(n_threads);
+
+    /* don't let the child inherit buffered output */
+    fflush(stdout);
+
+    pid = fork();
+    if (pid < 0)
+      throw MakeErrno("fork() failed");
+
+    if (pid == 0) {
+      /* the server logs each datagram; discard that */
+      if (freopen("/dev/null", "w", stdout) == nullptr)
+        _exit(EXIT_FAILURE);
+
+      execl(program, program, db_path, threads_string.c_str(), nullptr);
+      perror("Failed to execute server");
+      _exit(EXIT_FAILURE);
+    }
+  }
+
+  ~ServerProcess() noexcept {
+    kill(pid, SIGTERM);
+
+    int status;
+    waitpid(pid, &status, 0);
+  }
+
+  ServerProcess(const ServerProcess &) = delete;
+  ServerProcess &operator=(const ServerProcess &) = delete;
+};
+
+/**
+ * Measure the server with 1 to #max_threads threads.
+ */
+static void
+RunServerSeries(SocketAddress address, const char *program,
+                unsigned max_threads, unsigned n_sockets,
+                unsigned n_clients, unsigned n_seconds)
+{
+  char tmp_template[] = "/tmp/RunSkyLinesLoad.XXXXXX";
+  const char *tmp = mkdtemp(tmp_template);
+  if (tmp == nullptr)
+    throw MakeErrno("Failed to create temporary directory");
+
+  printf("clients=%u sockets=%u seconds=%u\n", n_clients, n_sockets, n_seconds);
+  printf("threads      sent/s  received/s       acks   lost\n");
+
+  for (unsigned n_threads = 1; n_threads <= max_threads; ++n_threads) {
+    /* a new database for each run */
+    const std::string db_path = std::string(tmp) + "/db" +
+      std::to_string(n_threads);
+
+    ServerProcess server(program, db_path.c_str(), n_threads);
+
+    if (!WaitServerReady(address)) {
+      fprintf(stderr, "Server does not respond\n");
+      break;
+    }
+
+    const auto start = steady_clock::now();
+    const auto statistics = RunLoad(address, n_sockets, n_clients, n_seconds);
+    const duration<double> elapsed = steady_clock::now() - start;
+
+    printf("%7u %11.0f %11.0f %10lu %6lu\n", n_threads,
+           statistics.sent / elapsed.count(),
+           statistics.received / elapsed.count(),
+           statistics.acks, statistics.lost);
+  }
+
+  std::filesystem::remove_all(tmp);
+}
+
+#endif
+
+int
+main(int argc, char *argv[])
+try {
+  Args args(argc, argv,
+            "[--sockets=N] [--server=PROGRAM --threads=N] "
+            "HOST[:PORT] [CLIENTS [SECONDS]]");
+
+  unsigned n_sockets = 1, max_threads = 1;
+  const char *server_program = nullptr;
+
+  const char *arg;
+  while ((arg = args.PeekNext()) != nullptr && *arg == '-') {
+    args.Skip();
+
+    const char *value;
+    if ((value = StringAfterPrefix(arg, "--sockets=")) != nullptr)
+      n_sockets = ParseUnsignedArg(args, value);
+    else if ((value = StringAfterPrefix(arg, "--threads=")) != nullptr)
+      max_threads = ParseUnsignedArg(args, value);
+#ifdef HAVE_POSIX
+    else if ((value = StringAfterPrefix(arg, "--server=")) != nullptr)
+      server_program = value;
+#endif
+    else
+      args.UsageError();
+  }
+
+  const char *host = args.ExpectNext();
+  const unsigned n_clients = ParseUnsignedArg(args, 100);
+  const unsigned n_seconds = ParseUnsignedArg(args, 10);
+  args.ExpectEnd();
+
+  const auto address_list = Resolve(host, DEFAULT_PORT,
+                                    0, SOCK_DGRAM);
+  const auto &address = address_list.GetBest();
+
+#ifdef HAVE_POSIX
+  if (server_program != nullptr) {
+    RunServerSeries(address, server_program, max_threads,
+                    n_sockets, n_clients, n_seconds);
+    return EXIT_SUCCESS;
+  }
+#endif
+
+  const auto start = steady_clock::now();
+  const auto statistics = RunLoad(address, n_sockets, n_clients, n_seconds);
+  const duration<double> elapsed = steady_clock::now() - start;
+
+  printf("clients=%u sockets=%u seconds=%.1f\n",
+         n_clients, n_sockets, elapsed.count());
+  PrintStatistics(statistics, elapsed);
+
+  return EXIT_SUCCESS;
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
@@ -2,6 +2,7 @@
 // Copyright The XCSoar Project
 
 #include "Airspace/AirspaceParser.hpp"
+#include "Airspace/AirspaceCache.hpp"
 #include "Engine/Airspace/AbstractAirspace.hpp"
 #include "Engine/Airspace/AirspaceCircle.hpp"
 #include "Engine/Airspace/AirspacePolygon.hpp"
@@ -11,9 +12,13 @@
 #include "util/StringAPI.hxx"
 #include "util/PrintException.hxx"
 #include "io/FileLineReader.hpp"
+#include "io/FileCache.hpp"
 #include "Operation/Operation.hpp"
 #include "TestUtil.hpp"
 
+#include <algorithm>
+#include <vector>
+
 #include <tchar.h>
 
 struct AirspaceClassTestCouple
@@ -288,13 +293,105 @@ TestOpenAirExtended()
   }
 }
 
+[[gnu::pure]]
+static bool
+IsEqualAltitude(const AirspaceAltitude &a, const AirspaceAltitude &b) noexcept
+{
+  return a.altitude == b.altitude && a.flight_level == b.flight_level &&
+    a.altitude_above_terrain == b.altitude_above_terrain &&
+    a.reference == b.reference;
+}
+
+[[gnu::pure]]
+static bool
+IsEqualAirspace(const AbstractAirspace &a, const AbstractAirspace &b) noexcept
+{
+  if (!StringIsEqual(a.GetName(), b.GetName()) ||
+      a.GetShape() != b.GetShape() ||
+      a.GetClass() != b.GetClass() || a.GetType() != b.GetType() ||
+      !IsEqualAltitude(a.GetBase(), b.GetBase()) ||
+      !IsEqualAltitude(a.GetTop(), b.GetTop()) ||
+      a.GetRadioFrequency().IsDefined() != b.GetRadioFrequency().IsDefined() ||
+      (a.GetRadioFrequency().IsDefined() &&
+       a.GetRadioFrequency().GetKiloHertz() != b.GetRadioFrequency().GetKiloHertz()) ||
+      a.GetDays().GetMask() != b.GetDays().GetMask())
+    return false;
+
+  if (a.GetShape() == AbstractAirspace::Shape::CIRCLE)
+    return a.GetReferenceLocation() == b.GetReferenceLocation() &&
+      ((const AirspaceCircle &)a).GetRadius() ==
+      ((const AirspaceCircle &)b).GetRadius();
+
+  return std::equal(a.GetPoints().begin(), a.GetPoints().end(),
+                    b.GetPoints().begin(), b.GetPoints().end(),
+                    [](const auto &x, const auto &y){
+                      return x.GetLocation() == y.GetLocation();
+                    });
+}
+
+static std::vector<const AbstractAirspace *>
+SortedAirspaces(const Airspaces &airspaces)
+{
+  std::vector<const AbstractAirspace *> v;
+  for (const auto &i : airspaces.QueryAll())
+    v.push_back(&i.GetAirspace());
+
+  std::sort(v.begin(), v.end(), [](const auto *a, const auto *b){
+    return StringCollate(a->GetName(), b->GetName()) < 0;
+  });
+  return v;
+}
+
+static void
+TestCache()
+{
+  const Path original_path(_T("test/data/airspace/openair.txt"));
+  const TCHAR *const name = _T("openair");
+  FileCache cache(AllocatedPath(_T("output/airspace-cache")));
+  cache.Flush(name);
+
+  Airspaces parsed;
+  FileReader file_reader{original_path};
+  BufferedReader buffered_reader{file_reader};
+  ParseAirspaceFile(parsed, buffered_reader);
+  parsed.Optimise();
+
+  SaveAirspaceCache(cache, name, original_path, original_path.c_str(),
+                    parsed);
+
+  Airspaces loaded;
+  ok1(LoadAirspaceCache(cache, name, original_path, original_path.c_str(),
+                        loaded));
+  loaded.Optimise();
+
+  const auto a = SortedAirspaces(parsed), b = SortedAirspaces(loaded);
+  ok1(a.size() == b.size());
+  ok1(std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                 [](const auto *x, const auto *y){
+                   return IsEqualAirspace(*x, *y);
+                 }));
+
+  /* the source is checked by the airspace cache, the rest of the
+     file validation is covered by TestFlatCache */
+  Airspaces other;
+  bool thrown = false;
+  try {
+    LoadAirspaceCache(cache, name, original_path, _T("other.txt"), other);
+  } catch (const std::runtime_error &) {
+    thrown = true;
+  }
+
+  ok1(thrown && other.IsEmpty());
+}
+
 int main()
 try {
-  plan_tests(113);
+  plan_tests(117);
 
   TestOpenAir();
   TestTNP();
   TestOpenAirExtended();
+  TestCache();
 
   return exit_status();
 } catch (const std::runtime_error &e) {
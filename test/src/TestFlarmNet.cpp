@@ -8,9 +8,11 @@
 #include "system/Path.hpp"
 #include "TestUtil.hpp"
 
+#include <iterator>
+
 int main()
 {
-  plan_tests(15);
+  plan_tests(25);
 
   FlarmNetDatabase db;
   int count = FlarmNetReader::LoadFile(Path(_T("test/data/flarmnet/data.fln")),
@@ -59,5 +61,34 @@ int main()
   ok1(foundDDA85C);
   ok1(foundDDA896);
 
+  /* the buffer size is respected */
+  ok1(db.FindIdsByCallSign(_T("TH"), ids, 1) == 1);
+  ok1(ids[0] == id || ids[0] == id2);
+  ok1(db.FindRecordsByCallSign(_T("TH"), array, 1) == 1);
+
+  record = db.FindFirstRecordByCallSign(_T("TH"));
+  ok1(record != NULL && StringIsEqual(record->callsign, _T("TH")));
+
+  ok1(db.FindFirstRecordByCallSign(_T("XYZ")) == NULL);
+  ok1(db.FindIdsByCallSign(_T("T"), ids, 3) == 0);
+
+  /* a duplicate id is ignored */
+  FlarmNetRecord duplicate = *db.FindRecordById(id);
+  duplicate.pilot = _T("Duplicate");
+  db.Insert(duplicate);
+  ok1(StringIsEqual(db.FindRecordById(id)->pilot, _T("Tobias Bieniek")));
+
+  /* insert a new record into the existing indexes */
+  FlarmNetRecord added = duplicate;
+  added.id = _T("ABCDEF");
+  db.Insert(added);
+  record = db.FindRecordById(FlarmId::Parse("ABCDEF", NULL));
+  ok1(record != NULL && StringIsEqual(record->pilot, _T("Duplicate")));
+  ok1(db.FindIdsByCallSign(_T("TH"), ids, 3) == 3);
+
+  /* load the same file again: all ids exist already */
+  FlarmNetReader::LoadFile(Path(_T("test/data/flarmnet/data.fln")), db);
+  ok1(std::distance(db.begin(), db.end()) == 7);
+
   return exit_status();
 }
@@ -0,0 +1,190 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "io/FlatCache.hpp"
+#include "io/FileOutputStream.hxx"
+#include "system/Path.hpp"
+#include "util/StringAPI.hxx"
+#include "util/PrintException.hxx"
+#include "TestUtil.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * A minimal file format: an array of values and a string table.
+ */
+struct Trailer {
+  uint32_t n_values, n_chars;
+  FlatCache::StringRef label;
+  uint32_t reserved;
+  uint64_t values_offset;
+};
+
+static const Path original_path(_T("test/src/TestFlatCache.cpp"));
+static const TCHAR *const name = _T("flat");
+
+static void
+Save(FileCache &cache, std::span<const uint32_t> values, const TCHAR *label,
+     uint32_t extra_values=0)
+{
+  FlatCache::StringTable strings;
+  const auto label_ref = strings.Add(label);
+  const auto chars = strings.GetChars();
+
+  FlatCache::Writer writer(cache, name, original_path);
+
+  Trailer trailer{};
+  trailer.n_values = values.size() + extra_values;
+  trailer.n_chars = chars.size();
+  trailer.label = label_ref;
+  trailer.values_offset = writer.GetPosition();
+
+  writer.Write(values);
+  writer.Write(chars);
+  writer.Commit(trailer);
+}
+
+static void
+Load(std::span<const std::byte> raw,
+     std::vector<uint32_t> &values, tstring &label)
+{
+  FlatCache::Reader reader(raw);
+  const auto trailer = reader.ReadTrailer<Trailer>();
+
+  reader.Seek(trailer.values_offset);
+  const auto v = reader.Read<uint32_t>(trailer.n_values);
+  const auto chars = reader.ReadStrings(trailer.n_chars);
+  reader.Finish();
+
+  values.assign(v.begin(), v.end());
+  label = FlatCache::GetString(chars, trailer.label);
+}
+
+static bool
+Load(FileCache &cache, std::vector<uint32_t> &values, tstring &label)
+{
+  return FlatCache::Load(cache, name, original_path,
+                         [&](std::unique_ptr<FileMapping> &&mapping){
+                           Load(*mapping, values, label);
+                         });
+}
+
+/**
+ * Attempt to load a malformed file.
+ *
+ * @return true if it was rejected and deleted
+ */
+static bool
+IsRejected(FileCache &cache)
+{
+  std::vector<uint32_t> values;
+  tstring label;
+
+  try {
+    Load(cache, values, label);
+    return false;
+  } catch (const std::runtime_error &) {
+  }
+
+  return !Load(cache, values, label);
+}
+
+static void
+TestStringTable()
+{
+  FlatCache::StringTable strings;
+  ok1(strings.Add(_T("")) == 0);
+
+  const auto foo = strings.Add(_T("foo"));
+  const auto bar = strings.Add(_T("bar"));
+  ok1(foo != 0 && bar != 0 && foo != bar);
+  ok1(strings.Add(_T("foo")) == foo);
+
+  const auto chars = strings.GetChars();
+  ok1(chars.front() == _T('\0') && chars.back() == _T('\0'));
+  ok1(StringIsEqual(FlatCache::GetString(chars, foo), _T("foo")));
+  ok1(StringIsEqual(FlatCache::GetString(chars, bar), _T("bar")));
+
+  bool thrown = false;
+  try {
+    FlatCache::GetString(chars, chars.size());
+  } catch (const std::runtime_error &) {
+    thrown = true;
+  }
+
+  ok1(thrown);
+}
+
+static void
+TestRoundTrip(FileCache &cache)
+{
+  static constexpr uint32_t expected[] = { 1, 2, 3, 5, 8 };
+  Save(cache, expected, _T("fibonacci"));
+
+  std::vector<uint32_t> values;
+  tstring label;
+  ok1(Load(cache, values, label));
+  ok1(std::equal(values.begin(), values.end(),
+                 std::begin(expected), std::end(expected)));
+  ok1(label == _T("fibonacci"));
+
+  /* an empty file is valid, too */
+  Save(cache, {}, _T(""));
+  ok1(Load(cache, values, label));
+  ok1(values.empty() && label.empty());
+}
+
+static void
+TestMalformed(FileCache &cache)
+{
+  static constexpr uint32_t values[] = { 1, 2, 3 };
+
+  /* the trailer refers to more data than there is */
+  Save(cache, values, _T("foo"), 1000);
+  ok1(IsRejected(cache));
+
+  /* smaller than the trailer */
+  {
+    auto file = cache.Save(name, original_path);
+    file->Write(ReferenceAsBytes(values));
+    file->Commit();
+  }
+
+  ok1(IsRejected(cache));
+
+  /* the string table is not null-terminated */
+  {
+    FlatCache::Writer writer(cache, name, original_path);
+    static constexpr TCHAR chars[] = { _T('\0'), _T('x') };
+
+    Trailer trailer{};
+    trailer.n_chars = std::size(chars);
+    trailer.values_offset = writer.GetPosition();
+
+    writer.Write(std::span{chars});
+    writer.Commit(trailer);
+  }
+
+  ok1(IsRejected(cache));
+}
+
+int main()
+try {
+  plan_tests(15);
+
+  FileCache cache(AllocatedPath(_T("output/flat-cache")));
+  cache.Flush(name);
+
+  TestStringTable();
+  TestRoundTrip(cache);
+  TestMalformed(cache);
+
+  cache.Flush(name);
+
+  return exit_status();
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
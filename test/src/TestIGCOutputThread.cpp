@@ -0,0 +1,198 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+// Copyright The XCSoar Project
+
+#include "IGC/IGCOutputThread.hpp"
+#include "io/FileOutputStream.hxx"
+#include "io/FileLineReader.hpp"
+#include "system/FileUtil.hpp"
+#include "util/StringAPI.hxx"
+#include "util/PrintException.hxx"
+#include "TestUtil.hpp"
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+
+#include <stdio.h>
+
+using std::chrono::steady_clock;
+
+/**
+ * Simulates a slow SD card: each write and each sync takes #delay.
+ */
+class SlowSink final : public IGCOutputThread::Sink {
+  FileOutputStream file;
+
+  const steady_clock::duration delay;
+
+public:
+  std::atomic_uint n_writes{0}, n_syncs{0};
+
+  SlowSink(Path path, steady_clock::duration _delay)
+    :file(path, FileOutputStream::Mode::CREATE_VISIBLE), delay(_delay) {}
+
+  void Write(std::span<const std::byte> src) override {
+    std::this_thread::sleep_for(delay);
+    file.Write(src);
+    ++n_writes;
+  }
+
+  void Sync() override {
+    std::this_thread::sleep_for(delay);
+    file.Sync();
+    ++n_syncs;
+  }
+};
+
+class FailingSink final : public IGCOutputThread::Sink {
+public:
+  void Write(std::span<const std::byte>) override {
+    throw std::runtime_error("Disk full");
+  }
+
+  void Sync() override {
+  }
+};
+
+static constexpr unsigned N_LINES = 3000;
+static constexpr auto DELAY = std::chrono::milliseconds(200);
+
+static void
+FormatLine(char *buffer, unsigned i) noexcept
+{
+  sprintf(buffer, "B%06u5103117N00742367EA0049000487", i);
+}
+
+/**
+ * The producer must not wait for the slow disk, even if it writes
+ * more than fits into the ring buffer.
+ */
+static void
+TestSlowDisk(Path path)
+{
+  steady_clock::duration max_append{}, total{};
+
+  {
+    SlowSink sink(path, DELAY);
+    IGCOutputThread output(sink);
+
+    char line[64];
+    for (unsigned i = 0; i < N_LINES; ++i) {
+      FormatLine(line, i);
+
+      const auto start = steady_clock::now();
+      output.Append(line);
+      const auto duration = steady_clock::now() - start;
+
+      total += duration;
+      if (duration > max_append)
+        max_append = duration;
+    }
+
+    /* nothing has been written yet, the thread is still busy */
+    ok1(sink.n_writes < 2);
+
+    output.Sign();
+
+    ok1(sink.n_writes > 1);
+    ok1(sink.n_syncs > 0);
+  }
+
+  ok1(max_append < DELAY / 4);
+  ok1(total < DELAY / 2);
+
+  FileLineReaderA reader(path);
+  unsigned n = 0;
+  bool equal = true;
+  const char *line;
+  while ((line = reader.ReadLine()) != nullptr && *line != 'G') {
+    char expected[64];
+    FormatLine(expected, n++);
+    equal = equal && StringIsEqual(line, expected);
+  }
+
+  ok1(n == N_LINES);
+  ok1(equal);
+
+  GRecord grecord;
+  grecord.Initialize();
+
+  bool valid;
+  try {
+    grecord.VerifyGRecordInFile(path);
+    valid = true;
+  } catch (...) {
+    valid = false;
+  }
+
+  ok1(valid);
+}
+
+/**
+ * Without an explicit Flush(), the data is synced after the
+ * configured interval.
+ */
+static void
+TestSyncInterval(Path path)
+{
+  SlowSink sink(path, {});
+  IGCOutputThread output(sink, {});
+
+  output.Append("AXCSFOO");
+
+  const auto timeout = steady_clock::now() + std::chrono::seconds(5);
+  while (sink.n_syncs == 0 && steady_clock::now() < timeout)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+  ok1(sink.n_writes == 1);
+  ok1(sink.n_syncs == 1);
+}
+
+/**
+ * I/O errors are reported to the producer.
+ */
+static void
+TestError()
+{
+  FailingSink sink;
+  IGCOutputThread output(sink);
+
+  output.Append("AXCSFOO");
+
+  bool thrown = false;
+  try {
+    output.Flush();
+  } catch (const std::runtime_error &) {
+    thrown = true;
+  }
+
+  ok1(thrown);
+
+  thrown = false;
+  try {
+    output.Append("HFDTE040910");
+  } catch (const std::runtime_error &) {
+    thrown = true;
+  }
+
+  ok1(thrown);
+}
+
+int main()
+try {
+  plan_tests(12);
+
+  const Path path(_T("output/test/test_output_thread.igc"));
+  File::Delete(path);
+
+  TestSlowDisk(path);
+  TestSyncInterval(path);
+  TestError();
+
+  File::Delete(path);
+
+  return exit_status();
+} catch (...) {
+  PrintException(std::current_exception());
+  return EXIT_FAILURE;
+}
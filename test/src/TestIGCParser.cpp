@@ -2,6 +2,7 @@
 // Copyright The XCSoar Project
 
 #include "IGC/IGCParser.hpp"
+#include "IGC/IGCScanner.hpp"
 #include "IGC/IGCExtensions.hpp"
 #include "IGC/IGCFix.hpp"
 #include "IGC/IGCHeader.hpp"
@@ -10,6 +11,8 @@
 #include "time/BrokenTime.hpp"
 #include "TestUtil.hpp"
 
+#include <string>
+
 #include <string.h>
 
 static void
@@ -171,6 +174,92 @@ TestFix()
   ok1(fix.gps_altitude == 7);
 }
 
+static bool
+Equals(const IGCFix &a, const IGCFix &b)
+{
+  return a.time == b.time && a.location == b.location &&
+    a.gps_valid == b.gps_valid &&
+    a.gps_altitude == b.gps_altitude &&
+    a.pressure_altitude == b.pressure_altitude &&
+    a.enl == b.enl && a.gsp == b.gsp;
+}
+
+/**
+ * Check the fast parser for lines which are not null-terminated
+ * against the generic one.
+ */
+static void
+TestFastFix()
+{
+  IGCExtensions extensions;
+  ok1(IGCParseExtensions("I033638FXA3941ENL4246GSP", extensions));
+
+  static constexpr const char *lines[] = {
+    "",
+    "B1122385103117N00742367EA",
+    "B1122385103117X00742367EA0049000487",
+    "B1122389003117N00742367EA0049000487",
+    "B1122385103117N18042367EA0049000487",
+    "B1122385103117N00742367EX0049000487",
+    "B1122385103117N00742367EA0049000487",
+    "B1122385103117S00742367WV-001200487",
+    "B1122385103117N00742367EA 049000487",
+    "B1122385103117N00742367EA00490004870120120050",
+    "B1122385103117N00742367EA004900048701201",
+  };
+
+  for (const char *line : lines) {
+    /* garbage after the end of the line must be ignored */
+    const std::string padded = std::string(line) + "99999";
+    const std::string_view view{padded.data(), strlen(line)};
+
+    IGCFix a, b;
+    const bool result = IGCParseFix(line, extensions, a);
+    ok1(IGCParseFix(view, extensions, b) == result &&
+        (!result || Equals(a, b)));
+  }
+}
+
+static void
+TestScanner()
+{
+  static constexpr char igc[] =
+    "AXCSfoo\r\n"
+    "HFDTE040910\r\n"
+    "I013638ENL\r\n"
+    "B1122385103117N00742367EA0049000487010\r\n"
+    "B1122395103117N00742367EA0049000487020\r\n"
+    "Bgarbage\r\n"
+    "\r\n"
+    "B1122405103117N00742367EA0049000487030\r\n"
+    "HFDTE050910\n"
+    "B1122415103117N00742367EA0049000487040";
+
+  IGCScanner scanner(std::as_bytes(std::span{igc, sizeof(igc) - 1}));
+  IGCFix fixes[2];
+  BrokenDate date;
+
+  ok1(scanner.Read(fixes) == 2);
+  ok1(scanner.TakeDate(date));
+  ok1(date == BrokenDate(2010, 9, 4));
+  ok1(!scanner.TakeDate(date));
+  ok1(fixes[0].time == BrokenTime(11, 22, 38));
+  ok1(fixes[1].enl == 20);
+
+  /* stops before the date change */
+  ok1(scanner.Read(fixes) == 1);
+  ok1(!scanner.TakeDate(date));
+  ok1(fixes[0].enl == 30);
+
+  ok1(scanner.Read(fixes) == 1);
+  ok1(scanner.TakeDate(date));
+  ok1(date == BrokenDate(2010, 9, 5));
+  ok1(fixes[0].time == BrokenTime(11, 22, 41));
+  ok1(fixes[0].enl == 40);
+
+  ok1(scanner.Read(fixes) == 0);
+}
+
 static void
 TestFixTime()
 {
@@ -251,13 +340,15 @@ TestDeclarationTurnpoint()
 
 int main()
 {
-  plan_tests(148);
+  plan_tests(175);
 
   TestHeader();
   TestDate();
   TestLocation();
   TestExtensions();
   TestFix();
+  TestFastFix();
+  TestScanner();
   TestFixTime();
   TestDeclarationHeader();
   TestDeclarationTurnpoint();
@@ -8,6 +8,7 @@
 #include "system/ConvertPathName.hpp"
 #include "Engine/Trace/Trace.hpp"
 #include "Engine/Trace/Vector.hpp"
+#include "Engine/Trace/Columns.hpp"
 #include "Printing.hpp"
 #include "TestUtil.hpp"
 #include "util/PrintException.hxx"
@@ -37,6 +38,41 @@ OnAdvance(Trace &trace, const GeoPoint &loc, const double alt,
   }
 }
 
+/**
+ * Keep the #TraceColumns in step with the #Trace, the way
+ * TraceManager does it.
+ */
+static void
+SyncColumns(const Trace &trace, TraceColumns &columns, Serial &modify_serial)
+{
+  if (modify_serial != trace.GetModifySerial()) {
+    trace.GetPoints(columns);
+    modify_serial = trace.GetModifySerial();
+  } else
+    trace.SyncPoints(columns);
+}
+
+/**
+ * Compare the #TraceColumns with the points of the #Trace.
+ */
+static bool
+CompareColumns(const Trace &trace, const TraceColumns &columns)
+{
+  TracePointVector v;
+  trace.GetPoints(v);
+
+  if (v.size() != columns.size())
+    return false;
+
+  for (std::size_t i = 0; i < v.size(); ++i)
+    if (v[i].GetTime() != columns.GetTime(i) ||
+        v[i].GetFlatLocation() != columns.GetFlatLocation(i) ||
+        v[i].GetIntegerAltitude() != columns.GetIntegerAltitude(i))
+      return false;
+
+  return true;
+}
+
 static bool
 TestTrace(Path filename, unsigned ntrace, bool output=false)
 {
@@ -48,6 +84,9 @@ TestTrace(Path filename, unsigned ntrace, bool output=false)
   IGCExtensions extensions;
   extensions.clear();
 
+  TraceColumns columns;
+  Serial modify_serial;
+
   char *line;
   int i = 0;
   for (; (line = reader.ReadLine()) != NULL; i++) {
@@ -64,10 +103,11 @@ TestTrace(Path filename, unsigned ntrace, bool output=false)
               fix.location,
               fix.gps_altitude,
               TimeStamp{fix.time.DurationSinceMidnight()});
+    SyncColumns(trace, columns, modify_serial);
   }
   putchar('\n');
   printf("# samples %d\n", i);
-  return true;
+  return CompareColumns(trace, columns);
 }
 
 
@@ -4,6 +4,7 @@
 #include "Waypoint/WaypointReader.hpp"
 #include "Waypoint/WaypointReaderBase.hpp"
 #include "Waypoint/CupWriter.hpp"
+#include "Waypoint/WaypointCache.hpp"
 #include "Engine/Waypoint/Waypoints.hpp"
 #include "Terrain/RasterMap.hpp"
 #include "Units/System.hpp"
@@ -11,11 +12,14 @@
 #include "system/Path.hpp"
 #include "io/BufferedOutputStream.hxx"
 #include "io/StringOutputStream.hxx"
+#include "io/FileCache.hpp"
 #include "util/tstring.hpp"
 #include "util/StringAPI.hxx"
 #include "util/StringStrip.hxx"
 #include "Operation/Operation.hpp"
 
+#include <algorithm>
+#include <stdexcept>
 #include <vector>
 
 using std::string_view_literals::operator""sv;
@@ -318,6 +322,79 @@ TestCupWriter(const wp_vector &org_wp)
 )cup"sv);
 }
 
+[[gnu::pure]]
+static bool
+IsEqualWaypoint(const Waypoint &a, const Waypoint &b) noexcept
+{
+  return a.location == b.location &&
+    a.has_elevation == b.has_elevation &&
+    (!a.has_elevation || a.elevation == b.elevation) &&
+    a.shortname == b.shortname && a.name == b.name &&
+    a.comment == b.comment && a.details == b.details &&
+    a.files_embed == b.files_embed &&
+    a.original_id == b.original_id &&
+    a.runway.IsDirectionDefined() == b.runway.IsDirectionDefined() &&
+    (!a.runway.IsDirectionDefined() ||
+     a.runway.GetDirectionDegrees() == b.runway.GetDirectionDegrees()) &&
+    a.runway.IsLengthDefined() == b.runway.IsLengthDefined() &&
+    (!a.runway.IsLengthDefined() ||
+     a.runway.GetLength() == b.runway.GetLength()) &&
+    a.radio_frequency.IsDefined() == b.radio_frequency.IsDefined() &&
+    (!a.radio_frequency.IsDefined() ||
+     a.radio_frequency.GetKiloHertz() == b.radio_frequency.GetKiloHertz()) &&
+    a.type == b.type &&
+    a.flags.turn_point == b.flags.turn_point &&
+    a.flags.home == b.flags.home &&
+    a.flags.start_point == b.flags.start_point &&
+    a.flags.finish_point == b.flags.finish_point &&
+    a.origin == b.origin;
+}
+
+static void
+TestWaypointCache()
+{
+  const Path original_path(_T("test/data/waypoints3.cup"));
+  const TCHAR *const name = _T("waypoints3");
+  FileCache cache(AllocatedPath(_T("output/waypoint-cache")));
+  cache.Flush(name);
+
+  Waypoints parsed;
+  NullOperationEnvironment operation;
+  ReadWaypointFile(original_path, parsed,
+                   WaypointFactory(WaypointOrigin::NONE), operation);
+
+  std::vector<WaypointPtr> list(parsed.begin(), parsed.end());
+  std::sort(list.begin(), list.end(), [](const auto &a, const auto &b){
+    return a->id < b->id;
+  });
+
+  SaveWaypointCache(cache, name, original_path, original_path.c_str(), list);
+
+  Waypoints loaded;
+  ok1(LoadWaypointCache(cache, name, original_path, original_path.c_str(),
+                        loaded, WaypointFactory(WaypointOrigin::NONE)));
+  ok1(loaded.size() == list.size());
+
+  /* the ids are assigned in file order, which the cache preserves */
+  for (const auto &i : list) {
+    const auto wp = loaded.LookupId(i->id);
+    ok1(wp != nullptr && IsEqualWaypoint(*wp, *i));
+  }
+
+  /* the source is checked by the waypoint cache, the rest of the
+     file validation is covered by TestFlatCache */
+  Waypoints other;
+  bool thrown = false;
+  try {
+    LoadWaypointCache(cache, name, original_path, _T("other.cup"),
+                      other, WaypointFactory(WaypointOrigin::NONE));
+  } catch (const std::runtime_error &) {
+    thrown = true;
+  }
+
+  ok1(thrown && other.IsEmpty());
+}
+
 static wp_vector
 CreateOriginalWaypoints()
 {
@@ -420,7 +497,7 @@ int main()
 {
   wp_vector org_wp = CreateOriginalWaypoints();
 
-  plan_tests(451);
+  plan_tests(459);
 
   TestWinPilot(org_wp);
   TestSeeYou(org_wp);
@@ -431,6 +508,7 @@ int main()
   TestCompeGPS(org_wp);
   TestCompeGPS_UTM(org_wp);
   TestCupWriter(org_wp);
+  TestWaypointCache();
 
   return exit_status();
 }